@@ -0,0 +1,220 @@
+/* bench-scenarios: verifier throughput on named synthetic beacon workloads
+ *
+ * Usage: bench-scenarios [-s seed] [scenario...]
+ *
+ * Generates each scenario (default: all but mainnet-state-1M), checks that
+ * the buffer path, the reader path and ssz_validate all accept every object
+ * and that both roots match the generator's, then reports throughput of each
+ * path. The reader path is skipped for types it does not stream. Objects are
+ * processed one at a time, as a node would receive them.
+ *
+ * The reroot row stands in for the next slot: each object's first
+ * List[uint64] field (balances in a state) gets one element in 1000 changed,
+ * and the copy is re-rooted from a tree of the original. The restore row
+ * stands in for a restart: the tree is saved and mapped back in with
+ * ssz_tree_load (page cache warm). Types without such a field report
+ * "unsupported" for both. */
+
+#define _POSIX_C_SOURCE 200809L
+#include "workload.h"
+#include "ssz_kernels.h"
+#include "ssz_reroot.h"
+#include "ssz_view.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+typedef struct {
+  const uint8_t *data;
+  size_t len;
+  size_t pos;
+} SliceReader;
+
+static double now_s(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static size_t slice_reader(uint8_t *buf, size_t buf_size, void *ctx) {
+  SliceReader *r = (SliceReader *)ctx;
+  size_t n = r->len - r->pos < buf_size ? r->len - r->pos : buf_size;
+  memcpy(buf, r->data + r->pos, n);
+  r->pos += n;
+  return n;
+}
+
+/* Seconds for one pass over every object, or -1 when the path does not
+ * support the type; mode 0 = validate, 1 = buffer root, 2 = reader root */
+static double run_pass(const Workload *w, int mode) {
+  double t0 = now_s();
+  for (size_t i = 0; i < w->count; i++) {
+    const WorkloadObject *obj = &w->objects[i];
+    const uint8_t *bytes = w->bytes + obj->offset;
+    char err[128] = {0};
+    uint8_t root[32];
+    int status;
+    if (mode == 0) {
+      status = ssz_validate(bytes, obj->len, w->td, err);
+    } else if (mode == 1) {
+      status = ssz_stream_root_from_buffer(bytes, obj->len, w->td, root, err);
+    } else {
+      SliceReader r = {bytes, obj->len, 0};
+      status = ssz_stream_root_from_reader(slice_reader, &r, w->td, root, err);
+    }
+    if (status == SSZ_ERR_UNSUPPORTED_TYPE && mode == 2) return -1;
+    if (status != 0) {
+      fprintf(stderr, "bench-scenarios: %s object %zu rejected: %s\n", w->name, i, err);
+      exit(1);
+    }
+    if (mode != 0 && memcmp(root, obj->root, 32) != 0) {
+      fprintf(stderr, "bench-scenarios: %s object %zu root differs from the generator's\n", w->name, i);
+      exit(1);
+    }
+  }
+  return now_s() - t0;
+}
+
+/* Validation is fast enough to need repeats for a stable figure */
+static double best_validate(const Workload *w) {
+  double best = run_pass(w, 0);
+  double deadline = now_s() + 0.3;
+  while (now_s() < deadline) {
+    double dt = run_pass(w, 0);
+    if (dt < best) best = dt;
+  }
+  return best;
+}
+
+/* Index of the first List[uint64] field, or -1 */
+static int u64_list_field(const TypeDesc *td) {
+  if (td->kind != SSZ_KIND_CONTAINER) return -1;
+  for (uint32_t i = 0; i < td->field_count; i++) {
+    const TypeDesc *f = (const TypeDesc *)td->field_types[i];
+    const TypeDesc *elem = (const TypeDesc *)f->element_type;
+    if (f->kind == SSZ_KIND_LIST && elem != NULL && elem->kind == SSZ_KIND_BASIC && elem->fixed_size == 8) {
+      return (int)i;
+    }
+  }
+  return -1;
+}
+
+/* Seconds to re-root every edited object and to restore every saved tree;
+ * tree builds and saves are not counted */
+static void tree_passes(const Workload *w, double *reroot, double *restore) {
+  int field = u64_list_field(w->td);
+  *reroot = *restore = -1;
+  if (field < 0) return;
+  char path[] = "/tmp/bench-tree-XXXXXX";
+  int fd = mkstemp(path);
+  if (fd < 0) {
+    fprintf(stderr, "bench-scenarios: cannot create %s\n", path);
+    exit(1);
+  }
+  close(fd);
+  *reroot = *restore = 0;
+  for (size_t i = 0; i < w->count; i++) {
+    const WorkloadObject *obj = &w->objects[i];
+    const uint8_t *bytes = w->bytes + obj->offset;
+    char err[128] = {0};
+    uint8_t root[32], expected[32];
+    ssz_view_t v, list;
+    size_t list_len = 0;
+    ssz_view_init(&v, bytes, obj->len, w->td);
+    uint8_t *next = malloc(obj->len);
+    ssz_tree_t *tree = NULL;
+    if (next == NULL || ssz_view_field(&v, (uint32_t)field, &list, err) != 0 ||
+        ssz_tree_build(bytes, obj->len, w->td, &tree, root, err) != 0) {
+      fprintf(stderr, "bench-scenarios: %s object %zu: cannot build tree: %s\n", w->name, i, err);
+      exit(1);
+    }
+    memcpy(next, bytes, obj->len);
+    size_t at = (size_t)(ssz_view_bytes(&list, &list_len) - bytes);
+    for (size_t k = 0; k < list_len / 8; k += 1000) next[at + k * 8]++;
+
+    ssz_tree_t *loaded = NULL;
+    uint8_t loaded_root[32];
+    if (ssz_tree_save(tree, path, err) != 0) {
+      fprintf(stderr, "bench-scenarios: %s object %zu: %s\n", w->name, i, err);
+      exit(1);
+    }
+    double t0 = now_s();
+    if (ssz_tree_load(path, bytes, obj->len, w->td, &loaded, loaded_root, err) != 0 ||
+        memcmp(loaded_root, root, 32) != 0) {
+      fprintf(stderr, "bench-scenarios: %s object %zu: restore failed: %s\n", w->name, i, err);
+      exit(1);
+    }
+    *restore += now_s() - t0;
+    ssz_tree_free(loaded);
+
+    t0 = now_s();
+    int status = ssz_reroot(bytes, obj->len, tree, next, obj->len, w->td, root, NULL, err);
+    *reroot += now_s() - t0;
+    if (status != 0 || ssz_stream_root_from_buffer(next, obj->len, w->td, expected, err) != 0 ||
+        memcmp(root, expected, 32) != 0) {
+      fprintf(stderr, "bench-scenarios: %s object %zu: reroot disagrees with a full hash\n", w->name, i);
+      exit(1);
+    }
+    ssz_tree_free(tree);
+    free(next);
+  }
+  unlink(path);
+}
+
+static void report(const char *path, const Workload *w, double seconds) {
+  if (seconds < 0) {
+    printf("  %-10s %15s\n", path, "unsupported");
+    return;
+  }
+  printf("  %-10s %10.1f MB/s %12.1f obj/s %10.2f us/obj\n", path, (double)w->len / seconds / 1e6,
+         (double)w->count / seconds, seconds * 1e6 / (double)w->count);
+}
+
+static int run_scenario(const char *name, uint64_t seed) {
+  Workload w;
+  char err[128] = {0};
+  double t0 = now_s();
+  if (workload_generate(name, seed, &w, err) != 0) {
+    fprintf(stderr, "bench-scenarios: %s: %s\n", name, err);
+    return 1;
+  }
+  double encode = now_s() - t0;
+
+  printf("%s: %zu object(s), %.2f MB, seed %llu\n", name, w.count, (double)w.len / 1e6,
+         (unsigned long long)seed);
+  report("encode", &w, encode);
+  report("validate", &w, best_validate(&w));
+  report("root", &w, run_pass(&w, 1));
+  report("reader", &w, run_pass(&w, 2));
+  double reroot, restore;
+  tree_passes(&w, &reroot, &restore);
+  report("reroot", &w, reroot);
+  report("restore", &w, restore);
+  workload_free(&w);
+  return 0;
+}
+
+int main(int argc, char **argv) {
+  uint64_t seed = 1;
+  int named = 0;
+  int failed = 0;
+
+  printf("kernel %s\n", ssz_kernel_name(ssz_kernel_active()));
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+      seed = strtoull(argv[++i], NULL, 10);
+      continue;
+    }
+    failed |= run_scenario(argv[i], seed);
+    named = 1;
+  }
+  if (!named) {
+    for (const WorkloadScenario *s = WORKLOAD_SCENARIOS; s->name; s++) {
+      if (strcmp(s->name, "mainnet-state-1M") == 0) continue;
+      failed |= run_scenario(s->name, seed);
+    }
+  }
+  return failed;
+}
@@ -0,0 +1,184 @@
+/* bench-validate: ssz_validate against the full root path
+ *
+ * Usage: bench-validate [size_mib]
+ *
+ * For each payload the table shows throughput of validation under every
+ * supported kernel variant, of the hashing path, and of a plain read pass over
+ * the same bytes (the memory bandwidth ceiling). Packed lists validate near
+ * that ceiling; lists of containers stay well below it, bound by per-element
+ * dispatch rather than by memory.
+ * A second table times ssz_container_roots on validator records under each
+ * kernel against hashing the records one at a time. */
+
+#define _POSIX_C_SOURCE 200809L
+#include "ssz_kernels.h"
+#include "ssz_stream.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+typedef struct {
+  const char *name;
+  const TypeDesc *td;
+  uint8_t *bytes;
+  size_t len;
+} Payload;
+
+static double now_s(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static volatile uint64_t sink;
+
+/* Read every byte once: the bandwidth reference */
+static void read_pass(const uint8_t *bytes, size_t len) {
+  uint64_t acc = 0;
+  size_t i = 0;
+  for (; i + 8 <= len; i += 8) {
+    uint64_t w;
+    memcpy(&w, bytes + i, 8);
+    acc ^= w;
+  }
+  for (; i < len; i++) acc ^= bytes[i];
+  sink = acc;
+}
+
+/* Best-of-runs GB/s; mode 0 = read pass, 1 = validate, 2 = root */
+static double measure(const Payload *p, int mode) {
+  double best = 0;
+  double deadline = now_s() + 0.3;
+  int runs = 0;
+  while (runs < 3 || now_s() < deadline) {
+    char err[128] = {0};
+    uint8_t root[32];
+    int status = 0;
+    double t0 = now_s();
+    if (mode == 0) read_pass(p->bytes, p->len);
+    else if (mode == 1) status = ssz_validate(p->bytes, p->len, p->td, err);
+    else status = ssz_stream_root_from_buffer(p->bytes, p->len, p->td, root, err);
+    double dt = now_s() - t0;
+    if (status != 0) {
+      fprintf(stderr, "bench-validate: %s failed: %s\n", p->name, err);
+      exit(1);
+    }
+    double gbs = (double)p->len / dt / 1e9;
+    if (gbs > best) best = gbs;
+    runs++;
+    if (mode == 2) break; /* hashing is slow and steady: one run is enough */
+  }
+  return best;
+}
+
+static void put_le32(uint8_t *p, uint32_t v) {
+  for (int i = 0; i < 4; i++) p[i] = (uint8_t)(v >> (8 * i));
+}
+
+int main(int argc, char **argv) {
+  size_t size = (argc > 1 ? (size_t)strtoul(argv[1], NULL, 10) : 64) << 20;
+  static const TypeDesc u8_td = {SSZ_KIND_BASIC, 1, NULL, NULL, 0, 0};
+  static const TypeDesc u64_td = {SSZ_KIND_BASIC, 8, NULL, NULL, 0, 0};
+  static const TypeDesc bool_td = {SSZ_KIND_BOOL, 1, NULL, NULL, 0, 0};
+  static const TypeDesc bits_td = {SSZ_KIND_BITLIST, 0, NULL, NULL, 0, 2048};
+  static const TypeDesc bytes32_td = {SSZ_KIND_LIST, 0, &u8_td, NULL, 0, 32};
+  static const void *att_fields[3] = {&u64_td, &bytes32_td, &bits_td};
+  static const TypeDesc att_td = {SSZ_KIND_CONTAINER, 0, NULL, att_fields, 3, 0};
+  const TypeDesc att_list = {SSZ_KIND_LIST, 0, &att_td, NULL, 0, 0};
+  const TypeDesc bool_list = {SSZ_KIND_LIST, 0, &bool_td, NULL, 0, 0};
+  const TypeDesc bits_list = {SSZ_KIND_LIST, 0, &bits_td, NULL, 0, 0};
+
+  /* List[Bitlist]: 60-byte aggregation bitfields behind a 4-byte offset each */
+  size_t elem = 60;
+  size_t count = size / (elem + 4);
+  uint8_t *bits = malloc(count * (elem + 4));
+  uint8_t *flags = malloc(size);
+  /* List[{uint64, List[uint8, 32], Bitlist}]: 16-byte fixed part, 32 + 9 payload */
+  size_t att = 16 + 32 + 9;
+  size_t atts = size / (att + 4);
+  uint8_t *containers = malloc(atts * (att + 4));
+  if (!bits || !flags || !containers) {
+    fprintf(stderr, "bench-validate: out of memory\n");
+    return 1;
+  }
+  for (size_t i = 0; i < count; i++) put_le32(bits + i * 4, (uint32_t)(count * 4 + i * elem));
+  for (size_t i = 0; i < count * elem; i++) bits[count * 4 + i] = (uint8_t)(i * 7 + 1);
+  for (size_t i = 0; i < size; i++) flags[i] = (uint8_t)(((i * 2654435761u) >> 13) & 1);
+  for (size_t i = 0; i < atts; i++) {
+    uint8_t *a = containers + atts * 4 + i * att;
+    put_le32(containers + i * 4, (uint32_t)(atts * 4 + i * att));
+    memset(a, (int)(i & 0xff), att);
+    put_le32(a + 8, 16);
+    put_le32(a + 12, 48);
+    a[att - 1] = 0x01;
+  }
+
+  Payload payloads[] = {
+    {"List[Attestation-ish]", &att_list, containers, atts * (att + 4)},
+    {"List[bool]", &bool_list, flags, size},
+    {"List[Bitlist[2048]]", &bits_list, bits, count * (elem + 4)},
+  };
+  const ssz_kernel_t kernels[] = {SSZ_KERNEL_SCALAR, SSZ_KERNEL_SSE41, SSZ_KERNEL_AVX2, SSZ_KERNEL_AVX512};
+
+  printf("%-22s %-8s %12s %12s %12s\n", "payload", "kernel", "validate", "root", "read pass");
+  for (size_t p = 0; p < sizeof(payloads) / sizeof(payloads[0]); p++) {
+    ssz_kernel_select(SSZ_KERNEL_AUTO);
+    double root = measure(&payloads[p], 2);
+    double read = measure(&payloads[p], 0);
+    for (size_t k = 0; k < sizeof(kernels) / sizeof(kernels[0]); k++) {
+      if (ssz_kernel_select(kernels[k]) != kernels[k]) continue;
+      double validate = measure(&payloads[p], 1);
+      printf("%-22s %-8s %9.2f GB/s %7.3f GB/s %7.2f GB/s\n", payloads[p].name,
+             ssz_kernel_name(kernels[k]), validate, root, read);
+    }
+  }
+  printf("(%zu MiB payloads)\n", size >> 20);
+
+  /* Validator records: 8 fields, 8 hashes per element root */
+  static const TypeDesc bytes48_td = {SSZ_KIND_VECTOR, 48, &u8_td, NULL, 0, 0};
+  static const TypeDesc root32_td = {SSZ_KIND_VECTOR, 32, &u8_td, NULL, 0, 0};
+  static const void *validator_fields[8] = {&bytes48_td, &root32_td, &u64_td, &bool_td,
+                                            &u64_td, &u64_td, &u64_td, &u64_td};
+  static const TypeDesc validator_td = {SSZ_KIND_CONTAINER, 121, NULL, validator_fields, 8, 0};
+  size_t validators = (size >> 4) / 121;
+  uint8_t *records = malloc(validators * 121);
+  uint8_t (*roots)[32] = malloc(validators * 32);
+  if (!records || !roots) {
+    fprintf(stderr, "bench-validate: out of memory\n");
+    return 1;
+  }
+  for (size_t i = 0; i < validators * 121; i++) records[i] = (uint8_t)(i * 2654435761u >> 11);
+  for (size_t i = 0; i < validators; i++) records[i * 121 + 88] &= 1;
+
+  char err[128] = {0};
+  ssz_kernel_select(SSZ_KERNEL_AUTO);
+  double t0 = now_s();
+  for (size_t i = 0; i < validators; i++) {
+    if (ssz_stream_root_from_buffer(records + i * 121, 121, &validator_td, roots[i], err) != 0) {
+      fprintf(stderr, "bench-validate: validator %zu failed: %s\n", i, err);
+      return 1;
+    }
+  }
+  double serial = validators / (now_s() - t0) / 1e6;
+  printf("\n%-22s %-8s %12s %12s\n", "element roots", "kernel", "lanes", "one by one");
+  for (size_t k = 0; k < sizeof(kernels) / sizeof(kernels[0]); k++) {
+    if (ssz_kernel_select(kernels[k]) != kernels[k]) continue;
+    t0 = now_s();
+    if (ssz_container_roots(records, validators, &validator_td, roots, err) != 0) {
+      fprintf(stderr, "bench-validate: element roots failed: %s\n", err);
+      return 1;
+    }
+    double lanes = validators / (now_s() - t0) / 1e6;
+    printf("%-22s %-8s %7.3f M/s %7.3f M/s\n", "Validator x121B", ssz_kernel_name(kernels[k]), lanes, serial);
+  }
+  ssz_kernel_select(SSZ_KERNEL_AUTO);
+  printf("(%zu validators)\n", validators);
+
+  free(records);
+  free(roots);
+  free(bits);
+  free(flags);
+  free(containers);
+  return 0;
+}
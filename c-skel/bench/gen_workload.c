@@ -0,0 +1,82 @@
+/* ssz-workload: write synthetic beacon workloads to disk
+ *
+ * Usage: ssz-workload [-s seed] [-o dir] scenario...
+ *        ssz-workload -l
+ *
+ * For each scenario writes, into dir (default "."):
+ *   <scenario>.ssz        the objects back to back
+ *   <scenario>.type.json  their type, in the TypeScript TypeDesc shape
+ *   <scenario>.roots      one "offset length root" line per object
+ * so the same workload can be replayed by other implementations. */
+
+#include "workload.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static void usage(void) {
+  fprintf(stderr, "Usage: ssz-workload [-s seed] [-o dir] scenario...\n       ssz-workload -l\n");
+  exit(2);
+}
+
+static FILE *open_output(const char *dir, const char *name, const char *suffix) {
+  char path[1024];
+  snprintf(path, sizeof(path), "%s/%s%s", dir, name, suffix);
+  FILE *f = fopen(path, "wb");
+  if (f == NULL) fprintf(stderr, "ssz-workload: cannot write %s\n", path);
+  return f;
+}
+
+static int write_workload(const Workload *w, const char *dir) {
+  FILE *data = open_output(dir, w->name, ".ssz");
+  FILE *type = open_output(dir, w->name, ".type.json");
+  FILE *roots = open_output(dir, w->name, ".roots");
+  int ok = data && type && roots;
+
+  if (ok) {
+    ok = fwrite(w->bytes, 1, w->len, data) == w->len;
+    workload_write_type_json(type, w->td);
+    fputc('\n', type);
+    for (size_t i = 0; i < w->count; i++) {
+      fprintf(roots, "%zu %zu ", w->objects[i].offset, w->objects[i].len);
+      for (int b = 0; b < 32; b++) fprintf(roots, "%02x", w->objects[i].root[b]);
+      fputc('\n', roots);
+    }
+  }
+  if (data && fclose(data) != 0) ok = 0;
+  if (type && fclose(type) != 0) ok = 0;
+  if (roots && fclose(roots) != 0) ok = 0;
+  return ok ? 0 : 1;
+}
+
+int main(int argc, char **argv) {
+  uint64_t seed = 1;
+  const char *dir = ".";
+  int first = 1;
+
+  for (; first < argc && argv[first][0] == '-'; first++) {
+    if (strcmp(argv[first], "-l") == 0) {
+      for (const WorkloadScenario *s = WORKLOAD_SCENARIOS; s->name; s++) printf("%-26s %s\n", s->name, s->summary);
+      return 0;
+    }
+    if (first + 1 >= argc) usage();
+    if (strcmp(argv[first], "-s") == 0) seed = strtoull(argv[++first], NULL, 10);
+    else if (strcmp(argv[first], "-o") == 0) dir = argv[++first];
+    else usage();
+  }
+  if (first >= argc) usage();
+
+  for (int i = first; i < argc; i++) {
+    Workload w;
+    char err[128] = {0};
+    if (workload_generate(argv[i], seed, &w, err) != 0) {
+      fprintf(stderr, "ssz-workload: %s: %s\n", argv[i], err);
+      return 1;
+    }
+    int failed = write_workload(&w, dir);
+    printf("%s: %zu object(s), %zu bytes%s\n", w.name, w.count, w.len, failed ? " (write failed)" : "");
+    workload_free(&w);
+    if (failed) return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,347 @@
+/* ssz-load: tail latency of the C library under concurrent offered load
+ *
+ * Usage: ssz-load [-c clients] [-r rate] [-d seconds] [-s seed] [-k kernel]
+ *                 [-m scenario:weight,...] [-o file.hgrm]
+ *
+ * Each of `clients` threads roots workload objects with
+ * ssz_stream_root_from_buffer, one at a time, and checks each root against
+ * the generator's. Objects are drawn from the scenarios of workload.c in
+ * proportion to their weights (default: mostly small gossip objects, some
+ * sync aggregates and an occasional block body).
+ *
+ * With -r the clients share `rate` requests per second between them. Each
+ * request has an intended start time on that schedule. A client that falls
+ * behind starts late requests at once, and their latency is counted from
+ * the intended start (coordinated-omission correction, as in wrk2). The
+ * service time (from the actual start) is recorded too, so the gap between
+ * the two is time spent queued behind slow requests. Without -r the clients
+ * run flat out and the two are the same.
+ *
+ * Latencies go into HDR histograms (3 significant digits, 1 ns to an hour),
+ * one per scenario and one overall. -o writes the overall corrected
+ * histogram in HdrHistogram's percentile-distribution text format. */
+
+#define _GNU_SOURCE
+#include "workload.h"
+#include "ssz_kernels.h"
+#include <errno.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static void usage(void) {
+  fprintf(stderr, "Usage: ssz-load [-c clients] [-r rate] [-d seconds] [-s seed] [-k kernel]\n"
+                  "                [-m scenario:weight,...] [-o file.hgrm]\n");
+  exit(2);
+}
+
+static uint64_t now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+static void sleep_until(uint64_t ns) {
+  struct timespec ts = {(time_t)(ns / 1000000000u), (long)(ns % 1000000000u)};
+  while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR) {
+  }
+}
+
+/* ===== HDR histogram =====
+ * Values below 2048 have their own bucket. Above that, each power of two is
+ * split into 1024 buckets, so a recorded value is off by at most 1/1024. */
+
+#define HDR_SUB_BITS 10
+#define HDR_SUB (1u << HDR_SUB_BITS)
+#define HDR_MAX_SHIFT 32                      /* 2^42 ns, over an hour */
+#define HDR_BUCKETS ((HDR_MAX_SHIFT + 2) * HDR_SUB)
+
+typedef struct {
+  uint64_t counts[HDR_BUCKETS];
+  uint64_t total;
+  uint64_t max;
+} Hdr;
+
+static uint32_t hdr_index(uint64_t v) {
+  if (v < 2 * HDR_SUB) return (uint32_t)v;
+  uint32_t shift = 63 - (uint32_t)__builtin_clzll(v) - HDR_SUB_BITS;
+  if (shift > HDR_MAX_SHIFT) return HDR_BUCKETS - 1;
+  return (shift + 1) * HDR_SUB + (uint32_t)(v >> shift) - HDR_SUB;
+}
+
+/* Largest value that lands in bucket i */
+static uint64_t hdr_value(uint32_t i) {
+  if (i < 2 * HDR_SUB) return i;
+  uint32_t shift = i / HDR_SUB - 1;
+  return (((uint64_t)(i % HDR_SUB + HDR_SUB) + 1) << shift) - 1;
+}
+
+static void hdr_record(Hdr *h, uint64_t v) {
+  h->counts[hdr_index(v)]++;
+  h->total++;
+  if (v > h->max) h->max = v;
+}
+
+static void hdr_add(Hdr *to, const Hdr *from) {
+  for (uint32_t i = 0; i < HDR_BUCKETS; i++) to->counts[i] += from->counts[i];
+  to->total += from->total;
+  if (from->max > to->max) to->max = from->max;
+}
+
+static uint64_t hdr_percentile(const Hdr *h, double q) {
+  if (h->total == 0) return 0;
+  uint64_t rank = (uint64_t)(q / 100 * (double)h->total + 0.5);
+  if (rank < 1) rank = 1;
+  uint64_t seen = 0;
+  for (uint32_t i = 0; i < HDR_BUCKETS; i++) {
+    seen += h->counts[i];
+    if (seen >= rank) return hdr_value(i) < h->max ? hdr_value(i) : h->max;
+  }
+  return h->max;
+}
+
+/* Percentile distribution in the text format HdrHistogram's plotter reads,
+ * values in microseconds */
+static int hdr_write(const Hdr *h, const char *path) {
+  FILE *f = fopen(path, "w");
+  if (!f) return -1;
+  fprintf(f, "%12s %14s %10s %14s\n\n", "Value", "Percentile", "TotalCount", "1/(1-Percentile)");
+  uint64_t seen = 0;
+  for (uint32_t i = 0; i < HDR_BUCKETS; i++) {
+    if (h->counts[i] == 0) continue;
+    seen += h->counts[i];
+    double p = (double)seen / (double)h->total;
+    uint64_t v = hdr_value(i) < h->max ? hdr_value(i) : h->max;
+    if (p < 1) fprintf(f, "%12.3f %14.12f %10llu %14.2f\n", v / 1e3, p, (unsigned long long)seen, 1 / (1 - p));
+    else fprintf(f, "%12.3f %14.12f %10llu\n", v / 1e3, p, (unsigned long long)seen);
+  }
+  fprintf(f, "#[Max = %12.3f, Total count = %12llu]\n", h->max / 1e3, (unsigned long long)h->total);
+  return fclose(f) == 0 ? 0 : -1;
+}
+
+/* ===== Load ===== */
+
+#define MAX_SCENARIOS 8
+
+typedef struct {
+  Workload w;
+  uint32_t weight;
+} MixEntry;
+
+typedef struct {
+  MixEntry mix[MAX_SCENARIOS];
+  uint32_t mix_count;
+  uint32_t weight_total;
+  uint32_t clients;
+  double rate;                 /* requests per second over all clients, 0 for flat out */
+  uint64_t start_ns;
+  uint64_t end_ns;
+} Load;
+
+typedef struct {
+  const Load *load;
+  uint32_t index;
+  uint64_t rng;
+  Hdr *corrected;              /* one per scenario, then the total */
+  Hdr *service;
+  uint64_t mismatches;
+  uint64_t failures;
+  uint64_t late;               /* requests started after their intended time */
+} Client;
+
+static uint64_t rng_next(uint64_t *s) {
+  uint64_t z = (*s += 0x9e3779b97f4a7c15ull);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+  return z ^ (z >> 31);
+}
+
+static void *run_client(void *arg) {
+  Client *c = (Client *)arg;
+  const Load *load = c->load;
+  /* Client k takes requests k, k + clients, ... of the shared schedule */
+  uint64_t interval = load->rate > 0 ? (uint64_t)(1e9 * load->clients / load->rate) : 0;
+  uint64_t intended = load->start_ns + (load->rate > 0 ? (uint64_t)(1e9 * c->index / load->rate) : 0);
+
+  for (;;) {
+    uint64_t now = now_ns();
+    if (interval > 0) {
+      if (intended >= load->end_ns) break;
+      if (now < intended) {
+        sleep_until(intended);
+        now = now_ns();
+      } else if (now - intended > 1000) {
+        c->late++;
+      }
+    } else {
+      if (now >= load->end_ns) break;
+      intended = now;
+    }
+
+    uint32_t pick = (uint32_t)(rng_next(&c->rng) % load->weight_total);
+    uint32_t s = 0;
+    while (pick >= load->mix[s].weight) pick -= load->mix[s++].weight;
+    const Workload *w = &load->mix[s].w;
+    const WorkloadObject *o = &w->objects[rng_next(&c->rng) % w->count];
+
+    uint8_t root[32];
+    char err[128] = {0};
+    int status = ssz_stream_root_from_buffer(w->bytes + o->offset, o->len, w->td, root, err);
+    uint64_t done = now_ns();
+    if (status != SSZ_ERR_NONE) c->failures++;
+    else if (memcmp(root, o->root, 32) != 0) c->mismatches++;
+
+    hdr_record(&c->corrected[s], done - intended);
+    hdr_record(&c->service[s], done - now);
+    intended += interval;
+  }
+  return NULL;
+}
+
+static int parse_mix(Load *load, const char *spec, uint64_t seed) {
+  char buf[512];
+  snprintf(buf, sizeof(buf), "%s", spec);
+  for (char *save = NULL, *item = strtok_r(buf, ",", &save); item; item = strtok_r(NULL, ",", &save)) {
+    char *colon = strchr(item, ':');
+    uint32_t weight = 1;
+    if (colon) {
+      *colon = 0;
+      weight = (uint32_t)strtoul(colon + 1, NULL, 10);
+    }
+    if (load->mix_count == MAX_SCENARIOS || weight == 0) return -1;
+    MixEntry *e = &load->mix[load->mix_count];
+    char err[128] = {0};
+    if (workload_generate(item, seed, &e->w, err) != 0) {
+      fprintf(stderr, "ssz-load: %s: %s\n", item, err);
+      return -1;
+    }
+    /* workload_generate keeps the name pointer; ours is on the stack */
+    e->w.name = strdup(item);
+    e->weight = weight;
+    load->weight_total += weight;
+    load->mix_count++;
+  }
+  return load->mix_count > 0 ? 0 : -1;
+}
+
+static void print_row(const char *name, const char *kind, const Hdr *h, double seconds) {
+  printf("  %-26s %-9s %9llu %9.0f %9.1f %9.1f %9.1f %9.1f %9.1f %10.1f\n", name, kind,
+         (unsigned long long)h->total, h->total / seconds, hdr_percentile(h, 50) / 1e3,
+         hdr_percentile(h, 90) / 1e3, hdr_percentile(h, 99) / 1e3, hdr_percentile(h, 99.9) / 1e3,
+         hdr_percentile(h, 99.99) / 1e3, h->max / 1e3);
+}
+
+int main(int argc, char **argv) {
+  Load load;
+  memset(&load, 0, sizeof(load));
+  load.clients = 4;
+  double duration = 10;
+  uint64_t seed = 1;
+  const char *mix = "gossip-attestation-flood:90,sync-aggregate-stream:9,mainnet-block:1";
+  const char *kernel = NULL;
+  const char *out = NULL;
+
+  for (int i = 1; i < argc; i++) {
+    if (i + 1 >= argc) usage();
+    if (strcmp(argv[i], "-c") == 0) load.clients = (uint32_t)strtoul(argv[++i], NULL, 10);
+    else if (strcmp(argv[i], "-r") == 0) load.rate = strtod(argv[++i], NULL);
+    else if (strcmp(argv[i], "-d") == 0) duration = strtod(argv[++i], NULL);
+    else if (strcmp(argv[i], "-s") == 0) seed = strtoull(argv[++i], NULL, 10);
+    else if (strcmp(argv[i], "-k") == 0) kernel = argv[++i];
+    else if (strcmp(argv[i], "-m") == 0) mix = argv[++i];
+    else if (strcmp(argv[i], "-o") == 0) out = argv[++i];
+    else usage();
+  }
+  if (load.clients < 1 || load.rate < 0 || duration <= 0) usage();
+
+  if (kernel) {
+    const ssz_kernel_t kernels[] = {SSZ_KERNEL_AUTO, SSZ_KERNEL_SCALAR, SSZ_KERNEL_SSE41, SSZ_KERNEL_AVX2,
+                                    SSZ_KERNEL_AVX512};
+    int found = 0;
+    for (size_t k = 0; k < sizeof(kernels) / sizeof(kernels[0]); k++) {
+      if (strcmp(kernel, ssz_kernel_name(kernels[k])) != 0) continue;
+      found = 1;
+      if (ssz_kernel_select(kernels[k]) != kernels[k] && kernels[k] != SSZ_KERNEL_AUTO) {
+        fprintf(stderr, "ssz-load: kernel %s is not supported on this CPU\n", kernel);
+        return 1;
+      }
+    }
+    if (!found) usage();
+  }
+  if (parse_mix(&load, mix, seed) != 0) usage();
+
+  uint32_t slots = load.mix_count + 1;
+  Client *clients = calloc(load.clients, sizeof(*clients));
+  Hdr *hists = calloc((size_t)load.clients * slots * 2, sizeof(Hdr));
+  pthread_t *tids = calloc(load.clients, sizeof(*tids));
+  if (!clients || !hists || !tids) {
+    fprintf(stderr, "ssz-load: out of memory\n");
+    return 1;
+  }
+
+  load.start_ns = now_ns() + 1000000;
+  load.end_ns = load.start_ns + (uint64_t)(duration * 1e9);
+  for (uint32_t i = 0; i < load.clients; i++) {
+    clients[i].load = &load;
+    clients[i].index = i;
+    clients[i].rng = seed * 0x2545f4914f6cdd1dull + i;
+    clients[i].corrected = hists + (size_t)i * slots * 2;
+    clients[i].service = clients[i].corrected + slots;
+    if (pthread_create(&tids[i], NULL, run_client, &clients[i]) != 0) {
+      fprintf(stderr, "ssz-load: cannot start client %u\n", i);
+      return 1;
+    }
+  }
+
+  /* Merge into client 0's histograms; the last slot is the total */
+  uint64_t mismatches = 0, failures = 0, late = 0;
+  for (uint32_t i = 0; i < load.clients; i++) {
+    pthread_join(tids[i], NULL);
+    mismatches += clients[i].mismatches;
+    failures += clients[i].failures;
+    late += clients[i].late;
+  }
+  double seconds = (double)(now_ns() - load.start_ns) / 1e9;
+  Hdr *corrected = clients[0].corrected, *service = clients[0].service;
+  for (uint32_t i = 1; i < load.clients; i++) {
+    for (uint32_t s = 0; s < load.mix_count; s++) {
+      hdr_add(&corrected[s], &clients[i].corrected[s]);
+      hdr_add(&service[s], &clients[i].service[s]);
+    }
+  }
+  for (uint32_t s = 0; s < load.mix_count; s++) {
+    hdr_add(&corrected[load.mix_count], &corrected[s]);
+    hdr_add(&service[load.mix_count], &service[s]);
+  }
+  const Hdr *all = &corrected[load.mix_count];
+
+  printf("kernel %s, %u client(s), ", ssz_kernel_name(ssz_kernel_active()), load.clients);
+  if (load.rate > 0) printf("offered %.0f req/s", load.rate);
+  else printf("flat out");
+  printf(", %.1f s\n", seconds);
+  printf("achieved %.0f req/s, %llu started late, %llu failed, %llu root mismatch(es)\n\n",
+         all->total / seconds, (unsigned long long)late, (unsigned long long)failures,
+         (unsigned long long)mismatches);
+  printf("  %-26s %-9s %9s %9s %9s %9s %9s %9s %9s %10s\n", "scenario", "latency", "requests", "req/s",
+         "p50 us", "p90 us", "p99 us", "p99.9 us", "p99.99 us", "max us");
+  for (uint32_t s = 0; s <= load.mix_count; s++) {
+    const char *name = s < load.mix_count ? load.mix[s].w.name : "all";
+    print_row(name, "corrected", &corrected[s], seconds);
+    if (load.rate > 0) print_row("", "service", &service[s], seconds);
+  }
+
+  if (out && hdr_write(all, out) != 0) {
+    fprintf(stderr, "ssz-load: cannot write %s\n", out);
+    return 1;
+  }
+  for (uint32_t s = 0; s < load.mix_count; s++) {
+    free((char *)load.mix[s].w.name);
+    workload_free(&load.mix[s].w);
+  }
+  free(hists);
+  free(clients);
+  free(tids);
+  return failures || mismatches ? 1 : 0;
+}
@@ -0,0 +1,545 @@
+#include "workload.h"
+#include "ssz_encode.h"
+#include <stdlib.h>
+#include <string.h>
+
+/* ===== Types (mainnet presets; Bitvectors are byte vectors) ===== */
+
+#define FAR_FUTURE_EPOCH UINT64_MAX
+#define GWEI_PER_ETH 1000000000ull
+/* 2^40 in the spec; descriptor limits are 32 bits */
+#define REGISTRY_LIMIT 0xffffffffu
+
+static const TypeDesc U8 = {SSZ_KIND_BASIC, 1, NULL, NULL, 0, 0};
+static const TypeDesc U64 = {SSZ_KIND_BASIC, 8, NULL, NULL, 0, 0};
+static const TypeDesc BOOLEAN = {SSZ_KIND_BOOL, 1, NULL, NULL, 0, 0};
+static const TypeDesc BYTES4 = {SSZ_KIND_VECTOR, 4, &U8, NULL, 0, 0};
+static const TypeDesc BYTES32 = {SSZ_KIND_VECTOR, 32, &U8, NULL, 0, 0};
+static const TypeDesc BYTES48 = {SSZ_KIND_VECTOR, 48, &U8, NULL, 0, 0};
+static const TypeDesc BYTES96 = {SSZ_KIND_VECTOR, 96, &U8, NULL, 0, 0};
+
+static const void *CHECKPOINT_FIELDS[] = {&U64, &BYTES32};
+static const TypeDesc CHECKPOINT = {SSZ_KIND_CONTAINER, 40, NULL, CHECKPOINT_FIELDS, 2, 0};
+
+static const void *ATTESTATION_DATA_FIELDS[] = {&U64, &U64, &BYTES32, &CHECKPOINT, &CHECKPOINT};
+static const TypeDesc ATTESTATION_DATA = {SSZ_KIND_CONTAINER, 128, NULL, ATTESTATION_DATA_FIELDS, 5, 0};
+
+static const TypeDesc AGGREGATION_BITS = {SSZ_KIND_BITLIST, 0, NULL, NULL, 0, 2048};
+static const void *ATTESTATION_FIELDS[] = {&AGGREGATION_BITS, &ATTESTATION_DATA, &BYTES96};
+static const TypeDesc ATTESTATION = {SSZ_KIND_CONTAINER, 0, NULL, ATTESTATION_FIELDS, 3, 0};
+
+static const TypeDesc SYNC_COMMITTEE_BITS = {SSZ_KIND_VECTOR, 64, &U8, NULL, 0, 0};
+static const void *SYNC_AGGREGATE_FIELDS[] = {&SYNC_COMMITTEE_BITS, &BYTES96};
+static const TypeDesc SYNC_AGGREGATE = {SSZ_KIND_CONTAINER, 160, NULL, SYNC_AGGREGATE_FIELDS, 2, 0};
+
+static const void *ETH1_DATA_FIELDS[] = {&BYTES32, &U64, &BYTES32};
+static const TypeDesc ETH1_DATA = {SSZ_KIND_CONTAINER, 72, NULL, ETH1_DATA_FIELDS, 3, 0};
+
+static const TypeDesc ATTESTATIONS = {SSZ_KIND_LIST, 0, &ATTESTATION, NULL, 0, 128};
+static const void *BLOCK_BODY_FIELDS[] = {&BYTES96, &ETH1_DATA, &BYTES32, &ATTESTATIONS, &SYNC_AGGREGATE};
+static const TypeDesc BLOCK_BODY = {SSZ_KIND_CONTAINER, 0, NULL, BLOCK_BODY_FIELDS, 5, 0};
+
+static const void *VALIDATOR_FIELDS[] = {&BYTES48, &BYTES32, &U64, &BOOLEAN, &U64, &U64, &U64, &U64};
+static const TypeDesc VALIDATOR = {SSZ_KIND_CONTAINER, 121, NULL, VALIDATOR_FIELDS, 8, 0};
+
+static const void *FORK_FIELDS[] = {&BYTES4, &BYTES4, &U64};
+static const TypeDesc FORK = {SSZ_KIND_CONTAINER, 16, NULL, FORK_FIELDS, 3, 0};
+
+static const TypeDesc HISTORICAL_ROOTS = {SSZ_KIND_VECTOR, 8192 * 32, &BYTES32, NULL, 0, 0};
+static const TypeDesc RANDAO_MIXES = {SSZ_KIND_VECTOR, 65536 * 32, &BYTES32, NULL, 0, 0};
+static const TypeDesc SLASHINGS = {SSZ_KIND_VECTOR, 8192 * 8, &U64, NULL, 0, 0};
+static const TypeDesc VALIDATORS = {SSZ_KIND_LIST, 0, &VALIDATOR, NULL, 0, REGISTRY_LIMIT};
+static const TypeDesc GWEI_LIST = {SSZ_KIND_LIST, 0, &U64, NULL, 0, REGISTRY_LIMIT};
+static const TypeDesc PARTICIPATION = {SSZ_KIND_LIST, 0, &U8, NULL, 0, REGISTRY_LIMIT};
+static const TypeDesc JUSTIFICATION_BITS = {SSZ_KIND_VECTOR, 1, &U8, NULL, 0, 0};
+
+/* Altair-shaped state without the sync committees and execution header */
+static const void *STATE_FIELDS[] = {
+  &U64, &BYTES32, &U64, &FORK, &HISTORICAL_ROOTS, &HISTORICAL_ROOTS, &ETH1_DATA, &U64,
+  &VALIDATORS, &GWEI_LIST, &RANDAO_MIXES, &SLASHINGS, &PARTICIPATION, &PARTICIPATION,
+  &JUSTIFICATION_BITS, &CHECKPOINT, &CHECKPOINT, &CHECKPOINT, &GWEI_LIST,
+};
+#define STATE_FIELD_COUNT (sizeof(STATE_FIELDS) / sizeof(STATE_FIELDS[0]))
+static const TypeDesc STATE = {SSZ_KIND_CONTAINER, 0, NULL, STATE_FIELDS, STATE_FIELD_COUNT, 0};
+
+/* ===== Seeded generation ===== */
+
+typedef struct {
+  uint64_t state;
+} Rng;
+
+/* splitmix64: every stream is independent of how its consumer chunks reads */
+static uint64_t rng_next(Rng *r) {
+  uint64_t z = (r->state += 0x9e3779b97f4a7c15ull);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+  return z ^ (z >> 31);
+}
+
+static Rng rng_stream(uint64_t seed, uint64_t stream) {
+  Rng r = {seed ^ (stream * 0xd1b54a32d192ed03ull)};
+  rng_next(&r);
+  return r;
+}
+
+/* True with probability per_mille / 1000 */
+static int rng_chance(Rng *r, uint32_t per_mille) {
+  return rng_next(r) % 1000 < per_mille;
+}
+
+static void rng_fill(Rng *r, uint8_t *out, size_t n) {
+  for (size_t i = 0; i < n; i += 8) {
+    uint64_t v = rng_next(r);
+    for (size_t b = i; b < n && b < i + 8; b++) out[b] = (uint8_t)(v >> (8 * (b - i)));
+  }
+}
+
+static void put_le64(uint8_t *p, uint64_t v) {
+  for (int i = 0; i < 8; i++) p[i] = (uint8_t)(v >> (8 * i));
+}
+
+static ssz_value_t bytes_value(const uint8_t *data, size_t len) {
+  ssz_value_t v = {data, len, NULL, NULL, NULL, 0};
+  return v;
+}
+
+static ssz_value_t items_value(const ssz_value_t *items, size_t count) {
+  ssz_value_t v = {NULL, 0, NULL, NULL, items, count};
+  return v;
+}
+
+/* Packed lists too large to build in memory are pulled record by record */
+typedef void (*fill_fn)(Rng *rng, size_t index, uint8_t *record);
+
+typedef struct {
+  fill_fn fill;
+  size_t record_len;
+  Rng rng;
+  size_t index;
+  size_t pos;
+  uint8_t record[128];
+} RecordReader;
+
+static size_t record_reader(uint8_t *buf, size_t buf_size, void *ctx) {
+  RecordReader *r = (RecordReader *)ctx;
+  size_t n = 0;
+  while (n < buf_size) {
+    if (r->pos == r->record_len) {
+      r->fill(&r->rng, r->index++, r->record);
+      r->pos = 0;
+    }
+    size_t take = r->record_len - r->pos < buf_size - n ? r->record_len - r->pos : buf_size - n;
+    memcpy(buf + n, r->record + r->pos, take);
+    r->pos += take;
+    n += take;
+  }
+  return n;
+}
+
+static ssz_value_t reader_value(RecordReader *r, fill_fn fill, size_t record_len, size_t count, Rng rng) {
+  r->fill = fill;
+  r->record_len = record_len;
+  r->rng = rng;
+  r->index = 0;
+  r->pos = record_len;
+  ssz_value_t v = {NULL, count * record_len, record_reader, r, NULL, 0};
+  return v;
+}
+
+static void fill_random32(Rng *rng, size_t index, uint8_t *record) {
+  (void)index;
+  rng_fill(rng, record, 32);
+}
+
+/* Mainnet-like registry: mostly 32 ETH, 0x01 credentials, a few exits */
+static void fill_validator(Rng *rng, size_t index, uint8_t *record) {
+  uint64_t activation = index / 8;
+  uint64_t exit = FAR_FUTURE_EPOCH;
+  uint64_t withdrawable = FAR_FUTURE_EPOCH;
+  uint64_t balance = 32 * GWEI_PER_ETH;
+
+  rng_fill(rng, record, 48);
+  memset(record + 48, 0, 32);
+  if (rng_chance(rng, 600)) {
+    record[48] = 0x01;
+    rng_fill(rng, record + 60, 20);
+  } else {
+    rng_fill(rng, record + 49, 31);
+  }
+  if (rng_chance(rng, 30)) balance = (16 + rng_next(rng) % 16) * GWEI_PER_ETH;
+  if (rng_chance(rng, 40)) {
+    exit = activation + 256 + rng_next(rng) % 100000;
+    withdrawable = exit + 256;
+  }
+  put_le64(record + 80, balance);
+  record[88] = (uint8_t)rng_chance(rng, 2);
+  put_le64(record + 89, activation > 0 ? activation - 1 : 0);
+  put_le64(record + 97, activation);
+  put_le64(record + 105, exit);
+  put_le64(record + 113, withdrawable);
+}
+
+static void fill_balance(Rng *rng, size_t index, uint8_t *record) {
+  (void)index;
+  put_le64(record, 32 * GWEI_PER_ETH + rng_next(rng) % (GWEI_PER_ETH / 10));
+}
+
+/* Mostly zero, which exercises the zero-subtree shortcut */
+static void fill_sparse_u64(Rng *rng, size_t index, uint8_t *record) {
+  (void)index;
+  put_le64(record, rng_chance(rng, 20) ? rng_next(rng) % 1024 : 0);
+}
+
+/* Source, target and head flags for nearly everyone */
+static void fill_participation(Rng *rng, size_t index, uint8_t *record) {
+  (void)index;
+  record[0] = rng_chance(rng, 950) ? 0x07 : (uint8_t)(rng_next(rng) & 0x07);
+}
+
+/* Bitlist of `bits` bits, each set with probability per_mille / 1000, or
+ * exactly one set when per_mille is 0. Returns the serialized length. */
+static size_t make_bitlist(Rng *rng, uint8_t *out, size_t bits, uint32_t per_mille) {
+  size_t len = bits / 8 + 1;
+  memset(out, 0, len);
+  if (per_mille == 0) {
+    size_t bit = rng_next(rng) % bits;
+    out[bit / 8] |= (uint8_t)(1u << (bit % 8));
+  } else {
+    for (size_t i = 0; i < bits; i++) {
+      if (rng_chance(rng, per_mille)) out[i / 8] |= (uint8_t)(1u << (i % 8));
+    }
+  }
+  out[bits / 8] |= (uint8_t)(1u << (bits % 8));
+  return len;
+}
+
+/* ===== Objects ===== */
+
+typedef struct {
+  uint8_t data[128];
+  ssz_value_t source[2];
+  ssz_value_t target[2];
+  ssz_value_t fields[5];
+} AttestationDataValue;
+
+static void attestation_data_value(AttestationDataValue *a) {
+  a->source[0] = bytes_value(a->data + 48, 8);
+  a->source[1] = bytes_value(a->data + 56, 32);
+  a->target[0] = bytes_value(a->data + 88, 8);
+  a->target[1] = bytes_value(a->data + 96, 32);
+  a->fields[0] = bytes_value(a->data, 8);
+  a->fields[1] = bytes_value(a->data + 8, 8);
+  a->fields[2] = bytes_value(a->data + 16, 32);
+  a->fields[3] = items_value(a->source, 2);
+  a->fields[4] = items_value(a->target, 2);
+}
+
+static void make_attestation_data(Rng *rng, AttestationDataValue *a, uint64_t slot, uint64_t committee) {
+  uint64_t epoch = slot / 32;
+  put_le64(a->data, slot);
+  put_le64(a->data + 8, committee);
+  rng_fill(rng, a->data + 16, 32);
+  put_le64(a->data + 48, epoch - 1);
+  rng_fill(rng, a->data + 56, 32);
+  put_le64(a->data + 88, epoch);
+  rng_fill(rng, a->data + 96, 32);
+  attestation_data_value(a);
+}
+
+typedef struct {
+  uint8_t bits[257];
+  uint8_t signature[96];
+  AttestationDataValue data;
+  ssz_value_t fields[3];
+} AttestationValue;
+
+static void make_attestation(Rng *rng, AttestationValue *a, const AttestationDataValue *data,
+                             size_t committee_bits, uint32_t per_mille) {
+  size_t bits_len = make_bitlist(rng, a->bits, committee_bits, per_mille);
+  rng_fill(rng, a->signature, 96);
+  memcpy(a->data.data, data->data, sizeof(a->data.data));
+  attestation_data_value(&a->data);
+  a->fields[0] = bytes_value(a->bits, bits_len);
+  a->fields[1] = items_value(a->data.fields, 5);
+  a->fields[2] = bytes_value(a->signature, 96);
+}
+
+/* ===== Workload assembly ===== */
+
+static int append_object(Workload *w, size_t *cap, size_t *obj_cap, const ssz_value_t *v, char err[128]) {
+  size_t len;
+  int result = ssz_encoded_size(w->td, v, &len, err);
+  if (result != SSZ_ERR_NONE) return result;
+  if (w->len + len > *cap) {
+    size_t grown = *cap ? *cap : 4096;
+    while (grown < w->len + len) grown *= 2;
+    uint8_t *bytes = realloc(w->bytes, grown);
+    if (bytes == NULL) {
+      if (err) snprintf(err, 128, "Out of memory for %zu bytes", grown);
+      return SSZ_ERR_WORKSPACE_EXHAUSTED;
+    }
+    w->bytes = bytes;
+    *cap = grown;
+  }
+  if (w->count == *obj_cap) {
+    size_t grown = *obj_cap ? *obj_cap * 2 : 16;
+    WorkloadObject *objects = realloc(w->objects, grown * sizeof(*objects));
+    if (objects == NULL) {
+      if (err) snprintf(err, 128, "Out of memory for %zu objects", grown);
+      return SSZ_ERR_WORKSPACE_EXHAUSTED;
+    }
+    w->objects = objects;
+    *obj_cap = grown;
+  }
+
+  WorkloadObject *obj = &w->objects[w->count];
+  obj->offset = w->len;
+  result = ssz_encode_to_buffer(w->td, v, w->bytes + w->len, len, &obj->len, obj->root, err);
+  if (result != SSZ_ERR_NONE) return result;
+  w->len += obj->len;
+  w->count++;
+  return SSZ_ERR_NONE;
+}
+
+/* Committee size for a registry of `validators`: 32 slots x 64 committees */
+static size_t committee_bits(size_t validators) {
+  size_t bits = validators / 32 / 64;
+  if (bits < 4) bits = 4;
+  return bits > 2048 ? 2048 : bits;
+}
+
+static int gen_state(Workload *w, uint64_t seed, size_t validators, char err[128]) {
+  Rng rng = rng_stream(seed, 1);
+  uint64_t epoch = 300000;
+  uint8_t head[8 + 32 + 8 + 16 + 72 + 8 + 1 + 3 * 40];
+  uint8_t *genesis_time = head, *gvr = head + 8, *slot = head + 40, *fork = head + 48;
+  uint8_t *eth1 = head + 64, *deposit_index = head + 136, *justification = head + 144;
+  uint8_t *checkpoints = head + 145;
+
+  put_le64(genesis_time, 1606824023);
+  rng_fill(&rng, gvr, 32);
+  put_le64(slot, epoch * 32 + 7);
+  memcpy(fork, "\x02\x00\x00\x00\x03\x00\x00\x00", 8);
+  put_le64(fork + 8, epoch - 20000);
+  rng_fill(&rng, eth1, 72);
+  put_le64(eth1 + 32, validators);
+  put_le64(deposit_index, validators);
+  justification[0] = 0x0f;
+  for (int i = 0; i < 3; i++) {
+    put_le64(checkpoints + i * 40, epoch - 1 - (uint64_t)(i == 2));
+    rng_fill(&rng, checkpoints + i * 40 + 8, 32);
+  }
+
+  ssz_value_t fork_fields[3] = {bytes_value(fork, 4), bytes_value(fork + 4, 4), bytes_value(fork + 8, 8)};
+  ssz_value_t eth1_fields[3] = {bytes_value(eth1, 32), bytes_value(eth1 + 32, 8), bytes_value(eth1 + 40, 32)};
+  ssz_value_t cp_fields[3][2];
+  for (int i = 0; i < 3; i++) {
+    cp_fields[i][0] = bytes_value(checkpoints + i * 40, 8);
+    cp_fields[i][1] = bytes_value(checkpoints + i * 40 + 8, 32);
+  }
+
+  RecordReader readers[9];
+  ssz_value_t fields[STATE_FIELD_COUNT] = {
+    bytes_value(genesis_time, 8),
+    bytes_value(gvr, 32),
+    bytes_value(slot, 8),
+    items_value(fork_fields, 3),
+    reader_value(&readers[0], fill_random32, 32, 8192, rng_stream(seed, 2)),
+    reader_value(&readers[1], fill_random32, 32, 8192, rng_stream(seed, 3)),
+    items_value(eth1_fields, 3),
+    bytes_value(deposit_index, 8),
+    reader_value(&readers[2], fill_validator, 121, validators, rng_stream(seed, 4)),
+    reader_value(&readers[3], fill_balance, 8, validators, rng_stream(seed, 5)),
+    reader_value(&readers[4], fill_random32, 32, 65536, rng_stream(seed, 6)),
+    reader_value(&readers[5], fill_sparse_u64, 8, 8192, rng_stream(seed, 7)),
+    reader_value(&readers[6], fill_participation, 1, validators, rng_stream(seed, 8)),
+    reader_value(&readers[7], fill_participation, 1, validators, rng_stream(seed, 9)),
+    bytes_value(justification, 1),
+    items_value(cp_fields[0], 2),
+    items_value(cp_fields[1], 2),
+    items_value(cp_fields[2], 2),
+    reader_value(&readers[8], fill_sparse_u64, 8, validators, rng_stream(seed, 10)),
+  };
+  ssz_value_t state = items_value(fields, STATE_FIELD_COUNT);
+
+  size_t cap = 0, obj_cap = 0;
+  w->td = &STATE;
+  return append_object(w, &cap, &obj_cap, &state, err);
+}
+
+/* Block body with `count` aggregated attestations and a sync aggregate */
+static int gen_block(Workload *w, uint64_t seed, size_t count, size_t validators, char err[128]) {
+  Rng rng = rng_stream(seed, 20);
+  uint64_t slot = 300000 * 32 + 7;
+  uint8_t randao[96], graffiti[32], eth1[72], sync_bits[64], sync_sig[96];
+  AttestationValue *atts = calloc(count, sizeof(*atts));
+  ssz_value_t *att_values = calloc(count, sizeof(*att_values));
+  if (atts == NULL || att_values == NULL) {
+    free(atts);
+    free(att_values);
+    if (err) snprintf(err, 128, "Out of memory");
+    return SSZ_ERR_WORKSPACE_EXHAUSTED;
+  }
+
+  rng_fill(&rng, randao, 96);
+  rng_fill(&rng, eth1, 72);
+  memset(graffiti, 0, 32);
+  memcpy(graffiti, "synthetic-workload", 18);
+  for (size_t i = 0; i < count; i++) {
+    AttestationDataValue data;
+    make_attestation_data(&rng, &data, slot - 1 - i / 64, i % 64);
+    make_attestation(&rng, &atts[i], &data, committee_bits(validators), 900);
+    att_values[i] = items_value(atts[i].fields, 3);
+  }
+  for (int i = 0; i < 64; i++) {
+    sync_bits[i] = 0;
+    for (int b = 0; b < 8; b++) {
+      if (rng_chance(&rng, 970)) sync_bits[i] |= (uint8_t)(1u << b);
+    }
+  }
+  rng_fill(&rng, sync_sig, 96);
+
+  ssz_value_t eth1_fields[3] = {bytes_value(eth1, 32), bytes_value(eth1 + 32, 8), bytes_value(eth1 + 40, 32)};
+  ssz_value_t sync_fields[2] = {bytes_value(sync_bits, 64), bytes_value(sync_sig, 96)};
+  ssz_value_t fields[5] = {
+    bytes_value(randao, 96),
+    items_value(eth1_fields, 3),
+    bytes_value(graffiti, 32),
+    items_value(att_values, count),
+    items_value(sync_fields, 2),
+  };
+  ssz_value_t body = items_value(fields, 5);
+
+  size_t cap = 0, obj_cap = 0;
+  w->td = &BLOCK_BODY;
+  int result = append_object(w, &cap, &obj_cap, &body, err);
+  free(atts);
+  free(att_values);
+  return result;
+}
+
+/* Unaggregated gossip: one bit each, data shared within a committee */
+static int gen_attestation_flood(Workload *w, uint64_t seed, size_t count, size_t validators, char err[128]) {
+  Rng rng = rng_stream(seed, 30);
+  uint64_t slot = 300000 * 32 + 7;
+  AttestationDataValue data[64];
+  for (int i = 0; i < 64; i++) make_attestation_data(&rng, &data[i], slot, (uint64_t)i);
+
+  size_t cap = 0, obj_cap = 0;
+  w->td = &ATTESTATION;
+  for (size_t i = 0; i < count; i++) {
+    AttestationValue att;
+    make_attestation(&rng, &att, &data[rng_next(&rng) % 64], committee_bits(validators), 0);
+    ssz_value_t v = items_value(att.fields, 3);
+    int result = append_object(w, &cap, &obj_cap, &v, err);
+    if (result != SSZ_ERR_NONE) return result;
+  }
+  return SSZ_ERR_NONE;
+}
+
+static int gen_sync_aggregates(Workload *w, uint64_t seed, size_t count, char err[128]) {
+  Rng rng = rng_stream(seed, 40);
+  size_t cap = 0, obj_cap = 0;
+  w->td = &SYNC_AGGREGATE;
+  for (size_t i = 0; i < count; i++) {
+    uint8_t bits[64], sig[96];
+    for (int b = 0; b < 512; b++) {
+      if (b % 8 == 0) bits[b / 8] = 0;
+      if (rng_chance(&rng, 970)) bits[b / 8] |= (uint8_t)(1u << (b % 8));
+    }
+    rng_fill(&rng, sig, 96);
+    ssz_value_t fields[2] = {bytes_value(bits, 64), bytes_value(sig, 96)};
+    ssz_value_t v = items_value(fields, 2);
+    int result = append_object(w, &cap, &obj_cap, &v, err);
+    if (result != SSZ_ERR_NONE) return result;
+  }
+  return SSZ_ERR_NONE;
+}
+
+/* Balance lists from 1 to 16384 entries, spread evenly over powers of two so
+ * every size bucket gets objects. Flat, so every implementation can run it. */
+static int gen_balance_lists(Workload *w, uint64_t seed, size_t count, char err[128]) {
+  Rng rng = rng_stream(seed, 50);
+  uint8_t *balances = malloc(16384 * 8);
+  if (balances == NULL) {
+    if (err) snprintf(err, 128, "Out of memory");
+    return SSZ_ERR_WORKSPACE_EXHAUSTED;
+  }
+  size_t cap = 0, obj_cap = 0;
+  w->td = &GWEI_LIST;
+  int result = SSZ_ERR_NONE;
+  for (size_t i = 0; i < count && result == SSZ_ERR_NONE; i++) {
+    size_t n = (size_t)1 << (i % 14);
+    n += rng_next(&rng) % n;
+    for (size_t k = 0; k < n; k++) fill_balance(&rng, k, balances + k * 8);
+    ssz_value_t v = bytes_value(balances, n * 8);
+    result = append_object(w, &cap, &obj_cap, &v, err);
+  }
+  free(balances);
+  return result;
+}
+
+const WorkloadScenario WORKLOAD_SCENARIOS[] = {
+  {"mainnet-state-1M", "BeaconState with 2^20 validators (~150 MB)"},
+  {"mainnet-state-16k", "BeaconState with 16384 validators (~5 MB)"},
+  {"mainnet-block", "Block body with 128 aggregated attestations and a sync aggregate"},
+  {"gossip-attestation-flood", "100000 single-bit gossip attestations"},
+  {"sync-aggregate-stream", "10000 sync aggregates, 97% participation"},
+  {"balance-lists", "1500 List[uint64] of 1 to 16383 balances"},
+  {NULL, NULL},
+};
+
+int workload_generate(const char *name, uint64_t seed, Workload *out, char err[128]) {
+  int result;
+  memset(out, 0, sizeof(*out));
+  out->name = name;
+
+  if (strcmp(name, "mainnet-state-1M") == 0) {
+    result = gen_state(out, seed, (size_t)1 << 20, err);
+  } else if (strcmp(name, "mainnet-state-16k") == 0) {
+    result = gen_state(out, seed, 16384, err);
+  } else if (strcmp(name, "mainnet-block") == 0) {
+    result = gen_block(out, seed, 128, (size_t)1 << 20, err);
+  } else if (strcmp(name, "gossip-attestation-flood") == 0) {
+    result = gen_attestation_flood(out, seed, 100000, (size_t)1 << 20, err);
+  } else if (strcmp(name, "sync-aggregate-stream") == 0) {
+    result = gen_sync_aggregates(out, seed, 10000, err);
+  } else if (strcmp(name, "balance-lists") == 0) {
+    result = gen_balance_lists(out, seed, 1500, err);
+  } else {
+    if (err) snprintf(err, 128, "Unknown scenario '%s'", name);
+    return SSZ_ERR_UNSUPPORTED_TYPE;
+  }
+
+  if (result != SSZ_ERR_NONE) workload_free(out);
+  return result;
+}
+
+void workload_free(Workload *w) {
+  free(w->bytes);
+  free(w->objects);
+  w->bytes = NULL;
+  w->objects = NULL;
+  w->len = 0;
+  w->count = 0;
+}
+
+/* Bools are plain one-byte basics on the TypeScript side */
+void workload_write_type_json(FILE *f, const TypeDesc *td) {
+  fprintf(f, "{\"kind\":%d", td->kind == SSZ_KIND_BOOL ? (int)SSZ_KIND_BASIC : (int)td->kind);
+  if (td->fixed_size > 0) fprintf(f, ",\"fixedSize\":%u", td->fixed_size);
+  if (td->element_type != NULL) {
+    fprintf(f, ",\"elementType\":");
+    workload_write_type_json(f, (const TypeDesc *)td->element_type);
+  }
+  if (td->field_count > 0) {
+    fprintf(f, ",\"fieldTypes\":[");
+    for (uint32_t i = 0; i < td->field_count; i++) {
+      if (i > 0) fputc(',', f);
+      workload_write_type_json(f, (const TypeDesc *)td->field_types[i]);
+    }
+    fputc(']', f);
+  }
+  if (td->max_length > 0) fprintf(f, ",\"maxLength\":%u", td->max_length);
+  fputc('}', f);
+}
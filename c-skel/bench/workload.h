@@ -0,0 +1,46 @@
+#ifndef SSZ_WORKLOAD_H
+#define SSZ_WORKLOAD_H
+
+/* Deterministic synthetic beacon-chain workloads.
+ *
+ * Each named scenario produces seeded SSZ objects shaped like mainnet
+ * traffic (states with N validators, blocks with K attestations, gossip
+ * attestations, sync aggregates) together with their type and the root of
+ * every object. Objects are built with the encoder, so expected roots come
+ * from a different code path than the verifier under test. The same name
+ * and seed always give the same bytes. */
+
+#include "ssz_stream.h"
+#include <stdio.h>
+
+typedef struct {
+  size_t offset;
+  size_t len;
+  uint8_t root[32];
+} WorkloadObject;
+
+typedef struct {
+  const char *name;
+  const TypeDesc *td;            /* type of every object */
+  uint8_t *bytes;                /* objects back to back */
+  size_t len;
+  WorkloadObject *objects;
+  size_t count;
+} Workload;
+
+typedef struct {
+  const char *name;
+  const char *summary;
+} WorkloadScenario;
+
+/* Scenario table, terminated by a NULL name */
+extern const WorkloadScenario WORKLOAD_SCENARIOS[];
+
+int workload_generate(const char *name, uint64_t seed, Workload *out, char err[128]);
+
+void workload_free(Workload *w);
+
+/* Type descriptor as JSON in the TypeScript TypeDesc shape */
+void workload_write_type_json(FILE *f, const TypeDesc *td);
+
+#endif
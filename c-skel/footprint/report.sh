@@ -0,0 +1,117 @@
+#!/bin/bash
+# Code size and worst-case stack report for the SSZ_TINY profile
+#
+# Usage: report.sh source.c...
+#   CC      compiler (default gcc; e.g. riscv64-unknown-elf-gcc for the guest)
+#   CFLAGS  profile flags (default: -std=c11 -Os -DSSZ_TINY)
+#
+# Needs GCC 10+ for -fcallgraph-info. Stack figures follow direct calls only;
+# the reader and writer callbacks run on top of the reported depth.
+
+set -e
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+C_SKEL_DIR="$(dirname "$SCRIPT_DIR")"
+CC="${CC:-gcc}"
+CFLAGS="${CFLAGS:--std=c11 -Os -DSSZ_TINY}"
+CROSS="${CC%gcc}"
+OUT_DIR="$C_SKEL_DIR/build/footprint"
+
+if [ $# -eq 0 ]; then
+    echo "Usage: report.sh source.c..."
+    exit 2
+fi
+
+rm -rf "$OUT_DIR"
+mkdir -p "$OUT_DIR"
+cd "$C_SKEL_DIR"
+
+OBJECTS=()
+for src in "$@"; do
+    name="$(basename "$src" .c)"
+    $CC $CFLAGS -Wall -Wextra -Iinclude -Isrc -fstack-usage -fcallgraph-info=su \
+        -c "$src" -o "$OUT_DIR/$name.o" -dumpbase "$OUT_DIR/$name.c"
+    OBJECTS+=("$OUT_DIR/$name.o")
+done
+
+echo "=== SSZ_TINY footprint ($CC $CFLAGS) ==="
+echo ""
+"${CROSS}size" -t "${OBJECTS[@]}" | sed "s|$OUT_DIR/||"
+echo ""
+
+# The profile promises nothing from libc beyond memcpy and memset
+EXTERNAL="$("${CROSS}nm" -u "${OBJECTS[@]}" | awk 'NF == 2 { print $2 }' | sort -u)"
+DEFINED="$("${CROSS}nm" --defined-only "${OBJECTS[@]}" | awk 'NF == 3 { print $3 }' | sort -u)"
+LIBC="$(comm -23 <(echo "$EXTERNAL") <(echo "$DEFINED") | tr '\n' ' ')"
+echo "External symbols: ${LIBC:-none}"
+for sym in $LIBC; do
+    case "$sym" in
+        memcpy|memset) ;;
+        *) echo "ERROR: $sym is outside the SSZ_TINY libc budget"; exit 1 ;;
+    esac
+done
+echo ""
+
+# Longest call chain from each public function over the per-object call
+# graphs. Recursion (nested types) is cut at the back edge and reported as the
+# extra stack each nesting level costs.
+echo "Worst-case stack per public function (bytes):"
+awk '
+    function frame(n) { return (n in bytes) ? bytes[n] : 0 }
+    function walk(n, depth,    i, c, best, deep, cyc) {
+        if (n in worst) return worst[n]
+        onstack[n] = depth
+        base[depth + 1] = base[depth] + frame(n)
+        best = 0
+        recur[n] = 0
+        for (i = 1; i <= nedge[n]; i++) {
+            c = edge[n, i]
+            if (c == "__indirect_call") { callback[n] = 1; continue }
+            if (c in onstack) {
+                cyc = base[depth + 1] - base[onstack[c]]
+                if (cyc > recur[n]) recur[n] = cyc
+                continue
+            }
+            deep = walk(c, depth + 1)
+            if (deep > best) best = deep
+            if (recur[c] > recur[n]) recur[n] = recur[c]
+            if (c in callback) callback[n] = 1
+            if (c in dynamic) dynamic[n] = 1
+        }
+        delete onstack[n]
+        worst[n] = frame(n) + best
+        return worst[n]
+    }
+    /^node:/ {
+        match($0, /title: "[^"]*"/)
+        title = substr($0, RSTART + 8, RLENGTH - 9)
+        if (match($0, /[0-9]+ bytes \([a-z,]+\)/)) {
+            split(substr($0, RSTART, RLENGTH), f, " ")
+            bytes[title] = f[1]
+            if (f[3] == "(dynamic)") dynamic[title] = 1
+            if (title !~ /:/) public[title] = 1
+        }
+    }
+    /^edge:/ {
+        match($0, /sourcename: "[^"]*"/)
+        from = substr($0, RSTART + 13, RLENGTH - 14)
+        match($0, /targetname: "[^"]*"/)
+        to = substr($0, RSTART + 13, RLENGTH - 14)
+        edge[from, ++nedge[from]] = to
+    }
+    END {
+        base[0] = 0
+        for (n in public) {
+            notes = ""
+            if (walk(n, 0) && recur[n] > 0) notes = notes sprintf(" +%d per nesting level", recur[n])
+            if (n in callback) notes = notes " +callback"
+            if (n in dynamic) notes = notes " +unbounded frame"
+            printf "%8d  %s%s\n", worst[n], n, notes
+        }
+    }
+' "$OUT_DIR"/*.ci | sort -k1,1nr -k2
+echo ""
+ARENA="$("${CROSS}nm" -S "${OBJECTS[@]}" | awk '$4 == "tiny_arena" { print $2 }')"
+if [ -n "$ARENA" ]; then
+    echo "Shared merkle arena (bss, not reentrant): $((16#$ARENA)) bytes"
+fi
@@ -0,0 +1,67 @@
+#ifndef SSZ_ENCODE_H
+#define SSZ_ENCODE_H
+
+#include "ssz_stream.h"
+
+/* Hash-while-serialize encoder.
+ *
+ * Serializes a value described by a TypeDesc plus an ssz_value_t tree and
+ * merkleizes the emitted bytes as they go out, so the output and its root
+ * come from one pass. Offsets of variable-size fields are taken from a size
+ * pass over the value tree before anything is written; large packed lists
+ * can be pulled from a reader and never need to exist in memory at once.
+ * The root always equals ssz_stream_root_from_buffer over the output. */
+
+/* Which members are used depends on the type:
+ *   basic, bool, bitlist:            data/len (bitlists include the sentinel)
+ *   list/vector, fixed-size elements: data/len, reader/ctx with len, or items
+ *   list/vector, variable elements:   items/count
+ *   container:                        items/count, one per field */
+typedef struct ssz_value {
+  const uint8_t *data;
+  size_t len;
+  ssz_reader_fn reader;          /* pulls exactly len bytes when data is NULL */
+  void *ctx;
+  const struct ssz_value *items;
+  size_t count;
+} ssz_value_t;
+
+/* Output sink: consume len bytes, return 0 on success */
+typedef int (*ssz_writer_fn)(const uint8_t *buf, size_t len, void *ctx);
+
+/* Serialized size of v, checking its shape against td */
+int ssz_encoded_size(const TypeDesc *td, const ssz_value_t *v, size_t *out_len, char err[128]);
+
+/* Streams the encoding of v to write; out_root may be NULL */
+int ssz_encode(
+  const TypeDesc *td,
+  const ssz_value_t *v,
+  ssz_writer_fn write,
+  void *ctx,
+  uint8_t out_root[32],
+  char err[128]
+);
+
+/* Same, drawing scratch from ws; ssz_workspace_size(td, encoded size) is enough */
+int ssz_encode_ws(
+  ssz_workspace_t *ws,
+  const TypeDesc *td,
+  const ssz_value_t *v,
+  ssz_writer_fn write,
+  void *ctx,
+  uint8_t out_root[32],
+  char err[128]
+);
+
+/* Encodes into out[0 .. cap); *written is the encoded length */
+int ssz_encode_to_buffer(
+  const TypeDesc *td,
+  const ssz_value_t *v,
+  uint8_t *out,
+  size_t cap,
+  size_t *written,
+  uint8_t out_root[32],
+  char err[128]
+);
+
+#endif
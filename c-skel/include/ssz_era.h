@@ -0,0 +1,70 @@
+#ifndef SSZ_ERA_H
+#define SSZ_ERA_H
+
+#include "ssz_stream.h"
+
+/* e2store / .era archive verification (POSIX hosts only, not part of the no_std core).
+ * The archive is indexed in one sequential scan of the record headers, then every
+ * compressed record is decompressed and merkleized on a pool of worker threads,
+ * largest records first. Slot index records are checked against the record table. */
+
+/* Record types, as the 2-byte little-endian type field */
+#define SSZ_E2_TYPE_EMPTY 0x0000
+#define SSZ_E2_TYPE_BLOCK 0x0001          /* CompressedSignedBeaconBlock */
+#define SSZ_E2_TYPE_STATE 0x0002          /* CompressedBeaconState */
+#define SSZ_E2_TYPE_VERSION 0x3265        /* "e2" */
+#define SSZ_E2_TYPE_SLOT_INDEX 0x3269     /* "i2" */
+
+#define SSZ_E2_HEADER_SIZE 8
+
+typedef struct {
+  uint16_t type;
+  uint64_t offset;            /* file offset of the record header */
+  uint32_t length;            /* data bytes following the header */
+  int64_t slot;               /* slot from a slot index, -1 if not indexed */
+  uint64_t ssz_bytes;         /* decompressed length of hashed records */
+  int hashed;                 /* 1 if root holds the record's hash tree root */
+  int status;                 /* SSZ_ERR_NONE or the record's error */
+  uint8_t root[32];
+  char err[128];
+} ssz_era_record_t;
+
+typedef struct {
+  const TypeDesc *block_type; /* NULL = hash as List[uint8] */
+  const TypeDesc *state_type; /* NULL = hash as List[uint8] */
+  uint32_t threads;           /* worker threads, 0 = online CPUs */
+} ssz_era_opts_t;
+
+typedef struct {
+  ssz_era_record_t *records;  /* in file order, owned by the report */
+  size_t record_count;
+  size_t failed_records;
+  size_t index_mismatches;    /* index entries not pointing at a block or state record */
+  uint64_t compressed_bytes;
+  uint64_t ssz_bytes;
+  double seconds;             /* wall time of the parallel hashing phase */
+  uint32_t threads;
+} ssz_era_report_t;
+
+/* Verify an archive already in memory. opts may be NULL.
+ * Returns SSZ_ERR_NONE only if every record and index entry checks out;
+ * the report is filled whenever the record headers could be scanned. */
+int ssz_era_verify_buffer(
+  const uint8_t *data,
+  size_t len,
+  const ssz_era_opts_t *opts,
+  ssz_era_report_t *report,
+  char err[128]
+);
+
+/* mmap path and verify it */
+int ssz_era_verify_file(
+  const char *path,
+  const ssz_era_opts_t *opts,
+  ssz_era_report_t *report,
+  char err[128]
+);
+
+void ssz_era_report_free(ssz_era_report_t *report);
+
+#endif
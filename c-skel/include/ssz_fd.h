@@ -0,0 +1,35 @@
+#ifndef SSZ_FD_H
+#define SSZ_FD_H
+
+#include "ssz_stream.h"
+
+/* Read-ahead file descriptor input (POSIX hosts only, not part of the no_std core).
+ * A dedicated I/O thread fills a ring of aligned buffers, using io_uring where the
+ * kernel allows it and pread/read otherwise, while the calling thread merkleizes
+ * through the reader path. Disk and hasher stay busy at the same time. */
+
+typedef struct {
+  const char *backend;        /* "io_uring", "pread" or "read" */
+  uint64_t bytes_read;
+  uint64_t hash_wait_ns;      /* hashing thread waiting for data: I/O bound */
+  uint64_t io_wait_ns;        /* I/O thread waiting for a free buffer: hash bound */
+} ssz_fd_stats_t;
+
+typedef struct {
+  size_t buffer_size;         /* bytes per ring buffer, 0 = 1 MiB */
+  uint32_t buffer_count;      /* ring buffers in flight, 0 = 4 */
+  int disable_io_uring;       /* force the pread/read fallback */
+  uint64_t offset;            /* starting file offset (seekable fds only) */
+  ssz_fd_stats_t *stats;      /* optional, filled on return */
+} ssz_fd_opts_t;
+
+/* Root of the value stored in fd from opts->offset to EOF. opts may be NULL. */
+int ssz_stream_root_from_fd(
+  int fd,
+  const TypeDesc *td,
+  uint8_t out_root[32],
+  const ssz_fd_opts_t *opts,
+  char err[128]
+);
+
+#endif
@@ -0,0 +1,56 @@
+#ifndef SSZ_KERNELS_H
+#define SSZ_KERNELS_H
+
+#include "ssz_stream.h"
+
+/* Bulk validation and lane hashing kernels used by the verifier, with SSE4.1,
+ * AVX2 and AVX-512 versions on x86 and a portable scalar version everywhere
+ * else (RISC-V, ARM, no_std). The best supported variant is picked on first
+ * use; ssz_kernel_select can pin one, e.g. to benchmark or to cross-check the
+ * scalar path. SSZ_TINY builds carry the scalar variant only. */
+
+typedef enum {
+  SSZ_KERNEL_AUTO = 0,
+  SSZ_KERNEL_SCALAR = 1,
+  SSZ_KERNEL_SSE41 = 2,
+  SSZ_KERNEL_AVX2 = 3,
+  SSZ_KERNEL_AVX512 = 4       /* AVX2 validation, 16-wide lane hashing */
+} ssz_kernel_t;
+
+/* Select a variant; unsupported requests fall back to the best available.
+ * Returns the variant now active. Safe to call while other threads check;
+ * each kernel call uses whichever variant is active when it starts. */
+ssz_kernel_t ssz_kernel_select(ssz_kernel_t want);
+
+ssz_kernel_t ssz_kernel_active(void);
+
+const char *ssz_kernel_name(ssz_kernel_t kernel);
+
+/* Offset table of `count` little-endian u32 entries at `table`: the first must
+ * equal `first`, each must be <= the next (< when `strict`), and the last <= end.
+ * Returns SSZ_ERR_NONE or SSZ_ERR_BAD_OFFSET with the failing entry in *bad. */
+int ssz_check_offsets(const uint8_t *table, size_t count, uint32_t first, uint32_t end, int strict, size_t *bad);
+
+/* Every byte is 0 or 1. Returns SSZ_ERR_NONE or SSZ_ERR_NON_CANONICAL, *bad = index. */
+int ssz_check_bools(const uint8_t *bytes, size_t len, size_t *bad);
+
+/* Elements of a List[Bitlist] delimited by an already validated strict offset
+ * table (element i ends at entry i + 1, the last at end): each final byte holds
+ * the sentinel bit, so it must be non-zero. Returns SSZ_ERR_NONE or
+ * SSZ_ERR_BITLIST_PADDING with the failing element in *bad. */
+int ssz_check_bitlist_sentinels(const uint8_t *bytes, const uint8_t *table, size_t count, uint32_t end, size_t *bad);
+
+/* Index of the first byte where a and b differ, or len when they are equal.
+ * Used to diff two versions of a value a chunk run at a time. */
+size_t ssz_first_diff(const uint8_t *a, const uint8_t *b, size_t len);
+
+/* Messages hashed per ssz_hash_lanes call */
+#define SSZ_LANES 16
+
+/* SHA-256 of SSZ_LANES independent 64-byte messages, e.g. the same parent
+ * node of 16 equally shaped trees. The data is transposed: left[w][l] is
+ * big-endian word w of lane l's first 32 bytes, right[w][l] of its last 32,
+ * and out[w][l] receives word w of lane l's digest. out may alias an input. */
+void ssz_hash_lanes(uint32_t out[8][SSZ_LANES], const uint32_t left[8][SSZ_LANES], const uint32_t right[8][SSZ_LANES]);
+
+#endif
@@ -0,0 +1,78 @@
+#ifndef SSZ_REROOT_H
+#define SSZ_REROOT_H
+
+#include "ssz_stream.h"
+
+/* Re-rooting consecutive versions of one object (hosts only, not part of the
+ * no_std core). A tree keeps the interior nodes of every list, vector and
+ * bitlist reachable through container fields. ssz_reroot diffs the previous
+ * bytes against the new ones a chunk run at a time, rehashes only the chunks
+ * and variable-size elements that differ plus the paths above them, and
+ * leaves the tree describing the new version. Offsets that move only change
+ * which bytes are compared; a list that grows past the tree's capacity is
+ * rehashed whole. Trees can be saved to disk and mapped back in after a
+ * restart. */
+
+typedef struct ssz_tree ssz_tree_t;
+
+typedef struct {
+  uint64_t bytes_compared;    /* bytes diffed between the two versions */
+  uint64_t leaves_rehashed;   /* chunks and element roots recomputed */
+  uint32_t lists_rebuilt;     /* lists that outgrew the tree */
+} ssz_reroot_stats_t;
+
+/* Validate and hash bytes, keeping the nodes later versions need.
+ * On success *out_tree must be released with ssz_tree_free. */
+int ssz_tree_build(
+  const uint8_t *bytes,
+  size_t len,
+  const TypeDesc *td,
+  ssz_tree_t **out_tree,
+  uint8_t out_root[32],
+  char err[128]
+);
+
+/* Root of new_bytes, given the bytes the tree currently describes. new_bytes
+ * is validated in full first; on any error before hashing starts the tree is
+ * unchanged. td must be the type the tree was built for. stats may be NULL. */
+int ssz_reroot(
+  const uint8_t *old_bytes,
+  size_t old_len,
+  ssz_tree_t *tree,
+  const uint8_t *new_bytes,
+  size_t new_len,
+  const TypeDesc *td,
+  uint8_t out_root[32],
+  ssz_reroot_stats_t *stats,
+  char err[128]
+);
+
+/* Root of the version the tree describes */
+void ssz_tree_root(const ssz_tree_t *tree, uint8_t out_root[32]);
+
+/* Persist the tree so a restarted process can skip the full hash. The file
+ * is versioned and keyed by the type's shape and the value's root; it is
+ * written aside and renamed into place. */
+int ssz_tree_save(const ssz_tree_t *tree, const char *path, char err[128]);
+
+/* Map a saved tree back in for bytes, the version it was saved with. The
+ * stored root is rebuilt from the stored nodes and a sample of leaf paths is
+ * rehashed from bytes, so a stale or corrupt file is rejected rather than
+ * trusted; nothing else is hashed. The tree then serves ssz_reroot as if
+ * ssz_tree_build had produced it; pages are copied on first write. */
+int ssz_tree_load(
+  const char *path,
+  const uint8_t *bytes,
+  size_t len,
+  const TypeDesc *td,
+  ssz_tree_t **out_tree,
+  uint8_t out_root[32],
+  char err[128]
+);
+
+/* Bytes held by the tree's nodes */
+size_t ssz_tree_bytes(const ssz_tree_t *tree);
+
+void ssz_tree_free(ssz_tree_t *tree);
+
+#endif
@@ -0,0 +1,48 @@
+#ifndef SSZ_RESUME_H
+#define SSZ_RESUME_H
+
+#include "ssz_stream.h"
+
+/* Resumable streaming roots (hosts only, not part of the no_std core). The
+ * caller pushes the value's bytes in pieces of any size instead of being
+ * called back for them, so the whole computation state sits in the context:
+ * the merkle frontier of each value being hashed, the byte position, a
+ * pending partial chunk and the container offsets read so far. That state
+ * saves to a small versioned checkpoint and restores in another process,
+ * which continues from the same byte. Types, roots and accepted inputs are
+ * those of ssz_stream_root_from_reader. */
+
+typedef struct ssz_stream_ctx ssz_stream_ctx_t;
+
+/* Start a computation; release *out_ctx with ssz_stream_free */
+int ssz_stream_new(const TypeDesc *td, ssz_stream_ctx_t **out_ctx, char err[128]);
+
+/* Feed the next len bytes. Errors are sticky: once a call fails, every
+ * later call returns the same error. */
+int ssz_stream_update(ssz_stream_ctx_t *ctx, const uint8_t *bytes, size_t len, char err[128]);
+
+/* End of input: the root, or the error a reader hitting EOF here gets */
+int ssz_stream_final(ssz_stream_ctx_t *ctx, uint8_t out_root[32], char err[128]);
+
+/* Bytes fed so far; a restored context continues from this offset */
+uint64_t ssz_stream_position(const ssz_stream_ctx_t *ctx);
+
+/* Checkpoint the context into buf. Returns the checkpoint size and writes
+ * it only when cap is large enough, so a call with cap 0 sizes the buffer.
+ * Returns 0 for a context that has failed. */
+size_t ssz_stream_save(const ssz_stream_ctx_t *ctx, uint8_t *buf, size_t cap);
+
+/* Rebuild a context from a checkpoint saved for td. The checkpoint carries
+ * its format version, a hash of the type's shape and a checksum; one from
+ * another type, version or a torn write is rejected. */
+int ssz_stream_restore(
+  const uint8_t *buf,
+  size_t len,
+  const TypeDesc *td,
+  ssz_stream_ctx_t **out_ctx,
+  char err[128]
+);
+
+void ssz_stream_free(ssz_stream_ctx_t *ctx);
+
+#endif
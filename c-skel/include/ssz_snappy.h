@@ -0,0 +1,51 @@
+#ifndef SSZ_SNAPPY_H
+#define SSZ_SNAPPY_H
+
+#include "ssz_stream.h"
+
+/* Snappy framing format decoder exposed as an ssz_reader_fn source.
+ * Decompression feeds the merkleizer directly: one pass, no full-size
+ * intermediate buffer. Memory is bounded by one frame chunk in each
+ * direction, held inline in the decoder state. */
+
+/* Largest decompressed chunk allowed by the framing format */
+#define SSZ_SNAPPY_MAX_BLOCK 65536
+/* Largest compressed chunk body: CRC + worst-case snappy expansion of a full block */
+#define SSZ_SNAPPY_MAX_CHUNK (4 + 32 + SSZ_SNAPPY_MAX_BLOCK + SSZ_SNAPPY_MAX_BLOCK / 6)
+
+typedef struct {
+  ssz_reader_fn upstream;
+  void *upstream_ctx;
+  size_t out_pos;
+  size_t out_len;
+  int started;      /* stream identifier chunk seen */
+  int finished;     /* clean EOF or error reached */
+  int status;       /* SSZ_ERR_NONE or the decode error */
+  const char *msg;
+  uint8_t in[SSZ_SNAPPY_MAX_CHUNK];
+  uint8_t out[SSZ_SNAPPY_MAX_BLOCK];
+} ssz_snappy_reader_t;
+
+void ssz_snappy_reader_init(ssz_snappy_reader_t *r, ssz_reader_fn upstream, void *upstream_ctx);
+
+/* ssz_reader_fn over decompressed bytes; ctx is an ssz_snappy_reader_t.
+ * Decode errors end the stream early, so check ssz_snappy_reader_status()
+ * after consuming it (ssz_snappy_root_from_reader does this for you). */
+size_t ssz_snappy_read(uint8_t *buf, size_t buf_size, void *ctx);
+
+int ssz_snappy_reader_status(const ssz_snappy_reader_t *r, char err[128]);
+
+/* Root of the snappy-framed value produced by upstream; r is caller-owned scratch */
+int ssz_snappy_root_from_reader(
+  ssz_snappy_reader_t *r,
+  ssz_reader_fn upstream,
+  void *upstream_ctx,
+  const TypeDesc *td,
+  uint8_t out_root[32],
+  char err[128]
+);
+
+/* CRC-32C (Castagnoli), hardware accelerated on SSE4.2 and ARMv8 CRC */
+uint32_t ssz_crc32c(uint32_t crc, const uint8_t *data, size_t len);
+
+#endif
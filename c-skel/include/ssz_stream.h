@@ -11,7 +11,8 @@ typedef enum {
   SSZ_KIND_VECTOR = 1,
   SSZ_KIND_LIST = 2,
   SSZ_KIND_CONTAINER = 3,
-  SSZ_KIND_BITLIST = 4
+  SSZ_KIND_BITLIST = 4,
+  SSZ_KIND_BOOL = 5           /* basic, fixed_size 1, byte must be 0 or 1 */
 } TypeKind;
 
 typedef enum {
@@ -22,7 +23,9 @@ typedef enum {
   SSZ_ERR_UNSUPPORTED_TYPE = 4,
   SSZ_ERR_MALFORMED_HEADER = 5,
   SSZ_ERR_LENGTH_OVERFLOW = 6,
-  SSZ_ERR_UNEXPECTED_EOF = 7
+  SSZ_ERR_UNEXPECTED_EOF = 7,
+  SSZ_ERR_WORKSPACE_EXHAUSTED = 8,
+  SSZ_IN_PROGRESS = -1        /* not an error: ssz_ctx_step has work left */
 } SszError;
 
 typedef struct {
@@ -34,7 +37,8 @@ typedef struct {
   uint32_t max_length;
 } TypeDesc;
 
-/* Main API */
+/* Main API. Scratch is sized to the value (ssz_workspace_size), on the stack
+ * when small and the heap otherwise; SSZ_TINY builds use their fixed arena. */
 int ssz_stream_root_from_buffer(
   const uint8_t *bytes,
   size_t len,
@@ -43,6 +47,153 @@ int ssz_stream_root_from_buffer(
   char err[128]
 );
 
+/* Runs every check the hashing path does (offsets, lengths, limits, bitlist
+ * padding, booleans) without hashing or copying the payload. A value passes
+ * exactly when ssz_stream_root_from_buffer would accept it. */
+int ssz_validate(
+  const uint8_t *bytes,
+  size_t len,
+  const TypeDesc *td,
+  char err[128]
+);
+
+/* Root of one value inside bytes, e.g. state.validators or a block body's
+ * execution_payload. path[i] is a field index (containers) or element index
+ * (lists, vectors); only the offsets along the path are read, then just the
+ * selected value is checked and merkleized. depth 0 gives the whole root. */
+int ssz_subroot(
+  const uint8_t *bytes,
+  size_t len,
+  const TypeDesc *td,
+  const uint32_t *path,
+  size_t depth,
+  uint8_t out_root[32],
+  char err[128]
+);
+
+/* Same, addressed by a consensus-spec generalized index. Each container level
+ * takes ceil(log2(field_count)) bits, each list one mix-in bit (1 selects the
+ * length leaf) plus ceil(log2(limit)) bits with limit from max_length. Leaves
+ * of basic-element lists and bitlists are returned as raw 32-byte chunks.
+ * Indices of internal nodes are rejected with SSZ_ERR_UNSUPPORTED_TYPE. */
+int ssz_subroot_gindex(
+  const uint8_t *bytes,
+  size_t len,
+  const TypeDesc *td,
+  uint64_t gindex,
+  uint8_t out_root[32],
+  char err[128]
+);
+
+/* Sharded merkleization. Split the packed chunks of a basic-element list or
+ * vector (or any byte payload) into consecutive runs of 2^depth chunks, hash
+ * each run anywhere (another thread, process or host), then combine the run
+ * roots in order. Every depth gives the root ssz_stream_root_from_buffer
+ * computes serially, including for a short final run.
+ *
+ * ssz_subtree_root hashes chunks [chunk_start, chunk_start + chunk_count) of
+ * bytes, zero-padding the final partial chunk. chunk_start must be a multiple
+ * of 2^depth and chunk_count at most 2^depth; only the last run may be short. */
+int ssz_subtree_root(
+  const uint8_t *bytes,
+  size_t len,
+  uint64_t chunk_start,
+  uint64_t chunk_count,
+  uint32_t depth,
+  uint8_t out_root[32],
+  char err[128]
+);
+
+/* Root of n run roots produced by ssz_subtree_root with the same depth.
+ * length_mixin is the list's element count, or NULL for vectors. */
+int ssz_combine_subtrees(
+  const uint8_t (*roots)[32],
+  size_t n,
+  uint32_t depth,
+  const uint32_t *length_mixin,
+  uint8_t out_root[32],
+  char err[128]
+);
+
+/* Roots of `count` consecutive values of a fixed-size container type, e.g.
+ * the records of a List[Validator] payload, into out_roots[i]: the roots and
+ * errors ssz_stream_root_from_buffer gives for each element on its own.
+ * Every element has the same tree, so the layout in td is compiled once and
+ * SSZ_LANES elements run through it in lockstep, each field loaded across
+ * the lanes of a vector hash (ssz_hash_lanes). Layouts too large for that,
+ * and SSZ_TINY builds, hash one element at a time. */
+int ssz_container_roots(
+  const uint8_t *bytes,
+  size_t count,
+  const TypeDesc *td,
+  uint8_t (*out_roots)[32],
+  char err[128]
+);
+
+/* Caller-owned scratch memory: allocate once per thread, reused across calls.
+ * All internal scratch (merkle stacks, per-level buffers) is bump-allocated
+ * from it and released when the call returns, so verification itself never
+ * allocates and the memory bound is known up front. */
+typedef struct {
+  uint8_t *base;
+  size_t size;
+  size_t used;
+  size_t peak;
+} ssz_workspace_t;
+
+/* Bytes of workspace needed to process any value of type td up to max_len bytes */
+size_t ssz_workspace_size(const TypeDesc *td, size_t max_len);
+
+void ssz_workspace_init(ssz_workspace_t *ws, void *mem, size_t size);
+
+/* Same as ssz_stream_root_from_buffer, drawing all scratch from ws */
+int ssz_stream_root_from_buffer_ws(
+  ssz_workspace_t *ws,
+  const uint8_t *bytes,
+  size_t len,
+  const TypeDesc *td,
+  uint8_t out_root[32],
+  char err[128]
+);
+
+/* Cooperative root computation for hosts that cannot block on a large value
+ * (an event loop, an embedded main loop, a guest with a cycle quota). Each
+ * ssz_ctx_step call does a bounded slice of the work of
+ * ssz_stream_root_from_buffer_ws and returns SSZ_IN_PROGRESS until the final
+ * result, which is the same root or error that call gives. The context and
+ * all scratch are caller-owned: bytes and ws must stay valid until the final
+ * result, and ws must not be shared with other calls meanwhile. */
+typedef struct {
+  ssz_workspace_t *ws;
+  const uint8_t *bytes;
+  size_t len;
+  const TypeDesc *td;
+  void *frames;               /* one per nested value being hashed, in ws */
+  uint32_t depth;
+  int status;
+  uint8_t root[32];
+  char err[128];
+} ssz_ctx_t;
+
+/* Workspace bytes for stepping values of type td up to max_len bytes */
+size_t ssz_ctx_workspace_size(const TypeDesc *td, size_t max_len);
+
+int ssz_ctx_init(
+  ssz_ctx_t *ctx,
+  ssz_workspace_t *ws,
+  const uint8_t *bytes,
+  size_t len,
+  const TypeDesc *td,
+  char err[128]
+);
+
+/* Hash at most max_chunks chunks (0: no limit), counting each leaf chunk and
+ * each field or element root. Merges add one hash per chunk on average and
+ * the tree height at worst; checks that precede hashing a value, such as a
+ * list's offset table, run whole in the slice that opens it. Once the final
+ * result is in, later calls return it again. */
+int ssz_ctx_step(ssz_ctx_t *ctx, uint64_t max_chunks, uint8_t out_root[32], char err[128]);
+
 /* Reader callback: fill buf, return bytes read, 0 for EOF */
 typedef size_t (*ssz_reader_fn)(uint8_t *buf, size_t buf_size, void *ctx);
 
@@ -54,4 +205,16 @@ int ssz_stream_root_from_reader(
   char err[128]
 );
 
+/* Workspace bytes needed by the reader path for values of type td */
+size_t ssz_workspace_size_reader(const TypeDesc *td);
+
+int ssz_stream_root_from_reader_ws(
+  ssz_workspace_t *ws,
+  ssz_reader_fn reader,
+  void *ctx,
+  const TypeDesc *td,
+  uint8_t out_root[32],
+  char err[128]
+);
+
 #endif
@@ -0,0 +1,51 @@
+#ifndef SSZ_TRACE_H
+#define SSZ_TRACE_H
+
+#include "ssz_stream.h"
+
+/* Span tracing (hosts only). Builds with -DSSZ_TRACE record a begin and an
+ * end timestamp for each phase of a root computation (offset checks, leaf
+ * ingestion, each nested type, reader and I/O waits) into a buffer owned by
+ * the recording thread; no lock is taken on the recording path. The
+ * buffers export as Chrome Trace Event JSON, which Perfetto and
+ * chrome://tracing open directly. Without SSZ_TRACE the span macros expand
+ * to nothing and the functions below do no work. */
+
+#if defined(SSZ_TRACE) && defined(SSZ_TINY)
+#error "SSZ_TRACE needs a hosted build; SSZ_TINY has no clock or threads"
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifdef SSZ_TRACE
+void ssz_trace_event(const char *name, char phase);
+#define SSZ_TRACE_BEGIN(name) ssz_trace_event(name, 'B')
+#define SSZ_TRACE_END(name) ssz_trace_event(name, 'E')
+#else
+#define SSZ_TRACE_BEGIN(name) ((void)0)
+#define SSZ_TRACE_END(name) ((void)0)
+#endif
+
+/* Label the calling thread's track in the exported trace. name must stay
+ * valid until the trace is exported. */
+void ssz_trace_thread_name(const char *name);
+
+/* Write every thread's events to path as Chrome Trace Event JSON. Events
+ * still being recorded on other threads may or may not be included. A
+ * build without SSZ_TRACE writes an empty trace. */
+int ssz_trace_export(const char *path, char err[128]);
+
+/* Events recorded since the last reset, and those dropped because a
+ * thread's buffer was full */
+uint64_t ssz_trace_count(uint64_t *dropped);
+
+/* Forget recorded events. Only call while no traced work is running. */
+void ssz_trace_reset(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
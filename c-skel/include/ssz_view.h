@@ -0,0 +1,41 @@
+#ifndef SSZ_VIEW_H
+#define SSZ_VIEW_H
+
+#include "ssz_stream.h"
+
+/* Zero-copy typed views into a serialized value.
+ *
+ * A view is a byte range of the caller's buffer plus its type. Stepping into
+ * a field or element reads at most the two offsets that bound it; nothing is
+ * copied and only the offsets on the visited path are checked. Use
+ * ssz_validate up front when the whole value must be canonical. */
+
+typedef struct {
+  const uint8_t *bytes;
+  size_t len;
+  const TypeDesc *td;
+} ssz_view_t;
+
+/* Whole-value view; bytes must outlive every view derived from it */
+void ssz_view_init(ssz_view_t *view, const uint8_t *bytes, size_t len, const TypeDesc *td);
+
+/* Field `index` of a container view */
+int ssz_view_field(const ssz_view_t *view, uint32_t index, ssz_view_t *out, char err[128]);
+
+/* Element `index` of a list or vector view */
+int ssz_view_index(const ssz_view_t *view, size_t index, ssz_view_t *out, char err[128]);
+
+/* Elements of a list/vector, fields of a container, bits of a bitlist, bytes
+ * of a basic value */
+int ssz_view_len(const ssz_view_t *view, size_t *count, char err[128]);
+
+/* The view's serialized bytes, pointing into the original buffer */
+const uint8_t *ssz_view_bytes(const ssz_view_t *view, size_t *len);
+
+/* Little-endian value of a basic view of at most 8 bytes */
+int ssz_view_uint(const ssz_view_t *view, uint64_t *value, char err[128]);
+
+/* Validates and merkleizes just the viewed value */
+int ssz_view_root(const ssz_view_t *view, uint8_t out_root[32], char err[128]);
+
+#endif
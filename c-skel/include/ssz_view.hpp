@@ -0,0 +1,118 @@
+#ifndef SSZ_VIEW_HPP
+#define SSZ_VIEW_HPP
+
+/* Thin C++ wrapper over ssz_view.h. Views are two pointers and a length, so
+ * they are passed by value; navigation errors throw ssz::Error. */
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <stdexcept>
+
+extern "C" {
+#include "ssz_view.h"
+}
+
+namespace ssz {
+
+class Error : public std::runtime_error {
+public:
+  Error(int code, const char *msg) : std::runtime_error(msg), code_(code) {}
+  int code() const { return code_; }
+
+private:
+  int code_;
+};
+
+class View {
+public:
+  class Iterator;
+
+  View(const uint8_t *bytes, size_t len, const TypeDesc &td) { ssz_view_init(&v_, bytes, len, &td); }
+  explicit View(const ssz_view_t &v) : v_(v) {}
+
+  const TypeDesc &type() const { return *v_.td; }
+  const uint8_t *data() const { return v_.bytes; }
+  size_t byte_size() const { return v_.len; }
+  const ssz_view_t &c_view() const { return v_; }
+
+  View field(uint32_t index) const {
+    char err[128] = {0};
+    ssz_view_t out;
+    check(ssz_view_field(&v_, index, &out, err), err);
+    return View(out);
+  }
+
+  View operator[](size_t index) const {
+    char err[128] = {0};
+    ssz_view_t out;
+    check(ssz_view_index(&v_, index, &out, err), err);
+    return View(out);
+  }
+
+  /* Elements, fields or bits, as ssz_view_len */
+  size_t size() const {
+    char err[128] = {0};
+    size_t n = 0;
+    check(ssz_view_len(&v_, &n, err), err);
+    return n;
+  }
+
+  uint64_t as_uint() const {
+    char err[128] = {0};
+    uint64_t value = 0;
+    check(ssz_view_uint(&v_, &value, err), err);
+    return value;
+  }
+
+  void root(uint8_t out[32]) const {
+    char err[128] = {0};
+    check(ssz_view_root(&v_, out, err), err);
+  }
+
+  /* Element iteration over lists and vectors */
+  Iterator begin() const;
+  Iterator end() const;
+
+private:
+  static void check(int code, const char *err) {
+    if (code != SSZ_ERR_NONE) throw Error(code, err);
+  }
+
+  ssz_view_t v_;
+};
+
+class View::Iterator {
+public:
+  using iterator_category = std::input_iterator_tag;
+  using value_type = View;
+  using difference_type = std::ptrdiff_t;
+  using pointer = void;
+  using reference = View;
+
+  Iterator(const View &parent, size_t index) : parent_(parent), index_(index) {}
+
+  View operator*() const { return parent_[index_]; }
+  Iterator &operator++() {
+    ++index_;
+    return *this;
+  }
+  Iterator operator++(int) {
+    Iterator prev = *this;
+    ++index_;
+    return prev;
+  }
+  bool operator==(const Iterator &other) const { return index_ == other.index_; }
+  bool operator!=(const Iterator &other) const { return index_ != other.index_; }
+
+private:
+  View parent_;
+  size_t index_;
+};
+
+inline View::Iterator View::begin() const { return Iterator(*this, 0); }
+inline View::Iterator View::end() const { return Iterator(*this, size()); }
+
+} // namespace ssz
+
+#endif
@@ -24,82 +24,51 @@ static const uint32_t K[64] = {
   0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
 };
 
+// One 64-byte block into the running state
+static void sha256_compress(uint32_t H[8], const uint8_t *p) {
+  uint32_t W[64];
+  for (int i = 0; i < 16; i++) {
+    W[i] = ((uint32_t)p[i*4] << 24) | ((uint32_t)p[i*4+1] << 16) | ((uint32_t)p[i*4+2] << 8) | p[i*4+3];
+  }
+  for (int i = 16; i < 64; i++) W[i] = SIG1(W[i-2]) + W[i-7] + SIG0(W[i-15]) + W[i-16];
+
+  uint32_t a = H[0], b = H[1], c = H[2], d = H[3], e = H[4], f = H[5], g = H[6], h = H[7];
+  for (int i = 0; i < 64; i++) {
+    uint32_t t1 = h + EP1(e) + CH(e, f, g) + K[i] + W[i];
+    uint32_t t2 = EP0(a) + MAJ(a, b, c);
+    h = g; g = f; f = e; e = d + t1;
+    d = c; c = b; b = a; a = t1 + t2;
+  }
+  H[0] += a; H[1] += b; H[2] += c; H[3] += d; H[4] += e; H[5] += f; H[6] += g; H[7] += h;
+}
+
 void sha256_hash(const uint8_t *data, size_t len, uint8_t out[32]) {
   uint32_t H[8] = {
     0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
     0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
   };
-  uint32_t W[64];
   uint8_t block[64];
   size_t offset = 0;
-  size_t total_bits = len * 8;
-  
-  // Removed: confusing padding logic replaced with clean two-phase approach below
-  
-  // Re-implement simpler flow
-  offset = 0;
+
   while (len - offset >= 64) {
-    const uint8_t *p = data + offset;
-    for (int i = 0; i < 16; i++) {
-      W[i] = (p[i*4] << 24) | (p[i*4+1] << 16) | (p[i*4+2] << 8) | p[i*4+3];
-    }
-    for (int i = 16; i < 64; i++) W[i] = SIG1(W[i-2]) + W[i-7] + SIG0(W[i-15]) + W[i-16];
-    
-    uint32_t a = H[0], b = H[1], c = H[2], d = H[3], e = H[4], f = H[5], g = H[6], h = H[7];
-    for (int i = 0; i < 64; i++) {
-      uint32_t t1 = h + EP1(e) + CH(e, f, g) + K[i] + W[i];
-      uint32_t t2 = EP0(a) + MAJ(a, b, c);
-      h = g; g = f; f = e; e = d + t1;
-      d = c; c = b; b = a; a = t1 + t2;
-    }
-    H[0] += a; H[1] += b; H[2] += c; H[3] += d; H[4] += e; H[5] += f; H[6] += g; H[7] += h;
+    sha256_compress(H, data + offset);
     offset += 64;
   }
-  
+
+  // Padding: 0x80, zeros, then the 64-bit big-endian bit length, spilling
+  // into a second block when fewer than 8 bytes remain after the marker
   memset(block, 0, 64);
   memcpy(block, data + offset, len - offset);
   block[len - offset] = 0x80;
   if (len - offset >= 56) {
-    // Process this block and create another
-    const uint8_t *p = block;
-    for (int i = 0; i < 16; i++) W[i] = (p[i*4] << 24) | (p[i*4+1] << 16) | (p[i*4+2] << 8) | p[i*4+3];
-    for (int i = 16; i < 64; i++) W[i] = SIG1(W[i-2]) + W[i-7] + SIG0(W[i-15]) + W[i-16];
-    uint32_t a = H[0], b = H[1], c = H[2], d = H[3], e = H[4], f = H[5], g = H[6], h = H[7];
-    for (int i = 0; i < 64; i++) {
-      uint32_t t1 = h + EP1(e) + CH(e, f, g) + K[i] + W[i];
-      uint32_t t2 = EP0(a) + MAJ(a, b, c);
-      h = g; g = f; f = e; e = d + t1;
-      d = c; c = b; b = a; a = t1 + t2;
-    }
-    H[0] += a; H[1] += b; H[2] += c; H[3] += d; H[4] += e; H[5] += f; H[6] += g; H[7] += h;
+    sha256_compress(H, block);
     memset(block, 0, 64);
   }
-  
-  // Append length
-  // Note: we only support 32-bit length for this simple impl (size_t cast)
-  // SSZ buffers are usually small in this context.
+
   uint64_t bitlen = (uint64_t)len * 8;
-  block[56] = (bitlen >> 56) & 0xff;
-  block[57] = (bitlen >> 48) & 0xff;
-  block[58] = (bitlen >> 40) & 0xff;
-  block[59] = (bitlen >> 32) & 0xff;
-  block[60] = (bitlen >> 24) & 0xff;
-  block[61] = (bitlen >> 16) & 0xff;
-  block[62] = (bitlen >> 8) & 0xff;
-  block[63] = bitlen & 0xff;
-  
-  const uint8_t *p = block;
-  for (int i = 0; i < 16; i++) W[i] = (p[i*4] << 24) | (p[i*4+1] << 16) | (p[i*4+2] << 8) | p[i*4+3];
-  for (int i = 16; i < 64; i++) W[i] = SIG1(W[i-2]) + W[i-7] + SIG0(W[i-15]) + W[i-16];
-  uint32_t a = H[0], b = H[1], c = H[2], d = H[3], e = H[4], f = H[5], g = H[6], h = H[7];
-  for (int i = 0; i < 64; i++) {
-    uint32_t t1 = h + EP1(e) + CH(e, f, g) + K[i] + W[i];
-    uint32_t t2 = EP0(a) + MAJ(a, b, c);
-    h = g; g = f; f = e; e = d + t1;
-    d = c; c = b; b = a; a = t1 + t2;
-  }
-  H[0] += a; H[1] += b; H[2] += c; H[3] += d; H[4] += e; H[5] += f; H[6] += g; H[7] += h;
-  
+  for (int i = 0; i < 8; i++) block[63 - i] = (uint8_t)(bitlen >> (8 * i));
+  sha256_compress(H, block);
+
   for (int i = 0; i < 8; i++) {
     out[i*4] = (H[i] >> 24) & 0xff;
     out[i*4+1] = (H[i] >> 16) & 0xff;
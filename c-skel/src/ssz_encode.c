@@ -0,0 +1,471 @@
+#include "ssz_encode.h"
+#include "ssz_kernels.h"
+#include "ssz_merkle.h"
+#include "ssz_error.h"
+#include <string.h>
+
+/* Staging buffer for packed data pulled from a reader; whole chunks only */
+#ifdef HOST_TEST
+#define PULL_BUFFER_SIZE 4096
+#else
+#define PULL_BUFFER_SIZE 256
+#endif
+
+/* Offsets written per sink call */
+#define OFFSET_BATCH 64
+
+/* ===== Size pass ===== */
+
+static int value_size(const TypeDesc *td, const ssz_value_t *v, size_t *out_len, char err[128]) {
+  size_t size = 0;
+  int result;
+
+  switch (td->kind) {
+    case SSZ_KIND_BASIC:
+    case SSZ_KIND_BOOL:
+    case SSZ_KIND_BITLIST:
+      if (v->data == NULL && v->len > 0) {
+        SSZ_ERROR_MSG(err, "Value of %zu bytes has no data", v->len);
+        return SSZ_ERR_UNSUPPORTED_TYPE;
+      }
+      size = v->len;
+      break;
+    case SSZ_KIND_CONTAINER:
+      if (td->field_count == 0 || v->items == NULL || v->count != td->field_count) {
+        SSZ_ERROR_MSG(err, "Container expects %u fields, value has %zu", td->field_count, v->count);
+        return SSZ_ERR_UNSUPPORTED_TYPE;
+      }
+      for (uint32_t i = 0; i < td->field_count; i++) {
+        const TypeDesc *field_td = (const TypeDesc *)td->field_types[i];
+        size_t field_len;
+        result = value_size(field_td, &v->items[i], &field_len, err);
+        if (result != SSZ_ERR_NONE) return result;
+        size += field_td->fixed_size > 0 ? field_len : 4 + field_len;
+      }
+      break;
+    default:
+      if (ssz_has_variable_elements(td) || v->items != NULL) {
+        const TypeDesc *elem_td = (const TypeDesc *)td->element_type;
+        if (elem_td == NULL || (v->items == NULL && v->count > 0)) {
+          SSZ_ERROR_MSG(err, "List value needs items of a declared element type");
+          return SSZ_ERR_UNSUPPORTED_TYPE;
+        }
+        int variable = ssz_has_variable_elements(td);
+        for (size_t i = 0; i < v->count; i++) {
+          size_t elem_len;
+          result = value_size(elem_td, &v->items[i], &elem_len, err);
+          if (result != SSZ_ERR_NONE) return result;
+          size += variable ? 4 + elem_len : elem_len;
+        }
+      } else {
+        if (v->data == NULL && v->reader == NULL && v->len > 0) {
+          SSZ_ERROR_MSG(err, "List value of %zu bytes has no data or reader", v->len);
+          return SSZ_ERR_UNSUPPORTED_TYPE;
+        }
+        size = v->len;
+        if (size % ssz_element_size(td) != 0) {
+          SSZ_ERROR_MSG(err, "Length %zu not a multiple of element size %zu", size, ssz_element_size(td));
+          return SSZ_ERR_NON_CANONICAL;
+        }
+      }
+      break;
+  }
+
+  if (td->fixed_size > 0 && size != td->fixed_size) {
+    SSZ_ERROR_MSG(err, "Value is %zu bytes, type is fixed at %u", size, td->fixed_size);
+    return SSZ_ERR_NON_CANONICAL;
+  }
+  *out_len = size;
+  return SSZ_ERR_NONE;
+}
+
+int ssz_encoded_size(const TypeDesc *td, const ssz_value_t *v, size_t *out_len, char err[128]) {
+  return value_size(td, v, out_len, err);
+}
+
+/* ===== Encoding pass ===== */
+
+/* While a packed region is open every emitted byte is also chunked into
+ * `chunker`; values nested inside it are emitted without roots of their own,
+ * so at most one region is open at a time. */
+typedef struct {
+  ssz_workspace_t *ws;
+  ssz_writer_fn write;
+  void *ctx;
+  size_t written;
+  Merkleizer *chunker;
+  uint8_t pending[32];
+  size_t pending_len;
+  char *err;
+} Encoder;
+
+static void chunk_bytes(Encoder *enc, const uint8_t *bytes, size_t n) {
+  if (enc->pending_len > 0) {
+    size_t take = 32 - enc->pending_len < n ? 32 - enc->pending_len : n;
+    memcpy(enc->pending + enc->pending_len, bytes, take);
+    enc->pending_len += take;
+    bytes += take;
+    n -= take;
+    if (enc->pending_len < 32) return;
+    ssz_merkle_push(enc->chunker, enc->pending);
+    enc->pending_len = 0;
+  }
+  ssz_merkle_push_bytes(enc->chunker, bytes, n / 32);
+  enc->pending_len = n % 32;
+  memcpy(enc->pending, bytes + n - enc->pending_len, enc->pending_len);
+}
+
+static int emit(Encoder *enc, const uint8_t *bytes, size_t n) {
+  if (n == 0) return SSZ_ERR_NONE;
+  if (enc->write(bytes, n, enc->ctx) != 0) {
+    SSZ_ERROR_MSG(enc->err, "Writer failed at byte %zu", enc->written);
+    return SSZ_ERR_UNEXPECTED_EOF;
+  }
+  enc->written += n;
+  if (enc->chunker != NULL) chunk_bytes(enc, bytes, n);
+  return SSZ_ERR_NONE;
+}
+
+static void region_open(Encoder *enc, Merkleizer *m) {
+  enc->chunker = m;
+  enc->pending_len = 0;
+}
+
+/* Zero-pads and pushes the partial last chunk */
+static void region_close(Encoder *enc) {
+  if (enc->pending_len > 0) {
+    memset(enc->pending + enc->pending_len, 0, 32 - enc->pending_len);
+    ssz_merkle_push(enc->chunker, enc->pending);
+    enc->pending_len = 0;
+  }
+  enc->chunker = NULL;
+}
+
+static int encode_value(Encoder *enc, const TypeDesc *td, const ssz_value_t *v, uint8_t out_root[32]);
+
+static int encode_basic(Encoder *enc, const TypeDesc *td, const ssz_value_t *v, uint8_t out_root[32]) {
+  if (td->kind == SSZ_KIND_BOOL && (v->len != 1 || v->data[0] > 1)) {
+    SSZ_ERROR_MSG(enc->err, "Boolean must be one byte of 0 or 1");
+    return SSZ_ERR_NON_CANONICAL;
+  }
+  int result = emit(enc, v->data, v->len);
+  if (result != SSZ_ERR_NONE || out_root == NULL) return result;
+  memset(out_root, 0, 32);
+  memcpy(out_root, v->data, v->len < 32 ? v->len : 32);
+  return SSZ_ERR_NONE;
+}
+
+static int encode_bitlist(Encoder *enc, const TypeDesc *td, const ssz_value_t *v, uint8_t out_root[32]) {
+  if (v->len == 0 || v->data[v->len - 1] == 0) {
+    SSZ_ERROR_MSG(enc->err, "Bitlist missing padding bit");
+    return SSZ_ERR_NON_CANONICAL;
+  }
+  uint32_t bit_count = (uint32_t)(v->len - 1) * 8;
+  for (uint8_t last = v->data[v->len - 1]; last > 1; last >>= 1) bit_count++;
+  if (td->max_length > 0 && bit_count > td->max_length) {
+    SSZ_ERROR_MSG(enc->err, "Bitlist has %u bits, limit %u", bit_count, td->max_length);
+    return SSZ_ERR_LENGTH_OVERFLOW;
+  }
+  if (out_root == NULL) return emit(enc, v->data, v->len);
+
+  /* The sentinel byte goes out after the region closes: it is not chunked */
+  size_t chunk_len = v->len - 1;
+  Merkleizer m;
+  int result = ssz_merkle_init(&m, enc->ws, chunk_len > 0 ? (chunk_len + 31) / 32 : 1, enc->err);
+  if (result != SSZ_ERR_NONE) return result;
+  region_open(enc, &m);
+  result = emit(enc, v->data, chunk_len);
+  region_close(enc);
+  if (result != SSZ_ERR_NONE) return result;
+  result = emit(enc, v->data + chunk_len, 1);
+  if (result != SSZ_ERR_NONE) return result;
+
+  if (chunk_len == 0) {
+    uint8_t zero_chunk[32] = {0};
+    ssz_merkle_push(&m, zero_chunk);
+  }
+  ssz_merkle_finish(&m, out_root);
+  ssz_mixin_length(out_root, bit_count);
+  return SSZ_ERR_NONE;
+}
+
+/* Packed elements from data, a reader, or fixed-size items */
+static int emit_packed(Encoder *enc, const TypeDesc *td, const ssz_value_t *v) {
+  const TypeDesc *elem_td = (const TypeDesc *)td->element_type;
+  int bools = elem_td != NULL && elem_td->kind == SSZ_KIND_BOOL;
+  size_t bad = 0;
+  int result;
+
+  if (v->items != NULL) {
+    for (size_t i = 0; i < v->count; i++) {
+      result = encode_value(enc, elem_td, &v->items[i], NULL);
+      if (result != SSZ_ERR_NONE) return result;
+    }
+    return SSZ_ERR_NONE;
+  }
+
+  if (v->data != NULL) {
+    if (bools && ssz_check_bools(v->data, v->len, &bad) != SSZ_ERR_NONE) {
+      SSZ_ERROR_MSG(enc->err, "Boolean element %zu not 0 or 1", bad);
+      return SSZ_ERR_NON_CANONICAL;
+    }
+    return emit(enc, v->data, v->len);
+  }
+
+  uint8_t buf[PULL_BUFFER_SIZE];
+  size_t done = 0;
+  while (done < v->len) {
+    size_t want = v->len - done < sizeof(buf) ? v->len - done : sizeof(buf);
+    size_t got = v->reader(buf, want, v->ctx);
+    if (got == 0 || got > want) {
+      SSZ_ERROR_MSG(enc->err, "Reader ended after %zu of %zu bytes", done, v->len);
+      return SSZ_ERR_UNEXPECTED_EOF;
+    }
+    if (bools && ssz_check_bools(buf, got, &bad) != SSZ_ERR_NONE) {
+      SSZ_ERROR_MSG(enc->err, "Boolean element %zu not 0 or 1", done + bad);
+      return SSZ_ERR_NON_CANONICAL;
+    }
+    result = emit(enc, buf, got);
+    if (result != SSZ_ERR_NONE) return result;
+    done += got;
+  }
+  return SSZ_ERR_NONE;
+}
+
+static int encode_packed(Encoder *enc, const TypeDesc *td, const ssz_value_t *v, uint8_t out_root[32]) {
+  size_t len;
+  int result = value_size(td, v, &len, enc->err);
+  if (result != SSZ_ERR_NONE) return result;
+  size_t elem_count = len / ssz_element_size(td);
+  if (td->kind == SSZ_KIND_LIST && td->max_length > 0 && elem_count > td->max_length) {
+    SSZ_ERROR_MSG(enc->err, "List has %zu elements, limit %u", elem_count, td->max_length);
+    return SSZ_ERR_LENGTH_OVERFLOW;
+  }
+  if (out_root == NULL) return emit_packed(enc, td, v);
+
+  Merkleizer m;
+  result = ssz_merkle_init(&m, enc->ws, (len + 31) / 32, enc->err);
+  if (result != SSZ_ERR_NONE) return result;
+  region_open(enc, &m);
+  result = emit_packed(enc, td, v);
+  region_close(enc);
+  if (result != SSZ_ERR_NONE) return result;
+
+  ssz_merkle_finish(&m, out_root);
+  if (td->kind == SSZ_KIND_LIST) {
+    ssz_mixin_length(out_root, (uint32_t)elem_count);
+  }
+  return SSZ_ERR_NONE;
+}
+
+/* Offset table from the size pass, then the element payloads */
+static int encode_var_list(Encoder *enc, const TypeDesc *td, const ssz_value_t *v, uint8_t out_root[32]) {
+  const TypeDesc *elem_td = (const TypeDesc *)td->element_type;
+  size_t count = v->count;
+  int result;
+
+  if (td->kind == SSZ_KIND_LIST && td->max_length > 0 && count > td->max_length) {
+    SSZ_ERROR_MSG(enc->err, "List has %zu elements, limit %u", count, td->max_length);
+    return SSZ_ERR_LENGTH_OVERFLOW;
+  }
+
+  uint8_t table[OFFSET_BATCH * 4];
+  size_t offset = count * 4;
+  for (size_t i = 0; i < count; i++) {
+    size_t elem_len;
+    result = value_size(elem_td, &v->items[i], &elem_len, enc->err);
+    if (result != SSZ_ERR_NONE) return result;
+    if (offset > UINT32_MAX) {
+      SSZ_ERROR_MSG(enc->err, "List element %zu offset exceeds 32 bits", i);
+      return SSZ_ERR_LENGTH_OVERFLOW;
+    }
+    ssz_put_le(table + (i % OFFSET_BATCH) * 4, (uint32_t)offset, 4);
+    offset += elem_len;
+    if (i % OFFSET_BATCH == OFFSET_BATCH - 1 || i + 1 == count) {
+      result = emit(enc, table, (i % OFFSET_BATCH + 1) * 4);
+      if (result != SSZ_ERR_NONE) return result;
+    }
+  }
+
+  Merkleizer m;
+  if (out_root != NULL) {
+    result = ssz_merkle_init(&m, enc->ws, count, enc->err);
+    if (result != SSZ_ERR_NONE) return result;
+  }
+
+  for (size_t i = 0; i < count; i++) {
+    uint8_t elem_root[32];
+    result = encode_value(enc, elem_td, &v->items[i], out_root ? elem_root : NULL);
+    if (result != SSZ_ERR_NONE) return result;
+    if (out_root != NULL) ssz_merkle_push(&m, elem_root);
+  }
+
+  if (out_root == NULL) return SSZ_ERR_NONE;
+  ssz_merkle_finish(&m, out_root);
+  if (td->kind == SSZ_KIND_LIST) {
+    ssz_mixin_length(out_root, (uint32_t)count);
+  }
+  return SSZ_ERR_NONE;
+}
+
+/* Fixed part with precomputed offsets, then the variable payloads. Field
+ * roots arrive out of declaration order, so they are held until the end. */
+static int encode_container(Encoder *enc, const TypeDesc *td, const ssz_value_t *v, uint8_t out_root[32]) {
+  uint8_t *roots = NULL;
+  size_t offset = 0;
+  int result;
+
+  for (uint32_t i = 0; i < td->field_count; i++) {
+    const TypeDesc *field_td = (const TypeDesc *)td->field_types[i];
+    offset += field_td->fixed_size > 0 ? field_td->fixed_size : 4;
+  }
+  if (out_root != NULL) {
+    roots = (uint8_t *)ssz_ws_alloc(enc->ws, (size_t)td->field_count * 32);
+    if (roots == NULL) {
+      SSZ_ERROR_MSG(enc->err, "Workspace exhausted (%zu of %zu bytes used)", enc->ws->used, enc->ws->size);
+      return SSZ_ERR_WORKSPACE_EXHAUSTED;
+    }
+  }
+
+  for (uint32_t i = 0; i < td->field_count; i++) {
+    const TypeDesc *field_td = (const TypeDesc *)td->field_types[i];
+    if (field_td->fixed_size > 0) {
+      result = encode_value(enc, field_td, &v->items[i], roots ? roots + (size_t)i * 32 : NULL);
+      if (result != SSZ_ERR_NONE) return result;
+      continue;
+    }
+    size_t field_len;
+    result = value_size(field_td, &v->items[i], &field_len, enc->err);
+    if (result != SSZ_ERR_NONE) return result;
+    if (offset > UINT32_MAX) {
+      SSZ_ERROR_MSG(enc->err, "Container field %u offset exceeds 32 bits", i);
+      return SSZ_ERR_LENGTH_OVERFLOW;
+    }
+    uint8_t le[4];
+    ssz_put_le(le, (uint32_t)offset, 4);
+    result = emit(enc, le, 4);
+    if (result != SSZ_ERR_NONE) return result;
+    offset += field_len;
+  }
+
+  for (uint32_t i = 0; i < td->field_count; i++) {
+    const TypeDesc *field_td = (const TypeDesc *)td->field_types[i];
+    if (field_td->fixed_size > 0) continue;
+    result = encode_value(enc, field_td, &v->items[i], roots ? roots + (size_t)i * 32 : NULL);
+    if (result != SSZ_ERR_NONE) return result;
+  }
+
+  if (out_root == NULL) return SSZ_ERR_NONE;
+  Merkleizer m;
+  result = ssz_merkle_init(&m, enc->ws, td->field_count, enc->err);
+  if (result != SSZ_ERR_NONE) return result;
+  for (uint32_t i = 0; i < td->field_count; i++) {
+    ssz_merkle_push(&m, roots + (size_t)i * 32);
+  }
+  ssz_merkle_finish(&m, out_root);
+  return SSZ_ERR_NONE;
+}
+
+static int encode_value(Encoder *enc, const TypeDesc *td, const ssz_value_t *v, uint8_t out_root[32]) {
+  /* Scratch taken by this level is released when it returns */
+  size_t mark = enc->ws->used;
+  int result;
+
+  switch (td->kind) {
+    case SSZ_KIND_BASIC:
+    case SSZ_KIND_BOOL:
+      result = encode_basic(enc, td, v, out_root);
+      break;
+    case SSZ_KIND_BITLIST:
+      result = encode_bitlist(enc, td, v, out_root);
+      break;
+    case SSZ_KIND_CONTAINER:
+      result = encode_container(enc, td, v, out_root);
+      break;
+    default:
+      if (ssz_has_variable_elements(td)) {
+        result = encode_var_list(enc, td, v, out_root);
+      } else {
+        result = encode_packed(enc, td, v, out_root);
+      }
+      break;
+  }
+
+  enc->ws->used = mark;
+  return result;
+}
+
+int ssz_encode_ws(
+  ssz_workspace_t *ws,
+  const TypeDesc *td,
+  const ssz_value_t *v,
+  ssz_writer_fn write,
+  void *ctx,
+  uint8_t out_root[32],
+  char err[128]
+) {
+  /* The size pass checks the whole shape before the first byte goes out */
+  size_t len;
+  int result = value_size(td, v, &len, err);
+  if (result != SSZ_ERR_NONE) return result;
+
+  Encoder enc;
+  memset(&enc, 0, sizeof(enc));
+  enc.ws = ws;
+  enc.write = write;
+  enc.ctx = ctx;
+  enc.err = err;
+  ws->used = 0;
+  return encode_value(&enc, td, v, out_root);
+}
+
+int ssz_encode(
+  const TypeDesc *td,
+  const ssz_value_t *v,
+  ssz_writer_fn write,
+  void *ctx,
+  uint8_t out_root[32],
+  char err[128]
+) {
+  /* Default workspace, sized like the buffer path's */
+  ssz_workspace_t ws;
+  SSZ_DEFAULT_WORKSPACE(ws, MAX_STACK_DEPTH * 2);
+  return ssz_encode_ws(&ws, td, v, write, ctx, out_root, err);
+}
+
+typedef struct {
+  uint8_t *out;
+  size_t cap;
+  size_t used;
+} BufferSink;
+
+static int write_buffer(const uint8_t *buf, size_t len, void *ctx) {
+  BufferSink *sink = (BufferSink *)ctx;
+  if (len > sink->cap - sink->used) return -1;
+  memcpy(sink->out + sink->used, buf, len);
+  sink->used += len;
+  return 0;
+}
+
+int ssz_encode_to_buffer(
+  const TypeDesc *td,
+  const ssz_value_t *v,
+  uint8_t *out,
+  size_t cap,
+  size_t *written,
+  uint8_t out_root[32],
+  char err[128]
+) {
+  size_t len;
+  int result = value_size(td, v, &len, err);
+  if (result != SSZ_ERR_NONE) return result;
+  if (len > cap) {
+    SSZ_ERROR_MSG(err, "Encoding needs %zu bytes, buffer holds %zu", len, cap);
+    return SSZ_ERR_LENGTH_OVERFLOW;
+  }
+
+  BufferSink sink = { out, cap, 0 };
+  result = ssz_encode(td, v, write_buffer, &sink, out_root, err);
+  if (written) *written = sink.used;
+  return result;
+}
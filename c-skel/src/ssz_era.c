@@ -0,0 +1,332 @@
+#define _GNU_SOURCE
+#include "ssz_era.h"
+#include "ssz_snappy.h"
+#include "ssz_trace.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+/* Root of opaque record payloads when the caller has no schema for them */
+static const TypeDesc BYTE_TD = {SSZ_KIND_BASIC, 1, NULL, NULL, 0, 0};
+static const TypeDesc BYTE_LIST_TD = {SSZ_KIND_LIST, 0, &BYTE_TD, NULL, 0, 0xffffffffu};
+
+typedef struct {
+  const uint8_t *data;
+  size_t len;
+  size_t pos;
+} MemReader;
+
+static size_t mem_read(uint8_t *buf, size_t buf_size, void *ctx) {
+  MemReader *m = (MemReader *)ctx;
+  size_t n = m->len - m->pos;
+  if (n > buf_size) n = buf_size;
+  memcpy(buf, m->data + m->pos, n);
+  m->pos += n;
+  return n;
+}
+
+typedef struct {
+  ssz_snappy_reader_t *snappy;
+  uint64_t bytes;
+} CountingReader;
+
+static size_t counting_read(uint8_t *buf, size_t buf_size, void *ctx) {
+  CountingReader *c = (CountingReader *)ctx;
+  size_t n = ssz_snappy_read(buf, buf_size, c->snappy);
+  c->bytes += n;
+  return n;
+}
+
+static uint64_t now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+static uint64_t load_le(const uint8_t *p, int n) {
+  uint64_t v = 0;
+  for (int i = n - 1; i >= 0; i--) v = (v << 8) | p[i];
+  return v;
+}
+
+/* ===== Record scan ===== */
+
+static int scan_records(const uint8_t *data, size_t len, ssz_era_report_t *report, char err[128]) {
+  size_t cap = 64;
+  size_t count = 0;
+  ssz_era_record_t *recs = malloc(cap * sizeof(*recs));
+  if (!recs) {
+    if (err) snprintf(err, 128, "Out of memory");
+    return SSZ_ERR_WORKSPACE_EXHAUSTED;
+  }
+
+  size_t pos = 0;
+  while (pos < len) {
+    if (len - pos < SSZ_E2_HEADER_SIZE) {
+      free(recs);
+      if (err) snprintf(err, 128, "Record header truncated at offset %zu", pos);
+      return SSZ_ERR_UNEXPECTED_EOF;
+    }
+    const uint8_t *h = data + pos;
+    uint32_t rec_len = (uint32_t)load_le(h + 2, 4);
+    if (h[6] != 0 || h[7] != 0) {
+      free(recs);
+      if (err) snprintf(err, 128, "Record reserved bytes non-zero at offset %zu", pos);
+      return SSZ_ERR_MALFORMED_HEADER;
+    }
+    if (len - pos - SSZ_E2_HEADER_SIZE < rec_len) {
+      free(recs);
+      if (err) snprintf(err, 128, "Record at offset %zu exceeds file", pos);
+      return SSZ_ERR_UNEXPECTED_EOF;
+    }
+    if (count == cap) {
+      ssz_era_record_t *grown = realloc(recs, cap * 2 * sizeof(*recs));
+      if (!grown) {
+        free(recs);
+        if (err) snprintf(err, 128, "Out of memory");
+        return SSZ_ERR_WORKSPACE_EXHAUSTED;
+      }
+      recs = grown;
+      cap *= 2;
+    }
+    ssz_era_record_t *r = &recs[count++];
+    memset(r, 0, sizeof(*r));
+    r->type = (uint16_t)load_le(h, 2);
+    r->offset = pos;
+    r->length = rec_len;
+    r->slot = -1;
+    pos += SSZ_E2_HEADER_SIZE + rec_len;
+  }
+
+  if (count == 0 || recs[0].type != SSZ_E2_TYPE_VERSION) {
+    free(recs);
+    if (err) snprintf(err, 128, "Archive does not start with a version record");
+    return SSZ_ERR_MALFORMED_HEADER;
+  }
+
+  report->records = recs;
+  report->record_count = count;
+  return SSZ_ERR_NONE;
+}
+
+static ssz_era_record_t *find_record(ssz_era_report_t *report, uint64_t offset) {
+  size_t lo = 0;
+  size_t hi = report->record_count;
+  while (lo < hi) {
+    size_t mid = lo + (hi - lo) / 2;
+    if (report->records[mid].offset < offset) lo = mid + 1;
+    else hi = mid;
+  }
+  if (lo < report->record_count && report->records[lo].offset == offset) return &report->records[lo];
+  return NULL;
+}
+
+/* Slot index: starting-slot | offset * count | count, offsets relative to the index record */
+static void check_slot_index(const uint8_t *data, ssz_era_report_t *report, ssz_era_record_t *idx) {
+  const uint8_t *body = data + idx->offset + SSZ_E2_HEADER_SIZE;
+  if (idx->length < 16) {
+    idx->status = SSZ_ERR_MALFORMED_HEADER;
+    snprintf(idx->err, sizeof(idx->err), "Slot index too short");
+    return;
+  }
+  uint64_t count = load_le(body + idx->length - 8, 8);
+  if (count > (idx->length - 16) / 8 || idx->length != 16 + count * 8) {
+    idx->status = SSZ_ERR_MALFORMED_HEADER;
+    snprintf(idx->err, sizeof(idx->err), "Slot index count %llu does not match length", (unsigned long long)count);
+    return;
+  }
+
+  uint64_t start_slot = load_le(body, 8);
+  for (uint64_t i = 0; i < count; i++) {
+    int64_t rel = (int64_t)load_le(body + 8 + i * 8, 8);
+    if (rel == 0) continue; /* empty slot */
+    uint64_t target = idx->offset + (uint64_t)rel;
+    ssz_era_record_t *r = find_record(report, target);
+    if (!r || (r->type != SSZ_E2_TYPE_BLOCK && r->type != SSZ_E2_TYPE_STATE)) {
+      if (idx->status == SSZ_ERR_NONE) {
+        idx->status = SSZ_ERR_BAD_OFFSET;
+        snprintf(idx->err, sizeof(idx->err), "Slot %llu points at offset %llu, not a block or state record",
+                 (unsigned long long)(start_slot + i), (unsigned long long)target);
+      }
+      report->index_mismatches++;
+      continue;
+    }
+    r->slot = (int64_t)(start_slot + i);
+  }
+}
+
+/* ===== Parallel hashing ===== */
+
+typedef struct {
+  const uint8_t *data;
+  ssz_era_record_t **work;
+  size_t work_count;
+  size_t next;                /* shared cursor into work, atomic */
+  const TypeDesc *block_type;
+  const TypeDesc *state_type;
+} Pool;
+
+static void hash_record(Pool *p, ssz_snappy_reader_t *snappy, ssz_era_record_t *r) {
+  const TypeDesc *td = r->type == SSZ_E2_TYPE_BLOCK ? p->block_type : p->state_type;
+  MemReader src = {p->data + r->offset + SSZ_E2_HEADER_SIZE, r->length, 0};
+  CountingReader counted = {snappy, 0};
+
+  ssz_snappy_reader_init(snappy, mem_read, &src);
+  SSZ_TRACE_BEGIN(r->type == SSZ_E2_TYPE_BLOCK ? "block record" : "state record");
+  r->status = ssz_stream_root_from_reader(counting_read, &counted, td, r->root, r->err);
+  SSZ_TRACE_END(r->type == SSZ_E2_TYPE_BLOCK ? "block record" : "state record");
+  if (snappy->status != SSZ_ERR_NONE) r->status = ssz_snappy_reader_status(snappy, r->err);
+  r->ssz_bytes = counted.bytes;
+  r->hashed = r->status == SSZ_ERR_NONE;
+}
+
+static void *worker(void *arg) {
+  Pool *p = (Pool *)arg;
+  ssz_snappy_reader_t *snappy = malloc(sizeof(*snappy));
+  ssz_trace_thread_name("era worker");
+
+  for (;;) {
+    size_t i = __atomic_fetch_add(&p->next, 1, __ATOMIC_RELAXED);
+    if (i >= p->work_count) break;
+    ssz_era_record_t *r = p->work[i];
+    if (!snappy) {
+      r->status = SSZ_ERR_WORKSPACE_EXHAUSTED;
+      snprintf(r->err, sizeof(r->err), "Out of memory");
+      continue;
+    }
+    hash_record(p, snappy, r);
+  }
+
+  free(snappy);
+  return NULL;
+}
+
+/* Longest records first so one big state does not start last */
+static int by_length_desc(const void *a, const void *b) {
+  const ssz_era_record_t *ra = *(ssz_era_record_t *const *)a;
+  const ssz_era_record_t *rb = *(ssz_era_record_t *const *)b;
+  if (ra->length != rb->length) return ra->length < rb->length ? 1 : -1;
+  return ra->offset < rb->offset ? -1 : 1;
+}
+
+int ssz_era_verify_buffer(
+  const uint8_t *data,
+  size_t len,
+  const ssz_era_opts_t *opts,
+  ssz_era_report_t *report,
+  char err[128]
+) {
+  memset(report, 0, sizeof(*report));
+  SSZ_TRACE_BEGIN("scan records");
+  int status = scan_records(data, len, report, err);
+  SSZ_TRACE_END("scan records");
+  if (status != SSZ_ERR_NONE) return status;
+
+  Pool pool;
+  pool.data = data;
+  pool.next = 0;
+  pool.work_count = 0;
+  pool.block_type = opts && opts->block_type ? opts->block_type : &BYTE_LIST_TD;
+  pool.state_type = opts && opts->state_type ? opts->state_type : &BYTE_LIST_TD;
+  pool.work = malloc(report->record_count * sizeof(*pool.work));
+  if (!pool.work) {
+    ssz_era_report_free(report);
+    if (err) snprintf(err, 128, "Out of memory");
+    return SSZ_ERR_WORKSPACE_EXHAUSTED;
+  }
+
+  for (size_t i = 0; i < report->record_count; i++) {
+    ssz_era_record_t *r = &report->records[i];
+    if (r->type == SSZ_E2_TYPE_BLOCK || r->type == SSZ_E2_TYPE_STATE) {
+      pool.work[pool.work_count++] = r;
+      report->compressed_bytes += r->length;
+    } else if (r->type == SSZ_E2_TYPE_SLOT_INDEX) {
+      check_slot_index(data, report, r);
+    }
+  }
+  qsort(pool.work, pool.work_count, sizeof(*pool.work), by_length_desc);
+
+  uint32_t threads = opts && opts->threads ? opts->threads : 0;
+  if (threads == 0) {
+    long online = sysconf(_SC_NPROCESSORS_ONLN);
+    threads = online > 0 ? (uint32_t)online : 1;
+  }
+  if (threads > pool.work_count) threads = pool.work_count ? (uint32_t)pool.work_count : 1;
+  report->threads = threads;
+
+  uint64_t t0 = now_ns();
+  pthread_t *tids = malloc(threads * sizeof(*tids));
+  uint32_t started = 0;
+  /* The calling thread is worker 0 */
+  while (tids && started + 1 < threads && pthread_create(&tids[started], NULL, worker, &pool) == 0) {
+    started++;
+  }
+  worker(&pool);
+  for (uint32_t i = 0; i < started; i++) pthread_join(tids[i], NULL);
+  free(tids);
+  report->seconds = (double)(now_ns() - t0) / 1e9;
+  free(pool.work);
+
+  const ssz_era_record_t *first_bad = NULL;
+  for (size_t i = 0; i < report->record_count; i++) {
+    ssz_era_record_t *r = &report->records[i];
+    report->ssz_bytes += r->ssz_bytes;
+    if (r->status != SSZ_ERR_NONE) {
+      report->failed_records++;
+      if (!first_bad) first_bad = r;
+    }
+  }
+
+  if (first_bad) {
+    if (err) snprintf(err, 128, "Record at offset %llu: %.96s", (unsigned long long)first_bad->offset, first_bad->err);
+    return first_bad->status;
+  }
+  return SSZ_ERR_NONE;
+}
+
+int ssz_era_verify_file(
+  const char *path,
+  const ssz_era_opts_t *opts,
+  ssz_era_report_t *report,
+  char err[128]
+) {
+  memset(report, 0, sizeof(*report));
+  int fd = open(path, O_RDONLY);
+  if (fd < 0) {
+    if (err) snprintf(err, 128, "Open failed: %s", strerror(errno));
+    return SSZ_ERR_UNEXPECTED_EOF;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size == 0) {
+    close(fd);
+    if (err) snprintf(err, 128, "Archive is empty or unreadable");
+    return SSZ_ERR_UNEXPECTED_EOF;
+  }
+
+  size_t len = (size_t)st.st_size;
+  void *map = mmap(NULL, len, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (map == MAP_FAILED) {
+    if (err) snprintf(err, 128, "mmap failed: %s", strerror(errno));
+    return SSZ_ERR_UNEXPECTED_EOF;
+  }
+  /* Workers touch records out of order: fault the whole file in ahead of them */
+  madvise(map, len, MADV_WILLNEED);
+
+  int status = ssz_era_verify_buffer((const uint8_t *)map, len, opts, report, err);
+  munmap(map, len);
+  return status;
+}
+
+void ssz_era_report_free(ssz_era_report_t *report) {
+  free(report->records);
+  report->records = NULL;
+  report->record_count = 0;
+}
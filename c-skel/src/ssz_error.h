@@ -0,0 +1,15 @@
+#ifndef SSZ_ERROR_H
+#define SSZ_ERROR_H
+
+/* Error messages for the core sources. SSZ_TINY builds return the same
+ * SszError codes but compile the formatting (and snprintf) away, leaving
+ * err buffers untouched. */
+
+#ifdef SSZ_TINY
+#define SSZ_ERROR_MSG(err, ...) ((void)(err))
+#else
+#include <stdio.h>
+#define SSZ_ERROR_MSG(err, ...) do { if (err) snprintf(err, 128, __VA_ARGS__); } while (0)
+#endif
+
+#endif
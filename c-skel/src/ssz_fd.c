@@ -0,0 +1,488 @@
+#define _GNU_SOURCE
+#include "ssz_fd.h"
+#include "ssz_trace.h"
+#include <errno.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#define HAVE_IO_URING 1
+#endif
+#endif
+
+#define DEFAULT_BUFFER_SIZE (1u << 20)
+#define DEFAULT_BUFFER_COUNT 4
+#define BUFFER_ALIGN 4096
+
+enum { SLOT_EMPTY = 0, SLOT_PENDING = 1, SLOT_FULL = 2 };
+
+typedef struct {
+  uint8_t *data;
+  size_t len;
+  int state;
+} Slot;
+
+typedef struct {
+  int fd;
+  int seekable;
+  size_t slot_size;
+  uint32_t slot_count;
+  Slot *slots;
+  uint64_t offset;
+
+  pthread_mutex_t lock;
+  pthread_cond_t filled;
+  pthread_cond_t drained;
+  int stop;
+  int io_errno;
+  int producer_done; /* set on every producer exit, so no slot wait outlives it */
+
+  /* Consumer cursor */
+  uint32_t cur;
+  size_t cur_pos;
+  int have_slot;
+  int done;
+
+  ssz_fd_stats_t stats;
+} Ring;
+
+static uint64_t now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+/* Producer side: wait until slot i is free, returns 0 if the consumer quit */
+static int ring_claim(Ring *r, uint32_t i) {
+  uint64_t t0 = now_ns();
+  SSZ_TRACE_BEGIN("wait for buffer");
+  pthread_mutex_lock(&r->lock);
+  while (r->slots[i].state != SLOT_EMPTY && !r->stop) {
+    pthread_cond_wait(&r->drained, &r->lock);
+  }
+  int ok = !r->stop;
+  if (ok) r->slots[i].state = SLOT_PENDING;
+  pthread_mutex_unlock(&r->lock);
+  SSZ_TRACE_END("wait for buffer");
+  r->stats.io_wait_ns += now_ns() - t0;
+  return ok;
+}
+
+static void ring_publish(Ring *r, uint32_t i, size_t len, int io_errno) {
+  pthread_mutex_lock(&r->lock);
+  r->slots[i].len = len;
+  r->slots[i].state = SLOT_FULL;
+  if (io_errno && !r->io_errno) r->io_errno = io_errno;
+  r->stats.bytes_read += len;
+  pthread_cond_broadcast(&r->filled);
+  pthread_mutex_unlock(&r->lock);
+}
+
+/* Producer exit: wake a consumer waiting on a slot that will never be filled */
+static void ring_finish(Ring *r) {
+  pthread_mutex_lock(&r->lock);
+  r->producer_done = 1;
+  pthread_cond_broadcast(&r->filled);
+  pthread_mutex_unlock(&r->lock);
+}
+
+/* ===== pread / read producer ===== */
+
+static void *io_thread_pread(void *arg) {
+  Ring *r = (Ring *)arg;
+  pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, NULL);
+  ssz_trace_thread_name("ssz-fd io");
+
+  for (uint32_t i = 0;; i = (i + 1) % r->slot_count) {
+    if (!ring_claim(r, i)) break;
+
+    Slot *s = &r->slots[i];
+    size_t got = 0;
+    int io_errno = 0;
+    int eof = 0;
+    SSZ_TRACE_BEGIN("read");
+    while (got < r->slot_size) {
+      ssize_t n;
+      if (r->seekable) {
+        n = pread(r->fd, s->data + got, r->slot_size - got, (off_t)(r->offset + got));
+      } else {
+        /* Pipes can block forever if the writer stalls: allow cancel here only */
+        pthread_setcancelstate(PTHREAD_CANCEL_ENABLE, NULL);
+        n = read(r->fd, s->data + got, r->slot_size - got);
+        pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, NULL);
+      }
+      if (n < 0) {
+        if (errno == EINTR) continue;
+        io_errno = errno;
+        break;
+      }
+      if (n == 0) {
+        eof = 1;
+        break;
+      }
+      got += (size_t)n;
+    }
+    SSZ_TRACE_END("read");
+    r->offset += got;
+    ring_publish(r, i, got, io_errno);
+    if (eof || io_errno) break;
+  }
+  ring_finish(r);
+  return NULL;
+}
+
+/* ===== io_uring producer ===== */
+
+#ifdef HAVE_IO_URING
+typedef struct {
+  int fd;
+  unsigned *sq_tail;
+  unsigned *sq_mask;
+  unsigned *sq_array;
+  unsigned *cq_head;
+  unsigned *cq_tail;
+  unsigned *cq_mask;
+  struct io_uring_sqe *sqes;
+  struct io_uring_cqe *cqes;
+  void *sq_ptr;
+  void *cq_ptr;
+  size_t sq_size;
+  size_t cq_size;
+  size_t sqes_size;
+} Uring;
+
+static void uring_close(Uring *u) {
+  if (u->sqes) munmap(u->sqes, u->sqes_size);
+  if (u->cq_ptr && u->cq_ptr != u->sq_ptr) munmap(u->cq_ptr, u->cq_size);
+  if (u->sq_ptr) munmap(u->sq_ptr, u->sq_size);
+  if (u->fd >= 0) close(u->fd);
+}
+
+static int uring_open(Uring *u, unsigned entries) {
+  struct io_uring_params p;
+  memset(&p, 0, sizeof(p));
+  memset(u, 0, sizeof(*u));
+  u->fd = (int)syscall(__NR_io_uring_setup, entries, &p);
+  if (u->fd < 0) return -1;
+
+  u->sq_size = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+  u->cq_size = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+  if (p.features & IORING_FEAT_SINGLE_MMAP) {
+    if (u->cq_size > u->sq_size) u->sq_size = u->cq_size;
+    u->cq_size = u->sq_size;
+  }
+
+  u->sq_ptr = mmap(NULL, u->sq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                   u->fd, IORING_OFF_SQ_RING);
+  if (u->sq_ptr == MAP_FAILED) {
+    u->sq_ptr = NULL;
+    uring_close(u);
+    return -1;
+  }
+  if (p.features & IORING_FEAT_SINGLE_MMAP) {
+    u->cq_ptr = u->sq_ptr;
+  } else {
+    u->cq_ptr = mmap(NULL, u->cq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                     u->fd, IORING_OFF_CQ_RING);
+    if (u->cq_ptr == MAP_FAILED) {
+      u->cq_ptr = NULL;
+      uring_close(u);
+      return -1;
+    }
+  }
+  u->sqes_size = p.sq_entries * sizeof(struct io_uring_sqe);
+  u->sqes = mmap(NULL, u->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                 u->fd, IORING_OFF_SQES);
+  if (u->sqes == MAP_FAILED) {
+    u->sqes = NULL;
+    uring_close(u);
+    return -1;
+  }
+
+  uint8_t *sq = (uint8_t *)u->sq_ptr;
+  uint8_t *cq = (uint8_t *)u->cq_ptr;
+  u->sq_tail = (unsigned *)(sq + p.sq_off.tail);
+  u->sq_mask = (unsigned *)(sq + p.sq_off.ring_mask);
+  u->sq_array = (unsigned *)(sq + p.sq_off.array);
+  u->cq_head = (unsigned *)(cq + p.cq_off.head);
+  u->cq_tail = (unsigned *)(cq + p.cq_off.tail);
+  u->cq_mask = (unsigned *)(cq + p.cq_off.ring_mask);
+  u->cqes = (struct io_uring_cqe *)(cq + p.cq_off.cqes);
+  return 0;
+}
+
+static void uring_queue_readv(Uring *u, int fd, struct iovec *iov, uint64_t off, uint64_t tag) {
+  unsigned tail = *u->sq_tail;
+  unsigned idx = tail & *u->sq_mask;
+  struct io_uring_sqe *sqe = &u->sqes[idx];
+  memset(sqe, 0, sizeof(*sqe));
+  sqe->opcode = IORING_OP_READV;
+  sqe->fd = fd;
+  sqe->addr = (uint64_t)(uintptr_t)iov;
+  sqe->len = 1;
+  sqe->off = off;
+  sqe->user_data = tag;
+  u->sq_array[idx] = idx;
+  __atomic_store_n(u->sq_tail, tail + 1, __ATOMIC_RELEASE);
+}
+
+static int uring_enter(Uring *u, unsigned to_submit, unsigned min_complete) {
+  for (;;) {
+    long rc = syscall(__NR_io_uring_enter, u->fd, to_submit, min_complete,
+                      min_complete ? IORING_ENTER_GETEVENTS : 0, NULL, 0);
+    if (rc >= 0) return 0;
+    if (errno != EINTR) return -1;
+  }
+}
+
+typedef struct {
+  Ring *ring;
+  Uring uring;
+} UringThread;
+
+static void *io_thread_uring(void *arg) {
+  UringThread *t = (UringThread *)arg;
+  Ring *r = t->ring;
+  Uring *u = &t->uring;
+  struct iovec *iov = calloc(r->slot_count, sizeof(struct iovec));
+  uint64_t *slot_off = calloc(r->slot_count, sizeof(uint64_t));
+  size_t *slot_got = calloc(r->slot_count, sizeof(size_t));
+  uint32_t next = 0;
+  uint32_t inflight = 0;
+  int eof = 0;
+  int io_errno = (iov && slot_off && slot_got) ? 0 : ENOMEM;
+  ssz_trace_thread_name("ssz-fd io");
+
+  while (!io_errno && (!eof || inflight > 0)) {
+    /* Keep a read in flight for every free buffer, in ring order */
+    unsigned queued = 0;
+    while (!eof && inflight < r->slot_count) {
+      pthread_mutex_lock(&r->lock);
+      int free_slot = r->slots[next].state == SLOT_EMPTY && !r->stop;
+      if (free_slot) r->slots[next].state = SLOT_PENDING;
+      int stopped = r->stop;
+      pthread_mutex_unlock(&r->lock);
+      if (stopped) eof = 1;
+      if (!free_slot) break;
+
+      slot_off[next] = r->offset;
+      slot_got[next] = 0;
+      r->offset += r->slot_size;
+      iov[next].iov_base = r->slots[next].data;
+      iov[next].iov_len = r->slot_size;
+      uring_queue_readv(u, r->fd, &iov[next], slot_off[next], next);
+      queued++;
+      inflight++;
+      next = (next + 1) % r->slot_count;
+    }
+
+    if (inflight == 0) {
+      if (eof) break;
+      /* Every buffer is full: wait for the hasher to drain one */
+      uint64_t t0 = now_ns();
+      SSZ_TRACE_BEGIN("wait for buffer");
+      pthread_mutex_lock(&r->lock);
+      while (r->slots[next].state != SLOT_EMPTY && !r->stop) {
+        pthread_cond_wait(&r->drained, &r->lock);
+      }
+      pthread_mutex_unlock(&r->lock);
+      SSZ_TRACE_END("wait for buffer");
+      r->stats.io_wait_ns += now_ns() - t0;
+      continue;
+    }
+
+    SSZ_TRACE_BEGIN("read");
+    int entered = uring_enter(u, queued, 1);
+    SSZ_TRACE_END("read");
+    if (entered != 0) {
+      io_errno = errno;
+      break;
+    }
+
+    unsigned head = *u->cq_head;
+    unsigned tail = __atomic_load_n(u->cq_tail, __ATOMIC_ACQUIRE);
+    unsigned resubmit = 0;
+    for (; head != tail; head++) {
+      struct io_uring_cqe *cqe = &u->cqes[head & *u->cq_mask];
+      uint32_t i = (uint32_t)cqe->user_data;
+      int res = cqe->res;
+      if (res < 0) {
+        io_errno = -res;
+        inflight--;
+        ring_publish(r, i, slot_got[i], io_errno);
+        continue;
+      }
+      slot_got[i] += (size_t)res;
+      if (res > 0 && slot_got[i] < r->slot_size) {
+        /* Short read: fetch the remainder of this buffer before publishing it */
+        iov[i].iov_base = r->slots[i].data + slot_got[i];
+        iov[i].iov_len = r->slot_size - slot_got[i];
+        uring_queue_readv(u, r->fd, &iov[i], slot_off[i] + slot_got[i], i);
+        resubmit++;
+        continue;
+      }
+      if (res == 0) eof = 1;
+      inflight--;
+      ring_publish(r, i, slot_got[i], 0);
+    }
+    __atomic_store_n(u->cq_head, head, __ATOMIC_RELEASE);
+    if (resubmit && uring_enter(u, resubmit, 0) != 0) io_errno = errno;
+  }
+
+  if (io_errno) {
+    /* Unblock the consumer on whatever buffer it waits for next */
+    for (uint32_t i = 0; i < r->slot_count; i++) {
+      pthread_mutex_lock(&r->lock);
+      int pending = r->slots[i].state == SLOT_PENDING;
+      pthread_mutex_unlock(&r->lock);
+      if (pending) ring_publish(r, i, 0, io_errno);
+    }
+  }
+  ring_finish(r);
+  free(iov);
+  free(slot_off);
+  free(slot_got);
+  return NULL;
+}
+#endif
+
+/* ===== Consumer: ssz_reader_fn over the ring ===== */
+
+static size_t ring_read(uint8_t *buf, size_t buf_size, void *ctx) {
+  Ring *r = (Ring *)ctx;
+
+  for (;;) {
+    Slot *s = &r->slots[r->cur];
+    if (r->have_slot) {
+      size_t take = s->len - r->cur_pos;
+      if (take > buf_size) take = buf_size;
+      memcpy(buf, s->data + r->cur_pos, take);
+      r->cur_pos += take;
+      if (r->cur_pos == s->len) {
+        /* A short buffer marks EOF (or an I/O error) */
+        if (s->len < r->slot_size) r->done = 1;
+        pthread_mutex_lock(&r->lock);
+        s->state = SLOT_EMPTY;
+        pthread_cond_broadcast(&r->drained);
+        pthread_mutex_unlock(&r->lock);
+        r->have_slot = 0;
+        r->cur = (r->cur + 1) % r->slot_count;
+      }
+      if (take > 0) return take;
+    }
+    if (r->done) return 0;
+
+    uint64_t t0 = now_ns();
+    SSZ_TRACE_BEGIN("wait for data");
+    pthread_mutex_lock(&r->lock);
+    while (s->state != SLOT_FULL && !r->producer_done) {
+      pthread_cond_wait(&r->filled, &r->lock);
+    }
+    int filled = s->state == SLOT_FULL;
+    pthread_mutex_unlock(&r->lock);
+    SSZ_TRACE_END("wait for data");
+    r->stats.hash_wait_ns += now_ns() - t0;
+    if (!filled) {
+      /* The producer stopped short (I/O error): the caller reports r->io_errno */
+      r->done = 1;
+      return 0;
+    }
+    r->have_slot = 1;
+    r->cur_pos = 0;
+  }
+}
+
+int ssz_stream_root_from_fd(
+  int fd,
+  const TypeDesc *td,
+  uint8_t out_root[32],
+  const ssz_fd_opts_t *opts,
+  char err[128]
+) {
+  Ring r;
+  memset(&r, 0, sizeof(r));
+  r.fd = fd;
+  r.slot_size = (opts && opts->buffer_size) ? opts->buffer_size : DEFAULT_BUFFER_SIZE;
+  r.slot_count = (opts && opts->buffer_count) ? opts->buffer_count : DEFAULT_BUFFER_COUNT;
+  r.offset = opts ? opts->offset : 0;
+  r.seekable = lseek(fd, 0, SEEK_CUR) >= 0;
+  r.slot_size = (r.slot_size + BUFFER_ALIGN - 1) & ~(size_t)(BUFFER_ALIGN - 1);
+
+  r.slots = calloc(r.slot_count, sizeof(Slot));
+  if (r.slots == NULL) {
+    if (err) snprintf(err, 128, "Out of memory for read-ahead ring");
+    return SSZ_ERR_WORKSPACE_EXHAUSTED;
+  }
+  for (uint32_t i = 0; i < r.slot_count; i++) {
+    if (posix_memalign((void **)&r.slots[i].data, BUFFER_ALIGN, r.slot_size) != 0) {
+      for (uint32_t j = 0; j < i; j++) free(r.slots[j].data);
+      free(r.slots);
+      if (err) snprintf(err, 128, "Out of memory for read-ahead ring");
+      return SSZ_ERR_WORKSPACE_EXHAUSTED;
+    }
+  }
+  pthread_mutex_init(&r.lock, NULL);
+  pthread_cond_init(&r.filled, NULL);
+  pthread_cond_init(&r.drained, NULL);
+
+  pthread_t thread;
+  int started = 0;
+  int create_err = 0;
+#ifdef HAVE_IO_URING
+  UringThread ut;
+  ut.ring = &r;
+  if (r.seekable && !(opts && opts->disable_io_uring) && uring_open(&ut.uring, r.slot_count) == 0) {
+    r.stats.backend = "io_uring";
+    started = pthread_create(&thread, NULL, io_thread_uring, &ut) == 0;
+    if (!started) uring_close(&ut.uring);
+  }
+#endif
+  if (!started) {
+    r.stats.backend = r.seekable ? "pread" : "read";
+    create_err = pthread_create(&thread, NULL, io_thread_pread, &r);
+    started = create_err == 0;
+  }
+
+  int result;
+  if (!started) {
+    /* Out of threads is a resource failure, like running out of ring memory */
+    if (err) snprintf(err, 128, "Cannot start the I/O thread: %s", strerror(create_err));
+    result = SSZ_ERR_WORKSPACE_EXHAUSTED;
+  } else {
+    result = ssz_stream_root_from_reader(ring_read, &r, td, out_root, err);
+
+    /* Release the producer whether or not the value consumed the whole input */
+    pthread_mutex_lock(&r.lock);
+    r.stop = 1;
+    int io_errno = r.io_errno;
+    pthread_cond_broadcast(&r.drained);
+    pthread_mutex_unlock(&r.lock);
+    if (!r.seekable) pthread_cancel(thread);
+    pthread_join(thread, NULL);
+#ifdef HAVE_IO_URING
+    if (r.stats.backend[0] == 'i') uring_close(&ut.uring);
+#endif
+
+    if (io_errno) {
+      if (err) snprintf(err, 128, "Read failed: %s", strerror(io_errno));
+      result = SSZ_ERR_UNEXPECTED_EOF;
+    }
+  }
+
+  if (opts && opts->stats) *opts->stats = r.stats;
+  pthread_cond_destroy(&r.drained);
+  pthread_cond_destroy(&r.filled);
+  pthread_mutex_destroy(&r.lock);
+  for (uint32_t i = 0; i < r.slot_count; i++) free(r.slots[i].data);
+  free(r.slots);
+  return result;
+}
@@ -0,0 +1,467 @@
+#include "ssz_kernels.h"
+#include <string.h>
+
+/* SSZ_TINY keeps only the scalar kernels: no CPU dispatch, no libgcc probes */
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && !defined(SSZ_TINY)
+#define KERNELS_X86 1
+#include <immintrin.h>
+#endif
+
+static uint32_t load_le32(const uint8_t *p) {
+  return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+/* ===== Scalar ===== */
+
+/* Checks entries [from, count); entry from - 1 is already known good */
+static int offsets_tail(const uint8_t *table, size_t from, size_t count, int strict, size_t *bad) {
+  uint32_t prev = load_le32(table + (from - 1) * 4);
+  for (size_t i = from; i < count; i++) {
+    uint32_t cur = load_le32(table + i * 4);
+    if (cur < prev || (strict && cur == prev)) {
+      *bad = i;
+      return SSZ_ERR_BAD_OFFSET;
+    }
+    prev = cur;
+  }
+  return SSZ_ERR_NONE;
+}
+
+static int offsets_ends(const uint8_t *table, size_t count, uint32_t first, uint32_t end, int strict, size_t *bad) {
+  if (load_le32(table) != first) {
+    *bad = 0;
+    return SSZ_ERR_BAD_OFFSET;
+  }
+  /* Monotonic entries make the last one the largest */
+  uint32_t last = load_le32(table + (count - 1) * 4);
+  if (last > end || (strict && last == end)) {
+    *bad = count - 1;
+    return SSZ_ERR_BAD_OFFSET;
+  }
+  return SSZ_ERR_NONE;
+}
+
+static int offsets_scalar(const uint8_t *table, size_t count, uint32_t first, uint32_t end, int strict, size_t *bad) {
+  int result = offsets_tail(table, 1, count, strict, bad);
+  if (result != SSZ_ERR_NONE) return result;
+  return offsets_ends(table, count, first, end, strict, bad);
+}
+
+static int bools_scalar(const uint8_t *bytes, size_t len, size_t *bad) {
+  for (size_t i = 0; i < len; i++) {
+    if (bytes[i] > 1) {
+      *bad = i;
+      return SSZ_ERR_NON_CANONICAL;
+    }
+  }
+  return SSZ_ERR_NONE;
+}
+
+static int sentinels_from(const uint8_t *bytes, const uint8_t *table, size_t from, size_t count, uint32_t end, size_t *bad) {
+  for (size_t i = from; i < count; i++) {
+    uint32_t stop = i + 1 < count ? load_le32(table + (i + 1) * 4) : end;
+    if (bytes[stop - 1] == 0) {
+      *bad = i;
+      return SSZ_ERR_BITLIST_PADDING;
+    }
+  }
+  return SSZ_ERR_NONE;
+}
+
+static int sentinels_scalar(const uint8_t *bytes, const uint8_t *table, size_t count, uint32_t end, size_t *bad) {
+  return sentinels_from(bytes, table, 0, count, end, bad);
+}
+
+static size_t diff_from(const uint8_t *a, const uint8_t *b, size_t from, size_t len) {
+  while (from < len && a[from] == b[from]) from++;
+  return from;
+}
+
+static size_t diff_scalar(const uint8_t *a, const uint8_t *b, size_t len) {
+  size_t i = 0;
+  for (; i + 8 <= len; i += 8) {
+    uint64_t x, y;
+    memcpy(&x, a + i, 8);
+    memcpy(&y, b + i, 8);
+    if (x != y) break;
+  }
+  return diff_from(a, b, i, len);
+}
+
+/* ===== SSE4.1 / AVX2 ===== */
+
+#ifdef KERNELS_X86
+
+/* Vector passes only detect a bad block; the scalar tail pinpoints the entry */
+
+__attribute__((target("sse4.1")))
+static int offsets_sse41(const uint8_t *table, size_t count, uint32_t first, uint32_t end, int strict, size_t *bad) {
+  size_t i = 0;
+  for (; i + 5 <= count; i += 4) {
+    __m128i a = _mm_loadu_si128((const __m128i *)(table + i * 4));
+    __m128i b = _mm_loadu_si128((const __m128i *)(table + i * 4 + 4));
+    __m128i good = _mm_cmpeq_epi32(_mm_max_epu32(a, b), b);
+    if (strict) good = _mm_andnot_si128(_mm_cmpeq_epi32(a, b), good);
+    if (_mm_movemask_epi8(good) != 0xffff) break;
+  }
+  int result = offsets_tail(table, i + 1, count, strict, bad);
+  if (result != SSZ_ERR_NONE) return result;
+  return offsets_ends(table, count, first, end, strict, bad);
+}
+
+__attribute__((target("sse4.1")))
+static int bools_sse41(const uint8_t *bytes, size_t len, size_t *bad) {
+  const __m128i ones = _mm_set1_epi8(1);
+  size_t i = 0;
+  for (; i + 16 <= len; i += 16) {
+    __m128i v = _mm_loadu_si128((const __m128i *)(bytes + i));
+    if (_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_max_epu8(v, ones), ones)) != 0xffff) break;
+  }
+  int result = bools_scalar(bytes + i, len - i, bad);
+  if (result != SSZ_ERR_NONE) *bad += i;
+  return result;
+}
+
+__attribute__((target("sse4.1")))
+static size_t diff_sse41(const uint8_t *a, const uint8_t *b, size_t len) {
+  size_t i = 0;
+  for (; i + 16 <= len; i += 16) {
+    __m128i x = _mm_loadu_si128((const __m128i *)(a + i));
+    __m128i y = _mm_loadu_si128((const __m128i *)(b + i));
+    int same = _mm_movemask_epi8(_mm_cmpeq_epi8(x, y));
+    if (same != 0xffff) return i + (size_t)__builtin_ctz(~same & 0xffff);
+  }
+  return diff_from(a, b, i, len);
+}
+
+__attribute__((target("avx2")))
+static int offsets_avx2(const uint8_t *table, size_t count, uint32_t first, uint32_t end, int strict, size_t *bad) {
+  size_t i = 0;
+  for (; i + 9 <= count; i += 8) {
+    __m256i a = _mm256_loadu_si256((const __m256i *)(table + i * 4));
+    __m256i b = _mm256_loadu_si256((const __m256i *)(table + i * 4 + 4));
+    __m256i good = _mm256_cmpeq_epi32(_mm256_max_epu32(a, b), b);
+    if (strict) good = _mm256_andnot_si256(_mm256_cmpeq_epi32(a, b), good);
+    if (_mm256_movemask_epi8(good) != -1) break;
+  }
+  int result = offsets_tail(table, i + 1, count, strict, bad);
+  if (result != SSZ_ERR_NONE) return result;
+  return offsets_ends(table, count, first, end, strict, bad);
+}
+
+__attribute__((target("avx2")))
+static int bools_avx2(const uint8_t *bytes, size_t len, size_t *bad) {
+  const __m256i ones = _mm256_set1_epi8(1);
+  size_t i = 0;
+  for (; i + 32 <= len; i += 32) {
+    __m256i v = _mm256_loadu_si256((const __m256i *)(bytes + i));
+    if (_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_max_epu8(v, ones), ones)) != -1) break;
+  }
+  int result = bools_scalar(bytes + i, len - i, bad);
+  if (result != SSZ_ERR_NONE) *bad += i;
+  return result;
+}
+
+__attribute__((target("avx2")))
+static int sentinels_avx2(const uint8_t *bytes, const uint8_t *table, size_t count, uint32_t end, size_t *bad) {
+  size_t i = 0;
+  /* Gather the 4 bytes ending at each element's end; the top byte is the sentinel.
+   * Offsets are at least 4 (the table itself), so the reads stay in bounds. */
+  if (end <= 0x7fffffffu) {
+    const __m256i four = _mm256_set1_epi32(4);
+    for (; i + 9 <= count; i += 8) {
+      __m256i ends = _mm256_loadu_si256((const __m256i *)(table + (i + 1) * 4));
+      __m256i words = _mm256_i32gather_epi32((const int *)bytes, _mm256_sub_epi32(ends, four), 1);
+      __m256i sentinel = _mm256_srli_epi32(words, 24);
+      if (_mm256_movemask_epi8(_mm256_cmpeq_epi32(sentinel, _mm256_setzero_si256())) != 0) break;
+    }
+  }
+  return sentinels_from(bytes, table, i, count, end, bad);
+}
+
+__attribute__((target("avx2")))
+static size_t diff_avx2(const uint8_t *a, const uint8_t *b, size_t len) {
+  size_t i = 0;
+  /* Two vectors per step: unchanged regions of large states dominate */
+  for (; i + 64 <= len; i += 64) {
+    __m256i x0 = _mm256_loadu_si256((const __m256i *)(a + i));
+    __m256i y0 = _mm256_loadu_si256((const __m256i *)(b + i));
+    __m256i x1 = _mm256_loadu_si256((const __m256i *)(a + i + 32));
+    __m256i y1 = _mm256_loadu_si256((const __m256i *)(b + i + 32));
+    __m256i same = _mm256_and_si256(_mm256_cmpeq_epi8(x0, y0), _mm256_cmpeq_epi8(x1, y1));
+    if (_mm256_movemask_epi8(same) != -1) break;
+  }
+  for (; i + 32 <= len; i += 32) {
+    __m256i x = _mm256_loadu_si256((const __m256i *)(a + i));
+    __m256i y = _mm256_loadu_si256((const __m256i *)(b + i));
+    uint32_t same = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(x, y));
+    if (same != 0xffffffffu) return i + (size_t)__builtin_ctz(~same);
+  }
+  return diff_from(a, b, i, len);
+}
+
+#endif
+
+/* ===== Lane hashing ===== */
+
+/* SHA-256 of a 64-byte message, one lane per message: the same code runs on
+ * plain words (scalar) and on GCC vectors of 8 or 16 words, so each round
+ * advances that many independent hashes. Inputs are the transposed rows
+ * described in ssz_kernels.h, so every load and store is a whole vector. */
+
+#ifdef SSZ_TINY
+extern void sha256_hash(const uint8_t *data, size_t len, uint8_t out[32]);
+
+/* The unrolled body is kilobytes; the tiny profile hashes lane by lane */
+static void lanes_scalar(uint32_t out[8][SSZ_LANES], const uint32_t left[8][SSZ_LANES],
+                         const uint32_t right[8][SSZ_LANES]) {
+  for (size_t lane = 0; lane < SSZ_LANES; lane++) {
+    uint8_t pair[64];
+    for (int i = 0; i < 16; i++) {
+      uint32_t v = i < 8 ? left[i][lane] : right[i - 8][lane];
+      for (int b = 0; b < 4; b++) pair[i * 4 + b] = (uint8_t)(v >> (24 - 8 * b));
+    }
+    sha256_hash(pair, 64, pair);
+    for (int i = 0; i < 8; i++) {
+      const uint8_t *b = pair + i * 4;
+      out[i][lane] = ((uint32_t)b[0] << 24) | ((uint32_t)b[1] << 16) | ((uint32_t)b[2] << 8) | b[3];
+    }
+  }
+}
+#else
+static const uint32_t LANE_K[64] = {
+  0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+  0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+  0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+  0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+  0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+  0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+  0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+  0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+static const uint32_t LANE_IV[8] = {
+  0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+};
+
+/* W[i] + K[i] of the padding block that follows every 64-byte message */
+static const uint32_t LANE_PAD_WK[64] = {
+  0xc28a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+  0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf374,
+  0x649b69c1, 0xf0fe4786, 0x0fe1edc6, 0x240cf254, 0x4fe9346f, 0x6cc984be, 0x61b9411e, 0x16f988fa,
+  0xf2c65152, 0xa88e5a6d, 0xb019fc65, 0xb9d99ec7, 0x9a1231c3, 0xe70eeaa0, 0xfdb1232b, 0xc7353eb0,
+  0x3069bad5, 0xcb976d5f, 0x5a0f118f, 0xdc1eeefd, 0x0a35b689, 0xde0b7a04, 0x58f4ca9d, 0xe15d5b16,
+  0x007f3e86, 0x37088980, 0xa507ea32, 0x6fab9537, 0x17406110, 0x0d8cd6f1, 0xcdaa3b6d, 0xc0bbbe37,
+  0x83613bda, 0xdb48a363, 0x0b02e931, 0x6fd15ca7, 0x521afaca, 0x31338431, 0x6ed41a95, 0x6d437890,
+  0xc39c91f2, 0x9eccabbd, 0xb5c9a0e6, 0x532fb63c, 0xd2c741c6, 0x07237ea3, 0xa4954b68, 0x4c191d76
+};
+
+#define LANE_ROTR(x, n) (((x) >> (n)) | ((x) << (32 - (n))))
+
+/* One round on state s with wk = W[i] + K[i]; the caller rotates the names */
+#define LANE_ROUND(a, b, c, d, e, f, g, h, wk)                                         \
+  do {                                                                                 \
+    h += (LANE_ROTR(e, 6) ^ LANE_ROTR(e, 11) ^ LANE_ROTR(e, 25)) + ((e & f) ^ (~e & g)) + (wk); \
+    d += h;                                                                            \
+    h += (LANE_ROTR(a, 2) ^ LANE_ROTR(a, 13) ^ LANE_ROTR(a, 22)) + ((a & b) ^ (a & c) ^ (b & c)); \
+  } while (0)
+
+#define LANE_ROUNDS8(s, i, wk)                                                         \
+  do {                                                                                 \
+    LANE_ROUND(s[0], s[1], s[2], s[3], s[4], s[5], s[6], s[7], wk(i));                 \
+    LANE_ROUND(s[7], s[0], s[1], s[2], s[3], s[4], s[5], s[6], wk(i + 1));             \
+    LANE_ROUND(s[6], s[7], s[0], s[1], s[2], s[3], s[4], s[5], wk(i + 2));             \
+    LANE_ROUND(s[5], s[6], s[7], s[0], s[1], s[2], s[3], s[4], wk(i + 3));             \
+    LANE_ROUND(s[4], s[5], s[6], s[7], s[0], s[1], s[2], s[3], wk(i + 4));             \
+    LANE_ROUND(s[3], s[4], s[5], s[6], s[7], s[0], s[1], s[2], wk(i + 5));             \
+    LANE_ROUND(s[2], s[3], s[4], s[5], s[6], s[7], s[0], s[1], wk(i + 6));             \
+    LANE_ROUND(s[1], s[2], s[3], s[4], s[5], s[6], s[7], s[0], wk(i + 7));             \
+  } while (0)
+
+/* Message schedule kept as a rolling window of 16 words */
+#define LANE_MSG_WK(i)                                                                 \
+  ((i) < 16 ? w[(i) & 15] + LANE_K[i]                                                  \
+            : (w[(i) & 15] += (LANE_ROTR(w[((i) - 2) & 15], 17) ^ LANE_ROTR(w[((i) - 2) & 15], 19) ^ \
+                               (w[((i) - 2) & 15] >> 10)) +                            \
+                              w[((i) - 7) & 15] +                                      \
+                              (LANE_ROTR(w[((i) - 15) & 15], 7) ^ LANE_ROTR(w[((i) - 15) & 15], 18) ^ \
+                               (w[((i) - 15) & 15] >> 3)),                             \
+               w[(i) & 15] + LANE_K[i]))
+#define LANE_PAD(i) LANE_PAD_WK[i]
+
+/* Body of a lane kernel over vector type T (or uint32_t for one lane) */
+#define LANE_KERNEL_BODY(T)                                                            \
+  for (size_t lane = 0; lane < SSZ_LANES; lane += sizeof(T) / 4) {                     \
+    T w[16], s[8], start[8], v;                                                        \
+    for (int i = 0; i < 8; i++) {                                                      \
+      memcpy(&v, &left[i][lane], sizeof(T));                                           \
+      w[i] = v;                                                                        \
+      memcpy(&v, &right[i][lane], sizeof(T));                                          \
+      w[i + 8] = v;                                                                    \
+      s[i] = start[i] = (T){0} + LANE_IV[i];                                           \
+    }                                                                                  \
+    _Pragma("GCC unroll 8") for (int i = 0; i < 64; i += 8) LANE_ROUNDS8(s, i, LANE_MSG_WK); \
+    for (int i = 0; i < 8; i++) s[i] = start[i] = s[i] + start[i];                     \
+    _Pragma("GCC unroll 8") for (int i = 0; i < 64; i += 8) LANE_ROUNDS8(s, i, LANE_PAD); \
+    for (int i = 0; i < 8; i++) {                                                      \
+      v = s[i] + start[i];                                                             \
+      memcpy(&out[i][lane], &v, sizeof(T));                                            \
+    }                                                                                  \
+  }
+
+static void lanes_scalar(uint32_t out[8][SSZ_LANES], const uint32_t left[8][SSZ_LANES],
+                         const uint32_t right[8][SSZ_LANES]) {
+  LANE_KERNEL_BODY(uint32_t)
+}
+#endif
+
+#ifdef KERNELS_X86
+typedef uint32_t LaneVec4 __attribute__((vector_size(16)));
+typedef uint32_t LaneVec8 __attribute__((vector_size(32)));
+typedef uint32_t LaneVec16 __attribute__((vector_size(64)));
+
+__attribute__((target("sse4.1")))
+static void lanes_sse41(uint32_t out[8][SSZ_LANES], const uint32_t left[8][SSZ_LANES],
+                        const uint32_t right[8][SSZ_LANES]) {
+  LANE_KERNEL_BODY(LaneVec4)
+}
+
+__attribute__((target("avx2")))
+static void lanes_avx2(uint32_t out[8][SSZ_LANES], const uint32_t left[8][SSZ_LANES],
+                       const uint32_t right[8][SSZ_LANES]) {
+  LANE_KERNEL_BODY(LaneVec8)
+}
+
+__attribute__((target("avx512f")))
+static void lanes_avx512(uint32_t out[8][SSZ_LANES], const uint32_t left[8][SSZ_LANES],
+                         const uint32_t right[8][SSZ_LANES]) {
+  LANE_KERNEL_BODY(LaneVec16)
+}
+#endif
+
+/* ===== Dispatch ===== */
+
+typedef struct {
+  ssz_kernel_t kernel;
+  int (*offsets)(const uint8_t *, size_t, uint32_t, uint32_t, int, size_t *);
+  int (*bools)(const uint8_t *, size_t, size_t *);
+  int (*sentinels)(const uint8_t *, const uint8_t *, size_t, uint32_t, size_t *);
+  size_t (*diff)(const uint8_t *, const uint8_t *, size_t);
+  void (*lanes)(uint32_t[8][SSZ_LANES], const uint32_t[8][SSZ_LANES], const uint32_t[8][SSZ_LANES]);
+} KernelOps;
+
+static const KernelOps SCALAR_OPS = {
+  SSZ_KERNEL_SCALAR, offsets_scalar, bools_scalar, sentinels_scalar, diff_scalar, lanes_scalar
+};
+#ifdef KERNELS_X86
+static const KernelOps SSE41_OPS = {
+  SSZ_KERNEL_SSE41, offsets_sse41, bools_sse41, sentinels_scalar, diff_sse41, lanes_sse41
+};
+static const KernelOps AVX2_OPS = {
+  SSZ_KERNEL_AVX2, offsets_avx2, bools_avx2, sentinels_avx2, diff_avx2, lanes_avx2
+};
+static const KernelOps AVX512_OPS = {
+  SSZ_KERNEL_AVX512, offsets_avx2, bools_avx2, sentinels_avx2, diff_avx2, lanes_avx512
+};
+#endif
+
+/* Read and written atomically: the era pool and verifyd workers check
+ * concurrently, and the first of them may be the one that picks the variant */
+static const KernelOps *active_ops = 0;
+
+static int kernel_supported(ssz_kernel_t kernel) {
+  switch (kernel) {
+    case SSZ_KERNEL_SCALAR:
+      return 1;
+#ifdef KERNELS_X86
+    case SSZ_KERNEL_SSE41:
+      return __builtin_cpu_supports("sse4.1");
+    case SSZ_KERNEL_AVX2:
+      return __builtin_cpu_supports("avx2");
+    case SSZ_KERNEL_AVX512:
+      return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("avx512f");
+#endif
+    default:
+      return 0;
+  }
+}
+
+static const KernelOps *resolve(ssz_kernel_t want) {
+  if (want == SSZ_KERNEL_AUTO || !kernel_supported(want)) {
+    want = SSZ_KERNEL_SCALAR;
+    if (kernel_supported(SSZ_KERNEL_SSE41)) want = SSZ_KERNEL_SSE41;
+    if (kernel_supported(SSZ_KERNEL_AVX2)) want = SSZ_KERNEL_AVX2;
+    if (kernel_supported(SSZ_KERNEL_AVX512)) want = SSZ_KERNEL_AVX512;
+  }
+
+  switch (want) {
+#ifdef KERNELS_X86
+    case SSZ_KERNEL_AVX512:
+      return &AVX512_OPS;
+    case SSZ_KERNEL_AVX2:
+      return &AVX2_OPS;
+    case SSZ_KERNEL_SSE41:
+      return &SSE41_OPS;
+#endif
+    default:
+      return &SCALAR_OPS;
+  }
+}
+
+ssz_kernel_t ssz_kernel_select(ssz_kernel_t want) {
+  const KernelOps *o = resolve(want);
+  __atomic_store_n(&active_ops, o, __ATOMIC_RELEASE);
+  return o->kernel;
+}
+
+static const KernelOps *ops(void) {
+  const KernelOps *o = __atomic_load_n(&active_ops, __ATOMIC_ACQUIRE);
+  if (o) return o;
+  /* First use: install the best variant unless a select got there first */
+  const KernelOps *best = resolve(SSZ_KERNEL_AUTO);
+  if (__atomic_compare_exchange_n(&active_ops, &o, best, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) return best;
+  return o;
+}
+
+ssz_kernel_t ssz_kernel_active(void) {
+  return ops()->kernel;
+}
+
+const char *ssz_kernel_name(ssz_kernel_t kernel) {
+  switch (kernel) {
+    case SSZ_KERNEL_SCALAR: return "scalar";
+    case SSZ_KERNEL_SSE41: return "sse4.1";
+    case SSZ_KERNEL_AVX2: return "avx2";
+    case SSZ_KERNEL_AVX512: return "avx512";
+    default: return "auto";
+  }
+}
+
+/* SSZ_TINY calls the scalar kernels directly, keeping the call graph static */
+#ifdef SSZ_TINY
+#define KERNEL(op, scalar) (scalar)
+#else
+#define KERNEL(op, scalar) (ops()->op)
+#endif
+
+int ssz_check_offsets(const uint8_t *table, size_t count, uint32_t first, uint32_t end, int strict, size_t *bad) {
+  if (count == 0) return SSZ_ERR_NONE;
+  return KERNEL(offsets, offsets_scalar)(table, count, first, end, strict, bad);
+}
+
+int ssz_check_bools(const uint8_t *bytes, size_t len, size_t *bad) {
+  return KERNEL(bools, bools_scalar)(bytes, len, bad);
+}
+
+int ssz_check_bitlist_sentinels(const uint8_t *bytes, const uint8_t *table, size_t count, uint32_t end, size_t *bad) {
+  if (count == 0) return SSZ_ERR_NONE;
+  return KERNEL(sentinels, sentinels_scalar)(bytes, table, count, end, bad);
+}
+
+size_t ssz_first_diff(const uint8_t *a, const uint8_t *b, size_t len) {
+  return KERNEL(diff, diff_scalar)(a, b, len);
+}
+
+void ssz_hash_lanes(uint32_t out[8][SSZ_LANES], const uint32_t left[8][SSZ_LANES], const uint32_t right[8][SSZ_LANES]) {
+  KERNEL(lanes, lanes_scalar)(out, left, right);
+}
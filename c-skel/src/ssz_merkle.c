@@ -0,0 +1,300 @@
+#include "ssz_merkle.h"
+#include "zero_hashes.h"
+#include "ssz_error.h"
+#include <string.h>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+extern void sha256_hash(const uint8_t *data, size_t len, uint8_t out[32]);
+
+void ssz_hash_parent(const uint8_t left[32], const uint8_t right[32], uint8_t out[32]) {
+  uint8_t combined[64];
+  memcpy(combined, left, 32);
+  memcpy(combined + 32, right, 32);
+  sha256_hash(combined, 64, out);
+}
+
+static int is_zero_subtree(const StackEntry *e) {
+  if (e->height >= ZERO_HASH_LEVELS) return 0;
+  /* A loop rather than memcmp keeps the core down to memcpy/memset */
+  uint8_t diff = 0;
+  for (int i = 0; i < 32; i++) diff |= (uint8_t)(e->hash[i] ^ ZERO_HASHES[e->height][i]);
+  return diff == 0;
+}
+
+static void push_and_merge(StackEntry *stack, uint32_t *depth, StackEntry entry) {
+  stack[*depth] = entry;
+  (*depth)++;
+  while (*depth >= 2) {
+    StackEntry *top = &stack[*depth - 1];
+    StackEntry *below = &stack[*depth - 2];
+    if (below->height != top->height) break;
+    uint8_t parent[32];
+    /* Two zero subtrees make the next zero subtree: look it up, don't hash */
+    if (below->height + 1 < ZERO_HASH_LEVELS && is_zero_subtree(top) && is_zero_subtree(below)) {
+      memcpy(parent, ZERO_HASHES[below->height + 1], 32);
+    } else {
+      ssz_hash_parent(below->hash, top->hash, parent);
+    }
+    (*depth) -= 2;
+    StackEntry merged = { .height = below->height + 1 };
+    memcpy(merged.hash, parent, 32);
+    stack[*depth] = merged;
+    (*depth)++;
+  }
+}
+
+/* Number of leading all-zero 32-byte chunks in bytes[0 .. chunks*32) */
+static size_t zero_chunk_run(const uint8_t *bytes, size_t chunks) {
+  size_t i = 0;
+#if defined(__AVX2__)
+  for (; i < chunks; i++) {
+    __m256i v = _mm256_loadu_si256((const __m256i *)(bytes + i * 32));
+    if (!_mm256_testz_si256(v, v)) break;
+  }
+#elif defined(__SSE2__)
+  const __m128i zero = _mm_setzero_si128();
+  for (; i < chunks; i++) {
+    __m128i v = _mm_or_si128(_mm_loadu_si128((const __m128i *)(bytes + i * 32)),
+                             _mm_loadu_si128((const __m128i *)(bytes + i * 32 + 16)));
+    if (_mm_movemask_epi8(_mm_cmpeq_epi8(v, zero)) != 0xffff) break;
+  }
+#else
+  for (; i < chunks; i++) {
+    uint64_t w[4];
+    memcpy(w, bytes + i * 32, 32);
+    if ((w[0] | w[1] | w[2] | w[3]) != 0) break;
+  }
+#endif
+  return i;
+}
+
+void ssz_mixin_length(uint8_t root[32], uint32_t length) {
+  uint8_t len_buf[32] = {0};
+  len_buf[0] = length & 0xff;
+  len_buf[1] = (length >> 8) & 0xff;
+  len_buf[2] = (length >> 16) & 0xff;
+  len_buf[3] = (length >> 24) & 0xff;
+  uint8_t new_root[32];
+  ssz_hash_parent(root, len_buf, new_root);
+  memcpy(root, new_root, 32);
+}
+
+#ifndef SSZ_TINY
+void ssz_type_hash(const TypeDesc *td, uint8_t out[32]) {
+  uint8_t buf[16 + 32 * 2];
+  size_t n = 16;
+  const uint32_t words[4] = {(uint32_t)td->kind, td->fixed_size, td->max_length, td->field_count};
+  for (int w = 0; w < 4; w++) {
+    for (int i = 0; i < 4; i++) buf[w * 4 + i] = (uint8_t)(words[w] >> (8 * i));
+  }
+  if (td->element_type != NULL) {
+    ssz_type_hash((const TypeDesc *)td->element_type, buf + n);
+    n += 32;
+  }
+  if (td->kind == SSZ_KIND_CONTAINER) {
+    /* Field hashes chained so the buffer stays fixed */
+    uint8_t chain[64] = {0};
+    for (uint32_t i = 0; i < td->field_count; i++) {
+      ssz_type_hash((const TypeDesc *)td->field_types[i], chain + 32);
+      sha256_hash(chain, 64, chain);
+    }
+    memcpy(buf + n, chain, 32);
+    n += 32;
+  }
+  sha256_hash(buf, n, out);
+}
+#endif
+
+void *ssz_ws_alloc(ssz_workspace_t *ws, size_t size) {
+  /* Align every allocation to 8 bytes regardless of base alignment */
+  size_t pad = (size_t)(-(uintptr_t)(ws->base + ws->used)) & 7u;
+  if (pad > ws->size - ws->used || size > ws->size - ws->used - pad) return NULL;
+  void *p = ws->base + ws->used + pad;
+  ws->used += pad + size;
+  if (ws->used > ws->peak) ws->peak = ws->used;
+  return p;
+}
+
+/* Stack entries needed to merkleize `leaves` leaves: one per set bit of the
+ * running count, plus the transient slot used by push_and_merge. */
+uint32_t ssz_merkle_stack_entries(size_t leaves) {
+  uint32_t bits = 0;
+  while (leaves) {
+    bits++;
+    leaves >>= 1;
+  }
+  return bits + 1;
+}
+
+size_t ssz_merkle_stack_bytes(size_t leaves) {
+  return ssz_merkle_stack_entries(leaves) * sizeof(StackEntry) + 7u;
+}
+
+/* ===== Merkleizer over a workspace-allocated stack ===== */
+
+int ssz_merkle_init(Merkleizer *m, ssz_workspace_t *ws, size_t leaves, char err[128]) {
+  m->depth = 0;
+  m->stack = (StackEntry *)ssz_ws_alloc(ws, ssz_merkle_stack_entries(leaves) * sizeof(StackEntry));
+  if (m->stack == NULL) {
+    SSZ_ERROR_MSG(err, "Workspace exhausted (%zu of %zu bytes used)", ws->used, ws->size);
+    return SSZ_ERR_WORKSPACE_EXHAUSTED;
+  }
+  return SSZ_ERR_NONE;
+}
+
+void ssz_merkle_push(Merkleizer *m, const uint8_t chunk[32]) {
+  ssz_merkle_push_subtree(m, chunk, 0);
+}
+
+void ssz_merkle_push_subtree(Merkleizer *m, const uint8_t root[32], uint32_t height) {
+  StackEntry entry = { .height = height };
+  memcpy(entry.hash, root, 32);
+  push_and_merge(m->stack, &m->depth, entry);
+}
+
+/* Push `count` zero chunks as the largest aligned zero subtrees that fit: the
+ * stack ends up exactly as if each chunk had been pushed, without hashing
+ * zero-over-zero parents. Alignment follows from the top entry's height,
+ * which is the lowest set bit of the leaves pushed so far. */
+void ssz_merkle_push_zeros(Merkleizer *m, size_t count) {
+  while (count > 0) {
+    uint32_t height = 0;
+    while (height + 1 < ZERO_HASH_LEVELS && ((size_t)2 << height) <= count &&
+           (m->depth == 0 || height + 1 <= m->stack[m->depth - 1].height)) {
+      height++;
+    }
+    StackEntry entry = { .height = height };
+    memcpy(entry.hash, ZERO_HASHES[height], 32);
+    push_and_merge(m->stack, &m->depth, entry);
+    count -= (size_t)1 << height;
+  }
+}
+
+/* Push whole chunks from bytes, collapsing aligned all-zero runs */
+void ssz_merkle_push_bytes(Merkleizer *m, const uint8_t *bytes, size_t chunks) {
+  size_t i = 0;
+  while (i < chunks) {
+    size_t zeros = zero_chunk_run(bytes + i * 32, chunks - i);
+    if (zeros > 0) {
+      ssz_merkle_push_zeros(m, zeros);
+      i += zeros;
+      continue;
+    }
+    ssz_merkle_push(m, bytes + i * 32);
+    i++;
+  }
+}
+
+void ssz_merkle_finish(Merkleizer *m, uint8_t out[32]) {
+  /* Collapse remaining stack entries */
+  while (m->depth > 1) {
+    StackEntry top = m->stack[m->depth - 1];
+    StackEntry below = m->stack[m->depth - 2];
+    uint8_t parent[32];
+    ssz_hash_parent(below.hash, top.hash, parent);
+    m->depth -= 2;
+    StackEntry merged = { .height = below.height + 1 };
+    memcpy(merged.hash, parent, 32);
+    m->stack[m->depth] = merged;
+    m->depth++;
+  }
+
+  if (m->depth == 0) {
+    /* Empty data: root is zero hash */
+    memset(out, 0, 32);
+  } else {
+    memcpy(out, m->stack[0].hash, 32);
+  }
+}
+
+/* ===== Sharded roots ===== */
+
+/* Entries for a stack over up to 2^MAX_STACK_DEPTH leaves, plus alignment */
+#define SHARD_STACK_ENTRIES (MAX_STACK_DEPTH + 3)
+
+int ssz_subtree_root(
+  const uint8_t *bytes,
+  size_t len,
+  uint64_t chunk_start,
+  uint64_t chunk_count,
+  uint32_t depth,
+  uint8_t out_root[32],
+  char err[128]
+) {
+  if (depth > MAX_STACK_DEPTH || depth >= 64) {
+    SSZ_ERROR_MSG(err, "Subtree depth %u exceeds %u", depth, MAX_STACK_DEPTH);
+    return SSZ_ERR_UNSUPPORTED_TYPE;
+  }
+  uint64_t width = (uint64_t)1 << depth;
+  if (chunk_start % width != 0 || chunk_count > width) {
+    SSZ_ERROR_MSG(err, "Chunks %llu+%llu not within one aligned run of %llu",
+                  (unsigned long long)chunk_start, (unsigned long long)chunk_count,
+                  (unsigned long long)width);
+    return SSZ_ERR_BAD_OFFSET;
+  }
+  uint64_t total = len / 32 + (len % 32 != 0);
+  if (chunk_start > total || chunk_count > total - chunk_start) {
+    SSZ_ERROR_MSG(err, "Chunks %llu+%llu past the %llu in the buffer",
+                  (unsigned long long)chunk_start, (unsigned long long)chunk_count,
+                  (unsigned long long)total);
+    return SSZ_ERR_LENGTH_OVERFLOW;
+  }
+
+  ssz_workspace_t ws;
+  SSZ_DEFAULT_WORKSPACE(ws, SHARD_STACK_ENTRIES);
+  Merkleizer m;
+  int result = ssz_merkle_init(&m, &ws, (size_t)chunk_count, err);
+  if (result != SSZ_ERR_NONE) return result;
+
+  /* Only the buffer's last chunk can be partial */
+  const uint8_t *p = bytes + (size_t)chunk_start * 32;
+  size_t whole = (size_t)chunk_count;
+  if (chunk_count > 0 && chunk_start + chunk_count == total && len % 32) whole--;
+  ssz_merkle_push_bytes(&m, p, whole);
+  if (whole < chunk_count) {
+    uint8_t chunk[32] = {0};
+    memcpy(chunk, p + whole * 32, len % 32);
+    ssz_merkle_push(&m, chunk);
+  }
+  ssz_merkle_finish(&m, out_root);
+  return SSZ_ERR_NONE;
+}
+
+/* The serial path folds a short tail into the full runs' entries exactly as
+ * pushing its root at the runs' height does, so no run needs special care */
+int ssz_combine_subtrees(
+  const uint8_t (*roots)[32],
+  size_t n,
+  uint32_t depth,
+  const uint32_t *length_mixin,
+  uint8_t out_root[32],
+  char err[128]
+) {
+  if (depth > MAX_STACK_DEPTH || depth >= 64) {
+    SSZ_ERROR_MSG(err, "Subtree depth %u exceeds %u", depth, MAX_STACK_DEPTH);
+    return SSZ_ERR_UNSUPPORTED_TYPE;
+  }
+  ssz_workspace_t ws;
+  SSZ_DEFAULT_WORKSPACE(ws, SHARD_STACK_ENTRIES);
+  Merkleizer m;
+  int result = ssz_merkle_init(&m, &ws, n, err);
+  if (result != SSZ_ERR_NONE) return result;
+
+  for (size_t i = 0; i < n; i++) ssz_merkle_push_subtree(&m, roots[i], depth);
+  ssz_merkle_finish(&m, out_root);
+  if (length_mixin) ssz_mixin_length(out_root, *length_mixin);
+  return SSZ_ERR_NONE;
+}
+
+#ifdef SSZ_TINY
+static StackEntry tiny_arena[SSZ_TINY_ARENA_ENTRIES];
+
+void ssz_tiny_workspace(ssz_workspace_t *ws) {
+  ssz_workspace_init(ws, tiny_arena, sizeof(tiny_arena));
+}
+#endif
@@ -0,0 +1,114 @@
+#ifndef SSZ_MERKLE_H
+#define SSZ_MERKLE_H
+
+/* Internal carry-stack merkleizer shared by the verifier and the encoder.
+ * Leaves are pushed left to right; equal-height neighbours merge as soon as
+ * they meet, so the stack never holds more than one entry per tree level. */
+
+#include "ssz_stream.h"
+
+/* Entries in the default on-stack workspaces */
+#ifdef HOST_TEST
+#define MAX_STACK_DEPTH 64
+#else
+#define MAX_STACK_DEPTH 32
+#endif
+
+typedef struct {
+  uint8_t hash[32];
+  uint32_t height;
+} StackEntry;
+
+typedef struct {
+  StackEntry *stack;
+  uint32_t depth;
+} Merkleizer;
+
+/* Scratch for entry points called without a workspace. Hosted builds put
+ * `entries` stack entries on the caller's stack. SSZ_TINY builds share one
+ * static arena across all entry points instead: less stack in the guest, but
+ * those calls are not reentrant. */
+#ifdef SSZ_TINY
+#define SSZ_TINY_ARENA_ENTRIES (MAX_STACK_DEPTH * 3 + 8)
+void ssz_tiny_workspace(ssz_workspace_t *ws);
+#define SSZ_DEFAULT_WORKSPACE(ws, entries) ssz_tiny_workspace(&(ws))
+#else
+#define SSZ_DEFAULT_WORKSPACE(ws, entries) \
+  StackEntry ws##_mem[entries];            \
+  ssz_workspace_init(&(ws), ws##_mem, sizeof(ws##_mem))
+#endif
+
+void ssz_hash_parent(const uint8_t left[32], const uint8_t right[32], uint8_t out[32]);
+
+void ssz_mixin_length(uint8_t root[32], uint32_t length);
+
+#ifndef SSZ_TINY
+/* Hash of a type's shape, depth first, for keying saved state to its type */
+void ssz_type_hash(const TypeDesc *td, uint8_t out[32]);
+#endif
+
+/* 8-byte aligned bump allocation; NULL when ws cannot fit size more bytes */
+void *ssz_ws_alloc(ssz_workspace_t *ws, size_t size);
+
+uint32_t ssz_merkle_stack_entries(size_t leaves);
+
+size_t ssz_merkle_stack_bytes(size_t leaves);
+
+/* Allocates a stack for up to `leaves` leaves from ws */
+int ssz_merkle_init(Merkleizer *m, ssz_workspace_t *ws, size_t leaves, char err[128]);
+
+void ssz_merkle_push(Merkleizer *m, const uint8_t chunk[32]);
+
+/* Push the root of a complete subtree of 2^height leaves */
+void ssz_merkle_push_subtree(Merkleizer *m, const uint8_t root[32], uint32_t height);
+
+void ssz_merkle_push_zeros(Merkleizer *m, size_t count);
+
+void ssz_merkle_push_bytes(Merkleizer *m, const uint8_t *bytes, size_t chunks);
+
+void ssz_merkle_finish(Merkleizer *m, uint8_t out[32]);
+
+/* ===== Wire format helpers =====
+ * The one copy of the type-classification rule every path depends on: the
+ * verifier, encoder, views and saved-state formats all include it from here. */
+
+static inline uint32_t ssz_read_le32(const uint8_t *p) {
+  return ((uint32_t)p[0]) | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+/* Little-endian field of n bytes, as used by the checkpoint and tree files */
+static inline void ssz_put_le(uint8_t *p, uint64_t v, int n) {
+  for (int i = 0; i < n; i++) p[i] = (uint8_t)(v >> (8 * i));
+}
+
+static inline uint64_t ssz_get_le(const uint8_t *p, int n) {
+  uint64_t v = 0;
+  for (int i = n - 1; i >= 0; i--) v = (v << 8) | p[i];
+  return v;
+}
+
+/* Values of these types are encoded behind an offset table when nested */
+static inline int ssz_is_variable_size(const TypeDesc *td) {
+  switch (td->kind) {
+    case SSZ_KIND_LIST:
+    case SSZ_KIND_BITLIST:
+      return 1;
+    case SSZ_KIND_CONTAINER:
+    case SSZ_KIND_VECTOR:
+      return td->fixed_size == 0;
+    default:
+      return 0;
+  }
+}
+
+static inline int ssz_has_variable_elements(const TypeDesc *td) {
+  return td->element_type != NULL && ssz_is_variable_size((const TypeDesc *)td->element_type);
+}
+
+/* Bytes per element of a packed sequence; 1 for bitlists and byte lists */
+static inline size_t ssz_element_size(const TypeDesc *td) {
+  const TypeDesc *elem_td = (const TypeDesc *)td->element_type;
+  return elem_td != NULL && elem_td->fixed_size > 0 ? elem_td->fixed_size : 1;
+}
+
+#endif
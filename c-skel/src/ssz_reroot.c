@@ -0,0 +1,751 @@
+#define _GNU_SOURCE
+#include "ssz_reroot.h"
+#include "ssz_kernels.h"
+#include "ssz_merkle.h"
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/* Packed sequences store interior nodes from this level up: a changed chunk
+ * costs rehashing its group of 8, and the tree stays under half the data */
+#define PACKED_BASE_LEVEL 3
+
+#define NO_NODE SIZE_MAX
+
+/* One list, vector or bitlist. Node (level, i) lives at nodes[(cap >> level) + i]
+ * for level >= base and holds a value only while its leaves are all below
+ * count; partial subtrees at the right edge are hashed when the root is taken,
+ * the same fold the carry-stack merkleizer ends with. Variable-size element
+ * lists store level 0 too (the element roots); packed ones read chunks from
+ * the bytes. */
+typedef struct {
+  size_t count;
+  size_t cap;
+  uint32_t base;
+  uint8_t (*nodes)[32];
+  int mapped;                 /* nodes point into a loaded file */
+} Region;
+
+struct ssz_tree {
+  const TypeDesc *td;
+  size_t len;                 /* length of the version described */
+  Region *regions;            /* in field order, depth first */
+  size_t region_count;
+  uint8_t *ws_mem;            /* element roots */
+  ssz_workspace_t ws;
+  uint8_t root[32];
+  int stale;                  /* an update failed half way */
+  void *map;                  /* file mapping behind loaded regions */
+  size_t map_len;
+};
+
+typedef struct {
+  ssz_tree_t *tree;
+  size_t next_region;
+  ssz_reroot_stats_t *stats;
+  char *err;
+  uint64_t sample_seed;       /* loading: spot-check stored nodes */
+} Walk;
+
+/* Dirty paths of one region, flushed bottom up as the diff moves right */
+typedef struct {
+  Walk *w;
+  Region *r;
+  const TypeDesc *td;
+  const uint8_t *bytes;       /* new version */
+  size_t len;
+  size_t data_len;            /* packed bytes that make chunks */
+  uint32_t top;
+  size_t pending[65];
+  int status;
+} Update;
+
+static int is_sequence(const TypeDesc *td) {
+  return td->kind == SSZ_KIND_VECTOR || td->kind == SSZ_KIND_LIST || td->kind == SSZ_KIND_BITLIST;
+}
+
+/* Packed sequences are chunked from their bytes; the rest merkleize element roots */
+static int is_packed(const TypeDesc *td) {
+  if (td->kind == SSZ_KIND_BITLIST || td->element_type == NULL) return 1;
+  const TypeDesc *elem = (const TypeDesc *)td->element_type;
+  switch (elem->kind) {
+    case SSZ_KIND_LIST:
+    case SSZ_KIND_BITLIST:
+      return 0;
+    case SSZ_KIND_CONTAINER:
+    case SSZ_KIND_VECTOR:
+      return elem->fixed_size > 0;
+    default:
+      return 1;
+  }
+}
+
+static size_t count_regions(const TypeDesc *td) {
+  if (is_sequence(td)) return 1;
+  if (td->kind != SSZ_KIND_CONTAINER) return 0;
+  size_t n = 0;
+  for (uint32_t i = 0; i < td->field_count; i++) n += count_regions((const TypeDesc *)td->field_types[i]);
+  return n;
+}
+
+/* ===== Leaves ===== */
+
+/* Bitlists chunk everything before the sentinel byte */
+static size_t packed_data_len(const TypeDesc *td, size_t len) {
+  return td->kind == SSZ_KIND_BITLIST ? len - 1 : len;
+}
+
+static size_t packed_leaf_count(const TypeDesc *td, size_t data_len) {
+  size_t chunks = (data_len + 31) / 32;
+  return td->kind == SSZ_KIND_BITLIST && chunks == 0 ? 1 : chunks;
+}
+
+static size_t var_count(const uint8_t *bytes, size_t len) {
+  return len == 0 ? 0 : ssz_read_le32(bytes) / 4;
+}
+
+static void var_element(const uint8_t *bytes, size_t len, size_t count, size_t i, size_t *start, size_t *elem_len) {
+  size_t stop = i + 1 < count ? ssz_read_le32(bytes + (i + 1) * 4) : len;
+  *start = ssz_read_le32(bytes + i * 4);
+  *elem_len = stop - *start;
+}
+
+static void leaf(Update *u, size_t i, uint8_t out[32]) {
+  u->w->stats->leaves_rehashed++;
+  if (u->r->base > 0) {
+    size_t at = i * 32;
+    size_t n = u->data_len - at < 32 ? u->data_len - at : 32;
+    memset(out, 0, 32);
+    memcpy(out, u->bytes + at, n);
+    return;
+  }
+  size_t start, elem_len;
+  var_element(u->bytes, u->len, u->r->count, i, &start, &elem_len);
+  int result = ssz_stream_root_from_buffer_ws(&u->w->tree->ws, u->bytes + start, elem_len,
+                                              (const TypeDesc *)u->td->element_type, out, u->w->err);
+  if (result != SSZ_ERR_NONE) u->status = result;
+}
+
+/* ===== Nodes ===== */
+
+static int complete(const Region *r, uint32_t level, size_t i) {
+  return ((i + 1) << level) <= r->count;
+}
+
+static void node_value(Update *u, uint32_t level, size_t i, uint8_t out[32]) {
+  if (level >= u->r->base) {
+    memcpy(out, u->r->nodes[(u->r->cap >> level) + i], 32);
+    return;
+  }
+  if (level == 0) {
+    leaf(u, i, out);
+    return;
+  }
+  uint8_t left[32], right[32];
+  node_value(u, level - 1, 2 * i, left);
+  node_value(u, level - 1, 2 * i + 1, right);
+  ssz_hash_parent(left, right, out);
+}
+
+/* Node (level, i) from the level below, ignoring any stored value */
+static void fresh_node(Update *u, uint32_t level, size_t i, uint8_t out[32]) {
+  if (level == 0) {
+    leaf(u, i, out);
+    return;
+  }
+  uint8_t left[32], right[32];
+  node_value(u, level - 1, 2 * i, left);
+  node_value(u, level - 1, 2 * i + 1, right);
+  ssz_hash_parent(left, right, out);
+}
+
+static void recompute(Update *u, uint32_t level, size_t i) {
+  fresh_node(u, level, i, u->r->nodes[(u->r->cap >> level) + i]);
+}
+
+/* Marks node (level, i) dirty. Marks arrive left to right, so a pending node
+ * to the left is final once a later one shows up: it is rehashed and its
+ * parent marked in turn. */
+static void mark(Update *u, uint32_t level, size_t i) {
+  for (;;) {
+    size_t prev = u->pending[level];
+    if (prev == i) return;
+    u->pending[level] = i;
+    if (prev == NO_NODE || !complete(u->r, level, prev)) return;
+    recompute(u, level, prev);
+    if (level == u->top) return;
+    level++;
+    i = prev >> 1;
+  }
+}
+
+static void mark_leaves(Update *u, size_t from, size_t to) {
+  if (to > u->r->count) to = u->r->count;
+  if (from >= to) return;
+  for (size_t g = from >> u->r->base; g <= (to - 1) >> u->r->base; g++) mark(u, u->r->base, g);
+}
+
+static void flush(Update *u) {
+  for (uint32_t level = u->r->base; level <= u->top; level++) {
+    size_t i = u->pending[level];
+    if (i == NO_NODE) continue;
+    u->pending[level] = NO_NODE;
+    if (!complete(u->r, level, i)) continue;
+    recompute(u, level, i);
+    if (level < u->top) mark(u, level + 1, i >> 1);
+  }
+}
+
+/* Perfect subtrees of the binary decomposition of count, folded right to left */
+static void region_root(Update *u, uint8_t out[32]) {
+  size_t count = u->r->count;
+  int have = 0;
+  memset(out, 0, 32);
+  for (uint32_t h = 0; h <= u->top; h++) {
+    if (!(count & ((size_t)1 << h))) continue;
+    uint8_t sub[32];
+    node_value(u, h, (count >> (h + 1)) << 1, sub);
+    if (have) ssz_hash_parent(sub, out, out);
+    else memcpy(out, sub, 32);
+    have = 1;
+  }
+}
+
+/* Every node is marked dirty after a grow, so old contents need not move */
+static int grow(Walk *w, Region *r, size_t count) {
+  size_t cap = (size_t)1 << r->base;
+  while (cap < count) cap <<= 1;
+  void *nodes = r->mapped ? malloc(2 * (cap >> r->base) * 32) : realloc(r->nodes, 2 * (cap >> r->base) * 32);
+  if (nodes == NULL) {
+    if (w->err) snprintf(w->err, 128, "Out of memory for %zu tree nodes", 2 * (cap >> r->base));
+    return SSZ_ERR_WORKSPACE_EXHAUSTED;
+  }
+  r->nodes = (uint8_t (*)[32])nodes;
+  r->cap = cap;
+  r->mapped = 0;
+  return SSZ_ERR_NONE;
+}
+
+/* ===== Diff ===== */
+
+static void diff_packed(Update *u, const uint8_t *old_bytes, size_t old_data) {
+  size_t common = old_data < u->data_len ? old_data : u->data_len;
+  size_t group_bytes = (size_t)32 << u->r->base;
+  size_t pos = 0;
+  while (pos < common) {
+    pos += ssz_first_diff(old_bytes + pos, u->bytes + pos, common - pos);
+    if (pos >= common) break;
+    size_t chunk = pos / 32;
+    mark_leaves(u, chunk, chunk + 1);
+    pos = (pos / group_bytes + 1) * group_bytes;
+  }
+  u->w->stats->bytes_compared += common;
+  /* The chunk straddling the old end and everything after it changed */
+  if (old_data != u->data_len) mark_leaves(u, common / 32, u->r->count);
+}
+
+static void diff_elements(Update *u, const uint8_t *old_bytes, size_t old_len, size_t old_count) {
+  size_t common = old_count < u->r->count ? old_count : u->r->count;
+  for (size_t i = 0; i < common; i++) {
+    size_t old_start, old_elem, new_start, new_elem;
+    var_element(old_bytes, old_len, old_count, i, &old_start, &old_elem);
+    var_element(u->bytes, u->len, u->r->count, i, &new_start, &new_elem);
+    if (old_elem == new_elem) {
+      u->w->stats->bytes_compared += new_elem;
+      if (ssz_first_diff(old_bytes + old_start, u->bytes + new_start, new_elem) == new_elem) continue;
+    }
+    mark_leaves(u, i, i + 1);
+  }
+  mark_leaves(u, common, u->r->count);
+}
+
+/* ===== Spot checks ===== */
+
+#define SAMPLED_PATHS 16
+
+static uint64_t next_sample(uint64_t *state) {
+  uint64_t z = (*state += 0x9e3779b97f4a7c15ull);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+  return z ^ (z >> 31);
+}
+
+/* Recomputes the lowest stored node of a leaf group from the bytes and every
+ * stored node above it from its children. Regions with few groups are
+ * checked in full. */
+static int check_paths(Update *u, uint64_t *seed) {
+  size_t groups = u->r->count >> u->r->base;
+  size_t checks = groups < SAMPLED_PATHS ? groups : SAMPLED_PATHS;
+  for (size_t k = 0; k < checks; k++) {
+    size_t g = groups <= SAMPLED_PATHS ? k : next_sample(seed) % groups;
+    for (uint32_t level = u->r->base; level <= u->top && complete(u->r, level, g); level++, g >>= 1) {
+      uint8_t node[32];
+      fresh_node(u, level, g, node);
+      if (memcmp(node, u->r->nodes[(u->r->cap >> level) + g], 32) != 0) return 0;
+    }
+  }
+  return u->status == SSZ_ERR_NONE;
+}
+
+static int update_region(
+  Walk *w,
+  const TypeDesc *td,
+  const uint8_t *old_bytes,
+  size_t old_len,
+  const uint8_t *bytes,
+  size_t len,
+  uint8_t out_root[32]
+) {
+  Region *r = &w->tree->regions[w->next_region++];
+  int packed = is_packed(td);
+  Update u = {w, r, td, bytes, len, packed ? packed_data_len(td, len) : 0, 0, {0}, SSZ_ERR_NONE};
+  size_t count = packed ? packed_leaf_count(td, u.data_len) : var_count(bytes, len);
+  size_t old_count = r->count;
+
+  if (w->sample_seed != 0) {
+    /* Loading: the region must be the one saved for these bytes */
+    while (((size_t)1 << u.top) < r->cap) u.top++;
+    if (count != r->count || r->base != (packed ? PACKED_BASE_LEVEL : 0u) || !check_paths(&u, &w->sample_seed)) {
+      if (w->err) snprintf(w->err, 128, "Saved tree does not match the bytes (region %zu)", w->next_region - 1);
+      return SSZ_ERR_MALFORMED_HEADER;
+    }
+    old_bytes = bytes;
+    old_len = len;
+  }
+
+  int rebuild = old_bytes == NULL || count > r->cap;
+  if (rebuild) {
+    if (old_bytes != NULL) w->stats->lists_rebuilt++;
+    r->base = packed ? PACKED_BASE_LEVEL : 0;
+    int result = grow(w, r, count);
+    if (result != SSZ_ERR_NONE) return result;
+  }
+  r->count = count;
+  while (((size_t)1 << u.top) < r->cap) u.top++;
+  for (uint32_t i = 0; i <= u.top; i++) u.pending[i] = NO_NODE;
+
+  if (rebuild) {
+    mark_leaves(&u, 0, count);
+  } else if (old_bytes == bytes && old_len == len) {
+    /* Same buffer: nothing to diff */
+  } else if (packed) {
+    diff_packed(&u, old_bytes, packed_data_len(td, old_len));
+  } else {
+    diff_elements(&u, old_bytes, old_len, old_count);
+  }
+  flush(&u);
+  region_root(&u, out_root);
+  if (u.status != SSZ_ERR_NONE) return u.status;
+
+  if (td->kind == SSZ_KIND_BITLIST) {
+    uint32_t bits = (uint32_t)(len - 1) * 8;
+    for (uint8_t last = bytes[len - 1]; last > 1; last >>= 1) bits++;
+    ssz_mixin_length(out_root, bits);
+  } else if (td->kind == SSZ_KIND_LIST) {
+    const TypeDesc *elem = (const TypeDesc *)td->element_type;
+    size_t elem_size = elem != NULL && elem->fixed_size > 0 ? elem->fixed_size : 1;
+    ssz_mixin_length(out_root, (uint32_t)(packed ? len / elem_size : count));
+  }
+  return SSZ_ERR_NONE;
+}
+
+/* ===== Walk ===== */
+
+/* Start and length of field i; old and new versions share the fixed part's layout */
+static void field_range(const TypeDesc *td, const uint8_t *bytes, size_t len, uint32_t index,
+                        size_t *start, size_t *field_len) {
+  size_t offset = 0;
+  size_t var_start = 0;
+  int in_var = 0;
+  for (uint32_t i = 0; i < td->field_count; i++) {
+    const TypeDesc *field_td = (const TypeDesc *)td->field_types[i];
+    if (field_td->fixed_size > 0) {
+      if (i == index) {
+        *start = offset;
+        *field_len = field_td->fixed_size;
+        return;
+      }
+      offset += field_td->fixed_size;
+      continue;
+    }
+    size_t here = ssz_read_le32(bytes + offset);
+    if (in_var) {
+      *field_len = here - var_start;
+      return;
+    }
+    if (i == index) {
+      var_start = here;
+      *start = here;
+      in_var = 1;
+    }
+    offset += 4;
+  }
+  *field_len = len - var_start;
+}
+
+static int walk(
+  Walk *w,
+  const TypeDesc *td,
+  const uint8_t *old_bytes,
+  size_t old_len,
+  const uint8_t *bytes,
+  size_t len,
+  uint8_t out_root[32]
+) {
+  if (is_sequence(td)) return update_region(w, td, old_bytes, old_len, bytes, len, out_root);
+  if (td->kind != SSZ_KIND_CONTAINER) {
+    memset(out_root, 0, 32);
+    memcpy(out_root, bytes, len < 32 ? len : 32);
+    return SSZ_ERR_NONE;
+  }
+
+  /* Field roots go through the merkleizer so the shape matches the buffer path */
+  StackEntry mem[MAX_STACK_DEPTH];
+  ssz_workspace_t ws;
+  ssz_workspace_init(&ws, mem, sizeof(mem));
+  Merkleizer m;
+  int result = ssz_merkle_init(&m, &ws, td->field_count, w->err);
+  if (result != SSZ_ERR_NONE) return result;
+
+  for (uint32_t i = 0; i < td->field_count; i++) {
+    const TypeDesc *field_td = (const TypeDesc *)td->field_types[i];
+    size_t start, field_len, old_start = 0, old_field_len = 0;
+    field_range(td, bytes, len, i, &start, &field_len);
+    if (old_bytes != NULL) field_range(td, old_bytes, old_len, i, &old_start, &old_field_len);
+    uint8_t field_root[32];
+    result = walk(w, field_td, old_bytes ? old_bytes + old_start : NULL, old_field_len,
+                  bytes + start, field_len, field_root);
+    if (result != SSZ_ERR_NONE) return result;
+    ssz_merkle_push(&m, field_root);
+  }
+  ssz_merkle_finish(&m, out_root);
+  return SSZ_ERR_NONE;
+}
+
+/* Element roots run on the buffer path; size its scratch for the new version */
+static int reserve_workspace(ssz_tree_t *tree, const TypeDesc *td, size_t len, char err[128]) {
+  size_t need = ssz_workspace_size(td, len);
+  if (need <= tree->ws.size) return SSZ_ERR_NONE;
+  uint8_t *mem = realloc(tree->ws_mem, need);
+  if (mem == NULL) {
+    if (err) snprintf(err, 128, "Out of memory for a %zu byte workspace", need);
+    return SSZ_ERR_WORKSPACE_EXHAUSTED;
+  }
+  tree->ws_mem = mem;
+  ssz_workspace_init(&tree->ws, mem, need);
+  return SSZ_ERR_NONE;
+}
+
+static int run(ssz_tree_t *tree, const uint8_t *old_bytes, size_t old_len, const uint8_t *bytes, size_t len,
+               uint8_t out_root[32], ssz_reroot_stats_t *stats, char err[128]) {
+  ssz_reroot_stats_t scratch;
+  if (stats == NULL) stats = &scratch;
+  memset(stats, 0, sizeof(*stats));
+
+  int result = ssz_validate(bytes, len, tree->td, err);
+  if (result != SSZ_ERR_NONE) return result;
+  result = reserve_workspace(tree, tree->td, len, err);
+  if (result != SSZ_ERR_NONE) return result;
+
+  Walk w = {tree, 0, stats, err, 0};
+  result = walk(&w, tree->td, old_bytes, old_len, bytes, len, out_root);
+  tree->stale = result != SSZ_ERR_NONE;
+  tree->len = len;
+  memcpy(tree->root, out_root, 32);
+  return result;
+}
+
+int ssz_tree_build(
+  const uint8_t *bytes,
+  size_t len,
+  const TypeDesc *td,
+  ssz_tree_t **out_tree,
+  uint8_t out_root[32],
+  char err[128]
+) {
+  *out_tree = NULL;
+  ssz_tree_t *tree = calloc(1, sizeof(*tree));
+  size_t region_count = count_regions(td);
+  Region *regions = calloc(region_count > 0 ? region_count : 1, sizeof(*regions));
+  if (tree == NULL || regions == NULL) {
+    free(tree);
+    free(regions);
+    if (err) snprintf(err, 128, "Out of memory for tree");
+    return SSZ_ERR_WORKSPACE_EXHAUSTED;
+  }
+  tree->td = td;
+  tree->regions = regions;
+  tree->region_count = region_count;
+
+  int result = run(tree, NULL, 0, bytes, len, out_root, NULL, err);
+  if (result != SSZ_ERR_NONE) {
+    ssz_tree_free(tree);
+    return result;
+  }
+  *out_tree = tree;
+  return SSZ_ERR_NONE;
+}
+
+int ssz_reroot(
+  const uint8_t *old_bytes,
+  size_t old_len,
+  ssz_tree_t *tree,
+  const uint8_t *new_bytes,
+  size_t new_len,
+  const TypeDesc *td,
+  uint8_t out_root[32],
+  ssz_reroot_stats_t *stats,
+  char err[128]
+) {
+  if (td != tree->td) {
+    if (err) snprintf(err, 128, "Tree was built for a different type");
+    return SSZ_ERR_UNSUPPORTED_TYPE;
+  }
+  if (tree->stale || old_len != tree->len) {
+    if (err) snprintf(err, 128, "Tree does not describe the old bytes (%zu bytes, tree has %zu)", old_len, tree->len);
+    return SSZ_ERR_MALFORMED_HEADER;
+  }
+  return run(tree, old_bytes, old_len, new_bytes, new_len, out_root, stats, err);
+}
+
+/* ===== Persistence ===== */
+
+/* File layout, little-endian:
+ *   0   "SSZTREE\0"
+ *   8   u32 format version, u32 reserved
+ *   16  type hash (32)
+ *   48  root (32)
+ *   80  u64 length of the value
+ *   88  u64 region count
+ *   96  per region: u64 count, u64 cap, u32 base, u32 reserved
+ *   then, from the next 64-byte boundary, each region's nodes in order */
+#define TREE_MAGIC "SSZTREE"
+#define TREE_FORMAT 1
+#define TREE_HEADER 96
+#define TREE_REGION 24
+
+static size_t region_node_bytes(const Region *r) {
+  return 2 * (r->cap >> r->base) * 32;
+}
+
+static size_t nodes_offset(size_t region_count) {
+  return (TREE_HEADER + region_count * TREE_REGION + 63) & ~(size_t)63;
+}
+
+static int write_all(int fd, const void *data, size_t len) {
+  const uint8_t *p = (const uint8_t *)data;
+  while (len > 0) {
+    ssize_t n = write(fd, p, len);
+    if (n <= 0) return -1;
+    p += n;
+    len -= (size_t)n;
+  }
+  return 0;
+}
+
+/* Make a completed rename durable: the new directory entry is only on disk once
+ * the directory itself is synced */
+static int sync_parent(const char *path) {
+  char dir[4096];
+  const char *slash = strrchr(path, '/');
+  if (slash == NULL) {
+    strcpy(dir, ".");
+  } else {
+    size_t n = slash == path ? 1 : (size_t)(slash - path);
+    if (n >= sizeof(dir)) return -1;
+    memcpy(dir, path, n);
+    dir[n] = 0;
+  }
+  int fd = open(dir, O_RDONLY | O_DIRECTORY);
+  if (fd < 0) return -1;
+  int rc = fsync(fd);
+  close(fd);
+  return rc;
+}
+
+int ssz_tree_save(const ssz_tree_t *tree, const char *path, char err[128]) {
+  if (tree->stale) {
+    if (err) snprintf(err, 128, "Tree is stale after a failed update");
+    return SSZ_ERR_MALFORMED_HEADER;
+  }
+  size_t head_len = nodes_offset(tree->region_count);
+  uint8_t *head = calloc(1, head_len);
+  char tmp[4096];
+  if (head == NULL || snprintf(tmp, sizeof(tmp), "%s.tmp", path) >= (int)sizeof(tmp)) {
+    free(head);
+    if (err) snprintf(err, 128, "Cannot stage %s", path);
+    return SSZ_ERR_WORKSPACE_EXHAUSTED;
+  }
+  memcpy(head, TREE_MAGIC, 8);
+  ssz_put_le(head + 8, TREE_FORMAT, 4);
+  ssz_type_hash(tree->td, head + 16);
+  memcpy(head + 48, tree->root, 32);
+  ssz_put_le(head + 80, tree->len, 8);
+  ssz_put_le(head + 88, tree->region_count, 8);
+  for (size_t i = 0; i < tree->region_count; i++) {
+    const Region *r = &tree->regions[i];
+    uint8_t *e = head + TREE_HEADER + i * TREE_REGION;
+    ssz_put_le(e, r->count, 8);
+    ssz_put_le(e + 8, r->cap, 8);
+    ssz_put_le(e + 16, r->base, 4);
+  }
+
+  /* Written aside and renamed, so a crash never leaves a torn cache */
+  int fd = open(tmp, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  int failed = fd < 0 || write_all(fd, head, head_len) != 0;
+  for (size_t i = 0; i < tree->region_count && !failed; i++) {
+    failed = write_all(fd, tree->regions[i].nodes, region_node_bytes(&tree->regions[i])) != 0;
+  }
+  if (fd >= 0 && (fsync(fd) != 0 || close(fd) != 0)) failed = 1;
+  free(head);
+  if (failed || rename(tmp, path) != 0) {
+    unlink(tmp);
+    if (err) snprintf(err, 128, "Cannot write %s", path);
+    return SSZ_ERR_UNEXPECTED_EOF;
+  }
+  if (sync_parent(path) != 0) {
+    if (err) snprintf(err, 128, "Cannot sync the directory of %s", path);
+    return SSZ_ERR_UNEXPECTED_EOF;
+  }
+  return SSZ_ERR_NONE;
+}
+
+/* Header and region table against the type and value being restored */
+static int check_header(const uint8_t *map, size_t map_len, const TypeDesc *td, size_t len, size_t region_count,
+                        char err[128]) {
+  uint8_t type_hash[32];
+  if (map_len < TREE_HEADER || memcmp(map, TREE_MAGIC, 8) != 0 || ssz_get_le(map + 8, 4) != TREE_FORMAT) {
+    if (err) snprintf(err, 128, "Not a version %d tree file", TREE_FORMAT);
+    return SSZ_ERR_MALFORMED_HEADER;
+  }
+  ssz_type_hash(td, type_hash);
+  if (memcmp(map + 16, type_hash, 32) != 0) {
+    if (err) snprintf(err, 128, "Tree file was saved for a different type");
+    return SSZ_ERR_UNSUPPORTED_TYPE;
+  }
+  if (ssz_get_le(map + 80, 8) != len || ssz_get_le(map + 88, 8) != region_count) {
+    if (err) snprintf(err, 128, "Tree file was saved for a %llu byte value, not %zu",
+                      (unsigned long long)ssz_get_le(map + 80, 8), len);
+    return SSZ_ERR_MALFORMED_HEADER;
+  }
+  if (map_len < nodes_offset(region_count)) {
+    if (err) snprintf(err, 128, "Tree file truncated");
+    return SSZ_ERR_UNEXPECTED_EOF;
+  }
+  return SSZ_ERR_NONE;
+}
+
+int ssz_tree_load(
+  const char *path,
+  const uint8_t *bytes,
+  size_t len,
+  const TypeDesc *td,
+  ssz_tree_t **out_tree,
+  uint8_t out_root[32],
+  char err[128]
+) {
+  *out_tree = NULL;
+  int fd = open(path, O_RDONLY);
+  struct stat st;
+  if (fd < 0 || fstat(fd, &st) != 0) {
+    if (fd >= 0) close(fd);
+    if (err) snprintf(err, 128, "Cannot open %s", path);
+    return SSZ_ERR_UNEXPECTED_EOF;
+  }
+  size_t map_len = (size_t)st.st_size;
+  /* Private and writable: updates after loading copy pages on first write */
+  void *map = map_len > 0 ? mmap(NULL, map_len, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+  close(fd);
+  if (map == MAP_FAILED) {
+    if (err) snprintf(err, 128, "Cannot map %s", path);
+    return SSZ_ERR_UNEXPECTED_EOF;
+  }
+
+  size_t region_count = count_regions(td);
+  ssz_tree_t *tree = calloc(1, sizeof(*tree));
+  Region *regions = calloc(region_count > 0 ? region_count : 1, sizeof(*regions));
+  if (tree == NULL || regions == NULL) {
+    free(tree);
+    free(regions);
+    munmap(map, map_len);
+    if (err) snprintf(err, 128, "Out of memory for tree");
+    return SSZ_ERR_WORKSPACE_EXHAUSTED;
+  }
+  tree->td = td;
+  tree->regions = regions;
+  tree->region_count = region_count;
+  tree->map = map;
+  tree->map_len = map_len;
+
+  const uint8_t *m = (const uint8_t *)map;
+  int result = check_header(m, map_len, td, len, region_count, err);
+  size_t at = nodes_offset(region_count);
+  for (size_t i = 0; i < region_count && result == SSZ_ERR_NONE; i++) {
+    const uint8_t *e = m + TREE_HEADER + i * TREE_REGION;
+    Region *r = &regions[i];
+    r->count = ssz_get_le(e, 8);
+    r->cap = ssz_get_le(e + 8, 8);
+    r->base = (uint32_t)ssz_get_le(e + 16, 4);
+    if (r->base > PACKED_BASE_LEVEL || r->cap < ((size_t)1 << r->base) || (r->cap & (r->cap - 1)) != 0 ||
+        r->count > r->cap || (r->cap >> r->base) > (map_len - at) / 64) {
+      if (err) snprintf(err, 128, "Tree file region %zu is malformed", i);
+      result = SSZ_ERR_MALFORMED_HEADER;
+      break;
+    }
+    r->nodes = (uint8_t (*)[32])(m + at);
+    r->mapped = 1;
+    at += region_node_bytes(r);
+  }
+
+  /* Rebuilding the root from the stored nodes must give the saved root */
+  if (result == SSZ_ERR_NONE) {
+    ssz_reroot_stats_t stats;
+    memset(&stats, 0, sizeof(stats));
+    result = ssz_validate(bytes, len, td, err);
+    if (result == SSZ_ERR_NONE) result = reserve_workspace(tree, td, len, err);
+    if (result == SSZ_ERR_NONE) {
+      Walk w = {tree, 0, &stats, err, ssz_get_le(m + 48, 8) | 1};
+      result = walk(&w, td, bytes, len, bytes, len, tree->root);
+    }
+    if (result == SSZ_ERR_NONE && memcmp(tree->root, m + 48, 32) != 0) {
+      if (err) snprintf(err, 128, "Tree file root does not match its nodes");
+      result = SSZ_ERR_MALFORMED_HEADER;
+    }
+  }
+  if (result != SSZ_ERR_NONE) {
+    ssz_tree_free(tree);
+    return result;
+  }
+  tree->len = len;
+  memcpy(out_root, tree->root, 32);
+  *out_tree = tree;
+  return SSZ_ERR_NONE;
+}
+
+void ssz_tree_root(const ssz_tree_t *tree, uint8_t out_root[32]) {
+  memcpy(out_root, tree->root, 32);
+}
+
+size_t ssz_tree_bytes(const ssz_tree_t *tree) {
+  size_t total = 0;
+  for (size_t i = 0; i < tree->region_count; i++) {
+    const Region *r = &tree->regions[i];
+    if (r->nodes != NULL) total += 2 * (r->cap >> r->base) * 32;
+  }
+  return total;
+}
+
+void ssz_tree_free(ssz_tree_t *tree) {
+  if (tree == NULL) return;
+  for (size_t i = 0; i < tree->region_count; i++) {
+    if (!tree->regions[i].mapped) free(tree->regions[i].nodes);
+  }
+  if (tree->map != NULL) munmap(tree->map, tree->map_len);
+  free(tree->regions);
+  free(tree->ws_mem);
+  free(tree);
+}
@@ -0,0 +1,637 @@
+#include "ssz_resume.h"
+#include "ssz_kernels.h"
+#include "ssz_merkle.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Byte count of a value when only EOF delimits it */
+#define LEN_UNKNOWN UINT64_MAX
+
+/* One frontier entry per level of a tree over up to 2^64 leaves, plus the
+ * slot push_and_merge uses before merging */
+#define FRONTIER_ENTRIES 65
+
+enum { FRAME_BASIC, FRAME_PACKED, FRAME_BITLIST, FRAME_CONTAINER };
+
+/* One value being hashed. Frames nest like the reader path's recursion:
+ * a container's frame sits below the frame of the field it is reading. */
+typedef struct {
+  const TypeDesc *td;
+  uint8_t kind;
+  uint8_t var_phase;          /* containers: streaming the variable payloads */
+  uint8_t pending_len;
+  uint8_t pending[64];        /* partial chunk, bitlist window, leading basic bytes or offset bytes */
+  uint64_t limit;             /* length of the value, LEN_UNKNOWN until EOF */
+  uint64_t consumed;          /* bytes of the value fed so far */
+  uint32_t field;             /* containers: field being read */
+  uint32_t var_index;         /* containers: offsets read, then payloads hashed */
+  uint32_t var_count;
+  uint64_t fixed_part;
+  uint8_t (*roots)[32];       /* containers: field roots */
+  uint32_t *offsets;          /* containers: variable field offsets */
+  uint32_t depth;
+  StackEntry stack[FRONTIER_ENTRIES];
+} Frame;
+
+struct ssz_stream_ctx {
+  const TypeDesc *td;
+  Frame *frames;              /* outermost first */
+  size_t depth;
+  size_t cap;
+  uint64_t position;
+  int done;                   /* the value is complete; only EOF may follow */
+  uint8_t root[32];
+  int status;
+  char err[128];
+};
+
+extern void sha256_hash(const uint8_t *data, size_t len, uint8_t out[32]);
+
+static int fail(ssz_stream_ctx_t *s, int status, const char *fmt, ...) {
+  va_list ap;
+  va_start(ap, fmt);
+  vsnprintf(s->err, sizeof(s->err), fmt, ap);
+  va_end(ap);
+  s->status = status;
+  return status;
+}
+
+static int report(const ssz_stream_ctx_t *s, char err[128]) {
+  if (s->status != SSZ_ERR_NONE && err) snprintf(err, 128, "%s", s->err);
+  return s->status;
+}
+
+static const TypeDesc *field_type(const TypeDesc *td, uint32_t i) {
+  return (const TypeDesc *)td->field_types[i];
+}
+
+static int bool_elements(const TypeDesc *td) {
+  const TypeDesc *elem_td = (const TypeDesc *)td->element_type;
+  return elem_td != NULL && elem_td->kind == SSZ_KIND_BOOL;
+}
+
+static void frame_push(Frame *f, const uint8_t chunk[32]) {
+  Merkleizer m = { f->stack, f->depth };
+  ssz_merkle_push(&m, chunk);
+  f->depth = m.depth;
+}
+
+static void frame_finish(Frame *f, uint8_t out[32]) {
+  Merkleizer m = { f->stack, f->depth };
+  ssz_merkle_finish(&m, out);
+  f->depth = m.depth;
+}
+
+static void add_consumed(ssz_stream_ctx_t *s, size_t n) {
+  for (size_t i = 0; i < s->depth; i++) s->frames[i].consumed += n;
+  s->position += n;
+}
+
+/* ===== Frames ===== */
+
+static void advance(ssz_stream_ctx_t *s);
+
+/* Same up-front checks as the reader path's stream_root dispatch */
+static int open_frame(ssz_stream_ctx_t *s, const TypeDesc *td, uint64_t limit) {
+  if (s->depth == s->cap) {
+    size_t cap = s->cap ? s->cap * 2 : 4;
+    Frame *frames = realloc(s->frames, cap * sizeof(*frames));
+    if (frames == NULL) return fail(s, SSZ_ERR_WORKSPACE_EXHAUSTED, "Out of memory for stream frames");
+    s->frames = frames;
+    s->cap = cap;
+  }
+  Frame *f = &s->frames[s->depth];
+  memset(f, 0, sizeof(*f));
+  f->td = td;
+  f->limit = limit;
+
+  switch (td->kind) {
+    case SSZ_KIND_BASIC:
+    case SSZ_KIND_BOOL:
+      f->kind = FRAME_BASIC;
+      if (td->fixed_size > 0) f->limit = td->fixed_size;
+      break;
+    case SSZ_KIND_BITLIST:
+      f->kind = FRAME_BITLIST;
+      break;
+    case SSZ_KIND_CONTAINER:
+      f->kind = FRAME_CONTAINER;
+      if (td->field_count == 0) return fail(s, SSZ_ERR_UNSUPPORTED_TYPE, "Container has no fields");
+      for (uint32_t i = 0; i < td->field_count; i++) {
+        const TypeDesc *field_td = field_type(td, i);
+        f->fixed_part += field_td->fixed_size > 0 ? field_td->fixed_size : 4;
+        if (field_td->fixed_size == 0) f->var_count++;
+      }
+      if (limit != LEN_UNKNOWN && limit < f->fixed_part) {
+        return fail(s, SSZ_ERR_NON_CANONICAL, "Container fixed part needs %llu bytes, got %llu",
+                    (unsigned long long)f->fixed_part, (unsigned long long)limit);
+      }
+      if (f->var_count == 0 && limit != LEN_UNKNOWN && limit != f->fixed_part) {
+        return fail(s, SSZ_ERR_NON_CANONICAL, "Container trailing bytes (%llu after fixed part)",
+                    (unsigned long long)(limit - f->fixed_part));
+      }
+      f->roots = calloc(td->field_count, 32);
+      f->offsets = calloc(f->var_count ? f->var_count : 1, 4);
+      if (f->roots == NULL || f->offsets == NULL) {
+        free(f->roots);
+        free(f->offsets);
+        return fail(s, SSZ_ERR_WORKSPACE_EXHAUSTED, "Out of memory for container fields");
+      }
+      break;
+    default:
+      if (td->element_type != NULL && ssz_is_variable_size((const TypeDesc *)td->element_type)) {
+        return fail(s, SSZ_ERR_UNSUPPORTED_TYPE, "Variable-size list elements need the buffer API");
+      }
+      f->kind = FRAME_PACKED;
+      break;
+  }
+  s->depth++;
+  return SSZ_ERR_NONE;
+}
+
+static void enter(ssz_stream_ctx_t *s, const TypeDesc *td, uint64_t limit) {
+  if (open_frame(s, td, limit) != SSZ_ERR_NONE) return;
+  if (s->frames[s->depth - 1].kind == FRAME_CONTAINER) advance(s);
+}
+
+/* Pop the finished innermost value and hand its root to the container
+ * reading it */
+static void deliver(ssz_stream_ctx_t *s, const uint8_t root[32]) {
+  Frame *f = &s->frames[--s->depth];
+  free(f->roots);
+  free(f->offsets);
+  if (s->depth == 0) {
+    memcpy(s->root, root, 32);
+    s->done = 1;
+    return;
+  }
+  Frame *parent = &s->frames[s->depth - 1];
+  memcpy(parent->roots[parent->field], root, 32);
+  parent->field++;
+  if (parent->var_phase) parent->var_index++;
+  advance(s);
+}
+
+/* Move the innermost container to its next field: open the field's frame,
+ * wait for offset bytes, or finish the container */
+static void advance(ssz_stream_ctx_t *s) {
+  Frame *f = &s->frames[s->depth - 1];
+  const TypeDesc *td = f->td;
+  if (!f->var_phase) {
+    if (f->field < td->field_count) {
+      const TypeDesc *field_td = field_type(td, f->field);
+      if (field_td->fixed_size > 0) enter(s, field_td, field_td->fixed_size);
+      return;
+    }
+    if (f->var_count > 0 && f->limit != LEN_UNKNOWN && f->offsets[f->var_count - 1] > f->limit) {
+      fail(s, SSZ_ERR_BAD_OFFSET, "Container field offset invalid");
+      return;
+    }
+    f->var_phase = 1;
+    f->field = 0;
+    f->var_index = 0;
+  }
+
+  /* Payloads follow in offset order; the last one runs to the end of the value */
+  while (f->field < td->field_count && field_type(td, f->field)->fixed_size > 0) f->field++;
+  if (f->field < td->field_count) {
+    uint64_t field_limit;
+    if (f->var_index + 1 < f->var_count) {
+      field_limit = f->offsets[f->var_index + 1] - f->offsets[f->var_index];
+    } else {
+      field_limit = f->limit == LEN_UNKNOWN ? LEN_UNKNOWN : f->limit - f->offsets[f->var_index];
+    }
+    enter(s, field_type(td, f->field), field_limit);
+    return;
+  }
+
+  uint8_t root[32];
+  for (uint32_t i = 0; i < td->field_count; i++) frame_push(f, f->roots[i]);
+  frame_finish(f, root);
+  deliver(s, root);
+}
+
+/* ===== Leaf values ===== */
+
+/* The pending bytes of a packed sequence as one chunk: the reader path's
+ * per-chunk checks, then the push */
+static int packed_chunk(ssz_stream_ctx_t *s, Frame *f) {
+  const TypeDesc *td = f->td;
+  size_t got = f->pending_len;
+  uint64_t base = f->consumed - got;
+  size_t bad = 0;
+  if (bool_elements(td) && ssz_check_bools(f->pending, got, &bad) != SSZ_ERR_NONE) {
+    return fail(s, SSZ_ERR_NON_CANONICAL, "Boolean element %llu not 0 or 1", (unsigned long long)(base + bad));
+  }
+  if (td->kind == SSZ_KIND_LIST && td->max_length > 0 && f->consumed / ssz_element_size(td) > td->max_length) {
+    return fail(s, SSZ_ERR_LENGTH_OVERFLOW, "List exceeds limit of %u elements", td->max_length);
+  }
+  if (got > 0) {
+    uint8_t chunk[32] = {0};
+    memcpy(chunk, f->pending, got);
+    frame_push(f, chunk);
+  }
+  f->pending_len = 0;
+  return SSZ_ERR_NONE;
+}
+
+static int finish_leaf(ssz_stream_ctx_t *s, Frame *f, uint8_t out[32]) {
+  const TypeDesc *td = f->td;
+  switch (f->kind) {
+    case FRAME_BASIC:
+      if (td->kind == SSZ_KIND_BOOL && (f->consumed != 1 || f->pending[0] > 1)) {
+        return fail(s, SSZ_ERR_NON_CANONICAL, "Boolean must be one byte of 0 or 1");
+      }
+      memset(out, 0, 32);
+      memcpy(out, f->pending, f->pending_len < 32 ? f->pending_len : 32);
+      return SSZ_ERR_NONE;
+
+    case FRAME_PACKED: {
+      size_t elem_size = ssz_element_size(td);
+      if (f->consumed % elem_size != 0) {
+        return fail(s, SSZ_ERR_NON_CANONICAL, "Length %llu not a multiple of element size %zu",
+                    (unsigned long long)f->consumed, elem_size);
+      }
+      frame_finish(f, out);
+      if (td->kind == SSZ_KIND_LIST) ssz_mixin_length(out, (uint32_t)(f->consumed / elem_size));
+      return SSZ_ERR_NONE;
+    }
+
+    default: {
+      /* Bitlist: the window holds the last 33 bytes or fewer */
+      if (f->consumed == 0) return fail(s, SSZ_ERR_NON_CANONICAL, "Bitlist cannot be empty");
+      uint8_t last_byte = f->pending[f->pending_len - 1];
+      if (last_byte == 0) return fail(s, SSZ_ERR_NON_CANONICAL, "Bitlist missing padding bit");
+      uint32_t bit_count = (uint32_t)(f->consumed - 1) * 8;
+      for (uint8_t last = last_byte; last > 1; last >>= 1) bit_count++;
+      if (td->max_length > 0 && bit_count > td->max_length) {
+        return fail(s, SSZ_ERR_LENGTH_OVERFLOW, "Bitlist has %u bits, limit %u", bit_count, td->max_length);
+      }
+      uint8_t chunk[32] = {0};
+      memcpy(chunk, f->pending, f->pending_len - 1);
+      if (f->pending_len > 1 || f->consumed == 1) frame_push(f, chunk);
+      frame_finish(f, out);
+      ssz_mixin_length(out, bit_count);
+      return SSZ_ERR_NONE;
+    }
+  }
+}
+
+/* Finish every innermost value whose length has been reached */
+static void settle(ssz_stream_ctx_t *s) {
+  while (s->status == SSZ_ERR_NONE && s->depth > 0) {
+    Frame *f = &s->frames[s->depth - 1];
+    if (f->kind == FRAME_CONTAINER || f->limit == LEN_UNKNOWN || f->consumed < f->limit) return;
+    uint8_t root[32];
+    if (finish_leaf(s, f, root) != SSZ_ERR_NONE) return;
+    deliver(s, root);
+  }
+}
+
+/* ===== Feeding bytes ===== */
+
+static size_t feed_packed(ssz_stream_ctx_t *s, Frame *f, const uint8_t *p, size_t take) {
+  const TypeDesc *td = f->td;
+  if (f->pending_len == 0 && take >= 32) {
+    /* Whole chunks straight from the caller's bytes, stopping short of the
+     * chunk that crosses the list limit so its error matches the reader's */
+    size_t chunks = take / 32;
+    if (td->kind == SSZ_KIND_LIST && td->max_length > 0) {
+      uint64_t bound = ((uint64_t)td->max_length + 1) * ssz_element_size(td) - 1;
+      uint64_t safe = bound > f->consumed ? (bound - f->consumed) / 32 : 0;
+      if (chunks > safe) chunks = (size_t)safe;
+    }
+    if (chunks > 0) {
+      size_t n = chunks * 32, bad = 0;
+      if (bool_elements(td) && ssz_check_bools(p, n, &bad) != SSZ_ERR_NONE) {
+        fail(s, SSZ_ERR_NON_CANONICAL, "Boolean element %llu not 0 or 1",
+             (unsigned long long)(f->consumed + bad));
+        return 0;
+      }
+      Merkleizer m = { f->stack, f->depth };
+      ssz_merkle_push_bytes(&m, p, chunks);
+      f->depth = m.depth;
+      add_consumed(s, n);
+      return n;
+    }
+  }
+
+  uint64_t base = f->consumed - f->pending_len;
+  size_t want = 32;
+  if (f->limit != LEN_UNKNOWN && f->limit - base < 32) want = (size_t)(f->limit - base);
+  size_t n = want - f->pending_len < take ? want - f->pending_len : take;
+  memcpy(f->pending + f->pending_len, p, n);
+  f->pending_len += (uint8_t)n;
+  add_consumed(s, n);
+  if (f->pending_len == want) packed_chunk(s, f);
+  return n;
+}
+
+static size_t feed_bitlist(ssz_stream_ctx_t *s, Frame *f, const uint8_t *p, size_t take) {
+  size_t n = sizeof(f->pending) - f->pending_len < take ? sizeof(f->pending) - f->pending_len : take;
+  memcpy(f->pending + f->pending_len, p, n);
+  f->pending_len += (uint8_t)n;
+  add_consumed(s, n);
+  /* N bits never take more than N / 8 + 1 bytes */
+  if (f->td->max_length > 0 && f->consumed > (uint64_t)f->td->max_length / 8 + 1) {
+    fail(s, SSZ_ERR_LENGTH_OVERFLOW, "Bitlist exceeds limit of %u bits", f->td->max_length);
+    return n;
+  }
+  /* The padding bit lives in the final byte: hold back 33 bytes */
+  while (f->pending_len >= 34) {
+    frame_push(f, f->pending);
+    memmove(f->pending, f->pending + 32, f->pending_len - 32);
+    f->pending_len -= 32;
+  }
+  return n;
+}
+
+static size_t feed_offset(ssz_stream_ctx_t *s, Frame *f, const uint8_t *p, size_t take) {
+  size_t n = 4u - f->pending_len < take ? 4u - f->pending_len : take;
+  memcpy(f->pending + f->pending_len, p, n);
+  f->pending_len += (uint8_t)n;
+  add_consumed(s, n);
+  if (f->pending_len < 4) return n;
+
+  uint32_t field_offset = ssz_read_le32(f->pending);
+  f->pending_len = 0;
+  /* Same rules as the buffer path's bulk check, one offset at a time */
+  if (f->var_index > 0 ? field_offset < f->offsets[f->var_index - 1] : field_offset != f->fixed_part) {
+    fail(s, SSZ_ERR_BAD_OFFSET, "Container field offset invalid");
+    return n;
+  }
+  f->offsets[f->var_index++] = field_offset;
+  f->field++;
+  advance(s);
+  return n;
+}
+
+/* ===== Public API ===== */
+
+int ssz_stream_new(const TypeDesc *td, ssz_stream_ctx_t **out_ctx, char err[128]) {
+  *out_ctx = NULL;
+  ssz_stream_ctx_t *s = calloc(1, sizeof(*s));
+  if (s == NULL) {
+    if (err) snprintf(err, 128, "Out of memory for stream context");
+    return SSZ_ERR_WORKSPACE_EXHAUSTED;
+  }
+  s->td = td;
+  enter(s, td, LEN_UNKNOWN);
+  settle(s);
+  if (s->status != SSZ_ERR_NONE) {
+    int status = report(s, err);
+    ssz_stream_free(s);
+    return status;
+  }
+  *out_ctx = s;
+  return SSZ_ERR_NONE;
+}
+
+int ssz_stream_update(ssz_stream_ctx_t *s, const uint8_t *bytes, size_t len, char err[128]) {
+  while (len > 0 && s->status == SSZ_ERR_NONE) {
+    if (s->done) {
+      fail(s, SSZ_ERR_NON_CANONICAL, "Trailing bytes after value");
+      break;
+    }
+    Frame *f = &s->frames[s->depth - 1];
+    size_t take = len;
+    if (f->limit != LEN_UNKNOWN && f->limit - f->consumed < take) take = (size_t)(f->limit - f->consumed);
+
+    size_t used;
+    switch (f->kind) {
+      case FRAME_BASIC:
+        /* Only the leading 32 bytes form the leaf; the rest is dropped */
+        if (f->pending_len < 32) {
+          size_t keep = 32u - f->pending_len < take ? 32u - f->pending_len : take;
+          memcpy(f->pending + f->pending_len, bytes, keep);
+          f->pending_len += (uint8_t)keep;
+        }
+        add_consumed(s, take);
+        used = take;
+        break;
+      case FRAME_PACKED:
+        used = feed_packed(s, f, bytes, take);
+        break;
+      case FRAME_BITLIST:
+        used = feed_bitlist(s, f, bytes, take);
+        break;
+      default:
+        used = feed_offset(s, f, bytes, take);
+        break;
+    }
+    bytes += used;
+    len -= used;
+    settle(s);
+  }
+  return report(s, err);
+}
+
+int ssz_stream_final(ssz_stream_ctx_t *s, uint8_t out_root[32], char err[128]) {
+  while (s->status == SSZ_ERR_NONE && !s->done) {
+    /* Values delimited only by EOF end here; any other is cut short */
+    Frame *f = &s->frames[s->depth - 1];
+    const char *what = NULL;
+    switch (f->kind) {
+      case FRAME_CONTAINER:
+        what = "container offset table";
+        break;
+      case FRAME_BASIC:
+        if (f->limit != LEN_UNKNOWN) what = "basic value";
+        break;
+      case FRAME_PACKED:
+        if (f->pending_len > 0 && packed_chunk(s, f) != SSZ_ERR_NONE) return report(s, err);
+        if (f->limit != LEN_UNKNOWN) what = "vector";
+        break;
+      default:
+        if (f->limit != LEN_UNKNOWN) what = "bitlist";
+        break;
+    }
+    if (what) {
+      fail(s, SSZ_ERR_UNEXPECTED_EOF, "Reader EOF within %s", what);
+      break;
+    }
+    uint8_t root[32];
+    if (finish_leaf(s, f, root) != SSZ_ERR_NONE) break;
+    deliver(s, root);
+  }
+  if (s->status == SSZ_ERR_NONE) memcpy(out_root, s->root, 32);
+  return report(s, err);
+}
+
+uint64_t ssz_stream_position(const ssz_stream_ctx_t *s) {
+  return s->position;
+}
+
+void ssz_stream_free(ssz_stream_ctx_t *s) {
+  if (s == NULL) return;
+  for (size_t i = 0; i < s->depth; i++) {
+    free(s->frames[i].roots);
+    free(s->frames[i].offsets);
+  }
+  free(s->frames);
+  free(s);
+}
+
+/* ===== Checkpoints ===== */
+
+/* Layout, little-endian:
+ *   0   "SSZCKPT\0"
+ *   8   u32 format version, u32 frame count
+ *   16  type hash (32)
+ *   48  u64 position, u32 done, u32 reserved
+ *   64  root once done (32)
+ *   96  per frame, outermost first:
+ *         u8 kind, u8 var_phase, u8 pending length, u8 frontier entries
+ *         u32 field, u32 var_index, u64 limit, u64 consumed
+ *         pending bytes, then per frontier entry u8 height and hash (32)
+ *         containers: field roots (32 each), then offsets (u32 each)
+ *   then SHA-256 of everything before it
+ * A frame's type is not stored: it follows from the type and the field
+ * each container frame is reading. */
+#define CKPT_MAGIC "SSZCKPT"
+#define CKPT_FORMAT 1
+#define CKPT_HEADER 96
+#define CKPT_FRAME 28
+
+static size_t frame_bytes(const Frame *f) {
+  size_t n = CKPT_FRAME + f->pending_len + (size_t)f->depth * 33;
+  if (f->kind == FRAME_CONTAINER) n += (size_t)f->td->field_count * 32 + (size_t)f->var_count * 4;
+  return n;
+}
+
+size_t ssz_stream_save(const ssz_stream_ctx_t *s, uint8_t *buf, size_t cap) {
+  if (s->status != SSZ_ERR_NONE) return 0;
+  size_t need = CKPT_HEADER + 32;
+  for (size_t i = 0; i < s->depth; i++) need += frame_bytes(&s->frames[i]);
+  if (cap < need) return need;
+
+  memset(buf, 0, CKPT_HEADER);
+  memcpy(buf, CKPT_MAGIC, 8);
+  ssz_put_le(buf + 8, CKPT_FORMAT, 4);
+  ssz_put_le(buf + 12, s->depth, 4);
+  ssz_type_hash(s->td, buf + 16);
+  ssz_put_le(buf + 48, s->position, 8);
+  ssz_put_le(buf + 56, (uint64_t)s->done, 4);
+  if (s->done) memcpy(buf + 64, s->root, 32);
+
+  uint8_t *p = buf + CKPT_HEADER;
+  for (size_t i = 0; i < s->depth; i++) {
+    const Frame *f = &s->frames[i];
+    p[0] = f->kind;
+    p[1] = f->var_phase;
+    p[2] = f->pending_len;
+    p[3] = (uint8_t)f->depth;
+    ssz_put_le(p + 4, f->field, 4);
+    ssz_put_le(p + 8, f->var_index, 4);
+    ssz_put_le(p + 12, f->limit, 8);
+    ssz_put_le(p + 20, f->consumed, 8);
+    p += CKPT_FRAME;
+    memcpy(p, f->pending, f->pending_len);
+    p += f->pending_len;
+    for (uint32_t e = 0; e < f->depth; e++) {
+      *p++ = (uint8_t)f->stack[e].height;
+      memcpy(p, f->stack[e].hash, 32);
+      p += 32;
+    }
+    if (f->kind == FRAME_CONTAINER) {
+      memcpy(p, f->roots, (size_t)f->td->field_count * 32);
+      p += (size_t)f->td->field_count * 32;
+      for (uint32_t k = 0; k < f->var_count; k++, p += 4) ssz_put_le(p, f->offsets[k], 4);
+    }
+  }
+  sha256_hash(buf, need - 32, p);
+  return need;
+}
+
+/* The type of frame i: the root type, or the field its parent is reading */
+static const TypeDesc *frame_type(const ssz_stream_ctx_t *s, const TypeDesc *td) {
+  if (s->depth == 0) return td;
+  const Frame *parent = &s->frames[s->depth - 1];
+  if (parent->kind != FRAME_CONTAINER || parent->field >= parent->td->field_count) return NULL;
+  const TypeDesc *field_td = field_type(parent->td, parent->field);
+  return (field_td->fixed_size == 0) == (parent->var_phase != 0) ? field_td : NULL;
+}
+
+static int restore_frames(ssz_stream_ctx_t *s, const uint8_t *p, const uint8_t *end, uint32_t count) {
+  for (uint32_t i = 0; i < count; i++) {
+    const TypeDesc *td = frame_type(s, s->td);
+    if (td == NULL || end - p < CKPT_FRAME) return -1;
+    if (open_frame(s, td, ssz_get_le(p + 12, 8)) != SSZ_ERR_NONE) return -1;
+    Frame *f = &s->frames[s->depth - 1];
+    if (p[0] != f->kind || p[2] > sizeof(f->pending) || p[3] > FRONTIER_ENTRIES) return -1;
+    f->var_phase = p[1];
+    f->pending_len = p[2];
+    f->depth = p[3];
+    f->field = (uint32_t)ssz_get_le(p + 4, 4);
+    f->var_index = (uint32_t)ssz_get_le(p + 8, 4);
+    f->consumed = ssz_get_le(p + 20, 8);
+    p += CKPT_FRAME;
+    if ((f->limit != LEN_UNKNOWN && f->consumed > f->limit) || f->consumed < f->pending_len) return -1;
+
+    size_t body = f->pending_len + (size_t)f->depth * 33;
+    if (f->kind == FRAME_CONTAINER) {
+      if (f->field > td->field_count || f->var_index > f->var_count) return -1;
+      body += (size_t)td->field_count * 32 + (size_t)f->var_count * 4;
+    }
+    if ((size_t)(end - p) < body) return -1;
+    memcpy(f->pending, p, f->pending_len);
+    p += f->pending_len;
+    for (uint32_t e = 0; e < f->depth; e++) {
+      f->stack[e].height = *p++;
+      memcpy(f->stack[e].hash, p, 32);
+      p += 32;
+    }
+    if (f->kind == FRAME_CONTAINER) {
+      memcpy(f->roots, p, (size_t)td->field_count * 32);
+      p += (size_t)td->field_count * 32;
+      for (uint32_t k = 0; k < f->var_count; k++, p += 4) f->offsets[k] = (uint32_t)ssz_get_le(p, 4);
+    }
+  }
+  return p == end ? 0 : -1;
+}
+
+int ssz_stream_restore(
+  const uint8_t *buf,
+  size_t len,
+  const TypeDesc *td,
+  ssz_stream_ctx_t **out_ctx,
+  char err[128]
+) {
+  *out_ctx = NULL;
+  uint8_t digest[32];
+  if (len < CKPT_HEADER + 32 || memcmp(buf, CKPT_MAGIC, 8) != 0 || ssz_get_le(buf + 8, 4) != CKPT_FORMAT) {
+    if (err) snprintf(err, 128, "Not a version %d stream checkpoint", CKPT_FORMAT);
+    return SSZ_ERR_MALFORMED_HEADER;
+  }
+  sha256_hash(buf, len - 32, digest);
+  if (memcmp(digest, buf + len - 32, 32) != 0) {
+    if (err) snprintf(err, 128, "Stream checkpoint checksum mismatch");
+    return SSZ_ERR_MALFORMED_HEADER;
+  }
+  ssz_type_hash(td, digest);
+  if (memcmp(buf + 16, digest, 32) != 0) {
+    if (err) snprintf(err, 128, "Stream checkpoint was saved for a different type");
+    return SSZ_ERR_UNSUPPORTED_TYPE;
+  }
+
+  ssz_stream_ctx_t *s = calloc(1, sizeof(*s));
+  if (s == NULL) {
+    if (err) snprintf(err, 128, "Out of memory for stream context");
+    return SSZ_ERR_WORKSPACE_EXHAUSTED;
+  }
+  s->td = td;
+  s->position = ssz_get_le(buf + 48, 8);
+  s->done = ssz_get_le(buf + 56, 4) != 0;
+  memcpy(s->root, buf + 64, 32);
+  uint32_t count = (uint32_t)ssz_get_le(buf + 12, 4);
+  if ((s->done ? count != 0 : count == 0) ||
+      restore_frames(s, buf + CKPT_HEADER, buf + len - 32, count) != 0) {
+    ssz_stream_free(s);
+    if (err) snprintf(err, 128, "Stream checkpoint is malformed");
+    return SSZ_ERR_MALFORMED_HEADER;
+  }
+  *out_ctx = s;
+  return SSZ_ERR_NONE;
+}
@@ -0,0 +1,323 @@
+#include "ssz_snappy.h"
+#include "ssz_error.h"
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define CRC32C_X86
+#include <nmmintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_FEATURE_CRC32)
+#define CRC32C_ARM
+#include <arm_acle.h>
+#endif
+
+/* ===== CRC-32C ===== */
+
+static const uint32_t CRC32C_TABLE[256] = {
+  0x00000000, 0xf26b8303, 0xe13b70f7, 0x1350f3f4, 0xc79a971f, 0x35f1141c,
+  0x26a1e7e8, 0xd4ca64eb, 0x8ad958cf, 0x78b2dbcc, 0x6be22838, 0x9989ab3b,
+  0x4d43cfd0, 0xbf284cd3, 0xac78bf27, 0x5e133c24, 0x105ec76f, 0xe235446c,
+  0xf165b798, 0x030e349b, 0xd7c45070, 0x25afd373, 0x36ff2087, 0xc494a384,
+  0x9a879fa0, 0x68ec1ca3, 0x7bbcef57, 0x89d76c54, 0x5d1d08bf, 0xaf768bbc,
+  0xbc267848, 0x4e4dfb4b, 0x20bd8ede, 0xd2d60ddd, 0xc186fe29, 0x33ed7d2a,
+  0xe72719c1, 0x154c9ac2, 0x061c6936, 0xf477ea35, 0xaa64d611, 0x580f5512,
+  0x4b5fa6e6, 0xb93425e5, 0x6dfe410e, 0x9f95c20d, 0x8cc531f9, 0x7eaeb2fa,
+  0x30e349b1, 0xc288cab2, 0xd1d83946, 0x23b3ba45, 0xf779deae, 0x05125dad,
+  0x1642ae59, 0xe4292d5a, 0xba3a117e, 0x4851927d, 0x5b016189, 0xa96ae28a,
+  0x7da08661, 0x8fcb0562, 0x9c9bf696, 0x6ef07595, 0x417b1dbc, 0xb3109ebf,
+  0xa0406d4b, 0x522bee48, 0x86e18aa3, 0x748a09a0, 0x67dafa54, 0x95b17957,
+  0xcba24573, 0x39c9c670, 0x2a993584, 0xd8f2b687, 0x0c38d26c, 0xfe53516f,
+  0xed03a29b, 0x1f682198, 0x5125dad3, 0xa34e59d0, 0xb01eaa24, 0x42752927,
+  0x96bf4dcc, 0x64d4cecf, 0x77843d3b, 0x85efbe38, 0xdbfc821c, 0x2997011f,
+  0x3ac7f2eb, 0xc8ac71e8, 0x1c661503, 0xee0d9600, 0xfd5d65f4, 0x0f36e6f7,
+  0x61c69362, 0x93ad1061, 0x80fde395, 0x72966096, 0xa65c047d, 0x5437877e,
+  0x4767748a, 0xb50cf789, 0xeb1fcbad, 0x197448ae, 0x0a24bb5a, 0xf84f3859,
+  0x2c855cb2, 0xdeeedfb1, 0xcdbe2c45, 0x3fd5af46, 0x7198540d, 0x83f3d70e,
+  0x90a324fa, 0x62c8a7f9, 0xb602c312, 0x44694011, 0x5739b3e5, 0xa55230e6,
+  0xfb410cc2, 0x092a8fc1, 0x1a7a7c35, 0xe811ff36, 0x3cdb9bdd, 0xceb018de,
+  0xdde0eb2a, 0x2f8b6829, 0x82f63b78, 0x709db87b, 0x63cd4b8f, 0x91a6c88c,
+  0x456cac67, 0xb7072f64, 0xa457dc90, 0x563c5f93, 0x082f63b7, 0xfa44e0b4,
+  0xe9141340, 0x1b7f9043, 0xcfb5f4a8, 0x3dde77ab, 0x2e8e845f, 0xdce5075c,
+  0x92a8fc17, 0x60c37f14, 0x73938ce0, 0x81f80fe3, 0x55326b08, 0xa759e80b,
+  0xb4091bff, 0x466298fc, 0x1871a4d8, 0xea1a27db, 0xf94ad42f, 0x0b21572c,
+  0xdfeb33c7, 0x2d80b0c4, 0x3ed04330, 0xccbbc033, 0xa24bb5a6, 0x502036a5,
+  0x4370c551, 0xb11b4652, 0x65d122b9, 0x97baa1ba, 0x84ea524e, 0x7681d14d,
+  0x2892ed69, 0xdaf96e6a, 0xc9a99d9e, 0x3bc21e9d, 0xef087a76, 0x1d63f975,
+  0x0e330a81, 0xfc588982, 0xb21572c9, 0x407ef1ca, 0x532e023e, 0xa145813d,
+  0x758fe5d6, 0x87e466d5, 0x94b49521, 0x66df1622, 0x38cc2a06, 0xcaa7a905,
+  0xd9f75af1, 0x2b9cd9f2, 0xff56bd19, 0x0d3d3e1a, 0x1e6dcdee, 0xec064eed,
+  0xc38d26c4, 0x31e6a5c7, 0x22b65633, 0xd0ddd530, 0x0417b1db, 0xf67c32d8,
+  0xe52cc12c, 0x1747422f, 0x49547e0b, 0xbb3ffd08, 0xa86f0efc, 0x5a048dff,
+  0x8ecee914, 0x7ca56a17, 0x6ff599e3, 0x9d9e1ae0, 0xd3d3e1ab, 0x21b862a8,
+  0x32e8915c, 0xc083125f, 0x144976b4, 0xe622f5b7, 0xf5720643, 0x07198540,
+  0x590ab964, 0xab613a67, 0xb831c993, 0x4a5a4a90, 0x9e902e7b, 0x6cfbad78,
+  0x7fab5e8c, 0x8dc0dd8f, 0xe330a81a, 0x115b2b19, 0x020bd8ed, 0xf0605bee,
+  0x24aa3f05, 0xd6c1bc06, 0xc5914ff2, 0x37faccf1, 0x69e9f0d5, 0x9b8273d6,
+  0x88d28022, 0x7ab90321, 0xae7367ca, 0x5c18e4c9, 0x4f48173d, 0xbd23943e,
+  0xf36e6f75, 0x0105ec76, 0x12551f82, 0xe03e9c81, 0x34f4f86a, 0xc69f7b69,
+  0xd5cf889d, 0x27a40b9e, 0x79b737ba, 0x8bdcb4b9, 0x988c474d, 0x6ae7c44e,
+  0xbe2da0a5, 0x4c4623a6, 0x5f16d052, 0xad7d5351,
+};
+
+static uint32_t crc32c_sw(uint32_t c, const uint8_t *data, size_t len) {
+  for (size_t i = 0; i < len; i++) {
+    c = CRC32C_TABLE[(c ^ data[i]) & 0xff] ^ (c >> 8);
+  }
+  return c;
+}
+
+#ifdef CRC32C_X86
+__attribute__((target("sse4.2")))
+static uint32_t crc32c_hw(uint32_t c, const uint8_t *data, size_t len) {
+  size_t i = 0;
+#if defined(__x86_64__)
+  uint64_t c64 = c;
+  for (; i + 8 <= len; i += 8) {
+    uint64_t word;
+    memcpy(&word, data + i, 8);
+    c64 = _mm_crc32_u64(c64, word);
+  }
+  c = (uint32_t)c64;
+#endif
+  for (; i < len; i++) c = _mm_crc32_u8(c, data[i]);
+  return c;
+}
+#endif
+
+#ifdef CRC32C_ARM
+static uint32_t crc32c_hw(uint32_t c, const uint8_t *data, size_t len) {
+  size_t i = 0;
+  for (; i + 8 <= len; i += 8) {
+    uint64_t word;
+    memcpy(&word, data + i, 8);
+    c = __crc32cd(c, word);
+  }
+  for (; i < len; i++) c = __crc32cb(c, data[i]);
+  return c;
+}
+#endif
+
+uint32_t ssz_crc32c(uint32_t crc, const uint8_t *data, size_t len) {
+  uint32_t c = ~crc;
+#if defined(CRC32C_X86)
+  /* Threads may race to detect the CPU; they all store the same answer */
+  static int has_sse42 = -1;
+  int hw = __atomic_load_n(&has_sse42, __ATOMIC_RELAXED);
+  if (hw < 0) {
+    hw = __builtin_cpu_supports("sse4.2") ? 1 : 0;
+    __atomic_store_n(&has_sse42, hw, __ATOMIC_RELAXED);
+  }
+  c = hw ? crc32c_hw(c, data, len) : crc32c_sw(c, data, len);
+#elif defined(CRC32C_ARM)
+  c = crc32c_hw(c, data, len);
+#else
+  c = crc32c_sw(c, data, len);
+#endif
+  return ~c;
+}
+
+/* ===== Snappy block decompression ===== */
+
+/* Decode one raw snappy block into out; returns decoded length or -1 */
+static long snappy_decompress(const uint8_t *src, size_t src_len, uint8_t *out, size_t out_cap) {
+  size_t ip = 0;
+  uint32_t expected = 0;
+  for (int shift = 0;; shift += 7) {
+    if (ip >= src_len || shift > 28) return -1;
+    uint8_t b = src[ip++];
+    expected |= (uint32_t)(b & 0x7f) << shift;
+    if ((b & 0x80) == 0) break;
+  }
+  if (expected > out_cap) return -1;
+
+  size_t op = 0;
+  while (ip < src_len) {
+    uint8_t tag = src[ip++];
+    size_t len;
+    size_t offset;
+
+    switch (tag & 3) {
+      case 0: /* literal */
+        len = tag >> 2;
+        if (len >= 60) {
+          size_t extra = len - 59;
+          if (src_len - ip < extra) return -1;
+          len = 0;
+          for (size_t k = 0; k < extra; k++) len |= (size_t)src[ip + k] << (8 * k);
+          ip += extra;
+        }
+        len += 1;
+        if (src_len - ip < len || expected - op < len) return -1;
+        memcpy(out + op, src + ip, len);
+        ip += len;
+        op += len;
+        continue;
+      case 1: /* copy, 1-byte offset */
+        if (src_len - ip < 1) return -1;
+        len = 4 + ((tag >> 2) & 7);
+        offset = ((size_t)(tag >> 5) << 8) | src[ip];
+        ip += 1;
+        break;
+      case 2: /* copy, 2-byte offset */
+        if (src_len - ip < 2) return -1;
+        len = (size_t)(tag >> 2) + 1;
+        offset = (size_t)src[ip] | ((size_t)src[ip + 1] << 8);
+        ip += 2;
+        break;
+      default: /* copy, 4-byte offset */
+        if (src_len - ip < 4) return -1;
+        len = (size_t)(tag >> 2) + 1;
+        offset = (size_t)src[ip] | ((size_t)src[ip + 1] << 8) |
+                 ((size_t)src[ip + 2] << 16) | ((size_t)src[ip + 3] << 24);
+        ip += 4;
+        break;
+    }
+
+    if (offset == 0 || offset > op || expected - op < len) return -1;
+    /* Copies may overlap their own output (run-length style) */
+    const uint8_t *from = out + op - offset;
+    if (offset >= len) {
+      memcpy(out + op, from, len);
+    } else {
+      for (size_t k = 0; k < len; k++) out[op + k] = from[k];
+    }
+    op += len;
+  }
+
+  return op == expected ? (long)op : -1;
+}
+
+/* ===== Framing format ===== */
+
+#define CHUNK_COMPRESSED 0x00
+#define CHUNK_UNCOMPRESSED 0x01
+#define CHUNK_PADDING 0xfe
+#define CHUNK_STREAM_ID 0xff
+
+static const uint8_t STREAM_ID[6] = { 's', 'N', 'a', 'P', 'p', 'Y' };
+
+void ssz_snappy_reader_init(ssz_snappy_reader_t *r, ssz_reader_fn upstream, void *upstream_ctx) {
+  r->upstream = upstream;
+  r->upstream_ctx = upstream_ctx;
+  r->out_pos = 0;
+  r->out_len = 0;
+  r->started = 0;
+  r->finished = 0;
+  r->status = SSZ_ERR_NONE;
+  r->msg = "";
+}
+
+static size_t upstream_read(ssz_snappy_reader_t *r, uint8_t *dst, size_t n) {
+  size_t got = 0;
+  while (got < n) {
+    size_t k = r->upstream(dst + got, n - got, r->upstream_ctx);
+    if (k == 0) break;
+    got += k;
+  }
+  return got;
+}
+
+static int fail(ssz_snappy_reader_t *r, int status, const char *msg) {
+  r->finished = 1;
+  r->status = status;
+  r->msg = msg;
+  return 0;
+}
+
+static uint32_t mask_crc(uint32_t crc) {
+  return ((crc >> 15) | (crc << 17)) + 0xa282ead8u;
+}
+
+/* Decode chunks until one yields data; returns 0 at EOF or on error */
+static int next_block(ssz_snappy_reader_t *r) {
+  while (!r->finished) {
+    uint8_t hdr[4];
+    size_t got = upstream_read(r, hdr, 4);
+    if (got == 0) {
+      if (!r->started) return fail(r, SSZ_ERR_UNEXPECTED_EOF, "Snappy stream is empty");
+      r->finished = 1;
+      return 0;
+    }
+    if (got < 4) return fail(r, SSZ_ERR_UNEXPECTED_EOF, "Snappy chunk header truncated");
+
+    uint8_t type = hdr[0];
+    size_t len = (size_t)hdr[1] | ((size_t)hdr[2] << 8) | ((size_t)hdr[3] << 16);
+
+    if (type == CHUNK_STREAM_ID) {
+      if (len != sizeof(STREAM_ID) || upstream_read(r, r->in, len) != len ||
+          memcmp(r->in, STREAM_ID, len) != 0) {
+        return fail(r, SSZ_ERR_MALFORMED_HEADER, "Bad snappy stream identifier");
+      }
+      r->started = 1;
+      continue;
+    }
+    if (!r->started) return fail(r, SSZ_ERR_MALFORMED_HEADER, "Snappy stream identifier missing");
+
+    if (type == CHUNK_COMPRESSED || type == CHUNK_UNCOMPRESSED) {
+      if (len < 4 || len > sizeof(r->in)) return fail(r, SSZ_ERR_LENGTH_OVERFLOW, "Snappy chunk too large");
+      if (upstream_read(r, r->in, len) != len) return fail(r, SSZ_ERR_UNEXPECTED_EOF, "Snappy chunk truncated");
+
+      uint32_t stored = (uint32_t)r->in[0] | ((uint32_t)r->in[1] << 8) |
+                        ((uint32_t)r->in[2] << 16) | ((uint32_t)r->in[3] << 24);
+      long n;
+      if (type == CHUNK_COMPRESSED) {
+        n = snappy_decompress(r->in + 4, len - 4, r->out, sizeof(r->out));
+        if (n < 0) return fail(r, SSZ_ERR_MALFORMED_HEADER, "Corrupt snappy block");
+      } else {
+        n = (long)(len - 4);
+        if ((size_t)n > sizeof(r->out)) return fail(r, SSZ_ERR_LENGTH_OVERFLOW, "Snappy chunk too large");
+        memcpy(r->out, r->in + 4, (size_t)n);
+      }
+      if (mask_crc(ssz_crc32c(0, r->out, (size_t)n)) != stored) {
+        return fail(r, SSZ_ERR_MALFORMED_HEADER, "Snappy chunk CRC mismatch");
+      }
+      r->out_pos = 0;
+      r->out_len = (size_t)n;
+      if (n > 0) return 1;
+      continue;
+    }
+
+    if (type >= 0x02 && type <= 0x7f) {
+      return fail(r, SSZ_ERR_UNSUPPORTED_TYPE, "Reserved unskippable snappy chunk");
+    }
+
+    /* Padding and reserved skippable chunks */
+    while (len > 0) {
+      size_t step = len < sizeof(r->in) ? len : sizeof(r->in);
+      if (upstream_read(r, r->in, step) != step) return fail(r, SSZ_ERR_UNEXPECTED_EOF, "Snappy chunk truncated");
+      len -= step;
+    }
+  }
+  return 0;
+}
+
+size_t ssz_snappy_read(uint8_t *buf, size_t buf_size, void *ctx) {
+  ssz_snappy_reader_t *r = (ssz_snappy_reader_t *)ctx;
+  if (r->out_pos == r->out_len && !next_block(r)) return 0;
+
+  size_t take = r->out_len - r->out_pos;
+  if (take > buf_size) take = buf_size;
+  memcpy(buf, r->out + r->out_pos, take);
+  r->out_pos += take;
+  return take;
+}
+
+int ssz_snappy_reader_status(const ssz_snappy_reader_t *r, char err[128]) {
+  if (r->status != SSZ_ERR_NONE) SSZ_ERROR_MSG(err, "%s", r->msg);
+  return r->status;
+}
+
+int ssz_snappy_root_from_reader(
+  ssz_snappy_reader_t *r,
+  ssz_reader_fn upstream,
+  void *upstream_ctx,
+  const TypeDesc *td,
+  uint8_t out_root[32],
+  char err[128]
+) {
+  ssz_snappy_reader_init(r, upstream, upstream_ctx);
+  int result = ssz_stream_root_from_reader(ssz_snappy_read, r, td, out_root, err);
+
+  /* A decode error looks like EOF to the merkleizer: it takes precedence */
+  if (r->status != SSZ_ERR_NONE) return ssz_snappy_reader_status(r, err);
+  return result;
+}
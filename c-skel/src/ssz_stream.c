@@ -1,233 +1,314 @@
 #include "ssz_stream.h"
+#include "ssz_kernels.h"
+#include "ssz_merkle.h"
+#include "ssz_error.h"
+#include "ssz_trace.h"
 #include <string.h>
-#include <stdio.h>
+#ifndef SSZ_TINY
+#include <stdlib.h>
+#endif
 
+/* Bytes buffered between reader calls on the streaming path */
 #ifdef HOST_TEST
-#define MAX_STACK_DEPTH 64
+#define READ_BUFFER_SIZE 4096
 #else
-#define MAX_STACK_DEPTH 32
+#define READ_BUFFER_SIZE 256
 #endif
 
-extern void sha256_hash(const uint8_t *data, size_t len, uint8_t out[32]);
+/* Default reader workspace: read buffer plus merkle stacks */
+#define READER_WORKSPACE_ENTRIES \
+  ((READ_BUFFER_SIZE + sizeof(StackEntry) - 1) / sizeof(StackEntry) + MAX_STACK_DEPTH * 3)
 
-typedef struct {
-  uint8_t hash[32];
-  uint32_t height;
-} StackEntry;
+#ifdef SSZ_TINY
+_Static_assert(READER_WORKSPACE_ENTRIES <= SSZ_TINY_ARENA_ENTRIES, "tiny arena too small for the reader");
+#endif
+
+/* Byte count of a value being streamed when only EOF delimits it */
+#define LEN_UNKNOWN SIZE_MAX
+
+/* ===== Workspace ===== */
+
+void ssz_workspace_init(ssz_workspace_t *ws, void *mem, size_t size) {
+  ws->base = (uint8_t *)mem;
+  ws->size = size;
+  ws->used = 0;
+  ws->peak = 0;
+}
+
+static size_t workspace_need(const TypeDesc *td, size_t len) {
+  size_t leaves;
+  size_t inner = 0;
+
+  switch (td->kind) {
+    case SSZ_KIND_BASIC:
+    case SSZ_KIND_BOOL:
+      return 0;
+    case SSZ_KIND_BITLIST:
+      leaves = (len > 1) ? (len - 1 + 31) / 32 : 1;
+      break;
+    case SSZ_KIND_CONTAINER: {
+      /* Variable-field offsets, plus the field roots the reader path holds
+       * back until the variable payloads have streamed past */
+      size_t held = (size_t)td->field_count * (4 + 32) + 7u;
+      leaves = td->field_count;
+      inner = held;
+      for (uint32_t i = 0; i < td->field_count; i++) {
+        const TypeDesc *field_td = (const TypeDesc *)td->field_types[i];
+        size_t field_len = field_td->fixed_size > 0 ? field_td->fixed_size : len;
+        size_t need = held + workspace_need(field_td, field_len);
+        if (need > inner) inner = need;
+      }
+      break;
+    }
+    default:
+      if (ssz_has_variable_elements(td)) {
+        leaves = len / 4;
+        inner = workspace_need((const TypeDesc *)td->element_type, len);
+      } else {
+        leaves = (len + 31) / 32;
+      }
+      break;
+  }
 
-static void hash_leaf(const uint8_t chunk[32], uint8_t out[32]) {
-  sha256_hash(chunk, 32, out);
+  return ssz_merkle_stack_bytes(leaves) + inner;
 }
 
-static void hash_parent(const uint8_t left[32], const uint8_t right[32], uint8_t out[32]) {
-  uint8_t combined[64];
-  memcpy(combined, left, 32);
-  memcpy(combined + 32, right, 32);
-  sha256_hash(combined, 64, out);
+size_t ssz_workspace_size(const TypeDesc *td, size_t max_len) {
+  return workspace_need(td, max_len);
 }
 
-static void push_and_merge(StackEntry *stack, uint32_t *depth, StackEntry entry) {
-  stack[*depth] = entry;
-  (*depth)++;
-  while (*depth >= 2) {
-    StackEntry *top = &stack[*depth - 1];
-    StackEntry *below = &stack[*depth - 2];
-    if (below->height != top->height) break;
-    uint8_t parent[32];
-    hash_parent(below->hash, top->hash, parent);
-    (*depth) -= 2;
-    StackEntry merged = { .height = below->height + 1 };
-    memcpy(merged.hash, parent, 32);
-    stack[*depth] = merged;
-    (*depth)++;
+/* ===== Root computation ===== */
+
+/* One walk serves both entry points: with out_root NULL every root_* function
+ * runs its full set of checks and returns before any merkleization, which is
+ * what ssz_validate uses. Hashing can therefore never accept a value that
+ * validation rejects, or the other way round. */
+
+static int root_from_buffer(
+  ssz_workspace_t *ws,
+  const uint8_t *bytes,
+  size_t len,
+  const TypeDesc *td,
+  uint8_t out_root[32],
+  char err[128]
+);
+
+static int root_basic(const uint8_t *bytes, size_t len, const TypeDesc *td, uint8_t out_root[32], char err[128]) {
+  /* Basic types (uintN, bool) - validate fixed size and return padded chunk */
+  if (td->fixed_size > 0) {
+    if (len != td->fixed_size) {
+      SSZ_ERROR_MSG(err, "Basic type length mismatch: expected %u, got %zu", td->fixed_size, len);
+      return SSZ_ERR_NON_CANONICAL;
+    }
+  }
+  if (td->kind == SSZ_KIND_BOOL && (len != 1 || bytes[0] > 1)) {
+    SSZ_ERROR_MSG(err, "Boolean must be one byte of 0 or 1");
+    return SSZ_ERR_NON_CANONICAL;
   }
+  if (out_root == NULL) return SSZ_ERR_NONE;
+  /* SSZ Basic types: the serialized bytes ARE the merkle leaf (zero-padded to 32 bytes) */
+  uint8_t chunk[32] = {0};
+  size_t copy_len = (len < 32) ? len : 32;
+  memcpy(chunk, bytes, copy_len);
+  memcpy(out_root, chunk, 32);
+  return SSZ_ERR_NONE;
 }
 
-static void mixin_length(uint8_t root[32], uint32_t length) {
-  uint8_t len_buf[32] = {0};
-  len_buf[0] = length & 0xff;
-  len_buf[1] = (length >> 8) & 0xff;
-  len_buf[2] = (length >> 16) & 0xff;
-  len_buf[3] = (length >> 24) & 0xff;
-  uint8_t new_root[32];
-  hash_parent(root, len_buf, new_root);
-  memcpy(root, new_root, 32);
+/* Padding bit present and bit count within the limit */
+static int check_bitlist(const uint8_t *bytes, size_t len, const TypeDesc *td, uint32_t *out_bits, char err[128]) {
+  if (len == 0) {
+    SSZ_ERROR_MSG(err, "Bitlist cannot be empty");
+    return SSZ_ERR_NON_CANONICAL;
+  }
+
+  /* Last byte must have exactly one padding bit (the highest set bit) */
+  uint8_t last_byte = bytes[len - 1];
+  if (last_byte == 0) {
+    SSZ_ERROR_MSG(err, "Bitlist missing padding bit");
+    return SSZ_ERR_NON_CANONICAL;
+  }
+
+  /* Count actual bits (excluding padding bit) */
+  uint32_t bit_count = (len - 1) * 8;
+  uint8_t last = last_byte;
+  while (last > 1) {
+    last >>= 1;
+    bit_count++;
+  }
+  if (td->max_length > 0 && bit_count > td->max_length) {
+    SSZ_ERROR_MSG(err, "Bitlist has %u bits, limit %u", bit_count, td->max_length);
+    return SSZ_ERR_LENGTH_OVERFLOW;
+  }
+  *out_bits = bit_count;
+  return SSZ_ERR_NONE;
 }
 
-int ssz_stream_root_from_buffer(
+static int root_bitlist(
+  ssz_workspace_t *ws,
   const uint8_t *bytes,
   size_t len,
   const TypeDesc *td,
   uint8_t out_root[32],
   char err[128]
 ) {
-  if (td->kind == SSZ_KIND_BASIC) {
-    /* Basic types (uintN, bool) - validate fixed size and return padded chunk */
-    if (td->fixed_size > 0) {
-      if (len != td->fixed_size) {
-        if (err) snprintf(err, 128, "Basic type length mismatch: expected %u, got %zu", td->fixed_size, len);
-        return SSZ_ERR_NON_CANONICAL;
-      }
-    }
-    /* SSZ Basic types: the serialized bytes ARE the merkle leaf (zero-padded to 32 bytes) */
+  /* Bitlist: validate padding bit, chunk bits, merkleize with length */
+  uint32_t bit_count;
+  int result = check_bitlist(bytes, len, td, &bit_count, err);
+  if (result != SSZ_ERR_NONE || out_root == NULL) return result;
+
+  /* Chunk the bit data (without padding byte) */
+  size_t chunk_len = len - 1;
+  Merkleizer m;
+  result = ssz_merkle_init(&m, ws, chunk_len > 0 ? (chunk_len + 31) / 32 : 1, err);
+  if (result != SSZ_ERR_NONE) return result;
+
+  ssz_merkle_push_bytes(&m, bytes, chunk_len / 32);
+  if (chunk_len % 32) {
     uint8_t chunk[32] = {0};
-    size_t copy_len = (len < 32) ? len : 32;
-    memcpy(chunk, bytes, copy_len);
-    memcpy(out_root, chunk, 32);
-    return SSZ_ERR_NONE;
+    memcpy(chunk, bytes + chunk_len - chunk_len % 32, chunk_len % 32);
+    ssz_merkle_push(&m, chunk);
   }
 
-  if (td->kind == SSZ_KIND_BITLIST) {
-    /* Bitlist: validate padding bit, chunk bits, merkleize with length */
-    if (len == 0) {
-      if (err) snprintf(err, 128, "Bitlist cannot be empty");
-      return SSZ_ERR_NON_CANONICAL;
+  /* Handle empty bitlist (only padding) */
+  if (chunk_len == 0) {
+    uint8_t zero_chunk[32] = {0};
+    ssz_merkle_push(&m, zero_chunk);
+  }
+
+  ssz_merkle_finish(&m, out_root);
+  ssz_mixin_length(out_root, bit_count);
+  return SSZ_ERR_NONE;
+}
+
+/* Fixed part present and variable-field offsets sound. The offsets are
+ * gathered into a table from ws for the bulk check and left there. */
+static int check_container(
+  ssz_workspace_t *ws,
+  const uint8_t *bytes,
+  size_t len,
+  const TypeDesc *td,
+  uint8_t **out_offsets,
+  uint32_t *out_var_count,
+  char err[128]
+) {
+  if (td->field_count == 0) {
+    SSZ_ERROR_MSG(err, "Container has no fields");
+    return SSZ_ERR_UNSUPPORTED_TYPE;
+  }
+
+  /* Fixed part: fixed-size fields inline, a 4-byte offset per variable one */
+  size_t fixed_part = 0;
+  uint32_t var_count = 0;
+  for (uint32_t i = 0; i < td->field_count; i++) {
+    const TypeDesc *field_td = (const TypeDesc *)td->field_types[i];
+    if (field_td->fixed_size > 0) {
+      fixed_part += field_td->fixed_size;
+    } else {
+      fixed_part += 4;
+      var_count++;
     }
-    
-    /* Last byte must have exactly one padding bit (the highest set bit) */
-    uint8_t last_byte = bytes[len - 1];
-    if (last_byte == 0) {
-      if (err) snprintf(err, 128, "Bitlist missing padding bit");
-      return SSZ_ERR_NON_CANONICAL;
+  }
+  if (len < fixed_part) {
+    SSZ_ERROR_MSG(err, "Container fixed part needs %zu bytes, got %zu", fixed_part, len);
+    return SSZ_ERR_NON_CANONICAL;
+  }
+  if (var_count == 0 && len != fixed_part) {
+    SSZ_ERROR_MSG(err, "Container trailing bytes (%zu after fixed part)", len - fixed_part);
+    return SSZ_ERR_NON_CANONICAL;
+  }
+
+  /* Variable-field offsets are gathered into one table for the bulk check */
+  uint8_t *offsets = NULL;
+  if (var_count > 0) {
+    SSZ_TRACE_BEGIN("offsets");
+    offsets = (uint8_t *)ssz_ws_alloc(ws, (size_t)var_count * 4);
+    if (offsets == NULL) {
+      SSZ_TRACE_END("offsets");
+      SSZ_ERROR_MSG(err, "Workspace exhausted (%zu of %zu bytes used)", ws->used, ws->size);
+      return SSZ_ERR_WORKSPACE_EXHAUSTED;
     }
-    
-    /* Count actual bits (excluding padding bit) */
-    uint32_t bit_count = (len - 1) * 8;
-    uint8_t last = last_byte;
-    while (last > 1) {
-      last >>= 1;
-      bit_count++;
-    }
-    
-    /* Chunk the bit data (without padding byte) */
-    StackEntry stack[MAX_STACK_DEPTH];
-    uint32_t depth = 0;
-    size_t chunk_len = len - 1; /* Exclude padding byte */
-    
-    for (size_t offset = 0; offset < chunk_len; offset += 32) {
-      uint8_t chunk[32] = {0};
-      size_t copy = (chunk_len - offset < 32) ? chunk_len - offset : 32;
-      memcpy(chunk, bytes + offset, copy);
-      
-      StackEntry entry = { .height = 0 };
-      memcpy(entry.hash, chunk, 32);
-      push_and_merge(stack, &depth, entry);
-    }
-    
-    /* Handle empty bitlist (only padding) */
-    if (chunk_len == 0) {
-      uint8_t zero_chunk[32] = {0};
-      StackEntry entry = { .height = 0 };
-      memcpy(entry.hash, zero_chunk, 32);
-      push_and_merge(stack, &depth, entry);
-    }
-    
-    /* Finalize merkleization */
-    while (depth > 1) {
-      StackEntry top = stack[depth - 1];
-      StackEntry below = stack[depth - 2];
-      uint8_t parent[32];
-      hash_parent(below.hash, top.hash, parent);
-      depth -= 2;
-      StackEntry merged = { .height = below.height + 1 };
-      memcpy(merged.hash, parent, 32);
-      stack[depth] = merged;
-      depth++;
-    }
-    
-    memcpy(out_root, stack[0].hash, 32);
-    mixin_length(out_root, bit_count);
-    return SSZ_ERR_NONE;
-  }
-
-  if (td->kind == SSZ_KIND_CONTAINER) {
-    /* Container: merkleize field roots */
-    if (td->field_count == 0) {
-      if (err) snprintf(err, 128, "Container has no fields");
-      return SSZ_ERR_UNSUPPORTED_TYPE;
-    }
-    
-    StackEntry stack[MAX_STACK_DEPTH];
-    uint32_t depth = 0;
     size_t offset = 0;
-    
-    /* Parse fixed-size fields first */
+    uint32_t var_index = 0;
     for (uint32_t i = 0; i < td->field_count; i++) {
       const TypeDesc *field_td = (const TypeDesc *)td->field_types[i];
-      
       if (field_td->fixed_size > 0) {
-        /* Fixed-size field */
-        if (offset + field_td->fixed_size > len) {
-          if (err) snprintf(err, 128, "Container field %u exceeds buffer", i);
-          return SSZ_ERR_NON_CANONICAL;
-        }
-        
-        uint8_t field_root[32];
-        int result = ssz_stream_root_from_buffer(
-          bytes + offset, field_td->fixed_size, field_td, field_root, err
-        );
-        if (result != SSZ_ERR_NONE) return result;
-        
-        StackEntry entry = { .height = 0 };
-        memcpy(entry.hash, field_root, 32);
-        push_and_merge(stack, &depth, entry);
-        
         offset += field_td->fixed_size;
       } else {
-        /* Variable-size field - read offset from header */
-        if (offset + 4 > len) {
-          if (err) snprintf(err, 128, "Container offset table truncated");
-          return SSZ_ERR_NON_CANONICAL;
-        }
-        
-        /* Fix: ensure safe cast to unsigned - prevent sign extension */
-        uint32_t field_offset = ((uint32_t)bytes[offset]) | 
-                               ((uint32_t)bytes[offset+1] << 8) | 
-                               ((uint32_t)bytes[offset+2] << 16) | 
-                               ((uint32_t)bytes[offset+3] << 24);
+        memcpy(offsets + (size_t)var_index * 4, bytes + offset, 4);
+        var_index++;
         offset += 4;
-        
-        /* Validate offset points into data region */
-        if (field_offset < offset || field_offset > len) {
-          if (err) snprintf(err, 128, "Container field offset invalid");
-          return SSZ_ERR_NON_CANONICAL;
-        }
-        
-        /* For now, simplified: process variable fields later */
-        /* Full implementation requires tracking all offsets */
       }
     }
-    
-    /* Finalize merkleization */
-    while (depth > 1) {
-      StackEntry top = stack[depth - 1];
-      StackEntry below = stack[depth - 2];
-      uint8_t parent[32];
-      hash_parent(below.hash, top.hash, parent);
-      depth -= 2;
-      StackEntry merged = { .height = below.height + 1 };
-      memcpy(merged.hash, parent, 32);
-      stack[depth] = merged;
-      depth++;
-    }
-    
-    if (depth == 0) {
-      memset(out_root, 0, 32);
+
+    /* First offset ends the fixed part, the rest are monotonic and in bounds */
+    size_t bad = 0;
+    uint32_t end = len > UINT32_MAX ? UINT32_MAX : (uint32_t)len;
+    int bad_offsets = fixed_part > UINT32_MAX ||
+        ssz_check_offsets(offsets, var_count, (uint32_t)fixed_part, end, 0, &bad) != SSZ_ERR_NONE;
+    SSZ_TRACE_END("offsets");
+    if (bad_offsets) {
+      SSZ_ERROR_MSG(err, "Container field offset invalid (variable field %zu)", bad);
+      return SSZ_ERR_BAD_OFFSET;
+    }
+  }
+  *out_offsets = offsets;
+  *out_var_count = var_count;
+  return SSZ_ERR_NONE;
+}
+
+static int root_container(
+  ssz_workspace_t *ws,
+  const uint8_t *bytes,
+  size_t len,
+  const TypeDesc *td,
+  uint8_t out_root[32],
+  char err[128]
+) {
+  /* Container: merkleize field roots */
+  uint8_t *offsets;
+  uint32_t var_count;
+  int result = check_container(ws, bytes, len, td, &offsets, &var_count, err);
+  if (result != SSZ_ERR_NONE) return result;
+
+  Merkleizer m;
+  if (out_root != NULL) {
+    result = ssz_merkle_init(&m, ws, td->field_count, err);
+    if (result != SSZ_ERR_NONE) return result;
+  }
+
+  /* Fields in declaration order; variable ones span to the next offset */
+  size_t offset = 0;
+  uint32_t var_index = 0;
+  for (uint32_t i = 0; i < td->field_count; i++) {
+    const TypeDesc *field_td = (const TypeDesc *)td->field_types[i];
+    size_t start = offset;
+    size_t field_len = field_td->fixed_size;
+    if (field_td->fixed_size > 0) {
+      offset += field_td->fixed_size;
     } else {
-      memcpy(out_root, stack[0].hash, 32);
+      start = ssz_read_le32(offsets + (size_t)var_index * 4);
+      size_t stop = var_index + 1 < var_count ? ssz_read_le32(offsets + (size_t)(var_index + 1) * 4) : len;
+      field_len = stop - start;
+      var_index++;
+      offset += 4;
     }
-    
-    return SSZ_ERR_NONE;
+
+    uint8_t field_root[32];
+    result = root_from_buffer(ws, bytes + start, field_len, field_td, out_root ? field_root : NULL, err);
+    if (result != SSZ_ERR_NONE) return result;
+    if (out_root != NULL) ssz_merkle_push(&m, field_root);
   }
 
-  /* For composite types (Vector/List/Container), chunk and merkleize */
-  StackEntry stack[MAX_STACK_DEPTH];
-  uint32_t depth = 0;
-  
+  if (out_root != NULL) ssz_merkle_finish(&m, out_root);
+  return SSZ_ERR_NONE;
+}
+
+/* Whole elements within the list limit; bool bytes are left to the caller */
+static int check_packed(size_t len, const TypeDesc *td, size_t *out_count, char err[128]) {
   /* Calculate element count and chunk size based on type */
   size_t elem_size = 1; /* Default: byte elements */
   size_t elem_count = len;
-  
+
   if (td->element_type != NULL) {
     const TypeDesc *elem_td = (const TypeDesc *)td->element_type;
     if (elem_td->fixed_size > 0) {
@@ -235,54 +316,1073 @@ int ssz_stream_root_from_buffer(
       elem_count = len / elem_size;
     }
   }
-  
-  /* Chunk data: pack elements into 32-byte chunks */
-  size_t offset = 0;
-  size_t chunk_count = 0;
-  
-  while (offset < len) {
+
+  if (len % elem_size != 0) {
+    SSZ_ERROR_MSG(err, "Length %zu not a multiple of element size %zu", len, elem_size);
+    return SSZ_ERR_NON_CANONICAL;
+  }
+  if (td->kind == SSZ_KIND_LIST && td->max_length > 0 && elem_count > td->max_length) {
+    SSZ_ERROR_MSG(err, "List has %zu elements, limit %u", elem_count, td->max_length);
+    return SSZ_ERR_LENGTH_OVERFLOW;
+  }
+  *out_count = elem_count;
+  return SSZ_ERR_NONE;
+}
+
+static int has_bool_elements(const TypeDesc *td) {
+  return td->element_type != NULL && ((const TypeDesc *)td->element_type)->kind == SSZ_KIND_BOOL;
+}
+
+static int root_packed(
+  ssz_workspace_t *ws,
+  const uint8_t *bytes,
+  size_t len,
+  const TypeDesc *td,
+  uint8_t out_root[32],
+  char err[128]
+) {
+  size_t elem_count;
+  int result = check_packed(len, td, &elem_count, err);
+  if (result != SSZ_ERR_NONE) return result;
+  if (has_bool_elements(td)) {
+    size_t bad = 0;
+    if (ssz_check_bools(bytes, len, &bad) != SSZ_ERR_NONE) {
+      SSZ_ERROR_MSG(err, "Boolean element %zu not 0 or 1", bad);
+      return SSZ_ERR_NON_CANONICAL;
+    }
+  }
+  if (out_root == NULL) return SSZ_ERR_NONE;
+
+  Merkleizer m;
+  result = ssz_merkle_init(&m, ws, (len + 31) / 32, err);
+  if (result != SSZ_ERR_NONE) return result;
+
+  /* Chunk data: pack elements into 32-byte chunks; chunks ARE the leaves */
+  SSZ_TRACE_BEGIN("leaves");
+  ssz_merkle_push_bytes(&m, bytes, len / 32);
+  if (len % 32) {
     uint8_t chunk[32] = {0};
-    size_t remain = len - offset;
-    size_t copy = (remain < 32) ? remain : 32;
-    memcpy(chunk, bytes + offset, copy);
-    
-    /* SSZ spec: for composite types, chunks ARE the leaf hashes (no additional hashing) */
-    StackEntry entry = { .height = 0 };
-    memcpy(entry.hash, chunk, 32);
-    push_and_merge(stack, &depth, entry);
-    
-    offset += 32;
-    chunk_count++;
-  }
-  
-  /* Finalize merkleization */
-  if (depth == 0) {
-    /* Empty data: root is zero hash */
-    memset(out_root, 0, 32);
-  } else {
-    /* Collapse remaining stack entries */
-    while (depth > 1) {
-      StackEntry top = stack[depth - 1];
-      StackEntry below = stack[depth - 2];
-      uint8_t parent[32];
-      hash_parent(below.hash, top.hash, parent);
-      depth -= 2;
-      StackEntry merged = { .height = below.height + 1 };
-      memcpy(merged.hash, parent, 32);
-      stack[depth] = merged;
-      depth++;
-    }
-    memcpy(out_root, stack[0].hash, 32);
-  }
-  
+    memcpy(chunk, bytes + len - len % 32, len % 32);
+    ssz_merkle_push(&m, chunk);
+  }
+  SSZ_TRACE_END("leaves");
+
+  ssz_merkle_finish(&m, out_root);
+
   /* Mix in length for List types (element count, not chunk count) */
   if (td->kind == SSZ_KIND_LIST) {
-    mixin_length(out_root, (uint32_t)elem_count);
+    ssz_mixin_length(out_root, (uint32_t)elem_count);
+  }
+
+  return SSZ_ERR_NONE;
+}
+
+/* List/Vector of variable-size elements: offset table, then element payloads */
+static int check_var_list(const uint8_t *bytes, size_t len, const TypeDesc *td, size_t *out_count, char err[128]) {
+  const TypeDesc *elem_td = (const TypeDesc *)td->element_type;
+  size_t count = 0;
+
+  if (len > 0) {
+    if (len < 4 || len > UINT32_MAX) {
+      SSZ_ERROR_MSG(err, "List offset table truncated or oversized");
+      return SSZ_ERR_BAD_OFFSET;
+    }
+    uint32_t first = ssz_read_le32(bytes);
+    if (first == 0 || first % 4 != 0 || first > len) {
+      SSZ_ERROR_MSG(err, "List first offset %u invalid", first);
+      return SSZ_ERR_BAD_OFFSET;
+    }
+    count = first / 4;
+    if (td->kind == SSZ_KIND_LIST && td->max_length > 0 && count > td->max_length) {
+      SSZ_ERROR_MSG(err, "List has %zu elements, limit %u", count, td->max_length);
+      return SSZ_ERR_LENGTH_OVERFLOW;
+    }
+
+    /* Bitlists are never empty, so their offsets must strictly increase */
+    int bitlists = elem_td->kind == SSZ_KIND_BITLIST;
+    size_t bad = 0;
+    SSZ_TRACE_BEGIN("offsets");
+    int offsets_ok = ssz_check_offsets(bytes, count, first, (uint32_t)len, bitlists, &bad) == SSZ_ERR_NONE;
+    SSZ_TRACE_END("offsets");
+    if (!offsets_ok) {
+      SSZ_ERROR_MSG(err, "List element %zu offset invalid", bad);
+      return SSZ_ERR_BAD_OFFSET;
+    }
+    if (bitlists && ssz_check_bitlist_sentinels(bytes, bytes, count, (uint32_t)len, &bad) != SSZ_ERR_NONE) {
+      SSZ_ERROR_MSG(err, "Bitlist missing padding bit (element %zu)", bad);
+      return SSZ_ERR_NON_CANONICAL;
+    }
+  }
+  *out_count = count;
+  return SSZ_ERR_NONE;
+}
+
+static int root_var_list(
+  ssz_workspace_t *ws,
+  const uint8_t *bytes,
+  size_t len,
+  const TypeDesc *td,
+  uint8_t out_root[32],
+  char err[128]
+) {
+  const TypeDesc *elem_td = (const TypeDesc *)td->element_type;
+  size_t count;
+  int result = check_var_list(bytes, len, td, &count, err);
+  if (result != SSZ_ERR_NONE) return result;
+
+  Merkleizer m;
+  if (out_root != NULL) {
+    result = ssz_merkle_init(&m, ws, count, err);
+    if (result != SSZ_ERR_NONE) return result;
+  }
+
+  for (size_t i = 0; i < count; i++) {
+    uint32_t start = ssz_read_le32(bytes + i * 4);
+    uint32_t end = i + 1 < count ? ssz_read_le32(bytes + (i + 1) * 4) : (uint32_t)len;
+    uint8_t elem_root[32];
+    result = root_from_buffer(ws, bytes + start, end - start, elem_td, out_root ? elem_root : NULL, err);
+    if (result != SSZ_ERR_NONE) return result;
+    if (out_root != NULL) ssz_merkle_push(&m, elem_root);
+  }
+
+  if (out_root == NULL) return SSZ_ERR_NONE;
+  ssz_merkle_finish(&m, out_root);
+  if (td->kind == SSZ_KIND_LIST) {
+    ssz_mixin_length(out_root, (uint32_t)count);
+  }
+  return SSZ_ERR_NONE;
+}
+
+static int root_from_buffer(
+  ssz_workspace_t *ws,
+  const uint8_t *bytes,
+  size_t len,
+  const TypeDesc *td,
+  uint8_t out_root[32],
+  char err[128]
+) {
+  /* Scratch taken by this level is released when it returns */
+  size_t mark = ws->used;
+  int result;
+
+  switch (td->kind) {
+    case SSZ_KIND_BASIC:
+    case SSZ_KIND_BOOL:
+      result = root_basic(bytes, len, td, out_root, err);
+      break;
+    case SSZ_KIND_BITLIST:
+      SSZ_TRACE_BEGIN("bitlist");
+      result = root_bitlist(ws, bytes, len, td, out_root, err);
+      SSZ_TRACE_END("bitlist");
+      break;
+    case SSZ_KIND_CONTAINER:
+      SSZ_TRACE_BEGIN("container");
+      result = root_container(ws, bytes, len, td, out_root, err);
+      SSZ_TRACE_END("container");
+      break;
+    default:
+      /* For composite types (Vector/List), chunk and merkleize */
+      if (ssz_has_variable_elements(td)) {
+        SSZ_TRACE_BEGIN("variable list");
+        result = root_var_list(ws, bytes, len, td, out_root, err);
+        SSZ_TRACE_END("variable list");
+      } else {
+        SSZ_TRACE_BEGIN("packed");
+        result = root_packed(ws, bytes, len, td, out_root, err);
+        SSZ_TRACE_END("packed");
+      }
+      break;
+  }
+
+  ws->used = mark;
+  return result;
+}
+
+int ssz_stream_root_from_buffer_ws(
+  ssz_workspace_t *ws,
+  const uint8_t *bytes,
+  size_t len,
+  const TypeDesc *td,
+  uint8_t out_root[32],
+  char err[128]
+) {
+  ws->used = 0;
+  SSZ_TRACE_BEGIN("root");
+  int result = root_from_buffer(ws, bytes, len, td, out_root, err);
+  SSZ_TRACE_END("root");
+  return result;
+}
+
+/* Buffer walk with scratch the caller did not provide. Hosted builds size it
+ * with ssz_workspace_size, so nesting depth and field count are bounded by
+ * memory only (small values stay on the stack); SSZ_TINY keeps its fixed
+ * arena. out_root NULL validates. */
+static int root_with_default_workspace(
+  const uint8_t *bytes,
+  size_t len,
+  const TypeDesc *td,
+  uint8_t out_root[32],
+  char err[128]
+) {
+  ssz_workspace_t ws;
+#ifdef SSZ_TINY
+  SSZ_DEFAULT_WORKSPACE(ws, MAX_STACK_DEPTH * 2);
+  return root_from_buffer(&ws, bytes, len, td, out_root, err);
+#else
+  StackEntry local[MAX_STACK_DEPTH * 2];
+  size_t need = ssz_workspace_size(td, len);
+  void *heap = NULL;
+  if (need > sizeof(local)) {
+    heap = malloc(need);
+    if (heap == NULL) {
+      SSZ_ERROR_MSG(err, "Out of memory for a %zu byte workspace", need);
+      return SSZ_ERR_WORKSPACE_EXHAUSTED;
+    }
+    ssz_workspace_init(&ws, heap, need);
+  } else {
+    ssz_workspace_init(&ws, local, sizeof(local));
+  }
+  int result = root_from_buffer(&ws, bytes, len, td, out_root, err);
+  free(heap);
+  return result;
+#endif
+}
+
+int ssz_stream_root_from_buffer(
+  const uint8_t *bytes,
+  size_t len,
+  const TypeDesc *td,
+  uint8_t out_root[32],
+  char err[128]
+) {
+  SSZ_TRACE_BEGIN("root");
+  int result = root_with_default_workspace(bytes, len, td, out_root, err);
+  SSZ_TRACE_END("root");
+  return result;
+}
+
+int ssz_validate(const uint8_t *bytes, size_t len, const TypeDesc *td, char err[128]) {
+  /* Same scratch as ssz_stream_root_from_buffer, so neither can run out where
+   * the other does not */
+  SSZ_TRACE_BEGIN("validate");
+  int result = root_with_default_workspace(bytes, len, td, NULL, err);
+  SSZ_TRACE_END("validate");
+  return result;
+}
+
+/* ===== Element roots in lanes ===== */
+
+#ifndef SSZ_TINY
+/* A fixed-size container's root is the same tree of loads and parent hashes
+ * for every element, so it compiles once to a straight-line program over
+ * slots. A slot holds one 32-byte node for SSZ_LANES elements, transposed
+ * into big-endian words as ssz_hash_lanes takes them; slots above a value's
+ * own act as its carry stack, exactly as in the Merkleizer. */
+#define LANE_SLOTS 24
+#define LANE_OPS 256
+
+enum { LANE_LOAD, LANE_HASH, LANE_BOOLS };
+
+typedef struct {
+  uint8_t op;
+  uint8_t slot;               /* LANE_HASH: slot = H(slot, slot + 1) */
+  uint32_t offset;            /* LANE_LOAD / LANE_BOOLS: bytes in the element */
+  uint32_t len;
+} LaneOp;
+
+typedef struct {
+  LaneOp ops[LANE_OPS];
+  uint32_t count;
+} LaneProgram;
+
+static int lane_emit(LaneProgram *p, uint8_t op, uint32_t slot, uint32_t offset, uint32_t len) {
+  if (p->count == LANE_OPS || slot + 1 >= LANE_SLOTS) return 0;
+  LaneOp *o = &p->ops[p->count++];
+  o->op = op;
+  o->slot = (uint8_t)slot;
+  o->offset = offset;
+  o->len = len;
+  return 1;
+}
+
+/* Ops leaving the root of the td value at `offset` in slot `base`, following
+ * root_from_buffer. Returns 0 for anything without a fixed shape, for layouts
+ * the buffer path would reject, and when the program outgrows its limits. */
+static int lane_compile(LaneProgram *p, const TypeDesc *td, uint32_t offset, uint32_t base) {
+  uint32_t leaves;
+  const TypeDesc *elem_td = (const TypeDesc *)td->element_type;
+
+  switch (td->kind) {
+    case SSZ_KIND_BASIC:
+    case SSZ_KIND_BOOL:
+      if (td->fixed_size == 0 || (td->kind == SSZ_KIND_BOOL && td->fixed_size != 1)) return 0;
+      if (td->kind == SSZ_KIND_BOOL && !lane_emit(p, LANE_BOOLS, base, offset, 1)) return 0;
+      return lane_emit(p, LANE_LOAD, base, offset, td->fixed_size < 32 ? td->fixed_size : 32);
+    case SSZ_KIND_VECTOR:
+      if (td->fixed_size == 0 || ssz_has_variable_elements(td)) return 0;
+      if (elem_td != NULL && elem_td->fixed_size > 0 && td->fixed_size % elem_td->fixed_size != 0) return 0;
+      if (has_bool_elements(td) && !lane_emit(p, LANE_BOOLS, base, offset, td->fixed_size)) return 0;
+      leaves = (td->fixed_size + 31) / 32;
+      break;
+    case SSZ_KIND_CONTAINER: {
+      uint32_t size = 0;
+      if (td->fixed_size == 0 || td->field_count == 0) return 0;
+      for (uint32_t i = 0; i < td->field_count; i++) {
+        uint32_t field_size = ((const TypeDesc *)td->field_types[i])->fixed_size;
+        if (field_size == 0 || field_size > td->fixed_size - size) return 0;
+        size += field_size;
+      }
+      if (size != td->fixed_size) return 0;
+      leaves = td->field_count;
+      break;
+    }
+    default:
+      return 0;
+  }
+
+  /* Merkleize the leaves: merge equal heights as they arrive, fold the rest */
+  uint32_t heights[LANE_SLOTS];
+  uint32_t depth = 0;
+  uint32_t at = offset;
+  for (uint32_t i = 0; i < leaves; i++) {
+    if (base + depth >= LANE_SLOTS) return 0;
+    if (td->kind == SSZ_KIND_CONTAINER) {
+      const TypeDesc *field_td = (const TypeDesc *)td->field_types[i];
+      if (!lane_compile(p, field_td, at, base + depth)) return 0;
+      at += field_td->fixed_size;
+    } else {
+      uint32_t n = offset + td->fixed_size - at;
+      if (!lane_emit(p, LANE_LOAD, base + depth, at, n < 32 ? n : 32)) return 0;
+      at += 32;
+    }
+    heights[depth++] = 0;
+    while (depth >= 2 && heights[depth - 1] == heights[depth - 2]) {
+      if (!lane_emit(p, LANE_HASH, base + depth - 2, 0, 0)) return 0;
+      heights[depth - 2]++;
+      depth--;
+    }
+  }
+  for (; depth > 1; depth--) {
+    if (!lane_emit(p, LANE_HASH, base + depth - 2, 0, 0)) return 0;
+  }
+  return 1;
+}
+
+/* Runs the program for elements [first, first + n), n <= SSZ_LANES. Spare
+ * lanes repeat the last element so every load stays inside bytes. */
+static int lane_run(
+  const LaneProgram *p,
+  const uint8_t *bytes,
+  size_t size,
+  size_t first,
+  size_t n,
+  uint8_t (*out_roots)[32],
+  char err[128]
+) {
+  uint32_t slots[LANE_SLOTS][8][SSZ_LANES];
+  const uint8_t *elems[SSZ_LANES];
+  for (size_t l = 0; l < SSZ_LANES; l++) elems[l] = bytes + (first + (l < n ? l : n - 1)) * size;
+
+  for (uint32_t k = 0; k < p->count; k++) {
+    const LaneOp *o = &p->ops[k];
+    if (o->op == LANE_HASH) {
+      ssz_hash_lanes(slots[o->slot], (const uint32_t (*)[SSZ_LANES])slots[o->slot],
+                     (const uint32_t (*)[SSZ_LANES])slots[o->slot + 1]);
+    } else if (o->op == LANE_LOAD) {
+      for (size_t l = 0; l < SSZ_LANES; l++) {
+        uint8_t chunk[32] = {0};
+        memcpy(chunk, elems[l] + o->offset, o->len);
+        for (int w = 0; w < 8; w++) {
+          const uint8_t *b = chunk + w * 4;
+          slots[o->slot][w][l] = ((uint32_t)b[0] << 24) | ((uint32_t)b[1] << 16) | ((uint32_t)b[2] << 8) | b[3];
+        }
+      }
+    } else {
+      for (size_t l = 0; l < n; l++) {
+        size_t bad = 0;
+        if (ssz_check_bools(elems[l] + o->offset, o->len, &bad) != SSZ_ERR_NONE) {
+          SSZ_ERROR_MSG(err, "Element %zu boolean byte %zu not 0 or 1", first + l, o->offset + bad);
+          return SSZ_ERR_NON_CANONICAL;
+        }
+      }
+    }
+  }
+
+  for (size_t l = 0; l < n; l++) {
+    for (int w = 0; w < 8; w++) {
+      uint32_t v = slots[0][w][l];
+      out_roots[first + l][w * 4] = (uint8_t)(v >> 24);
+      out_roots[first + l][w * 4 + 1] = (uint8_t)(v >> 16);
+      out_roots[first + l][w * 4 + 2] = (uint8_t)(v >> 8);
+      out_roots[first + l][w * 4 + 3] = (uint8_t)v;
+    }
+  }
+  return SSZ_ERR_NONE;
+}
+#endif
+
+int ssz_container_roots(
+  const uint8_t *bytes,
+  size_t count,
+  const TypeDesc *td,
+  uint8_t (*out_roots)[32],
+  char err[128]
+) {
+  if (td->kind != SSZ_KIND_CONTAINER || td->fixed_size == 0) {
+    SSZ_ERROR_MSG(err, "Element roots need a fixed-size container type");
+    return SSZ_ERR_UNSUPPORTED_TYPE;
+  }
+  size_t size = td->fixed_size;
+  SSZ_TRACE_BEGIN("element roots");
+
+#ifndef SSZ_TINY
+  LaneProgram program;
+  program.count = 0;
+  if (count > 0 && lane_compile(&program, td, 0, 0)) {
+    int result = SSZ_ERR_NONE;
+    for (size_t first = 0; first < count && result == SSZ_ERR_NONE; first += SSZ_LANES) {
+      size_t n = count - first < SSZ_LANES ? count - first : SSZ_LANES;
+      result = lane_run(&program, bytes, size, first, n, out_roots, err);
+    }
+    SSZ_TRACE_END("element roots");
+    return result;
+  }
+#endif
+
+  /* No lane program: one element at a time through the buffer path */
+  ssz_workspace_t ws;
+  SSZ_DEFAULT_WORKSPACE(ws, MAX_STACK_DEPTH * 2);
+  for (size_t i = 0; i < count; i++) {
+    ws.used = 0;
+    int result = root_from_buffer(&ws, bytes + i * size, size, td, out_roots[i], err);
+    if (result != SSZ_ERR_NONE) {
+      SSZ_TRACE_END("element roots");
+      return result;
+    }
+  }
+  SSZ_TRACE_END("element roots");
+  return SSZ_ERR_NONE;
+}
+
+/* ===== Cooperative stepping ===== */
+
+/* What a frame feeds its merkleizer from */
+enum { STEP_CHUNKS, STEP_FIELDS, STEP_ELEMENTS };
+
+/* One composite value being hashed. Frames nest like the root_* calls above,
+ * run the same check_* functions and take their scratch from the workspace
+ * in the same order, so stepping yields the same roots and errors as the
+ * buffer path. */
+typedef struct {
+  const TypeDesc *td;
+  const uint8_t *bytes;
+  size_t len;
+  size_t mark;              /* workspace use before this frame */
+  Merkleizer m;
+  int source;
+  int bools;                /* chunk bytes are bools, checked as they go */
+  int mixin;
+  uint32_t length;          /* mixed in when mixin is set */
+  size_t data_len;          /* STEP_CHUNKS: bytes to chunk */
+  size_t next;              /* next chunk, field or element */
+  size_t count;             /* STEP_FIELDS / STEP_ELEMENTS: children */
+  const uint8_t *offsets;   /* variable-field table, or the list's header */
+  uint32_t var_count;
+  uint32_t var_index;
+  size_t fixed_offset;      /* STEP_FIELDS: where field `next` starts */
+} StepFrame;
+
+/* Frames open at once for the deepest value of type td */
+static uint32_t step_depth(const TypeDesc *td) {
+  uint32_t deepest = 0;
+  switch (td->kind) {
+    case SSZ_KIND_BASIC:
+    case SSZ_KIND_BOOL:
+      return 0;
+    case SSZ_KIND_CONTAINER:
+      for (uint32_t i = 0; i < td->field_count; i++) {
+        uint32_t d = step_depth((const TypeDesc *)td->field_types[i]);
+        if (d > deepest) deepest = d;
+      }
+      return 1 + deepest;
+    case SSZ_KIND_BITLIST:
+      return 1;
+    default:
+      return ssz_has_variable_elements(td) ? 1 + step_depth((const TypeDesc *)td->element_type) : 1;
+  }
+}
+
+size_t ssz_ctx_workspace_size(const TypeDesc *td, size_t max_len) {
+  return (size_t)step_depth(td) * sizeof(StepFrame) + 8 + ssz_workspace_size(td, max_len);
+}
+
+int ssz_ctx_init(
+  ssz_ctx_t *ctx,
+  ssz_workspace_t *ws,
+  const uint8_t *bytes,
+  size_t len,
+  const TypeDesc *td,
+  char err[128]
+) {
+  memset(ctx, 0, sizeof(*ctx));
+  ctx->ws = ws;
+  ctx->bytes = bytes;
+  ctx->len = len;
+  ctx->td = td;
+  ctx->status = SSZ_IN_PROGRESS;
+  ws->used = 0;
+  uint32_t depth = step_depth(td);
+  if (depth > 0) {
+    ctx->frames = ssz_ws_alloc(ws, (size_t)depth * sizeof(StepFrame));
+    if (ctx->frames == NULL) {
+      SSZ_ERROR_MSG(err, "Workspace exhausted (%zu of %zu bytes used)", ws->used, ws->size);
+      return SSZ_ERR_WORKSPACE_EXHAUSTED;
+    }
+  }
+  return SSZ_ERR_NONE;
+}
+
+/* Check a composite value and push its frame, as root_from_buffer would
+ * before hashing it */
+static int step_open(ssz_ctx_t *ctx, const uint8_t *bytes, size_t len, const TypeDesc *td, char err[128]) {
+  ssz_workspace_t *ws = ctx->ws;
+  StepFrame *f = (StepFrame *)ctx->frames + ctx->depth;
+  memset(f, 0, sizeof(*f));
+  f->td = td;
+  f->bytes = bytes;
+  f->len = len;
+  f->mark = ws->used;
+
+  int result;
+  size_t leaves;
+  if (td->kind == SSZ_KIND_BITLIST) {
+    uint32_t bit_count;
+    result = check_bitlist(bytes, len, td, &bit_count, err);
+    if (result != SSZ_ERR_NONE) return result;
+    f->source = STEP_CHUNKS;
+    f->data_len = len - 1;
+    f->mixin = 1;
+    f->length = bit_count;
+    leaves = f->data_len > 0 ? (f->data_len + 31) / 32 : 1;
+  } else if (td->kind == SSZ_KIND_CONTAINER) {
+    uint8_t *offsets;
+    result = check_container(ws, bytes, len, td, &offsets, &f->var_count, err);
+    if (result != SSZ_ERR_NONE) return result;
+    f->source = STEP_FIELDS;
+    f->offsets = offsets;
+    f->count = td->field_count;
+    leaves = td->field_count;
+  } else if (ssz_has_variable_elements(td)) {
+    result = check_var_list(bytes, len, td, &f->count, err);
+    if (result != SSZ_ERR_NONE) return result;
+    f->source = STEP_ELEMENTS;
+    f->offsets = bytes;
+    f->mixin = td->kind == SSZ_KIND_LIST;
+    f->length = (uint32_t)f->count;
+    leaves = f->count;
+  } else {
+    size_t elem_count;
+    result = check_packed(len, td, &elem_count, err);
+    if (result != SSZ_ERR_NONE) return result;
+    f->source = STEP_CHUNKS;
+    f->data_len = len;
+    f->bools = has_bool_elements(td);
+    f->mixin = td->kind == SSZ_KIND_LIST;
+    f->length = (uint32_t)elem_count;
+    leaves = (len + 31) / 32;
+  }
+
+  result = ssz_merkle_init(&f->m, ws, leaves, err);
+  if (result != SSZ_ERR_NONE) return result;
+  ctx->depth++;
+  return SSZ_ERR_NONE;
+}
+
+/* Bool bytes [start, start + n) of the top frame's data */
+static int step_check_bools(const StepFrame *f, size_t start, size_t n, char err[128]) {
+  size_t bad = 0;
+  if (!f->bools || ssz_check_bools(f->bytes + start, n, &bad) == SSZ_ERR_NONE) return SSZ_ERR_NONE;
+  SSZ_ERROR_MSG(err, "Boolean element %zu not 0 or 1", start + bad);
+  return SSZ_ERR_NON_CANONICAL;
+}
+
+/* Finish the top frame and hand its root to the one below, or end the walk */
+static void step_close(ssz_ctx_t *ctx) {
+  StepFrame *f = (StepFrame *)ctx->frames + ctx->depth - 1;
+  uint8_t root[32];
+  ssz_merkle_finish(&f->m, root);
+  if (f->mixin) ssz_mixin_length(root, f->length);
+  ctx->ws->used = f->mark;
+  ctx->depth--;
+  if (ctx->depth == 0) {
+    memcpy(ctx->root, root, 32);
+    ctx->status = SSZ_ERR_NONE;
+  } else {
+    ssz_merkle_push(&(f - 1)->m, root);
+  }
+}
+
+/* Bytes of the top frame's next field or element; advances the frame */
+static const TypeDesc *step_child(StepFrame *f, const uint8_t **out_bytes, size_t *out_len) {
+  size_t i = f->next++;
+  if (f->source == STEP_ELEMENTS) {
+    uint32_t start = ssz_read_le32(f->offsets + i * 4);
+    uint32_t end = i + 1 < f->count ? ssz_read_le32(f->offsets + (i + 1) * 4) : (uint32_t)f->len;
+    *out_bytes = f->bytes + start;
+    *out_len = end - start;
+    return (const TypeDesc *)f->td->element_type;
+  }
+
+  const TypeDesc *field_td = (const TypeDesc *)f->td->field_types[i];
+  size_t start = f->fixed_offset;
+  size_t field_len = field_td->fixed_size;
+  if (field_td->fixed_size > 0) {
+    f->fixed_offset += field_td->fixed_size;
+  } else {
+    uint32_t v = f->var_index++;
+    start = ssz_read_le32(f->offsets + (size_t)v * 4);
+    size_t stop = v + 1 < f->var_count ? ssz_read_le32(f->offsets + (size_t)(v + 1) * 4) : f->len;
+    field_len = stop - start;
+    f->fixed_offset += 4;
+  }
+  *out_bytes = f->bytes + start;
+  *out_len = field_len;
+  return field_td;
+}
+
+static int step_run(ssz_ctx_t *ctx, uint64_t max_chunks, char err[128]) {
+  uint64_t spent = 0;
+  int result;
+
+  if (ctx->frames == NULL) {
+    /* A basic value is its own root */
+    return root_basic(ctx->bytes, ctx->len, ctx->td, ctx->root, err);
+  }
+  if (ctx->depth == 0) {
+    result = step_open(ctx, ctx->bytes, ctx->len, ctx->td, err);
+    if (result != SSZ_ERR_NONE) return result;
+  }
+
+  while (ctx->depth > 0) {
+    if (max_chunks > 0 && spent >= max_chunks) return SSZ_IN_PROGRESS;
+    StepFrame *f = (StepFrame *)ctx->frames + ctx->depth - 1;
+
+    if (f->source == STEP_CHUNKS) {
+      size_t whole = f->data_len / 32;
+      if (f->next < whole) {
+        size_t n = whole - f->next;
+        if (max_chunks > 0 && n > max_chunks - spent) n = (size_t)(max_chunks - spent);
+        result = step_check_bools(f, f->next * 32, n * 32, err);
+        if (result != SSZ_ERR_NONE) return result;
+        ssz_merkle_push_bytes(&f->m, f->bytes + f->next * 32, n);
+        f->next += n;
+        spent += n;
+        continue;
+      }
+      /* Zero-padded tail; a bitlist of only its padding bit is one zero chunk */
+      size_t tail = f->data_len % 32;
+      if (tail > 0 || (f->td->kind == SSZ_KIND_BITLIST && f->data_len == 0)) {
+        result = step_check_bools(f, f->data_len - tail, tail, err);
+        if (result != SSZ_ERR_NONE) return result;
+        uint8_t chunk[32] = {0};
+        memcpy(chunk, f->bytes + f->data_len - tail, tail);
+        ssz_merkle_push(&f->m, chunk);
+        spent++;
+      }
+      step_close(ctx);
+      continue;
+    }
+
+    if (f->next == f->count) {
+      step_close(ctx);
+      continue;
+    }
+    const uint8_t *child;
+    size_t child_len;
+    const TypeDesc *child_td = step_child(f, &child, &child_len);
+    spent++;
+    if (child_td->kind == SSZ_KIND_BASIC || child_td->kind == SSZ_KIND_BOOL) {
+      uint8_t chunk[32];
+      result = root_basic(child, child_len, child_td, chunk, err);
+      if (result != SSZ_ERR_NONE) return result;
+      ssz_merkle_push(&f->m, chunk);
+    } else {
+      result = step_open(ctx, child, child_len, child_td, err);
+      if (result != SSZ_ERR_NONE) return result;
+    }
+  }
+  return SSZ_ERR_NONE;
+}
+
+int ssz_ctx_step(ssz_ctx_t *ctx, uint64_t max_chunks, uint8_t out_root[32], char err[128]) {
+  if (ctx->status == SSZ_IN_PROGRESS) {
+    SSZ_TRACE_BEGIN("step");
+    ctx->status = step_run(ctx, max_chunks, ctx->err);
+    SSZ_TRACE_END("step");
+  }
+  if (ctx->status == SSZ_ERR_NONE) {
+    memcpy(out_root, ctx->root, 32);
+  } else if (ctx->status != SSZ_IN_PROGRESS) {
+#ifndef SSZ_TINY
+    if (err) memcpy(err, ctx->err, 128);
+#else
+    (void)err;
+#endif
+  }
+  return ctx->status;
+}
+
+/* ===== Streaming (reader-based) root computation ===== */
+
+typedef struct {
+  ssz_reader_fn reader;
+  void *ctx;
+  uint8_t *buf;
+  size_t pos;
+  size_t avail;
+  int eof;
+} ReadStream;
+
+/* Copy up to n bytes; returns fewer only when the reader hits EOF */
+static size_t rs_read(ReadStream *rs, uint8_t *dst, size_t n) {
+  size_t done = 0;
+  while (done < n) {
+    if (rs->pos == rs->avail) {
+      if (rs->eof) break;
+      rs->pos = 0;
+      rs->avail = rs->reader(rs->buf, READ_BUFFER_SIZE, rs->ctx);
+      if (rs->avail == 0) {
+        rs->eof = 1;
+        break;
+      }
+    }
+    size_t take = rs->avail - rs->pos;
+    if (take > n - done) take = n - done;
+    if (dst) memcpy(dst + done, rs->buf + rs->pos, take);
+    rs->pos += take;
+    done += take;
+  }
+  return done;
+}
+
+static int stream_eof_error(char err[128], const char *what) {
+  (void)what;
+  SSZ_ERROR_MSG(err, "Reader EOF within %s", what);
+  return SSZ_ERR_UNEXPECTED_EOF;
+}
+
+static int stream_root(
+  ReadStream *rs,
+  ssz_workspace_t *ws,
+  const TypeDesc *td,
+  size_t limit,
+  uint8_t out_root[32],
+  char err[128]
+);
+
+static int stream_basic(ReadStream *rs, const TypeDesc *td, size_t limit, uint8_t out_root[32], char err[128]) {
+  /* Only the leading 32 bytes form the leaf; the rest is consumed and dropped */
+  size_t want = td->fixed_size > 0 ? td->fixed_size : limit;
+  uint8_t chunk[32] = {0};
+  size_t got = rs_read(rs, chunk, want < 32 ? want : 32);
+  if (want > 32) got += rs_read(rs, NULL, want - 32);
+  if (td->fixed_size > 0 && got != td->fixed_size) return stream_eof_error(err, "basic value");
+  if (td->kind == SSZ_KIND_BOOL && (got != 1 || chunk[0] > 1)) {
+    SSZ_ERROR_MSG(err, "Boolean must be one byte of 0 or 1");
+    return SSZ_ERR_NON_CANONICAL;
+  }
+  memcpy(out_root, chunk, 32);
+  return SSZ_ERR_NONE;
+}
+
+static int stream_packed(
+  ReadStream *rs,
+  ssz_workspace_t *ws,
+  const TypeDesc *td,
+  size_t limit,
+  uint8_t out_root[32],
+  char err[128]
+) {
+  size_t elem_size = 1;
+  int bools = 0;
+  if (td->element_type != NULL) {
+    const TypeDesc *elem_td = (const TypeDesc *)td->element_type;
+    if (elem_td->fixed_size > 0) elem_size = elem_td->fixed_size;
+    bools = elem_td->kind == SSZ_KIND_BOOL;
+  }
+
+  Merkleizer m;
+  int result = ssz_merkle_init(&m, ws, limit == LEN_UNKNOWN ? LEN_UNKNOWN / 32 : (limit + 31) / 32, err);
+  if (result != SSZ_ERR_NONE) return result;
+
+  size_t total = 0;
+  for (;;) {
+    size_t want = 32;
+    if (limit != LEN_UNKNOWN && limit - total < 32) want = limit - total;
+    if (want == 0) break;
+
+    uint8_t chunk[32] = {0};
+    size_t got = rs_read(rs, chunk, want);
+    size_t bad = 0;
+    if (bools && ssz_check_bools(chunk, got, &bad) != SSZ_ERR_NONE) {
+      SSZ_ERROR_MSG(err, "Boolean element %zu not 0 or 1", total + bad);
+      return SSZ_ERR_NON_CANONICAL;
+    }
+    total += got;
+    if (td->kind == SSZ_KIND_LIST && td->max_length > 0 && total / elem_size > td->max_length) {
+      SSZ_ERROR_MSG(err, "List exceeds limit of %u elements", td->max_length);
+      return SSZ_ERR_LENGTH_OVERFLOW;
+    }
+    if (got > 0) ssz_merkle_push(&m, chunk);
+    if (got < want) {
+      if (limit != LEN_UNKNOWN) return stream_eof_error(err, "vector");
+      break;
+    }
+  }
+  if (total % elem_size != 0) {
+    SSZ_ERROR_MSG(err, "Length %zu not a multiple of element size %zu", total, elem_size);
+    return SSZ_ERR_NON_CANONICAL;
+  }
+
+  ssz_merkle_finish(&m, out_root);
+  if (td->kind == SSZ_KIND_LIST) {
+    ssz_mixin_length(out_root, (uint32_t)(total / elem_size));
+  }
+  return SSZ_ERR_NONE;
+}
+
+static int stream_bitlist(
+  ReadStream *rs,
+  ssz_workspace_t *ws,
+  const TypeDesc *td,
+  size_t limit,
+  uint8_t out_root[32],
+  char err[128]
+) {
+  /* The padding bit lives in the final byte, so the last 33 bytes are held
+   * back until EOF decides which of them is the sentinel. */
+  Merkleizer m;
+  int result = ssz_merkle_init(&m, ws, limit == LEN_UNKNOWN ? LEN_UNKNOWN / 32 : limit / 32 + 1, err);
+  if (result != SSZ_ERR_NONE) return result;
+
+  uint8_t window[64];
+  size_t wlen = 0;
+  size_t total = 0;
+  for (;;) {
+    size_t want = sizeof(window) - wlen;
+    if (limit != LEN_UNKNOWN && limit - total < want) want = limit - total;
+    size_t got = rs_read(rs, window + wlen, want);
+    wlen += got;
+    total += got;
+    /* N bits never take more than N / 8 + 1 bytes: stop reading early. The
+     * limit goes before EOF, as for packed lists and in ssz_resume.c, so the
+     * error does not depend on how the input was split. */
+    if (td->max_length > 0 && total > (size_t)td->max_length / 8 + 1) {
+      SSZ_ERROR_MSG(err, "Bitlist exceeds limit of %u bits", td->max_length);
+      return SSZ_ERR_LENGTH_OVERFLOW;
+    }
+    if (got < want && limit != LEN_UNKNOWN) return stream_eof_error(err, "bitlist");
+    if (wlen < 34) break;
+    while (wlen >= 34) {
+      ssz_merkle_push(&m, window);
+      /* wlen <= 64, so the tail never overlaps the head */
+      memcpy(window, window + 32, wlen - 32);
+      wlen -= 32;
+    }
+  }
+
+  if (total == 0) {
+    SSZ_ERROR_MSG(err, "Bitlist cannot be empty");
+    return SSZ_ERR_NON_CANONICAL;
+  }
+  uint8_t last_byte = window[wlen - 1];
+  if (last_byte == 0) {
+    SSZ_ERROR_MSG(err, "Bitlist missing padding bit");
+    return SSZ_ERR_NON_CANONICAL;
+  }
+
+  uint32_t bit_count = (uint32_t)(total - 1) * 8;
+  uint8_t last = last_byte;
+  while (last > 1) {
+    last >>= 1;
+    bit_count++;
+  }
+  if (td->max_length > 0 && bit_count > td->max_length) {
+    SSZ_ERROR_MSG(err, "Bitlist has %u bits, limit %u", bit_count, td->max_length);
+    return SSZ_ERR_LENGTH_OVERFLOW;
   }
-  
+
+  /* Remaining data bytes (possibly none) form the final chunk */
+  uint8_t chunk[32] = {0};
+  memcpy(chunk, window, wlen - 1);
+  if (wlen > 1 || total == 1) ssz_merkle_push(&m, chunk);
+
+  ssz_merkle_finish(&m, out_root);
+  ssz_mixin_length(out_root, bit_count);
+  return SSZ_ERR_NONE;
+}
+
+static int stream_container(
+  ReadStream *rs,
+  ssz_workspace_t *ws,
+  const TypeDesc *td,
+  size_t limit,
+  uint8_t out_root[32],
+  char err[128]
+) {
+  if (td->field_count == 0) {
+    SSZ_ERROR_MSG(err, "Container has no fields");
+    return SSZ_ERR_UNSUPPORTED_TYPE;
+  }
+
+  size_t fixed_part = 0;
+  uint32_t var_count = 0;
+  for (uint32_t i = 0; i < td->field_count; i++) {
+    const TypeDesc *field_td = (const TypeDesc *)td->field_types[i];
+    fixed_part += field_td->fixed_size > 0 ? field_td->fixed_size : 4;
+    if (field_td->fixed_size == 0) var_count++;
+  }
+  if (limit != LEN_UNKNOWN && limit < fixed_part) {
+    SSZ_ERROR_MSG(err, "Container fixed part needs %zu bytes, got %zu", fixed_part, limit);
+    return SSZ_ERR_NON_CANONICAL;
+  }
+  if (var_count == 0 && limit != LEN_UNKNOWN && limit != fixed_part) {
+    SSZ_ERROR_MSG(err, "Container trailing bytes (%zu after fixed part)", limit - fixed_part);
+    return SSZ_ERR_NON_CANONICAL;
+  }
+
+  /* Field roots are held until the variable payloads behind the fixed part
+   * have been streamed, then merkleized in declaration order */
+  uint8_t (*roots)[32] = (uint8_t (*)[32])ssz_ws_alloc(ws, (size_t)td->field_count * 32);
+  uint32_t *offsets = (uint32_t *)ssz_ws_alloc(ws, (size_t)var_count * 4);
+  if (roots == NULL || offsets == NULL) {
+    SSZ_ERROR_MSG(err, "Workspace exhausted (%zu of %zu bytes used)", ws->used, ws->size);
+    return SSZ_ERR_WORKSPACE_EXHAUSTED;
+  }
+
+  uint32_t var_index = 0;
+  int result;
+  for (uint32_t i = 0; i < td->field_count; i++) {
+    const TypeDesc *field_td = (const TypeDesc *)td->field_types[i];
+
+    if (field_td->fixed_size > 0) {
+      result = stream_root(rs, ws, field_td, field_td->fixed_size, roots[i], err);
+      if (result != SSZ_ERR_NONE) return result;
+    } else {
+      uint8_t raw[4];
+      if (rs_read(rs, raw, 4) != 4) return stream_eof_error(err, "container offset table");
+      uint32_t field_offset = ssz_read_le32(raw);
+      /* Same rules as the buffer path's bulk check, one offset at a time */
+      if (var_index > 0 ? field_offset < offsets[var_index - 1] : field_offset != fixed_part) {
+        SSZ_ERROR_MSG(err, "Container field offset invalid");
+        return SSZ_ERR_BAD_OFFSET;
+      }
+      offsets[var_index++] = field_offset;
+    }
+  }
+  if (var_count > 0 && limit != LEN_UNKNOWN && offsets[var_count - 1] > limit) {
+    SSZ_ERROR_MSG(err, "Container field offset invalid");
+    return SSZ_ERR_BAD_OFFSET;
+  }
+
+  /* Payloads follow in offset order; the last one runs to the end of the value */
+  var_index = 0;
+  for (uint32_t i = 0; i < td->field_count; i++) {
+    const TypeDesc *field_td = (const TypeDesc *)td->field_types[i];
+    if (field_td->fixed_size > 0) continue;
+    size_t field_limit;
+    if (var_index + 1 < var_count) {
+      field_limit = offsets[var_index + 1] - offsets[var_index];
+    } else {
+      field_limit = limit == LEN_UNKNOWN ? LEN_UNKNOWN : limit - offsets[var_index];
+    }
+    result = stream_root(rs, ws, field_td, field_limit, roots[i], err);
+    if (result != SSZ_ERR_NONE) return result;
+    var_index++;
+  }
+
+  Merkleizer m;
+  result = ssz_merkle_init(&m, ws, td->field_count, err);
+  if (result != SSZ_ERR_NONE) return result;
+  for (uint32_t i = 0; i < td->field_count; i++) ssz_merkle_push(&m, roots[i]);
+  ssz_merkle_finish(&m, out_root);
   return SSZ_ERR_NONE;
 }
 
+static int stream_root(
+  ReadStream *rs,
+  ssz_workspace_t *ws,
+  const TypeDesc *td,
+  size_t limit,
+  uint8_t out_root[32],
+  char err[128]
+) {
+  size_t mark = ws->used;
+  int result;
+
+  switch (td->kind) {
+    case SSZ_KIND_BASIC:
+    case SSZ_KIND_BOOL:
+      result = stream_basic(rs, td, limit, out_root, err);
+      break;
+    case SSZ_KIND_BITLIST:
+      SSZ_TRACE_BEGIN("bitlist");
+      result = stream_bitlist(rs, ws, td, limit, out_root, err);
+      SSZ_TRACE_END("bitlist");
+      break;
+    case SSZ_KIND_CONTAINER:
+      SSZ_TRACE_BEGIN("container");
+      result = stream_container(rs, ws, td, limit, out_root, err);
+      SSZ_TRACE_END("container");
+      break;
+    default:
+      /* Element lengths come from an offset table of unbounded size */
+      if (ssz_has_variable_elements(td)) {
+        SSZ_ERROR_MSG(err, "Variable-size list elements need the buffer API");
+        result = SSZ_ERR_UNSUPPORTED_TYPE;
+      } else {
+        SSZ_TRACE_BEGIN("packed");
+        result = stream_packed(rs, ws, td, limit, out_root, err);
+        SSZ_TRACE_END("packed");
+      }
+      break;
+  }
+
+  ws->used = mark;
+  return result;
+}
+
+size_t ssz_workspace_size_reader(const TypeDesc *td) {
+  return READ_BUFFER_SIZE + workspace_need(td, LEN_UNKNOWN);
+}
+
+int ssz_stream_root_from_reader_ws(
+  ssz_workspace_t *ws,
+  ssz_reader_fn reader,
+  void *ctx,
+  const TypeDesc *td,
+  uint8_t out_root[32],
+  char err[128]
+) {
+  ws->used = 0;
+  ReadStream rs = { reader, ctx, NULL, 0, 0, 0 };
+  rs.buf = (uint8_t *)ssz_ws_alloc(ws, READ_BUFFER_SIZE);
+  if (rs.buf == NULL) {
+    SSZ_ERROR_MSG(err, "Workspace exhausted (%zu of %zu bytes used)", ws->used, ws->size);
+    return SSZ_ERR_WORKSPACE_EXHAUSTED;
+  }
+
+  SSZ_TRACE_BEGIN("root");
+  int result = stream_root(&rs, ws, td, LEN_UNKNOWN, out_root, err);
+  if (result == SSZ_ERR_NONE && rs_read(&rs, NULL, 1) != 0) {
+    SSZ_ERROR_MSG(err, "Trailing bytes after value");
+    result = SSZ_ERR_NON_CANONICAL;
+  }
+  SSZ_TRACE_END("root");
+  ws->used = 0;
+  return result;
+}
+
 int ssz_stream_root_from_reader(
   ssz_reader_fn reader,
   void *ctx,
@@ -290,7 +1390,8 @@ int ssz_stream_root_from_reader(
   uint8_t out_root[32],
   char err[128]
 ) {
-  // Not implemented in this pass
-  (void)reader; (void)ctx; (void)td; (void)out_root; (void)err;
-  return SSZ_ERR_UNSUPPORTED_TYPE;
+  /* Read buffer plus merkle stacks for unbounded input */
+  ssz_workspace_t ws;
+  SSZ_DEFAULT_WORKSPACE(ws, READER_WORKSPACE_ENTRIES);
+  return ssz_stream_root_from_reader_ws(&ws, reader, ctx, td, out_root, err);
 }
@@ -0,0 +1,182 @@
+#define _GNU_SOURCE
+#include "ssz_trace.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifdef SSZ_TRACE
+
+/* Events per thread; later spans are dropped whole once it fills */
+#define TRACE_CAPACITY (1u << 16)
+
+typedef struct {
+  const char *name;
+  uint64_t ts_ns;
+  char phase;
+} TraceEvent;
+
+/* One per recording thread, linked into a global list that only grows.
+ * Only the owner writes events; count is published with release stores so
+ * an exporter on another thread sees whole events. Buffers outlive their
+ * threads so a worker's spans can be exported after it exits. */
+typedef struct TraceBuffer {
+  struct TraceBuffer *next;
+  uint32_t tid;
+  const char *thread_name;
+  uint32_t count;
+  uint32_t open;              /* recorded begins still waiting for their end */
+  uint32_t skipped;           /* begins dropped, so their ends are dropped too */
+  uint64_t dropped;
+  TraceEvent events[TRACE_CAPACITY];
+} TraceBuffer;
+
+static TraceBuffer *trace_head;
+static uint32_t trace_next_tid;
+static _Thread_local TraceBuffer *trace_local;
+
+static uint64_t now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+static TraceBuffer *local_buffer(void) {
+  if (trace_local) return trace_local;
+  TraceBuffer *b = calloc(1, sizeof(*b));
+  if (!b) return NULL;
+  b->tid = __atomic_add_fetch(&trace_next_tid, 1, __ATOMIC_RELAXED);
+  b->next = __atomic_load_n(&trace_head, __ATOMIC_RELAXED);
+  while (!__atomic_compare_exchange_n(&trace_head, &b->next, b, 1, __ATOMIC_RELEASE, __ATOMIC_RELAXED)) {
+  }
+  trace_local = b;
+  return b;
+}
+
+void ssz_trace_event(const char *name, char phase) {
+  TraceBuffer *b = local_buffer();
+  if (!b) return;
+  uint32_t n = b->count;
+  if (phase == 'B') {
+    /* Keep a slot free for the end of every begin already recorded */
+    if (b->skipped > 0 || n + b->open + 2 > TRACE_CAPACITY) {
+      b->skipped++;
+      b->dropped++;
+      return;
+    }
+    b->open++;
+  } else {
+    if (b->skipped > 0) {
+      b->skipped--;
+      b->dropped++;
+      return;
+    }
+    if (b->open > 0) b->open--;
+  }
+  b->events[n].name = name;
+  b->events[n].ts_ns = now_ns();
+  b->events[n].phase = phase;
+  __atomic_store_n(&b->count, n + 1, __ATOMIC_RELEASE);
+}
+
+void ssz_trace_thread_name(const char *name) {
+  TraceBuffer *b = local_buffer();
+  if (b) b->thread_name = name;
+}
+
+/* Span names are literals from this library, but keep the JSON valid */
+static void put_string(FILE *f, const char *s) {
+  fputc('"', f);
+  for (; *s; s++) {
+    if (*s == '"' || *s == '\\') fputc('\\', f);
+    if ((unsigned char)*s >= 0x20) fputc(*s, f);
+  }
+  fputc('"', f);
+}
+
+int ssz_trace_export(const char *path, char err[128]) {
+  FILE *f = fopen(path, "w");
+  if (!f) {
+    if (err) snprintf(err, 128, "Cannot create %s", path);
+    return SSZ_ERR_UNEXPECTED_EOF;
+  }
+
+  uint64_t dropped = 0;
+  int first = 1;
+  fputs("{\"traceEvents\":[", f);
+  for (TraceBuffer *b = __atomic_load_n(&trace_head, __ATOMIC_ACQUIRE); b; b = b->next) {
+    uint32_t count = __atomic_load_n(&b->count, __ATOMIC_ACQUIRE);
+    dropped += b->dropped;
+    if (b->thread_name) {
+      fprintf(f, "%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":",
+              first ? "" : ",", b->tid);
+      put_string(f, b->thread_name);
+      fputs("}}", f);
+      first = 0;
+    }
+    for (uint32_t i = 0; i < count; i++) {
+      const TraceEvent *e = &b->events[i];
+      fprintf(f, "%s\n{\"name\":", first ? "" : ",");
+      put_string(f, e->name);
+      fprintf(f, ",\"ph\":\"%c\",\"ts\":%llu.%03u,\"pid\":1,\"tid\":%u}", e->phase,
+              (unsigned long long)(e->ts_ns / 1000), (unsigned)(e->ts_ns % 1000), b->tid);
+      first = 0;
+    }
+  }
+  fprintf(f, "\n],\"displayTimeUnit\":\"ns\",\"otherData\":{\"dropped_events\":\"%llu\"}}\n",
+          (unsigned long long)dropped);
+
+  if (fclose(f) != 0) {
+    if (err) snprintf(err, 128, "Write to %s failed", path);
+    return SSZ_ERR_UNEXPECTED_EOF;
+  }
+  return SSZ_ERR_NONE;
+}
+
+uint64_t ssz_trace_count(uint64_t *dropped) {
+  uint64_t total = 0, lost = 0;
+  for (TraceBuffer *b = __atomic_load_n(&trace_head, __ATOMIC_ACQUIRE); b; b = b->next) {
+    total += __atomic_load_n(&b->count, __ATOMIC_ACQUIRE);
+    lost += b->dropped;
+  }
+  if (dropped) *dropped = lost;
+  return total;
+}
+
+void ssz_trace_reset(void) {
+  for (TraceBuffer *b = __atomic_load_n(&trace_head, __ATOMIC_ACQUIRE); b; b = b->next) {
+    __atomic_store_n(&b->count, 0, __ATOMIC_RELEASE);
+    b->open = 0;
+    b->skipped = 0;
+    b->dropped = 0;
+  }
+}
+
+#else
+
+void ssz_trace_thread_name(const char *name) {
+  (void)name;
+}
+
+int ssz_trace_export(const char *path, char err[128]) {
+  FILE *f = fopen(path, "w");
+  if (!f) {
+    if (err) snprintf(err, 128, "Cannot create %s", path);
+    return SSZ_ERR_UNEXPECTED_EOF;
+  }
+  fputs("{\"traceEvents\":[]}\n", f);
+  if (fclose(f) != 0) {
+    if (err) snprintf(err, 128, "Write to %s failed", path);
+    return SSZ_ERR_UNEXPECTED_EOF;
+  }
+  return SSZ_ERR_NONE;
+}
+
+uint64_t ssz_trace_count(uint64_t *dropped) {
+  if (dropped) *dropped = 0;
+  return 0;
+}
+
+void ssz_trace_reset(void) {}
+
+#endif
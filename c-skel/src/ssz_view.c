@@ -0,0 +1,322 @@
+#include "ssz_view.h"
+#include "ssz_error.h"
+#include "ssz_merkle.h"
+#include <string.h>
+
+void ssz_view_init(ssz_view_t *view, const uint8_t *bytes, size_t len, const TypeDesc *td) {
+  view->bytes = bytes;
+  view->len = len;
+  view->td = td;
+}
+
+int ssz_view_field(const ssz_view_t *view, uint32_t index, ssz_view_t *out, char err[128]) {
+  const TypeDesc *td = view->td;
+  if (td->kind != SSZ_KIND_CONTAINER) {
+    SSZ_ERROR_MSG(err, "Field access on type kind %d", (int)td->kind);
+    return SSZ_ERR_UNSUPPORTED_TYPE;
+  }
+  if (index >= td->field_count) {
+    SSZ_ERROR_MSG(err, "Field %u out of range (%u fields)", index, td->field_count);
+    return SSZ_ERR_UNSUPPORTED_TYPE;
+  }
+
+  /* Positions come from the type alone; the data is not touched */
+  size_t fixed_part = 0;
+  size_t pos = 0;          /* fixed-part position of the target */
+  size_t next_pos = 0;     /* position of the next variable field's offset, if any */
+  int has_next = 0;
+  for (uint32_t i = 0; i < td->field_count; i++) {
+    const TypeDesc *field_td = (const TypeDesc *)td->field_types[i];
+    if (i == index) pos = fixed_part;
+    if (i > index && field_td->fixed_size == 0 && !has_next) {
+      next_pos = fixed_part;
+      has_next = 1;
+    }
+    fixed_part += field_td->fixed_size > 0 ? field_td->fixed_size : 4;
+  }
+  if (view->len < fixed_part) {
+    SSZ_ERROR_MSG(err, "Container fixed part needs %zu bytes, got %zu", fixed_part, view->len);
+    return SSZ_ERR_NON_CANONICAL;
+  }
+
+  const TypeDesc *field_td = (const TypeDesc *)td->field_types[index];
+  if (field_td->fixed_size > 0) {
+    ssz_view_init(out, view->bytes + pos, field_td->fixed_size, field_td);
+    return SSZ_ERR_NONE;
+  }
+  size_t start = ssz_read_le32(view->bytes + pos);
+  size_t end = has_next ? ssz_read_le32(view->bytes + next_pos) : view->len;
+  if (start < fixed_part || start > end || end > view->len) {
+    SSZ_ERROR_MSG(err, "Container field %u offset invalid", index);
+    return SSZ_ERR_BAD_OFFSET;
+  }
+  ssz_view_init(out, view->bytes + start, end - start, field_td);
+  return SSZ_ERR_NONE;
+}
+
+/* Element count of a list or vector, without walking the elements */
+static int element_count(const ssz_view_t *view, size_t *count, char err[128]) {
+  if (ssz_has_variable_elements(view->td)) {
+    if (view->len == 0) {
+      *count = 0;
+      return SSZ_ERR_NONE;
+    }
+    uint32_t first = view->len >= 4 ? ssz_read_le32(view->bytes) : 0;
+    if (first == 0 || first % 4 != 0 || first > view->len) {
+      SSZ_ERROR_MSG(err, "List first offset %u invalid", first);
+      return SSZ_ERR_BAD_OFFSET;
+    }
+    *count = first / 4;
+    return SSZ_ERR_NONE;
+  }
+  size_t elem_size = ssz_element_size(view->td);
+  if (view->len % elem_size != 0) {
+    SSZ_ERROR_MSG(err, "Length %zu not a multiple of element size %zu", view->len, elem_size);
+    return SSZ_ERR_NON_CANONICAL;
+  }
+  *count = view->len / elem_size;
+  return SSZ_ERR_NONE;
+}
+
+int ssz_view_index(const ssz_view_t *view, size_t index, ssz_view_t *out, char err[128]) {
+  const TypeDesc *td = view->td;
+  if ((td->kind != SSZ_KIND_LIST && td->kind != SSZ_KIND_VECTOR) || td->element_type == NULL) {
+    SSZ_ERROR_MSG(err, "Element access on type kind %d", (int)td->kind);
+    return SSZ_ERR_UNSUPPORTED_TYPE;
+  }
+  size_t count;
+  int result = element_count(view, &count, err);
+  if (result != SSZ_ERR_NONE) return result;
+  if (index >= count) {
+    SSZ_ERROR_MSG(err, "Element %zu out of range (%zu elements)", index, count);
+    return SSZ_ERR_LENGTH_OVERFLOW;
+  }
+
+  const TypeDesc *elem_td = (const TypeDesc *)td->element_type;
+  if (!ssz_has_variable_elements(td)) {
+    size_t elem_size = ssz_element_size(td);
+    ssz_view_init(out, view->bytes + index * elem_size, elem_size, elem_td);
+    return SSZ_ERR_NONE;
+  }
+  size_t start = ssz_read_le32(view->bytes + index * 4);
+  size_t end = index + 1 < count ? ssz_read_le32(view->bytes + (index + 1) * 4) : view->len;
+  if (start < count * 4 || start > end || end > view->len) {
+    SSZ_ERROR_MSG(err, "List element %zu offset invalid", index);
+    return SSZ_ERR_BAD_OFFSET;
+  }
+  ssz_view_init(out, view->bytes + start, end - start, elem_td);
+  return SSZ_ERR_NONE;
+}
+
+int ssz_view_len(const ssz_view_t *view, size_t *count, char err[128]) {
+  switch (view->td->kind) {
+    case SSZ_KIND_CONTAINER:
+      *count = view->td->field_count;
+      return SSZ_ERR_NONE;
+    case SSZ_KIND_BITLIST: {
+      if (view->len == 0 || view->bytes[view->len - 1] == 0) {
+        SSZ_ERROR_MSG(err, "Bitlist missing padding bit");
+        return SSZ_ERR_NON_CANONICAL;
+      }
+      size_t bits = (view->len - 1) * 8;
+      for (uint8_t last = view->bytes[view->len - 1]; last > 1; last >>= 1) bits++;
+      *count = bits;
+      return SSZ_ERR_NONE;
+    }
+    case SSZ_KIND_LIST:
+    case SSZ_KIND_VECTOR:
+      return element_count(view, count, err);
+    default:
+      *count = view->len;
+      return SSZ_ERR_NONE;
+  }
+}
+
+const uint8_t *ssz_view_bytes(const ssz_view_t *view, size_t *len) {
+  if (len) *len = view->len;
+  return view->bytes;
+}
+
+int ssz_view_uint(const ssz_view_t *view, uint64_t *value, char err[128]) {
+  if ((view->td->kind != SSZ_KIND_BASIC && view->td->kind != SSZ_KIND_BOOL) || view->len > 8) {
+    SSZ_ERROR_MSG(err, "Not a basic value of at most 8 bytes");
+    return SSZ_ERR_UNSUPPORTED_TYPE;
+  }
+  if (view->td->fixed_size > 0 && view->len != view->td->fixed_size) {
+    SSZ_ERROR_MSG(err, "Basic type length mismatch: expected %u, got %zu", view->td->fixed_size, view->len);
+    return SSZ_ERR_NON_CANONICAL;
+  }
+  uint64_t v = 0;
+  for (size_t i = 0; i < view->len; i++) v |= (uint64_t)view->bytes[i] << (8 * i);
+  if (view->td->kind == SSZ_KIND_BOOL && v > 1) {
+    SSZ_ERROR_MSG(err, "Boolean must be one byte of 0 or 1");
+    return SSZ_ERR_NON_CANONICAL;
+  }
+  *value = v;
+  return SSZ_ERR_NONE;
+}
+
+int ssz_view_root(const ssz_view_t *view, uint8_t out_root[32], char err[128]) {
+  return ssz_stream_root_from_buffer(view->bytes, view->len, view->td, out_root, err);
+}
+
+/* ===== Subtree roots ===== */
+
+static int descend(ssz_view_t *v, size_t index, char err[128]) {
+  if (v->td->kind == SSZ_KIND_CONTAINER) {
+    return ssz_view_field(v, index > UINT32_MAX ? UINT32_MAX : (uint32_t)index, v, err);
+  }
+  return ssz_view_index(v, index, v, err);
+}
+
+int ssz_subroot(
+  const uint8_t *bytes,
+  size_t len,
+  const TypeDesc *td,
+  const uint32_t *path,
+  size_t depth,
+  uint8_t out_root[32],
+  char err[128]
+) {
+  ssz_view_t v;
+  ssz_view_init(&v, bytes, len, td);
+  for (size_t i = 0; i < depth; i++) {
+    int result = descend(&v, path[i], err);
+    if (result != SSZ_ERR_NONE) return result;
+  }
+  return ssz_view_root(&v, out_root, err);
+}
+
+static uint32_t ceil_log2(uint64_t n) {
+  uint32_t bits = 0;
+  while (((uint64_t)1 << bits) < n) bits++;
+  return bits;
+}
+
+/* Packed leaf `chunk` of a basic-element list/vector or bitlist: raw data
+ * bytes, zero beyond the value (a padding leaf of the spec tree) */
+static void packed_chunk(const ssz_view_t *v, uint64_t chunk, uint8_t out[32]) {
+  size_t data_len = v->td->kind == SSZ_KIND_BITLIST && v->len > 0 ? v->len - 1 : v->len;
+  memset(out, 0, 32);
+  if (chunk < (data_len + 31) / 32) {
+    size_t start = (size_t)chunk * 32;
+    memcpy(out, v->bytes + start, data_len - start < 32 ? data_len - start : 32);
+  }
+}
+
+#define GINDEX_NOT_A_VALUE (-1)
+
+/* Walks v down to the node gindex addresses. Returns SSZ_ERR_NONE with
+ * *leaf set once out_root holds a packed chunk or length leaf, SSZ_ERR_NONE
+ * with v at the selected value otherwise, or GINDEX_NOT_A_VALUE. */
+
+static int gindex_walk(ssz_view_t *root_v, uint64_t gindex, uint8_t out_root[32], int *leaf, char err[128]) {
+  /* Path bits below the leading one, consumed from the top */
+  uint32_t left = 63;
+  while (!((gindex >> left) & 1)) left--;
+  ssz_view_t v = *root_v;
+  *leaf = 0;
+
+  while (left > 0) {
+    const TypeDesc *cur = v.td;
+    const TypeDesc *elem_td = (const TypeDesc *)cur->element_type;
+    /* Basic elements share leaves; composite elements are a leaf each */
+    int packed = cur->kind == SSZ_KIND_BITLIST ||
+                 ((cur->kind == SSZ_KIND_LIST || cur->kind == SSZ_KIND_VECTOR) &&
+                  (elem_td == NULL || elem_td->kind == SSZ_KIND_BASIC || elem_td->kind == SSZ_KIND_BOOL));
+    size_t elem_size = 1;
+    if (elem_td != NULL && elem_td->fixed_size > 0) elem_size = elem_td->fixed_size;
+    uint64_t leaves;
+
+    if (cur->kind == SSZ_KIND_CONTAINER) {
+      leaves = cur->field_count;
+    } else if (cur->kind == SSZ_KIND_LIST || cur->kind == SSZ_KIND_BITLIST) {
+      if (cur->max_length == 0) {
+        SSZ_ERROR_MSG(err, "List gindex needs max_length");
+        return SSZ_ERR_UNSUPPORTED_TYPE;
+      }
+      /* Right child of a list is the length mix-in */
+      left--;
+      if ((gindex >> left) & 1) {
+        if (left != 0) return GINDEX_NOT_A_VALUE;
+        size_t length;
+        int result = cur->kind == SSZ_KIND_BITLIST ? ssz_validate(v.bytes, v.len, cur, err) : SSZ_ERR_NONE;
+        if (result == SSZ_ERR_NONE) result = ssz_view_len(&v, &length, err);
+        if (result != SSZ_ERR_NONE) return result;
+        memset(out_root, 0, 32);
+        for (int i = 0; i < 8; i++) out_root[i] = (uint8_t)(length >> (8 * i));
+        *leaf = 1;
+        return SSZ_ERR_NONE;
+      }
+      if (left == 0) return GINDEX_NOT_A_VALUE;
+      if (cur->kind == SSZ_KIND_BITLIST) {
+        leaves = ((uint64_t)cur->max_length + 255) / 256;
+      } else if (packed) {
+        leaves = ((uint64_t)cur->max_length * elem_size + 31) / 32;
+      } else {
+        leaves = cur->max_length;
+      }
+    } else if (cur->kind == SSZ_KIND_VECTOR && cur->element_type != NULL) {
+      size_t count;
+      int result = ssz_view_len(&v, &count, err);
+      if (result != SSZ_ERR_NONE) return result;
+      leaves = packed ? ((uint64_t)count * elem_size + 31) / 32 : count;
+    } else {
+      SSZ_ERROR_MSG(err, "Cannot descend into type kind %d", (int)cur->kind);
+      return SSZ_ERR_UNSUPPORTED_TYPE;
+    }
+
+    uint32_t level_bits = ceil_log2(leaves);
+    if (level_bits > left) return GINDEX_NOT_A_VALUE;
+    left -= level_bits;
+    uint64_t index = level_bits ? (gindex >> left) & (((uint64_t)1 << level_bits) - 1) : 0;
+
+    if (packed) {
+      /* Leaves of packed data are chunks, not elements: nothing below them */
+      if (left != 0) return GINDEX_NOT_A_VALUE;
+      if (cur->kind == SSZ_KIND_BITLIST) {
+        int result = ssz_validate(v.bytes, v.len, cur, err);
+        if (result != SSZ_ERR_NONE) return result;
+      } else {
+        size_t count;
+        int result = ssz_view_len(&v, &count, err);
+        if (result != SSZ_ERR_NONE) return result;
+      }
+      packed_chunk(&v, index, out_root);
+      *leaf = 1;
+      return SSZ_ERR_NONE;
+    }
+    if (cur->kind == SSZ_KIND_CONTAINER && index >= cur->field_count) return GINDEX_NOT_A_VALUE;
+
+    int result = descend(&v, (size_t)index, err);
+    if (result != SSZ_ERR_NONE) return result;
+  }
+
+  *root_v = v;
+  return SSZ_ERR_NONE;
+}
+
+int ssz_subroot_gindex(
+  const uint8_t *bytes,
+  size_t len,
+  const TypeDesc *td,
+  uint64_t gindex,
+  uint8_t out_root[32],
+  char err[128]
+) {
+  if (gindex == 0) {
+    SSZ_ERROR_MSG(err, "Generalized index 0 is invalid");
+    return SSZ_ERR_UNSUPPORTED_TYPE;
+  }
+  ssz_view_t v;
+  ssz_view_init(&v, bytes, len, td);
+  int leaf = 0;
+  int result = gindex_walk(&v, gindex, out_root, &leaf, err);
+  if (result == GINDEX_NOT_A_VALUE) {
+    SSZ_ERROR_MSG(err, "Generalized index %llu does not address a field or element",
+                      (unsigned long long)gindex);
+    return SSZ_ERR_UNSUPPORTED_TYPE;
+  }
+  if (result != SSZ_ERR_NONE || leaf) return result;
+  return ssz_view_root(&v, out_root, err);
+}
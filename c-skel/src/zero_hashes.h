@@ -0,0 +1,135 @@
+/* Roots of all-zero subtrees: ZERO_HASHES[h] is the root of 2^h zero chunks.
+ * Generated with zero[h + 1] = sha256(zero[h] || zero[h]). */
+
+#define ZERO_HASH_LEVELS 64
+
+static const uint8_t ZERO_HASHES[ZERO_HASH_LEVELS][32] = {
+  { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },
+  { 0xf5, 0xa5, 0xfd, 0x42, 0xd1, 0x6a, 0x20, 0x30, 0x27, 0x98, 0xef, 0x6e, 0xd3, 0x09, 0x97, 0x9b,
+    0x43, 0x00, 0x3d, 0x23, 0x20, 0xd9, 0xf0, 0xe8, 0xea, 0x98, 0x31, 0xa9, 0x27, 0x59, 0xfb, 0x4b },
+  { 0xdb, 0x56, 0x11, 0x4e, 0x00, 0xfd, 0xd4, 0xc1, 0xf8, 0x5c, 0x89, 0x2b, 0xf3, 0x5a, 0xc9, 0xa8,
+    0x92, 0x89, 0xaa, 0xec, 0xb1, 0xeb, 0xd0, 0xa9, 0x6c, 0xde, 0x60, 0x6a, 0x74, 0x8b, 0x5d, 0x71 },
+  { 0xc7, 0x80, 0x09, 0xfd, 0xf0, 0x7f, 0xc5, 0x6a, 0x11, 0xf1, 0x22, 0x37, 0x06, 0x58, 0xa3, 0x53,
+    0xaa, 0xa5, 0x42, 0xed, 0x63, 0xe4, 0x4c, 0x4b, 0xc1, 0x5f, 0xf4, 0xcd, 0x10, 0x5a, 0xb3, 0x3c },
+  { 0x53, 0x6d, 0x98, 0x83, 0x7f, 0x2d, 0xd1, 0x65, 0xa5, 0x5d, 0x5e, 0xea, 0xe9, 0x14, 0x85, 0x95,
+    0x44, 0x72, 0xd5, 0x6f, 0x24, 0x6d, 0xf2, 0x56, 0xbf, 0x3c, 0xae, 0x19, 0x35, 0x2a, 0x12, 0x3c },
+  { 0x9e, 0xfd, 0xe0, 0x52, 0xaa, 0x15, 0x42, 0x9f, 0xae, 0x05, 0xba, 0xd4, 0xd0, 0xb1, 0xd7, 0xc6,
+    0x4d, 0xa6, 0x4d, 0x03, 0xd7, 0xa1, 0x85, 0x4a, 0x58, 0x8c, 0x2c, 0xb8, 0x43, 0x0c, 0x0d, 0x30 },
+  { 0xd8, 0x8d, 0xdf, 0xee, 0xd4, 0x00, 0xa8, 0x75, 0x55, 0x96, 0xb2, 0x19, 0x42, 0xc1, 0x49, 0x7e,
+    0x11, 0x4c, 0x30, 0x2e, 0x61, 0x18, 0x29, 0x0f, 0x91, 0xe6, 0x77, 0x29, 0x76, 0x04, 0x1f, 0xa1 },
+  { 0x87, 0xeb, 0x0d, 0xdb, 0xa5, 0x7e, 0x35, 0xf6, 0xd2, 0x86, 0x67, 0x38, 0x02, 0xa4, 0xaf, 0x59,
+    0x75, 0xe2, 0x25, 0x06, 0xc7, 0xcf, 0x4c, 0x64, 0xbb, 0x6b, 0xe5, 0xee, 0x11, 0x52, 0x7f, 0x2c },
+  { 0x26, 0x84, 0x64, 0x76, 0xfd, 0x5f, 0xc5, 0x4a, 0x5d, 0x43, 0x38, 0x51, 0x67, 0xc9, 0x51, 0x44,
+    0xf2, 0x64, 0x3f, 0x53, 0x3c, 0xc8, 0x5b, 0xb9, 0xd1, 0x6b, 0x78, 0x2f, 0x8d, 0x7d, 0xb1, 0x93 },
+  { 0x50, 0x6d, 0x86, 0x58, 0x2d, 0x25, 0x24, 0x05, 0xb8, 0x40, 0x01, 0x87, 0x92, 0xca, 0xd2, 0xbf,
+    0x12, 0x59, 0xf1, 0xef, 0x5a, 0xa5, 0xf8, 0x87, 0xe1, 0x3c, 0xb2, 0xf0, 0x09, 0x4f, 0x51, 0xe1 },
+  { 0xff, 0xff, 0x0a, 0xd7, 0xe6, 0x59, 0x77, 0x2f, 0x95, 0x34, 0xc1, 0x95, 0xc8, 0x15, 0xef, 0xc4,
+    0x01, 0x4e, 0xf1, 0xe1, 0xda, 0xed, 0x44, 0x04, 0xc0, 0x63, 0x85, 0xd1, 0x11, 0x92, 0xe9, 0x2b },
+  { 0x6c, 0xf0, 0x41, 0x27, 0xdb, 0x05, 0x44, 0x1c, 0xd8, 0x33, 0x10, 0x7a, 0x52, 0xbe, 0x85, 0x28,
+    0x68, 0x89, 0x0e, 0x43, 0x17, 0xe6, 0xa0, 0x2a, 0xb4, 0x76, 0x83, 0xaa, 0x75, 0x96, 0x42, 0x20 },
+  { 0xb7, 0xd0, 0x5f, 0x87, 0x5f, 0x14, 0x00, 0x27, 0xef, 0x51, 0x18, 0xa2, 0x24, 0x7b, 0xbb, 0x84,
+    0xce, 0x8f, 0x2f, 0x0f, 0x11, 0x23, 0x62, 0x30, 0x85, 0xda, 0xf7, 0x96, 0x0c, 0x32, 0x9f, 0x5f },
+  { 0xdf, 0x6a, 0xf5, 0xf5, 0xbb, 0xdb, 0x6b, 0xe9, 0xef, 0x8a, 0xa6, 0x18, 0xe4, 0xbf, 0x80, 0x73,
+    0x96, 0x08, 0x67, 0x17, 0x1e, 0x29, 0x67, 0x6f, 0x8b, 0x28, 0x4d, 0xea, 0x6a, 0x08, 0xa8, 0x5e },
+  { 0xb5, 0x8d, 0x90, 0x0f, 0x5e, 0x18, 0x2e, 0x3c, 0x50, 0xef, 0x74, 0x96, 0x9e, 0xa1, 0x6c, 0x77,
+    0x26, 0xc5, 0x49, 0x75, 0x7c, 0xc2, 0x35, 0x23, 0xc3, 0x69, 0x58, 0x7d, 0xa7, 0x29, 0x37, 0x84 },
+  { 0xd4, 0x9a, 0x75, 0x02, 0xff, 0xcf, 0xb0, 0x34, 0x0b, 0x1d, 0x78, 0x85, 0x68, 0x85, 0x00, 0xca,
+    0x30, 0x81, 0x61, 0xa7, 0xf9, 0x6b, 0x62, 0xdf, 0x9d, 0x08, 0x3b, 0x71, 0xfc, 0xc8, 0xf2, 0xbb },
+  { 0x8f, 0xe6, 0xb1, 0x68, 0x92, 0x56, 0xc0, 0xd3, 0x85, 0xf4, 0x2f, 0x5b, 0xbe, 0x20, 0x27, 0xa2,
+    0x2c, 0x19, 0x96, 0xe1, 0x10, 0xba, 0x97, 0xc1, 0x71, 0xd3, 0xe5, 0x94, 0x8d, 0xe9, 0x2b, 0xeb },
+  { 0x8d, 0x0d, 0x63, 0xc3, 0x9e, 0xba, 0xde, 0x85, 0x09, 0xe0, 0xae, 0x3c, 0x9c, 0x38, 0x76, 0xfb,
+    0x5f, 0xa1, 0x12, 0xbe, 0x18, 0xf9, 0x05, 0xec, 0xac, 0xfe, 0xcb, 0x92, 0x05, 0x76, 0x03, 0xab },
+  { 0x95, 0xee, 0xc8, 0xb2, 0xe5, 0x41, 0xca, 0xd4, 0xe9, 0x1d, 0xe3, 0x83, 0x85, 0xf2, 0xe0, 0x46,
+    0x61, 0x9f, 0x54, 0x49, 0x6c, 0x23, 0x82, 0xcb, 0x6c, 0xac, 0xd5, 0xb9, 0x8c, 0x26, 0xf5, 0xa4 },
+  { 0xf8, 0x93, 0xe9, 0x08, 0x91, 0x77, 0x75, 0xb6, 0x2b, 0xff, 0x23, 0x29, 0x4d, 0xbb, 0xe3, 0xa1,
+    0xcd, 0x8e, 0x6c, 0xc1, 0xc3, 0x5b, 0x48, 0x01, 0x88, 0x7b, 0x64, 0x6a, 0x6f, 0x81, 0xf1, 0x7f },
+  { 0xcd, 0xdb, 0xa7, 0xb5, 0x92, 0xe3, 0x13, 0x33, 0x93, 0xc1, 0x61, 0x94, 0xfa, 0xc7, 0x43, 0x1a,
+    0xbf, 0x2f, 0x54, 0x85, 0xed, 0x71, 0x1d, 0xb2, 0x82, 0x18, 0x3c, 0x81, 0x9e, 0x08, 0xeb, 0xaa },
+  { 0x8a, 0x8d, 0x7f, 0xe3, 0xaf, 0x8c, 0xaa, 0x08, 0x5a, 0x76, 0x39, 0xa8, 0x32, 0x00, 0x14, 0x57,
+    0xdf, 0xb9, 0x12, 0x8a, 0x80, 0x61, 0x14, 0x2a, 0xd0, 0x33, 0x56, 0x29, 0xff, 0x23, 0xff, 0x9c },
+  { 0xfe, 0xb3, 0xc3, 0x37, 0xd7, 0xa5, 0x1a, 0x6f, 0xbf, 0x00, 0xb9, 0xe3, 0x4c, 0x52, 0xe1, 0xc9,
+    0x19, 0x5c, 0x96, 0x9b, 0xd4, 0xe7, 0xa0, 0xbf, 0xd5, 0x1d, 0x5c, 0x5b, 0xed, 0x9c, 0x11, 0x67 },
+  { 0xe7, 0x1f, 0x0a, 0xa8, 0x3c, 0xc3, 0x2e, 0xdf, 0xbe, 0xfa, 0x9f, 0x4d, 0x3e, 0x01, 0x74, 0xca,
+    0x85, 0x18, 0x2e, 0xec, 0x9f, 0x3a, 0x09, 0xf6, 0xa6, 0xc0, 0xdf, 0x63, 0x77, 0xa5, 0x10, 0xd7 },
+  { 0x31, 0x20, 0x6f, 0xa8, 0x0a, 0x50, 0xbb, 0x6a, 0xbe, 0x29, 0x08, 0x50, 0x58, 0xf1, 0x62, 0x12,
+    0x21, 0x2a, 0x60, 0xee, 0xc8, 0xf0, 0x49, 0xfe, 0xcb, 0x92, 0xd8, 0xc8, 0xe0, 0xa8, 0x4b, 0xc0 },
+  { 0x21, 0x35, 0x2b, 0xfe, 0xcb, 0xed, 0xdd, 0xe9, 0x93, 0x83, 0x9f, 0x61, 0x4c, 0x3d, 0xac, 0x0a,
+    0x3e, 0xe3, 0x75, 0x43, 0xf9, 0xb4, 0x12, 0xb1, 0x61, 0x99, 0xdc, 0x15, 0x8e, 0x23, 0xb5, 0x44 },
+  { 0x61, 0x9e, 0x31, 0x27, 0x24, 0xbb, 0x6d, 0x7c, 0x31, 0x53, 0xed, 0x9d, 0xe7, 0x91, 0xd7, 0x64,
+    0xa3, 0x66, 0xb3, 0x89, 0xaf, 0x13, 0xc5, 0x8b, 0xf8, 0xa8, 0xd9, 0x04, 0x81, 0xa4, 0x67, 0x65 },
+  { 0x7c, 0xdd, 0x29, 0x86, 0x26, 0x82, 0x50, 0x62, 0x8d, 0x0c, 0x10, 0xe3, 0x85, 0xc5, 0x8c, 0x61,
+    0x91, 0xe6, 0xfb, 0xe0, 0x51, 0x91, 0xbc, 0xc0, 0x4f, 0x13, 0x3f, 0x2c, 0xea, 0x72, 0xc1, 0xc4 },
+  { 0x84, 0x89, 0x30, 0xbd, 0x7b, 0xa8, 0xca, 0xc5, 0x46, 0x61, 0x07, 0x21, 0x13, 0xfb, 0x27, 0x88,
+    0x69, 0xe0, 0x7b, 0xb8, 0x58, 0x7f, 0x91, 0x39, 0x29, 0x33, 0x37, 0x4d, 0x01, 0x7b, 0xcb, 0xe1 },
+  { 0x88, 0x69, 0xff, 0x2c, 0x22, 0xb2, 0x8c, 0xc1, 0x05, 0x10, 0xd9, 0x85, 0x32, 0x92, 0x80, 0x33,
+    0x28, 0xbe, 0x4f, 0xb0, 0xe8, 0x04, 0x95, 0xe8, 0xbb, 0x8d, 0x27, 0x1f, 0x5b, 0x88, 0x96, 0x36 },
+  { 0xb5, 0xfe, 0x28, 0xe7, 0x9f, 0x1b, 0x85, 0x0f, 0x86, 0x58, 0x24, 0x6c, 0xe9, 0xb6, 0xa1, 0xe7,
+    0xb4, 0x9f, 0xc0, 0x6d, 0xb7, 0x14, 0x3e, 0x8f, 0xe0, 0xb4, 0xf2, 0xb0, 0xc5, 0x52, 0x3a, 0x5c },
+  { 0x98, 0x5e, 0x92, 0x9f, 0x70, 0xaf, 0x28, 0xd0, 0xbd, 0xd1, 0xa9, 0x0a, 0x80, 0x8f, 0x97, 0x7f,
+    0x59, 0x7c, 0x7c, 0x77, 0x8c, 0x48, 0x9e, 0x98, 0xd3, 0xbd, 0x89, 0x10, 0xd3, 0x1a, 0xc0, 0xf7 },
+  { 0xc6, 0xf6, 0x7e, 0x02, 0xe6, 0xe4, 0xe1, 0xbd, 0xef, 0xb9, 0x94, 0xc6, 0x09, 0x89, 0x53, 0xf3,
+    0x46, 0x36, 0xba, 0x2b, 0x6c, 0xa2, 0x0a, 0x47, 0x21, 0xd2, 0xb2, 0x6a, 0x88, 0x67, 0x22, 0xff },
+  { 0x1c, 0x9a, 0x7e, 0x5f, 0xf1, 0xcf, 0x48, 0xb4, 0xad, 0x15, 0x82, 0xd3, 0xf4, 0xe4, 0xa1, 0x00,
+    0x4f, 0x3b, 0x20, 0xd8, 0xc5, 0xa2, 0xb7, 0x13, 0x87, 0xa4, 0x25, 0x4a, 0xd9, 0x33, 0xeb, 0xc5 },
+  { 0x2f, 0x07, 0x5a, 0xe2, 0x29, 0x64, 0x6b, 0x6f, 0x6a, 0xed, 0x19, 0xa5, 0xe3, 0x72, 0xcf, 0x29,
+    0x50, 0x81, 0x40, 0x1e, 0xb8, 0x93, 0xff, 0x59, 0x9b, 0x3f, 0x9a, 0xcc, 0x0c, 0x0d, 0x3e, 0x7d },
+  { 0x32, 0x89, 0x21, 0xde, 0xb5, 0x96, 0x12, 0x07, 0x68, 0x01, 0xe8, 0xcd, 0x61, 0x59, 0x21, 0x07,
+    0xb5, 0xc6, 0x7c, 0x79, 0xb8, 0x46, 0x59, 0x5c, 0xc6, 0x32, 0x0c, 0x39, 0x5b, 0x46, 0x36, 0x2c },
+  { 0xbf, 0xb9, 0x09, 0xfd, 0xb2, 0x36, 0xad, 0x24, 0x11, 0xb4, 0xe4, 0x88, 0x38, 0x10, 0xa0, 0x74,
+    0xb8, 0x40, 0x46, 0x46, 0x89, 0x98, 0x6c, 0x3f, 0x8a, 0x80, 0x91, 0x82, 0x7e, 0x17, 0xc3, 0x27 },
+  { 0x55, 0xd8, 0xfb, 0x36, 0x87, 0xba, 0x3b, 0xa4, 0x9f, 0x34, 0x2c, 0x77, 0xf5, 0xa1, 0xf8, 0x9b,
+    0xec, 0x83, 0xd8, 0x11, 0x44, 0x6e, 0x1a, 0x46, 0x71, 0x39, 0x21, 0x3d, 0x64, 0x0b, 0x6a, 0x74 },
+  { 0xf7, 0x21, 0x0d, 0x4f, 0x8e, 0x7e, 0x10, 0x39, 0x79, 0x0e, 0x7b, 0xf4, 0xef, 0xa2, 0x07, 0x55,
+    0x5a, 0x10, 0xa6, 0xdb, 0x1d, 0xd4, 0xb9, 0x5d, 0xa3, 0x13, 0xaa, 0xa8, 0x8b, 0x88, 0xfe, 0x76 },
+  { 0xad, 0x21, 0xb5, 0x16, 0xcb, 0xc6, 0x45, 0xff, 0xe3, 0x4a, 0xb5, 0xde, 0x1c, 0x8a, 0xef, 0x8c,
+    0xd4, 0xe7, 0xf8, 0xd2, 0xb5, 0x1e, 0x8e, 0x14, 0x56, 0xad, 0xc7, 0x56, 0x3c, 0xda, 0x20, 0x6f },
+  { 0x6b, 0xfe, 0x8d, 0x2b, 0xcc, 0x42, 0x37, 0xb7, 0x4a, 0x50, 0x47, 0x05, 0x8e, 0xf4, 0x55, 0x33,
+    0x9e, 0xcd, 0x73, 0x60, 0xcb, 0x63, 0xbf, 0xbb, 0x8e, 0xe5, 0x44, 0x8e, 0x64, 0x30, 0xba, 0x04 },
+  { 0xa7, 0xf2, 0x3c, 0xe9, 0x18, 0x17, 0x40, 0xdc, 0x22, 0x0c, 0x81, 0x47, 0x82, 0x65, 0x4f, 0xee,
+    0x6a, 0xce, 0xb9, 0xf1, 0xec, 0x92, 0x22, 0xc4, 0xe2, 0x46, 0x7d, 0x0a, 0xb1, 0x68, 0x08, 0x37 },
+  { 0xae, 0xf9, 0x47, 0x6c, 0x89, 0x59, 0x0a, 0x2c, 0x8c, 0xc9, 0xb3, 0xb7, 0x4f, 0x49, 0x67, 0xc7,
+    0x57, 0xc4, 0x9d, 0x98, 0x66, 0xa4, 0x4b, 0xac, 0xf2, 0x1f, 0xa2, 0xed, 0x67, 0x5d, 0xdf, 0xa2 },
+  { 0x9a, 0x42, 0xbc, 0xad, 0x82, 0xf6, 0xa9, 0xe4, 0x12, 0x84, 0xd8, 0x08, 0xea, 0xd3, 0x19, 0xf2,
+    0x9f, 0x3b, 0x08, 0x20, 0x9d, 0x68, 0x0f, 0x0e, 0x2c, 0xe7, 0x15, 0x10, 0xd0, 0x71, 0xe2, 0x05 },
+  { 0xd1, 0xa6, 0x6d, 0x35, 0x4a, 0x67, 0xb9, 0xcf, 0x17, 0x95, 0x71, 0xd8, 0xe5, 0xf9, 0x77, 0x92,
+    0x71, 0x6e, 0x8d, 0xd4, 0xec, 0x44, 0x19, 0x68, 0x39, 0xa3, 0xf7, 0xc6, 0xb7, 0x4f, 0x8b, 0xac },
+  { 0xfa, 0xfa, 0x30, 0x25, 0xf2, 0xf8, 0x95, 0x09, 0xc2, 0xc7, 0x1c, 0x74, 0xfb, 0xa0, 0xcd, 0x92,
+    0x85, 0x8e, 0xf4, 0x9b, 0x07, 0x80, 0xfb, 0x54, 0x79, 0x74, 0x6c, 0x8a, 0x9b, 0xfc, 0xb3, 0x46 },
+  { 0x33, 0x34, 0xa7, 0xc1, 0xe7, 0xf6, 0x70, 0x5a, 0xa6, 0x01, 0x1a, 0x6a, 0x94, 0x96, 0x45, 0x01,
+    0x6d, 0xb4, 0xac, 0xde, 0x0c, 0xa9, 0xab, 0xd6, 0x6d, 0xc7, 0x9d, 0x82, 0x66, 0x42, 0x30, 0x56 },
+  { 0x07, 0x96, 0xfd, 0x75, 0x66, 0x4f, 0xae, 0xf7, 0x44, 0xee, 0x4e, 0x52, 0xd7, 0x27, 0x1e, 0x2b,
+    0xbb, 0x76, 0x9f, 0x91, 0xed, 0x6f, 0x9b, 0x74, 0xd8, 0xb6, 0x94, 0xf5, 0x66, 0x06, 0x85, 0x2c },
+  { 0x7b, 0xa3, 0xae, 0x4a, 0x41, 0x7f, 0xe8, 0x54, 0x5b, 0x14, 0x2b, 0xc8, 0x9f, 0x4a, 0xdc, 0xd7,
+    0xae, 0x13, 0x94, 0x1c, 0xba, 0xb7, 0x75, 0x0b, 0x83, 0xe9, 0xf0, 0xa6, 0x6d, 0x16, 0xbe, 0x64 },
+  { 0x78, 0x8f, 0xaf, 0xcc, 0x4a, 0xa5, 0x20, 0x39, 0x9a, 0xdb, 0xae, 0xd1, 0x95, 0xf8, 0xb1, 0x2c,
+    0x4e, 0xb3, 0x1e, 0xc1, 0x01, 0x68, 0xe5, 0x0a, 0xab, 0xc6, 0x59, 0xa6, 0xae, 0xa5, 0x16, 0xdc },
+  { 0xe8, 0x33, 0xd7, 0xa6, 0x71, 0x60, 0xe6, 0x8b, 0xf4, 0xc9, 0x04, 0x4a, 0x53, 0x07, 0x7d, 0xf2,
+    0x72, 0x7a, 0xd0, 0x0c, 0xf3, 0x6f, 0x49, 0x49, 0xc7, 0xb6, 0x81, 0xa9, 0x12, 0x14, 0x0c, 0xbb },
+  { 0x30, 0x9e, 0xab, 0xf0, 0x95, 0xdc, 0x67, 0x14, 0xf9, 0xf4, 0xd8, 0x64, 0xbb, 0xa5, 0xaf, 0xfa,
+    0xe0, 0xb3, 0x5a, 0xe2, 0xf5, 0xe3, 0x56, 0x5b, 0xcc, 0x3a, 0x47, 0xb2, 0x12, 0x76, 0x77, 0x01 },
+  { 0x22, 0x6a, 0x8e, 0xbe, 0xfa, 0x28, 0x86, 0x65, 0xa6, 0x44, 0xa5, 0x02, 0x73, 0x33, 0x5e, 0xfb,
+    0xb6, 0x10, 0x51, 0x0f, 0x24, 0x1b, 0x5b, 0x72, 0x0c, 0x8a, 0x36, 0x8d, 0x59, 0xa6, 0x9a, 0x5d },
+  { 0x41, 0xab, 0xfd, 0x99, 0x54, 0x25, 0x82, 0x76, 0x25, 0x93, 0x81, 0x31, 0xaf, 0x0c, 0x4f, 0x33,
+    0xfe, 0x0b, 0xd4, 0x68, 0x8c, 0x22, 0x2c, 0x21, 0xfa, 0x9d, 0xa8, 0xe8, 0x9c, 0xaa, 0x03, 0xf8 },
+  { 0x44, 0x2c, 0x64, 0x2e, 0xf5, 0x0f, 0xa1, 0xa6, 0x67, 0xa6, 0xe6, 0xd1, 0x05, 0xc7, 0x7c, 0x5c,
+    0xc3, 0xfe, 0xc8, 0xd7, 0xaa, 0x25, 0x70, 0xcf, 0x1a, 0x30, 0x77, 0xb5, 0x03, 0xc3, 0x80, 0x69 },
+  { 0xa0, 0xa0, 0x8d, 0xfc, 0x9b, 0x42, 0xd9, 0x6c, 0x2d, 0xe1, 0x9b, 0x6d, 0x12, 0x7b, 0x8a, 0xe1,
+    0x36, 0xdd, 0xcf, 0x3e, 0x5a, 0xd0, 0xdc, 0xe4, 0x22, 0xc4, 0x5a, 0x56, 0xf6, 0x1f, 0x6a, 0x74 },
+  { 0x7d, 0x34, 0x83, 0x82, 0xaf, 0x09, 0x6d, 0xbe, 0x0b, 0xf0, 0x86, 0xc7, 0xbb, 0x39, 0xb2, 0xa2,
+    0xc0, 0xbc, 0x36, 0xb6, 0x21, 0xab, 0x0c, 0x73, 0x8e, 0x98, 0x85, 0xd7, 0x31, 0xd8, 0x17, 0x40 },
+  { 0x3a, 0xb1, 0x34, 0x75, 0x1d, 0x19, 0x12, 0x69, 0x02, 0x6c, 0x86, 0x99, 0x4e, 0xaa, 0x8b, 0x43,
+    0xa8, 0x3b, 0x4a, 0xd1, 0xf6, 0xd0, 0xe7, 0x73, 0x81, 0xc4, 0xe2, 0x97, 0x4a, 0xfb, 0xc8, 0xf6 },
+  { 0x9a, 0x74, 0x52, 0x61, 0x1d, 0xb2, 0xd2, 0x3e, 0xae, 0x26, 0xf9, 0xbd, 0xbb, 0x88, 0x95, 0x8e,
+    0xf4, 0x4c, 0x64, 0xd0, 0xfe, 0x98, 0x7b, 0xe9, 0xf7, 0x26, 0xad, 0xf9, 0x38, 0xf5, 0x0f, 0x6c },
+  { 0x72, 0x5c, 0x7f, 0x81, 0x60, 0x37, 0xbf, 0xe4, 0x52, 0xcd, 0x1e, 0x7b, 0xa3, 0x5a, 0xc4, 0x7e,
+    0xdc, 0xb4, 0x9a, 0x9a, 0x2b, 0x27, 0xae, 0xca, 0x70, 0xdc, 0xe4, 0x83, 0xcb, 0x7d, 0xed, 0x1f },
+  { 0x2c, 0xea, 0x1a, 0xf5, 0x1f, 0xb2, 0x8b, 0x62, 0x88, 0x7c, 0x39, 0x99, 0x8a, 0xc9, 0xfe, 0xf4,
+    0xdf, 0xde, 0xda, 0x1f, 0x07, 0xe0, 0x71, 0xba, 0x55, 0x8a, 0x17, 0x3a, 0xfd, 0x06, 0xcb, 0xc3 },
+  { 0xff, 0x1d, 0x59, 0xf9, 0x8b, 0x6c, 0x55, 0x1d, 0x95, 0x08, 0x93, 0x57, 0x05, 0x7d, 0x5c, 0x8b,
+    0xe2, 0x64, 0x02, 0x27, 0x9e, 0x9d, 0xf0, 0xb1, 0xdf, 0x1a, 0x10, 0xb7, 0x2b, 0xf3, 0x92, 0x7f },
+  { 0x2f, 0x8a, 0x18, 0x1f, 0x7c, 0x99, 0xdd, 0x21, 0x5a, 0x75, 0x29, 0xbf, 0xe2, 0x96, 0xa9, 0x60,
+    0x3a, 0x14, 0x46, 0x73, 0x71, 0x86, 0xd2, 0x1a, 0xeb, 0x8b, 0xc7, 0xae, 0x59, 0xe1, 0xfd, 0x21 },
+  { 0xec, 0xc5, 0x02, 0xc9, 0xb1, 0x14, 0x5f, 0x39, 0x50, 0xcb, 0x7d, 0x3e, 0x38, 0x42, 0x44, 0x6f,
+    0x81, 0xa4, 0xf0, 0xdf, 0x1d, 0xf5, 0x37, 0xce, 0xe1, 0x39, 0xef, 0x64, 0xea, 0x98, 0x4b, 0xd9 }
+};
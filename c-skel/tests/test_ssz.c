@@ -1,8 +1,19 @@
+#define _POSIX_C_SOURCE 200809L
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <assert.h>
+#include <unistd.h>
 #include "../include/ssz_stream.h"
+#include "../include/ssz_fd.h"
+#include "../include/ssz_snappy.h"
+#include "../include/ssz_era.h"
+#include "../include/ssz_kernels.h"
+#include "../include/ssz_view.h"
+#include "../include/ssz_encode.h"
+#include "../include/ssz_reroot.h"
+#include "../include/ssz_trace.h"
+#include "../include/ssz_resume.h"
 
 /* Test framework */
 static int tests_run = 0;
@@ -527,6 +538,2107 @@ TEST(stress_all_ones) {
     ASSERT_EQ(ret, 0);
 }
 
+/* ===== WORKSPACE TESTS ===== */
+
+TEST(workspace_matches_default_path) {
+    uint8_t data[1000];
+    for (int i = 0; i < 1000; i++) data[i] = i % 251;
+    uint8_t expected[32] = {0xce, 0x76, 0x3a, 0x89, 0x8e, 0xde, 0x2a, 0x1a, 0xc9, 0x5e, 0x83, 0x06, 0x52, 0xfb, 0x1c, 0xaa,
+                            0xbd, 0x08, 0xa7, 0x9d, 0x75, 0x90, 0x9d, 0x74, 0xa3, 0x21, 0xc5, 0x1c, 0xc3, 0xc9, 0xda, 0xe7};
+    uint8_t root[32];
+    uint8_t ws_root[32];
+    char err[128] = {0};
+    TypeDesc elem_td = {SSZ_KIND_BASIC, 1, NULL, NULL, 0, 0};
+    TypeDesc td = {SSZ_KIND_LIST, 0, &elem_td, NULL, 0, 1000};
+
+    size_t need = ssz_workspace_size(&td, sizeof(data));
+    uint8_t *mem = malloc(need);
+    ssz_workspace_t ws;
+    ssz_workspace_init(&ws, mem, need);
+
+    ASSERT_EQ(ssz_stream_root_from_buffer(data, sizeof(data), &td, root, err), 0);
+    ASSERT_EQ(ssz_stream_root_from_buffer_ws(&ws, data, sizeof(data), &td, ws_root, err), 0);
+    ASSERT_BYTES_EQ(root, expected, 32);
+    ASSERT_BYTES_EQ(ws_root, expected, 32);
+    ASSERT_EQ(ws.peak <= need, 1);
+    free(mem);
+}
+
+TEST(workspace_nested_container) {
+    uint8_t data[17];
+    for (int i = 0; i < 17; i++) data[i] = i;
+    uint8_t expected[32] = {0xf7, 0x47, 0xfc, 0x7a, 0x43, 0x61, 0xfe, 0xb9, 0xfe, 0xff, 0x64, 0x54, 0x54, 0x2b, 0x0b, 0x99,
+                            0x99, 0xb6, 0x87, 0x9a, 0x2f, 0xb4, 0x19, 0x42, 0xe4, 0x76, 0x60, 0x0e, 0xcf, 0x2b, 0x68, 0x3a};
+    uint8_t root[32];
+    char err[128] = {0};
+    TypeDesc u8_td = {SSZ_KIND_BASIC, 1, NULL, NULL, 0, 0};
+    TypeDesc u64_td = {SSZ_KIND_BASIC, 8, NULL, NULL, 0, 0};
+    const void *fields[3] = {&u64_td, &u64_td, &u8_td};
+    TypeDesc td = {SSZ_KIND_CONTAINER, 17, NULL, fields, 3, 0};
+
+    uint8_t mem[256];
+    ssz_workspace_t ws;
+    ssz_workspace_init(&ws, mem, sizeof(mem));
+    ASSERT_EQ(ssz_workspace_size(&td, sizeof(data)) <= sizeof(mem), 1);
+    ASSERT_EQ(ssz_stream_root_from_buffer_ws(&ws, data, sizeof(data), &td, root, err), 0);
+    ASSERT_BYTES_EQ(root, expected, 32);
+}
+
+TEST(workspace_reused_across_calls) {
+    uint8_t data[256];
+    for (int i = 0; i < 256; i++) data[i] = i;
+    uint8_t first[32];
+    uint8_t second[32];
+    char err[128] = {0};
+    TypeDesc elem_td = {SSZ_KIND_BASIC, 1, NULL, NULL, 0, 0};
+    TypeDesc td = {SSZ_KIND_LIST, 0, &elem_td, NULL, 0, 500};
+
+    uint8_t mem[512];
+    ssz_workspace_t ws;
+    ssz_workspace_init(&ws, mem, sizeof(mem));
+    ASSERT_EQ(ssz_stream_root_from_buffer_ws(&ws, data, 256, &td, first, err), 0);
+    ASSERT_EQ(ws.used, 0);
+    ASSERT_EQ(ssz_stream_root_from_buffer_ws(&ws, data, 256, &td, second, err), 0);
+    ASSERT_BYTES_EQ(first, second, 32);
+}
+
+TEST(workspace_exhausted) {
+    uint8_t data[256];
+    memset(data, 0x11, sizeof(data));
+    uint8_t root[32];
+    char err[128] = {0};
+    TypeDesc elem_td = {SSZ_KIND_BASIC, 1, NULL, NULL, 0, 0};
+    TypeDesc td = {SSZ_KIND_LIST, 0, &elem_td, NULL, 0, 500};
+
+    uint8_t mem[16];
+    ssz_workspace_t ws;
+    ssz_workspace_init(&ws, mem, sizeof(mem));
+    ASSERT_EQ(ssz_stream_root_from_buffer_ws(&ws, data, 256, &td, root, err), SSZ_ERR_WORKSPACE_EXHAUSTED);
+}
+
+/* Root of td over data through the sized workspace API, for comparing the
+ * entry points that pick their own scratch */
+static int root_with_sized_workspace(const uint8_t *data, size_t len, const TypeDesc *td, uint8_t root[32]) {
+    char err[128] = {0};
+    size_t need = ssz_workspace_size(td, len);
+    uint8_t *mem = malloc(need);
+    ssz_workspace_t ws;
+    ssz_workspace_init(&ws, mem, need);
+    int result = ssz_stream_root_from_buffer_ws(&ws, data, len, td, root, err);
+    free(mem);
+    return result;
+}
+
+/* 1000 levels of {uint8, <inner>} around a List[uint8]; level i encodes as
+ * its byte, the offset 5, then level i - 1 */
+#define DEEP_LEVELS 1000
+static TypeDesc deep_types[DEEP_LEVELS + 1];
+static const void *deep_fields[DEEP_LEVELS][2];
+static uint8_t deep_data[DEEP_LEVELS * 5 + 3];
+
+static void build_deep(void) {
+    static TypeDesc u8_td = {SSZ_KIND_BASIC, 1, NULL, NULL, 0, 0};
+    deep_types[0] = (TypeDesc){SSZ_KIND_LIST, 0, &u8_td, NULL, 0, 16};
+    for (int i = 1; i <= DEEP_LEVELS; i++) {
+        deep_fields[i - 1][0] = &u8_td;
+        deep_fields[i - 1][1] = &deep_types[i - 1];
+        deep_types[i] = (TypeDesc){SSZ_KIND_CONTAINER, 0, NULL, deep_fields[i - 1], 2, 0};
+    }
+    for (int i = 0; i < DEEP_LEVELS; i++) {
+        uint8_t *p = deep_data + i * 5;
+        p[0] = (uint8_t)i;
+        p[1] = 5;
+        p[2] = p[3] = p[4] = 0;
+    }
+    memcpy(deep_data + DEEP_LEVELS * 5, "\x01\x02\x03", 3);
+}
+
+/* 500 List[uint8] fields of one byte each */
+#define WIDE_FIELDS 500
+static TypeDesc wide_td;
+static const void *wide_fields[WIDE_FIELDS];
+static uint8_t wide_data[WIDE_FIELDS * 5];
+
+static void build_wide(void) {
+    static TypeDesc u8_td = {SSZ_KIND_BASIC, 1, NULL, NULL, 0, 0};
+    static TypeDesc bytes_td = {SSZ_KIND_LIST, 0, &u8_td, NULL, 0, 16};
+    for (int i = 0; i < WIDE_FIELDS; i++) {
+        uint32_t off = WIDE_FIELDS * 4 + i;
+        wide_fields[i] = &bytes_td;
+        for (int b = 0; b < 4; b++) wide_data[i * 4 + b] = (uint8_t)(off >> (8 * b));
+        wide_data[off] = (uint8_t)i;
+    }
+    wide_td = (TypeDesc){SSZ_KIND_CONTAINER, 0, NULL, wide_fields, WIDE_FIELDS, 0};
+}
+
+/* Without a caller workspace, depth and width are bounded by memory only */
+TEST(default_workspace_deep_nesting) {
+    build_deep();
+    uint8_t root[32];
+    uint8_t expected[32];
+    char err[128] = {0};
+    ASSERT_EQ(root_with_sized_workspace(deep_data, sizeof(deep_data), &deep_types[DEEP_LEVELS], expected), 0);
+    ASSERT_EQ(ssz_stream_root_from_buffer(deep_data, sizeof(deep_data), &deep_types[DEEP_LEVELS], root, err), 0);
+    ASSERT_BYTES_EQ(root, expected, 32);
+    ASSERT_EQ(ssz_stream_root_from_buffer(deep_data + 5 * (DEEP_LEVELS - 19), 5 * 19 + 3, &deep_types[19], root,
+                                          err), 0);
+}
+
+TEST(default_workspace_wide_container) {
+    build_wide();
+    uint8_t root[32];
+    uint8_t expected[32];
+    char err[128] = {0};
+    ASSERT_EQ(root_with_sized_workspace(wide_data, sizeof(wide_data), &wide_td, expected), 0);
+    ASSERT_EQ(ssz_stream_root_from_buffer(wide_data, sizeof(wide_data), &wide_td, root, err), 0);
+    ASSERT_BYTES_EQ(root, expected, 32);
+}
+
+/* ssz_validate draws the same scratch as hashing: deep and wide values pass
+ * or fail both the same way */
+TEST(default_workspace_validate_matches_root) {
+    build_deep();
+    build_wide();
+    uint8_t root[32];
+    char err[128] = {0};
+    const int depths[] = {18, 19, 20, DEEP_LEVELS};
+    for (int d = 0; d < 4; d++) {
+        const uint8_t *data = deep_data + 5 * (DEEP_LEVELS - depths[d]);
+        size_t len = 5 * (size_t)depths[d] + 3;
+        const TypeDesc *td = &deep_types[depths[d]];
+        ASSERT_EQ(ssz_validate(data, len, td, err), 0);
+        ASSERT_EQ(ssz_stream_root_from_buffer(data, len, td, root, err), 0);
+    }
+    deep_data[5 * 500 + 1] = 4; /* an offset pointing into its own header */
+    ASSERT_EQ(ssz_validate(deep_data, sizeof(deep_data), &deep_types[DEEP_LEVELS], err),
+              ssz_stream_root_from_buffer(deep_data, sizeof(deep_data), &deep_types[DEEP_LEVELS], root, err));
+    ASSERT_EQ(ssz_validate(deep_data, sizeof(deep_data), &deep_types[DEEP_LEVELS], err) != 0, 1);
+    deep_data[5 * 500 + 1] = 5;
+
+    for (uint32_t fields = 300; fields <= WIDE_FIELDS; fields += 200) {
+        /* The first `fields` fields, with their offsets rebased */
+        static uint8_t data[WIDE_FIELDS * 5];
+        for (uint32_t i = 0; i < fields; i++) {
+            uint32_t off = fields * 4 + i;
+            for (int b = 0; b < 4; b++) data[i * 4 + b] = (uint8_t)(off >> (8 * b));
+            data[off] = (uint8_t)i;
+        }
+        TypeDesc td = wide_td;
+        td.field_count = fields;
+        ASSERT_EQ(ssz_validate(data, fields * 5, &td, err), 0);
+        ASSERT_EQ(ssz_stream_root_from_buffer(data, fields * 5, &td, root, err), 0);
+        data[4] ^= 0x80; /* field 1's offset past field 2's */
+        ASSERT_EQ(ssz_validate(data, fields * 5, &td, err) != 0, 1);
+        ASSERT_EQ(ssz_validate(data, fields * 5, &td, err),
+                  ssz_stream_root_from_buffer(data, fields * 5, &td, root, err));
+    }
+}
+
+/* ===== READER TESTS ===== */
+
+typedef struct {
+    const uint8_t *data;
+    size_t len;
+    size_t pos;
+    size_t step;
+} SliceReader;
+
+/* Hands out at most `step` bytes per call to exercise chunk reassembly */
+static size_t slice_reader(uint8_t *buf, size_t buf_size, void *ctx) {
+    SliceReader *r = (SliceReader *)ctx;
+    size_t n = r->len - r->pos;
+    if (n > r->step) n = r->step;
+    if (n > buf_size) n = buf_size;
+    memcpy(buf, r->data + r->pos, n);
+    r->pos += n;
+    return n;
+}
+
+static void check_reader_matches_buffer(const uint8_t *data, size_t len, const TypeDesc *td) {
+    static const size_t steps[] = {1, 7, 32, 33, 4096};
+    uint8_t expected[32];
+    char err[128] = {0};
+    ASSERT_EQ(ssz_stream_root_from_buffer(data, len, td, expected, err), 0);
+    for (size_t i = 0; i < sizeof(steps) / sizeof(steps[0]); i++) {
+        SliceReader r = {data, len, 0, steps[i]};
+        uint8_t root[32];
+        ASSERT_EQ(ssz_stream_root_from_reader(slice_reader, &r, td, root, err), 0);
+        ASSERT_BYTES_EQ(root, expected, 32);
+    }
+}
+
+TEST(reader_basic_and_packed) {
+    uint8_t data[1000];
+    for (int i = 0; i < 1000; i++) data[i] = i % 251;
+    TypeDesc u8_td = {SSZ_KIND_BASIC, 1, NULL, NULL, 0, 0};
+    TypeDesc u64_td = {SSZ_KIND_BASIC, 8, NULL, NULL, 0, 0};
+    TypeDesc list_td = {SSZ_KIND_LIST, 0, &u8_td, NULL, 0, 1000};
+    TypeDesc vec_td = {SSZ_KIND_VECTOR, 0, &u64_td, NULL, 0, 0};
+    check_reader_matches_buffer(data, 8, &u64_td);
+    check_reader_matches_buffer(data, 0, &list_td);
+    check_reader_matches_buffer(data, 1000, &list_td);
+    check_reader_matches_buffer(data, 160, &vec_td);
+}
+
+TEST(reader_bitlist) {
+    uint8_t data[70];
+    for (int i = 0; i < 69; i++) data[i] = i;
+    TypeDesc td = {SSZ_KIND_BITLIST, 0, NULL, NULL, 0, 2048};
+    size_t lens[] = {1, 2, 32, 33, 34, 65, 66, 70};
+    for (size_t i = 0; i < sizeof(lens) / sizeof(lens[0]); i++) {
+        data[lens[i] - 1] = 0x05;
+        check_reader_matches_buffer(data, lens[i], &td);
+        data[lens[i] - 1] = (uint8_t)(lens[i] - 1);
+    }
+}
+
+TEST(reader_container) {
+    uint8_t data[17];
+    for (int i = 0; i < 17; i++) data[i] = i;
+    TypeDesc u8_td = {SSZ_KIND_BASIC, 1, NULL, NULL, 0, 0};
+    TypeDesc u64_td = {SSZ_KIND_BASIC, 8, NULL, NULL, 0, 0};
+    const void *fields[3] = {&u64_td, &u64_td, &u8_td};
+    TypeDesc td = {SSZ_KIND_CONTAINER, 17, NULL, fields, 3, 0};
+    check_reader_matches_buffer(data, 17, &td);
+}
+
+TEST(reader_truncated_container) {
+    uint8_t data[12] = {0};
+    uint8_t root[32];
+    char err[128] = {0};
+    TypeDesc u64_td = {SSZ_KIND_BASIC, 8, NULL, NULL, 0, 0};
+    const void *fields[2] = {&u64_td, &u64_td};
+    TypeDesc td = {SSZ_KIND_CONTAINER, 16, NULL, fields, 2, 0};
+    SliceReader r = {data, sizeof(data), 0, 5};
+    ASSERT_EQ(ssz_stream_root_from_reader(slice_reader, &r, &td, root, err), SSZ_ERR_UNEXPECTED_EOF);
+}
+
+TEST(reader_trailing_bytes) {
+    uint8_t data[9] = {0};
+    uint8_t root[32];
+    char err[128] = {0};
+    TypeDesc u64_td = {SSZ_KIND_BASIC, 8, NULL, NULL, 0, 0};
+    SliceReader r = {data, sizeof(data), 0, 4096};
+    ASSERT_EQ(ssz_stream_root_from_reader(slice_reader, &r, &u64_td, root, err), SSZ_ERR_NON_CANONICAL);
+}
+
+/* ===== FILE DESCRIPTOR TESTS ===== */
+
+TEST(fd_file_matches_buffer) {
+    size_t len = 300000;
+    uint8_t *data = malloc(len);
+    for (size_t i = 0; i < len; i++) data[i] = (uint8_t)(i * 31 + 7);
+    uint8_t expected[32];
+    uint8_t root[32];
+    char err[128] = {0};
+    TypeDesc elem_td = {SSZ_KIND_BASIC, 8, NULL, NULL, 0, 0};
+    TypeDesc td = {SSZ_KIND_LIST, 0, &elem_td, NULL, 0, 1 << 20};
+    ASSERT_EQ(ssz_stream_root_from_buffer(data, len, &td, expected, err), 0);
+
+    FILE *f = tmpfile();
+    ASSERT_EQ(fwrite(data, 1, len, f), len);
+    fflush(f);
+
+    for (int disable_uring = 0; disable_uring <= 1; disable_uring++) {
+        ssz_fd_stats_t stats;
+        ssz_fd_opts_t opts = {4096, 3, disable_uring, 0, &stats};
+        ASSERT_EQ(ssz_stream_root_from_fd(fileno(f), &td, root, &opts, err), 0);
+        ASSERT_BYTES_EQ(root, expected, 32);
+        ASSERT_EQ(stats.bytes_read, len);
+    }
+
+    /* Default options: one buffer larger than the whole file */
+    ASSERT_EQ(ssz_stream_root_from_fd(fileno(f), &td, root, NULL, err), 0);
+    ASSERT_BYTES_EQ(root, expected, 32);
+
+    fclose(f);
+    free(data);
+}
+
+TEST(fd_pipe_matches_buffer) {
+    uint8_t data[20000];
+    for (size_t i = 0; i < sizeof(data); i++) data[i] = (uint8_t)(i ^ (i >> 8));
+    uint8_t expected[32];
+    uint8_t root[32];
+    char err[128] = {0};
+    TypeDesc elem_td = {SSZ_KIND_BASIC, 1, NULL, NULL, 0, 0};
+    TypeDesc td = {SSZ_KIND_LIST, 0, &elem_td, NULL, 0, 1 << 20};
+    ASSERT_EQ(ssz_stream_root_from_buffer(data, sizeof(data), &td, expected, err), 0);
+
+    int fds[2];
+    ASSERT_EQ(pipe(fds), 0);
+    ASSERT_EQ(write(fds[1], data, sizeof(data)), (ssize_t)sizeof(data));
+    close(fds[1]);
+
+    ssz_fd_stats_t stats;
+    ssz_fd_opts_t opts = {4096, 2, 0, 0, &stats};
+    ASSERT_EQ(ssz_stream_root_from_fd(fds[0], &td, root, &opts, err), 0);
+    ASSERT_BYTES_EQ(root, expected, 32);
+    ASSERT_EQ(strcmp(stats.backend, "read"), 0);
+    close(fds[0]);
+}
+
+/* ===== SNAPPY TESTS ===== */
+
+static ssz_snappy_reader_t snappy_reader;
+
+static size_t frame_header(uint8_t *out, uint8_t type, size_t len) {
+    out[0] = type;
+    out[1] = (uint8_t)len;
+    out[2] = (uint8_t)(len >> 8);
+    out[3] = (uint8_t)(len >> 16);
+    return 4;
+}
+
+static size_t frame_stream_id(uint8_t *out) {
+    size_t n = frame_header(out, 0xff, 6);
+    memcpy(out + n, "sNaPpY", 6);
+    return n + 6;
+}
+
+static void put_masked_crc(uint8_t *out, const uint8_t *data, size_t len) {
+    uint32_t crc = ssz_crc32c(0, data, len);
+    crc = ((crc >> 15) | (crc << 17)) + 0xa282ead8u;
+    for (int i = 0; i < 4; i++) out[i] = (uint8_t)(crc >> (8 * i));
+}
+
+/* Frames data as uncompressed chunks of at most chunk bytes */
+static size_t frame_uncompressed(uint8_t *out, const uint8_t *data, size_t len, size_t chunk) {
+    size_t n = frame_stream_id(out);
+    for (size_t off = 0; off < len; off += chunk) {
+        size_t take = len - off < chunk ? len - off : chunk;
+        n += frame_header(out + n, 0x01, take + 4);
+        put_masked_crc(out + n, data + off, take);
+        memcpy(out + n + 4, data + off, take);
+        n += 4 + take;
+    }
+    return n;
+}
+
+TEST(crc32c_check_value) {
+    ASSERT_EQ(ssz_crc32c(0, (const uint8_t *)"123456789", 9) == 0xE3069283u, 1);
+    /* Incremental updates match one-shot */
+    uint32_t crc = ssz_crc32c(0, (const uint8_t *)"1234", 4);
+    ASSERT_EQ(ssz_crc32c(crc, (const uint8_t *)"56789", 5) == 0xE3069283u, 1);
+}
+
+TEST(snappy_uncompressed_matches_buffer) {
+    size_t len = 150000;
+    uint8_t *data = malloc(len);
+    uint8_t *framed = malloc(len + 64);
+    for (size_t i = 0; i < len; i++) data[i] = (uint8_t)(i % 251);
+    uint8_t expected[32];
+    uint8_t root[32];
+    char err[128] = {0};
+    TypeDesc elem_td = {SSZ_KIND_BASIC, 8, NULL, NULL, 0, 0};
+    TypeDesc td = {SSZ_KIND_LIST, 0, &elem_td, NULL, 0, 1 << 20};
+    ASSERT_EQ(ssz_stream_root_from_buffer(data, len, &td, expected, err), 0);
+
+    size_t n = frame_uncompressed(framed, data, len, 65536);
+    size_t steps[] = {3, 4096, 1 << 20};
+    for (size_t i = 0; i < sizeof(steps) / sizeof(steps[0]); i++) {
+        SliceReader r = {framed, n, 0, steps[i]};
+        ASSERT_EQ(ssz_snappy_root_from_reader(&snappy_reader, slice_reader, &r, &td, root, err), 0);
+        ASSERT_BYTES_EQ(root, expected, 32);
+    }
+    free(framed);
+    free(data);
+}
+
+TEST(snappy_compressed_copies) {
+    uint8_t data[40];
+    for (int i = 0; i < 40; i++) data[i] = "abcd"[i % 4];
+    /* literal "abcd", copy1 len 8 offset 4, copy2 len 28 offset 12 */
+    static const uint8_t block[] = {40, 0x0c, 'a', 'b', 'c', 'd', 0x11, 0x04, 0x6e, 0x0c, 0x00};
+    uint8_t framed[64];
+    size_t n = frame_stream_id(framed);
+    n += frame_header(framed + n, 0x00, 4 + sizeof(block));
+    put_masked_crc(framed + n, data, sizeof(data));
+    memcpy(framed + n + 4, block, sizeof(block));
+    n += 4 + sizeof(block);
+    /* Trailing padding chunk is skipped */
+    n += frame_header(framed + n, 0xfe, 2);
+    framed[n++] = 0;
+    framed[n++] = 0;
+
+    uint8_t expected[32];
+    uint8_t root[32];
+    char err[128] = {0};
+    TypeDesc elem_td = {SSZ_KIND_BASIC, 1, NULL, NULL, 0, 0};
+    TypeDesc td = {SSZ_KIND_LIST, 0, &elem_td, NULL, 0, 100};
+    ASSERT_EQ(ssz_stream_root_from_buffer(data, sizeof(data), &td, expected, err), 0);
+    SliceReader r = {framed, n, 0, 5};
+    ASSERT_EQ(ssz_snappy_root_from_reader(&snappy_reader, slice_reader, &r, &td, root, err), 0);
+    ASSERT_BYTES_EQ(root, expected, 32);
+}
+
+TEST(snappy_bad_crc) {
+    uint8_t data[64];
+    uint8_t framed[128];
+    uint8_t root[32];
+    char err[128] = {0};
+    memset(data, 0x42, sizeof(data));
+    size_t n = frame_uncompressed(framed, data, sizeof(data), 64);
+    framed[n - 1] ^= 1;
+    TypeDesc elem_td = {SSZ_KIND_BASIC, 1, NULL, NULL, 0, 0};
+    TypeDesc td = {SSZ_KIND_LIST, 0, &elem_td, NULL, 0, 100};
+    SliceReader r = {framed, n, 0, 4096};
+    ASSERT_EQ(ssz_snappy_root_from_reader(&snappy_reader, slice_reader, &r, &td, root, err), SSZ_ERR_MALFORMED_HEADER);
+    ASSERT_EQ(strstr(err, "CRC") != NULL, 1);
+}
+
+TEST(snappy_missing_stream_id) {
+    uint8_t data[16] = {0};
+    uint8_t framed[64];
+    uint8_t root[32];
+    char err[128] = {0};
+    size_t n = frame_uncompressed(framed, data, sizeof(data), 16);
+    TypeDesc elem_td = {SSZ_KIND_BASIC, 1, NULL, NULL, 0, 0};
+    TypeDesc td = {SSZ_KIND_LIST, 0, &elem_td, NULL, 0, 100};
+    SliceReader r = {framed + 10, n - 10, 0, 4096};
+    ASSERT_EQ(ssz_snappy_root_from_reader(&snappy_reader, slice_reader, &r, &td, root, err), SSZ_ERR_MALFORMED_HEADER);
+}
+
+/* ===== ERA ARCHIVE TESTS ===== */
+
+static size_t e2_record(uint8_t *out, uint16_t type, const uint8_t *data, size_t len) {
+    out[0] = (uint8_t)type;
+    out[1] = (uint8_t)(type >> 8);
+    for (int i = 0; i < 4; i++) out[2 + i] = (uint8_t)(len >> (8 * i));
+    out[6] = 0;
+    out[7] = 0;
+    if (len) memcpy(out + 8, data, len);
+    return 8 + len;
+}
+
+static void put_le64(uint8_t *out, uint64_t v) {
+    for (int i = 0; i < 8; i++) out[i] = (uint8_t)(v >> (8 * i));
+}
+
+typedef struct {
+    uint8_t bytes[4096];
+    size_t len;
+    size_t block_at[2];
+    size_t state_at;
+    size_t index_at;
+    uint8_t payload[3][300];
+} EraFixture;
+
+/* version | block | block | state | block index (3 slots, one empty) | state index */
+static void build_era(EraFixture *e) {
+    uint8_t framed[512];
+    uint8_t index[64];
+    size_t n = 0;
+    for (int k = 0; k < 3; k++) {
+        for (int i = 0; i < 300; i++) e->payload[k][i] = (uint8_t)(i * (k + 3));
+    }
+
+    n += e2_record(e->bytes + n, SSZ_E2_TYPE_VERSION, NULL, 0);
+    for (int k = 0; k < 2; k++) {
+        e->block_at[k] = n;
+        size_t flen = frame_uncompressed(framed, e->payload[k], 100 + 100 * k, 64);
+        n += e2_record(e->bytes + n, SSZ_E2_TYPE_BLOCK, framed, flen);
+    }
+    e->state_at = n;
+    n += e2_record(e->bytes + n, SSZ_E2_TYPE_STATE, framed, frame_uncompressed(framed, e->payload[2], 300, 128));
+
+    e->index_at = n;
+    put_le64(index, 100);
+    put_le64(index + 8, (uint64_t)((int64_t)e->block_at[0] - (int64_t)n));
+    put_le64(index + 16, 0);
+    put_le64(index + 24, (uint64_t)((int64_t)e->block_at[1] - (int64_t)n));
+    put_le64(index + 32, 3);
+    n += e2_record(e->bytes + n, SSZ_E2_TYPE_SLOT_INDEX, index, 40);
+
+    put_le64(index, 103);
+    put_le64(index + 8, (uint64_t)((int64_t)e->state_at - (int64_t)n));
+    put_le64(index + 16, 1);
+    n += e2_record(e->bytes + n, SSZ_E2_TYPE_SLOT_INDEX, index, 24);
+    e->len = n;
+}
+
+static EraFixture era;
+
+TEST(era_records_match_buffer_roots) {
+    build_era(&era);
+    TypeDesc u8_td = {SSZ_KIND_BASIC, 1, NULL, NULL, 0, 0};
+    TypeDesc td = {SSZ_KIND_LIST, 0, &u8_td, NULL, 0, 1 << 20};
+    ssz_era_opts_t opts = {&td, &td, 3};
+    ssz_era_report_t report;
+    char err[128] = {0};
+    ASSERT_EQ(ssz_era_verify_buffer(era.bytes, era.len, &opts, &report, err), 0);
+    ASSERT_EQ(report.record_count, 6);
+    ASSERT_EQ(report.index_mismatches, 0);
+    ASSERT_EQ(report.ssz_bytes, 100 + 200 + 300);
+
+    size_t lens[3] = {100, 200, 300};
+    int64_t slots[3] = {100, 102, 103};
+    for (int k = 0; k < 3; k++) {
+        const ssz_era_record_t *r = &report.records[1 + k];
+        uint8_t expected[32];
+        ASSERT_EQ(ssz_stream_root_from_buffer(era.payload[k], lens[k], &td, expected, err), 0);
+        ASSERT_EQ(r->hashed, 1);
+        ASSERT_EQ(r->slot, slots[k]);
+        ASSERT_BYTES_EQ(r->root, expected, 32);
+    }
+    ssz_era_report_free(&report);
+}
+
+TEST(era_index_mismatch) {
+    build_era(&era);
+    /* Point slot 102 at the version record */
+    put_le64(era.bytes + era.index_at + 8 + 24, (uint64_t)(0 - (int64_t)era.index_at));
+    ssz_era_report_t report;
+    char err[128] = {0};
+    ASSERT_EQ(ssz_era_verify_buffer(era.bytes, era.len, NULL, &report, err), SSZ_ERR_BAD_OFFSET);
+    ASSERT_EQ(report.index_mismatches, 1);
+    ASSERT_EQ(report.records[2].slot, -1);
+    ASSERT_EQ(report.records[1].hashed, 1);
+    ssz_era_report_free(&report);
+}
+
+TEST(era_corrupt_record) {
+    build_era(&era);
+    era.bytes[era.state_at + 40] ^= 0xff;
+    ssz_era_report_t report;
+    char err[128] = {0};
+    ASSERT_EQ(ssz_era_verify_buffer(era.bytes, era.len, NULL, &report, err), SSZ_ERR_MALFORMED_HEADER);
+    ASSERT_EQ(report.failed_records, 1);
+    ASSERT_EQ(report.records[3].hashed, 0);
+    ASSERT_EQ(report.records[1].hashed, 1);
+    ssz_era_report_free(&report);
+}
+
+TEST(era_truncated_file) {
+    build_era(&era);
+    char path[] = "/tmp/ssz_era_XXXXXX";
+    int fd = mkstemp(path);
+    ASSERT_EQ(fd >= 0, 1);
+    ASSERT_EQ(write(fd, era.bytes, era.len - 3), (ssize_t)(era.len - 3));
+    close(fd);
+    ssz_era_report_t report;
+    char err[128] = {0};
+    ASSERT_EQ(ssz_era_verify_file(path, NULL, &report, err), SSZ_ERR_UNEXPECTED_EOF);
+    ASSERT_EQ(report.records == NULL, 1);
+    unlink(path);
+}
+
+/* ===== SPARSE (ZERO-RUN) TESTS ===== */
+
+extern void sha256_hash(const uint8_t *data, size_t len, uint8_t out[32]);
+
+/* Chunk-by-chunk carry merkleizer with no zero shortcuts, as the reference */
+static void reference_root(const uint8_t *bytes, size_t len, uint8_t out[32]) {
+    uint8_t stack[65][32];
+    uint32_t heights[65];
+    uint32_t depth = 0;
+    uint8_t pair[64];
+    for (size_t off = 0; off < len; off += 32) {
+        memset(stack[depth], 0, 32);
+        memcpy(stack[depth], bytes + off, len - off < 32 ? len - off : 32);
+        heights[depth++] = 0;
+        while (depth >= 2 && heights[depth - 2] == heights[depth - 1]) {
+            memcpy(pair, stack[depth - 2], 32);
+            memcpy(pair + 32, stack[depth - 1], 32);
+            depth--;
+            sha256_hash(pair, 64, stack[depth - 1]);
+            heights[depth - 1]++;
+        }
+    }
+    while (depth > 1) {
+        memcpy(pair, stack[depth - 2], 32);
+        memcpy(pair + 32, stack[depth - 1], 32);
+        depth--;
+        sha256_hash(pair, 64, stack[depth - 1]);
+    }
+    if (depth == 0) memset(out, 0, 32);
+    else memcpy(out, stack[0], 32);
+}
+
+TEST(sparse_vector_matches_reference) {
+    size_t len = 1000 * 32 + 23;
+    uint8_t *data = calloc(len, 1);
+    uint8_t expected[32];
+    uint8_t root[32];
+    char err[128] = {0};
+    TypeDesc u8_td = {SSZ_KIND_BASIC, 1, NULL, NULL, 0, 0};
+    TypeDesc td = {SSZ_KIND_VECTOR, 0, &u8_td, NULL, 0, 0};
+
+    /* All zero, then non-zero bytes at chunk positions that break alignment */
+    size_t marks[] = {0, 1, 3, 64, 511, 512, 777, 999, 1000};
+    for (size_t i = 0; i <= sizeof(marks) / sizeof(marks[0]); i++) {
+        if (i > 0) data[marks[i - 1] * 32 + (i % 32)] = (uint8_t)(0x10 + i);
+        size_t lens[] = {len, 1000 * 32, 37 * 32, 64 * 32, 32};
+        for (size_t k = 0; k < sizeof(lens) / sizeof(lens[0]); k++) {
+            reference_root(data, lens[k], expected);
+            ASSERT_EQ(ssz_stream_root_from_buffer(data, lens[k], &td, root, err), 0);
+            ASSERT_BYTES_EQ(root, expected, 32);
+            SliceReader r = {data, lens[k], 0, 4096};
+            ASSERT_EQ(ssz_stream_root_from_reader(slice_reader, &r, &td, root, err), 0);
+            ASSERT_BYTES_EQ(root, expected, 32);
+        }
+    }
+    free(data);
+}
+
+TEST(sparse_all_zero_uses_zero_hashes) {
+    uint8_t data[64 * 32] = {0};
+    uint8_t root[32];
+    uint8_t expected[32];
+    char err[128] = {0};
+    TypeDesc u8_td = {SSZ_KIND_BASIC, 1, NULL, NULL, 0, 0};
+    TypeDesc td = {SSZ_KIND_VECTOR, 0, &u8_td, NULL, 0, 0};
+    /* Root of 64 zero chunks is zero_hashes[6] */
+    static const uint8_t zero6[32] = {
+        0xd8, 0x8d, 0xdf, 0xee, 0xd4, 0x00, 0xa8, 0x75, 0x55, 0x96, 0xb2, 0x19, 0x42, 0xc1, 0x49, 0x7e,
+        0x11, 0x4c, 0x30, 0x2e, 0x61, 0x18, 0x29, 0x0f, 0x91, 0xe6, 0x77, 0x29, 0x76, 0x04, 0x1f, 0xa1 };
+    ASSERT_EQ(ssz_stream_root_from_buffer(data, sizeof(data), &td, root, err), 0);
+    reference_root(data, sizeof(data), expected);
+    ASSERT_BYTES_EQ(expected, zero6, 32);
+    ASSERT_BYTES_EQ(root, zero6, 32);
+}
+
+TEST(sparse_bitlist_matches_reference) {
+    uint8_t data[300] = {0};
+    uint8_t body_root[32];
+    uint8_t expected[32];
+    uint8_t root[32];
+    char err[128] = {0};
+    TypeDesc td = {SSZ_KIND_BITLIST, 0, NULL, NULL, 0, 4096};
+    data[150] = 0x20;
+    data[299] = 0x01;
+    reference_root(data, 299, body_root);
+    uint8_t pair[64] = {0};
+    memcpy(pair, body_root, 32);
+    pair[32] = (uint8_t)((299 * 8) & 0xff);
+    pair[33] = (uint8_t)((299 * 8) >> 8);
+    sha256_hash(pair, 64, expected);
+    ASSERT_EQ(ssz_stream_root_from_buffer(data, sizeof(data), &td, root, err), 0);
+    ASSERT_BYTES_EQ(root, expected, 32);
+    check_reader_matches_buffer(data, sizeof(data), &td);
+}
+
+/* ===== VALIDATION KERNEL TESTS ===== */
+
+static void put_le32(uint8_t *out, uint32_t v) {
+    for (int i = 0; i < 4; i++) out[i] = (uint8_t)(v >> (8 * i));
+}
+
+TEST(kernels_agree_across_variants) {
+    const ssz_kernel_t kernels[4] = {SSZ_KERNEL_SCALAR, SSZ_KERNEL_SSE41, SSZ_KERNEL_AVX2, SSZ_KERNEL_AVX512};
+    uint8_t table[100 * 4];
+    uint8_t bools[200];
+    uint8_t payload[400 + 100];
+    size_t bad = 0;
+    for (int i = 0; i < 200; i++) bools[i] = (uint8_t)(i % 3 == 0);
+    memset(payload, 0x01, sizeof(payload));
+
+    for (int k = 0; k < 4; k++) {
+        ssz_kernel_select(kernels[k]);
+        for (uint32_t i = 0; i < 100; i++) put_le32(table + i * 4, 400 + i);
+        ASSERT_EQ(ssz_check_offsets(table, 100, 400, 500, 1, &bad), 0);
+        ASSERT_EQ(ssz_check_offsets(table, 100, 404, 500, 1, &bad), SSZ_ERR_BAD_OFFSET);
+        ASSERT_EQ(bad, 0);
+        ASSERT_EQ(ssz_check_offsets(table, 100, 400, 498, 0, &bad), SSZ_ERR_BAD_OFFSET);
+        ASSERT_EQ(bad, 99);
+
+        /* Equal neighbours only fail the strict check */
+        put_le32(table + 70 * 4, 469);
+        ASSERT_EQ(ssz_check_offsets(table, 100, 400, 500, 0, &bad), 0);
+        ASSERT_EQ(ssz_check_offsets(table, 100, 400, 500, 1, &bad), SSZ_ERR_BAD_OFFSET);
+        ASSERT_EQ(bad, 70);
+        put_le32(table + 57 * 4, 300);
+        ASSERT_EQ(ssz_check_offsets(table, 100, 400, 500, 0, &bad), SSZ_ERR_BAD_OFFSET);
+        ASSERT_EQ(bad, 57);
+
+        ASSERT_EQ(ssz_check_bools(bools, sizeof(bools), &bad), 0);
+        bools[133] = 2;
+        ASSERT_EQ(ssz_check_bools(bools, sizeof(bools), &bad), SSZ_ERR_NON_CANONICAL);
+        ASSERT_EQ(bad, 133);
+        bools[133] = 1;
+
+        for (uint32_t i = 0; i < 100; i++) put_le32(table + i * 4, 400 + i);
+        ASSERT_EQ(ssz_check_bitlist_sentinels(payload, table, 100, 500, &bad), 0);
+        payload[444] = 0;
+        ASSERT_EQ(ssz_check_bitlist_sentinels(payload, table, 100, 500, &bad), SSZ_ERR_BITLIST_PADDING);
+        ASSERT_EQ(bad, 44);
+        payload[444] = 1;
+
+        uint8_t copy[sizeof(payload)];
+        memcpy(copy, payload, sizeof(payload));
+        ASSERT_EQ(ssz_first_diff(payload, copy, sizeof(payload)), sizeof(payload));
+        for (size_t at = 0; at < sizeof(payload); at += 37) {
+            copy[at] ^= 0x10;
+            ASSERT_EQ(ssz_first_diff(payload, copy, sizeof(payload)), at);
+            ASSERT_EQ(ssz_first_diff(payload + at + 1, copy + at + 1, sizeof(payload) - at - 1), sizeof(payload) - at - 1);
+            copy[at] ^= 0x10;
+        }
+
+        /* Each lane is hash(left || right) of its own transposed words */
+        uint32_t left[8][SSZ_LANES], right[8][SSZ_LANES], out[8][SSZ_LANES];
+        for (int w = 0; w < 8; w++) {
+            for (int l = 0; l < SSZ_LANES; l++) {
+                left[w][l] = (uint32_t)(w * 0x01000193u + l * 0x9e3779b9u);
+                right[w][l] = (uint32_t)(l * 0x85ebca6bu ^ w);
+            }
+        }
+        ssz_hash_lanes(out, (const uint32_t (*)[SSZ_LANES])left, (const uint32_t (*)[SSZ_LANES])right);
+        for (int l = 0; l < SSZ_LANES; l++) {
+            uint8_t pair[64], digest[32], lane[32];
+            for (int w = 0; w < 8; w++) {
+                for (int b = 0; b < 4; b++) {
+                    pair[w * 4 + b] = (uint8_t)(left[w][l] >> (24 - 8 * b));
+                    pair[32 + w * 4 + b] = (uint8_t)(right[w][l] >> (24 - 8 * b));
+                    lane[w * 4 + b] = (uint8_t)(out[w][l] >> (24 - 8 * b));
+                }
+            }
+            sha256_hash(pair, 64, digest);
+            ASSERT_BYTES_EQ(lane, digest, 32);
+        }
+    }
+    ssz_kernel_select(SSZ_KERNEL_AUTO);
+}
+
+TEST(bool_list_rejects_non_canonical) {
+    uint8_t data[40];
+    uint8_t root[32];
+    uint8_t expected[32];
+    char err[128] = {0};
+    TypeDesc bool_td = {SSZ_KIND_BOOL, 1, NULL, NULL, 0, 0};
+    TypeDesc u8_td = {SSZ_KIND_BASIC, 1, NULL, NULL, 0, 0};
+    TypeDesc list_td = {SSZ_KIND_LIST, 0, &bool_td, NULL, 0, 64};
+    TypeDesc u8_list_td = {SSZ_KIND_LIST, 0, &u8_td, NULL, 0, 64};
+    for (int i = 0; i < 40; i++) data[i] = (uint8_t)(i & 1);
+
+    /* Valid booleans hash exactly like bytes */
+    ASSERT_EQ(ssz_stream_root_from_buffer(data, sizeof(data), &list_td, root, err), 0);
+    ASSERT_EQ(ssz_stream_root_from_buffer(data, sizeof(data), &u8_list_td, expected, err), 0);
+    ASSERT_BYTES_EQ(root, expected, 32);
+    check_reader_matches_buffer(data, sizeof(data), &list_td);
+
+    data[35] = 2;
+    ASSERT_EQ(ssz_stream_root_from_buffer(data, sizeof(data), &list_td, root, err), SSZ_ERR_NON_CANONICAL);
+    SliceReader r = {data, sizeof(data), 0, 7};
+    ASSERT_EQ(ssz_stream_root_from_reader(slice_reader, &r, &list_td, root, err), SSZ_ERR_NON_CANONICAL);
+    ASSERT_EQ(ssz_stream_root_from_buffer(data + 35, 1, &bool_td, root, err), SSZ_ERR_NON_CANONICAL);
+    ASSERT_EQ(ssz_stream_root_from_buffer(data + 34, 1, &bool_td, root, err), 0);
+}
+
+TEST(list_of_bitlists_matches_composition) {
+    /* Four bitlists behind a 16-byte offset table */
+    uint8_t data[16 + 6] = {0};
+    const uint32_t starts[4] = {16, 17, 19, 20};
+    const uint8_t payload[6] = {0x01, 0xff, 0x03, 0x05, 0x00, 0x80};
+    uint8_t elem_roots[4][32];
+    uint8_t pair[64];
+    uint8_t expected[32];
+    uint8_t root[32];
+    char err[128] = {0};
+    TypeDesc bits_td = {SSZ_KIND_BITLIST, 0, NULL, NULL, 0, 2048};
+    TypeDesc td = {SSZ_KIND_LIST, 0, &bits_td, NULL, 0, 16};
+    for (int i = 0; i < 4; i++) put_le32(data + i * 4, starts[i]);
+    memcpy(data + 16, payload, sizeof(payload));
+
+    for (int i = 0; i < 4; i++) {
+        size_t end = i < 3 ? starts[i + 1] : sizeof(data);
+        ASSERT_EQ(ssz_stream_root_from_buffer(data + starts[i], end - starts[i], &bits_td, elem_roots[i], err), 0);
+    }
+    /* Rows are contiguous, so elem_roots[i] spans the pair (i, i + 1) */
+    sha256_hash(elem_roots[0], 64, pair);
+    sha256_hash(elem_roots[2], 64, pair + 32);
+    sha256_hash(pair, 64, expected);
+    memset(pair, 0, 64);
+    memcpy(pair, expected, 32);
+    pair[32] = 4;
+    sha256_hash(pair, 64, expected);
+
+    ASSERT_EQ(ssz_stream_root_from_buffer(data, sizeof(data), &td, root, err), 0);
+    ASSERT_BYTES_EQ(root, expected, 32);
+
+    /* Streaming cannot see the offset table ahead of the payloads */
+    SliceReader r = {data, sizeof(data), 0, 4096};
+    ASSERT_EQ(ssz_stream_root_from_reader(slice_reader, &r, &td, root, err), SSZ_ERR_UNSUPPORTED_TYPE);
+
+    data[18] = 0x00;
+    ASSERT_EQ(ssz_stream_root_from_buffer(data, sizeof(data), &td, root, err), SSZ_ERR_NON_CANONICAL);
+    data[18] = 0x03;
+    put_le32(data + 8, 17);
+    ASSERT_EQ(ssz_stream_root_from_buffer(data, sizeof(data), &td, root, err), SSZ_ERR_BAD_OFFSET);
+    put_le32(data + 8, 19);
+    put_le32(data, 18);
+    ASSERT_EQ(ssz_stream_root_from_buffer(data, sizeof(data), &td, root, err), SSZ_ERR_BAD_OFFSET);
+}
+
+TEST(container_offsets_checked) {
+    /* {uint64, List[uint8], List[uint8]}: fixed part 8 + 4 + 4 */
+    uint8_t data[21];
+    uint8_t root[32];
+    char err[128] = {0};
+    TypeDesc u8_td = {SSZ_KIND_BASIC, 1, NULL, NULL, 0, 0};
+    TypeDesc u64_td = {SSZ_KIND_BASIC, 8, NULL, NULL, 0, 0};
+    TypeDesc list_td = {SSZ_KIND_LIST, 0, &u8_td, NULL, 0, 32};
+    const void *fields[3] = {&u64_td, &list_td, &list_td};
+    TypeDesc td = {SSZ_KIND_CONTAINER, 0, NULL, fields, 3, 0};
+    for (int i = 0; i < 21; i++) data[i] = (uint8_t)i;
+    put_le32(data + 8, 16);
+    put_le32(data + 12, 18);
+    ASSERT_EQ(ssz_stream_root_from_buffer(data, sizeof(data), &td, root, err), 0);
+    check_reader_matches_buffer(data, sizeof(data), &td);
+
+    put_le32(data + 12, 15);
+    ASSERT_EQ(ssz_stream_root_from_buffer(data, sizeof(data), &td, root, err), SSZ_ERR_BAD_OFFSET);
+    put_le32(data + 12, 22);
+    ASSERT_EQ(ssz_stream_root_from_buffer(data, sizeof(data), &td, root, err), SSZ_ERR_BAD_OFFSET);
+    put_le32(data + 12, 18);
+    put_le32(data + 8, 20);
+    ASSERT_EQ(ssz_stream_root_from_buffer(data, sizeof(data), &td, root, err), SSZ_ERR_BAD_OFFSET);
+    SliceReader r = {data, sizeof(data), 0, 4096};
+    ASSERT_EQ(ssz_stream_root_from_reader(slice_reader, &r, &td, root, err), SSZ_ERR_BAD_OFFSET);
+}
+
+/* ===== VALIDATION MODE TESTS ===== */
+
+TEST(validate_agrees_with_root_path) {
+    uint8_t data[64];
+    uint8_t root[32];
+    char err[128] = {0};
+    TypeDesc u8_td = {SSZ_KIND_BASIC, 1, NULL, NULL, 0, 0};
+    TypeDesc u64_td = {SSZ_KIND_BASIC, 8, NULL, NULL, 0, 0};
+    TypeDesc bool_td = {SSZ_KIND_BOOL, 1, NULL, NULL, 0, 0};
+    TypeDesc bytes_td = {SSZ_KIND_LIST, 0, &u8_td, NULL, 0, 32};
+    TypeDesc u64_list_td = {SSZ_KIND_LIST, 0, &u64_td, NULL, 0, 4};
+    TypeDesc bools_td = {SSZ_KIND_LIST, 0, &bool_td, NULL, 0, 64};
+    TypeDesc bits_td = {SSZ_KIND_BITLIST, 0, NULL, NULL, 0, 64};
+    const void *fields[3] = {&u64_td, &bytes_td, &bits_td};
+    TypeDesc container_td = {SSZ_KIND_CONTAINER, 0, NULL, fields, 3, 0};
+    const TypeDesc *types[] = {&u64_td, &bytes_td, &u64_list_td, &bools_td, &bits_td, &container_td};
+    const size_t lens[] = {0, 1, 8, 9, 16, 17, 20, 24, 32, 33, 40, 64};
+
+    /* Container-shaped prefix so some lengths parse as {u64, bytes, bits} */
+    for (int i = 0; i < 64; i++) data[i] = (uint8_t)(i & 1);
+    put_le32(data + 8, 16);
+    put_le32(data + 12, 18);
+    data[23] = 0x01;
+    for (size_t t = 0; t < sizeof(types) / sizeof(types[0]); t++) {
+        for (size_t l = 0; l < sizeof(lens) / sizeof(lens[0]); l++) {
+            int hashed = ssz_stream_root_from_buffer(data, lens[l], types[t], root, err);
+            ASSERT_EQ(ssz_validate(data, lens[l], types[t], err), hashed);
+        }
+    }
+}
+
+TEST(validate_limits_and_lengths) {
+    uint8_t data[72] = {0};
+    char err[128] = {0};
+    TypeDesc u8_td = {SSZ_KIND_BASIC, 1, NULL, NULL, 0, 0};
+    TypeDesc u64_td = {SSZ_KIND_BASIC, 8, NULL, NULL, 0, 0};
+    TypeDesc bytes_td = {SSZ_KIND_LIST, 0, &u8_td, NULL, 0, 32};
+    TypeDesc u64_list_td = {SSZ_KIND_LIST, 0, &u64_td, NULL, 0, 8};
+    TypeDesc bits_td = {SSZ_KIND_BITLIST, 0, NULL, NULL, 0, 10};
+    const void *fields[2] = {&u64_td, &u64_td};
+    TypeDesc pair_td = {SSZ_KIND_CONTAINER, 16, NULL, fields, 2, 0};
+
+    ASSERT_EQ(ssz_validate(data, 32, &bytes_td, err), 0);
+    ASSERT_EQ(ssz_validate(data, 33, &bytes_td, err), SSZ_ERR_LENGTH_OVERFLOW);
+    ASSERT_EQ(ssz_validate(data, 64, &u64_list_td, err), 0);
+    ASSERT_EQ(ssz_validate(data, 72, &u64_list_td, err), SSZ_ERR_LENGTH_OVERFLOW);
+    ASSERT_EQ(ssz_validate(data, 12, &u64_list_td, err), SSZ_ERR_NON_CANONICAL);
+    ASSERT_EQ(ssz_validate(data, 16, &pair_td, err), 0);
+    ASSERT_EQ(ssz_validate(data, 17, &pair_td, err), SSZ_ERR_NON_CANONICAL);
+    ASSERT_EQ(ssz_validate(data, 15, &pair_td, err), SSZ_ERR_NON_CANONICAL);
+
+    /* Ten bits fit, eleven do not */
+    data[1] = 0x04;
+    ASSERT_EQ(ssz_validate(data, 2, &bits_td, err), 0);
+    data[1] = 0x08;
+    ASSERT_EQ(ssz_validate(data, 2, &bits_td, err), SSZ_ERR_LENGTH_OVERFLOW);
+
+    /* The reader path enforces the same limits */
+    uint8_t root[32];
+    SliceReader r1 = {data, 2, 0, 4096};
+    ASSERT_EQ(ssz_stream_root_from_reader(slice_reader, &r1, &bits_td, root, err), SSZ_ERR_LENGTH_OVERFLOW);
+    SliceReader r2 = {data, 72, 0, 7};
+    ASSERT_EQ(ssz_stream_root_from_reader(slice_reader, &r2, &u64_list_td, root, err), SSZ_ERR_LENGTH_OVERFLOW);
+    SliceReader r3 = {data, 12, 0, 4096};
+    ASSERT_EQ(ssz_stream_root_from_reader(slice_reader, &r3, &u64_list_td, root, err), SSZ_ERR_NON_CANONICAL);
+    SliceReader r4 = {data, 17, 0, 4096};
+    ASSERT_EQ(ssz_stream_root_from_reader(slice_reader, &r4, &pair_td, root, err), SSZ_ERR_NON_CANONICAL);
+}
+
+TEST(container_variable_fields_merkleized) {
+    /* {uint64, List[uint8], Bitlist}: variable payloads hash at their field positions */
+    uint8_t data[16 + 3 + 2];
+    uint8_t field_roots[3][32];
+    uint8_t expected[32];
+    uint8_t root[32];
+    char err[128] = {0};
+    TypeDesc u8_td = {SSZ_KIND_BASIC, 1, NULL, NULL, 0, 0};
+    TypeDesc u64_td = {SSZ_KIND_BASIC, 8, NULL, NULL, 0, 0};
+    TypeDesc bytes_td = {SSZ_KIND_LIST, 0, &u8_td, NULL, 0, 32};
+    TypeDesc bits_td = {SSZ_KIND_BITLIST, 0, NULL, NULL, 0, 64};
+    const void *fields[3] = {&u64_td, &bytes_td, &bits_td};
+    TypeDesc td = {SSZ_KIND_CONTAINER, 0, NULL, fields, 3, 0};
+    for (int i = 0; i < 8; i++) data[i] = (uint8_t)(i + 1);
+    put_le32(data + 8, 16);
+    put_le32(data + 12, 19);
+    data[16] = 0xaa;
+    data[17] = 0xbb;
+    data[18] = 0xcc;
+    data[19] = 0x0f;
+    data[20] = 0x01;
+
+    ASSERT_EQ(ssz_stream_root_from_buffer(data, 8, &u64_td, field_roots[0], err), 0);
+    ASSERT_EQ(ssz_stream_root_from_buffer(data + 16, 3, &bytes_td, field_roots[1], err), 0);
+    ASSERT_EQ(ssz_stream_root_from_buffer(data + 19, 2, &bits_td, field_roots[2], err), 0);
+    uint8_t pair[64];
+    sha256_hash(field_roots[0], 64, pair);
+    memcpy(pair + 32, field_roots[2], 32);
+    sha256_hash(pair, 64, expected);
+
+    ASSERT_EQ(ssz_stream_root_from_buffer(data, sizeof(data), &td, root, err), 0);
+    ASSERT_BYTES_EQ(root, expected, 32);
+    check_reader_matches_buffer(data, sizeof(data), &td);
+
+    /* A bad variable field fails the container on both paths */
+    data[20] = 0x00;
+    ASSERT_EQ(ssz_stream_root_from_buffer(data, sizeof(data), &td, root, err), SSZ_ERR_NON_CANONICAL);
+    ASSERT_EQ(ssz_validate(data, sizeof(data), &td, err), SSZ_ERR_NON_CANONICAL);
+    SliceReader r = {data, sizeof(data), 0, 4096};
+    ASSERT_EQ(ssz_stream_root_from_reader(slice_reader, &r, &td, root, err), SSZ_ERR_NON_CANONICAL);
+}
+
+/* ===== SUBTREE ROOT TESTS ===== */
+
+/* {uint64, List[Bitlist[2048], 16]} with four bitlists */
+static size_t build_nested(uint8_t *data) {
+    const uint32_t starts[4] = {16, 17, 19, 20};
+    const uint8_t payload[6] = {0x01, 0xff, 0x03, 0x05, 0x00, 0x80};
+    for (int i = 0; i < 8; i++) data[i] = (uint8_t)(0x10 + i);
+    put_le32(data + 8, 12);
+    for (int i = 0; i < 4; i++) put_le32(data + 12 + i * 4, starts[i]);
+    memcpy(data + 28, payload, sizeof(payload));
+    return 28 + sizeof(payload);
+}
+
+TEST(subroot_by_path) {
+    uint8_t data[64];
+    uint8_t root[32];
+    uint8_t expected[32];
+    char err[128] = {0};
+    TypeDesc u64_td = {SSZ_KIND_BASIC, 8, NULL, NULL, 0, 0};
+    TypeDesc bits_td = {SSZ_KIND_BITLIST, 0, NULL, NULL, 0, 2048};
+    TypeDesc list_td = {SSZ_KIND_LIST, 0, &bits_td, NULL, 0, 16};
+    const void *fields[2] = {&u64_td, &list_td};
+    TypeDesc td = {SSZ_KIND_CONTAINER, 0, NULL, fields, 2, 0};
+    size_t len = build_nested(data);
+
+    ASSERT_EQ(ssz_subroot(data, len, &td, NULL, 0, root, err), 0);
+    ASSERT_EQ(ssz_stream_root_from_buffer(data, len, &td, expected, err), 0);
+    ASSERT_BYTES_EQ(root, expected, 32);
+
+    const uint32_t field0[1] = {0};
+    ASSERT_EQ(ssz_subroot(data, len, &td, field0, 1, root, err), 0);
+    ASSERT_EQ(ssz_stream_root_from_buffer(data, 8, &u64_td, expected, err), 0);
+    ASSERT_BYTES_EQ(root, expected, 32);
+
+    const uint32_t field1[1] = {1};
+    ASSERT_EQ(ssz_subroot(data, len, &td, field1, 1, root, err), 0);
+    ASSERT_EQ(ssz_stream_root_from_buffer(data + 12, len - 12, &list_td, expected, err), 0);
+    ASSERT_BYTES_EQ(root, expected, 32);
+
+    const uint32_t elem1[2] = {1, 1};
+    ASSERT_EQ(ssz_subroot(data, len, &td, elem1, 2, root, err), 0);
+    ASSERT_EQ(ssz_stream_root_from_buffer(data + 29, 2, &bits_td, expected, err), 0);
+    ASSERT_BYTES_EQ(root, expected, 32);
+
+    /* Packed elements come back as their padded leaf */
+    TypeDesc u64_list_td = {SSZ_KIND_LIST, 0, &u64_td, NULL, 0, 8};
+    const uint32_t third[1] = {2};
+    ASSERT_EQ(ssz_subroot(data, 24, &u64_list_td, third, 1, root, err), 0);
+    memset(expected, 0, 32);
+    memcpy(expected, data + 16, 8);
+    ASSERT_BYTES_EQ(root, expected, 32);
+}
+
+TEST(subroot_by_gindex) {
+    uint8_t data[64];
+    uint8_t root[32];
+    uint8_t expected[32];
+    char err[128] = {0};
+    TypeDesc u64_td = {SSZ_KIND_BASIC, 8, NULL, NULL, 0, 0};
+    TypeDesc bits_td = {SSZ_KIND_BITLIST, 0, NULL, NULL, 0, 2048};
+    TypeDesc list_td = {SSZ_KIND_LIST, 0, &bits_td, NULL, 0, 16};
+    const void *fields[2] = {&u64_td, &list_td};
+    TypeDesc td = {SSZ_KIND_CONTAINER, 0, NULL, fields, 2, 0};
+    size_t len = build_nested(data);
+
+    /* field 1 -> data side -> element 2 of 16: 1 | 1 | 0 | 0010 */
+    ASSERT_EQ(ssz_subroot_gindex(data, len, &td, 0x62, root, err), 0);
+    ASSERT_EQ(ssz_stream_root_from_buffer(data + 31, 1, &bits_td, expected, err), 0);
+    ASSERT_BYTES_EQ(root, expected, 32);
+
+    /* field 1 -> length mix-in */
+    ASSERT_EQ(ssz_subroot_gindex(data, len, &td, 7, root, err), 0);
+    memset(expected, 0, 32);
+    expected[0] = 4;
+    ASSERT_BYTES_EQ(root, expected, 32);
+
+    /* field 0 agrees with the path form */
+    const uint32_t field0[1] = {0};
+    ASSERT_EQ(ssz_subroot_gindex(data, len, &td, 2, root, err), 0);
+    ASSERT_EQ(ssz_subroot(data, len, &td, field0, 1, expected, err), 0);
+    ASSERT_BYTES_EQ(root, expected, 32);
+
+    /* List[uint64, 8] has two leaves: gindex 5 is the second chunk */
+    TypeDesc u64_list_td = {SSZ_KIND_LIST, 0, &u64_td, NULL, 0, 8};
+    ASSERT_EQ(ssz_subroot_gindex(data, 40, &u64_list_td, 5, root, err), 0);
+    memset(expected, 0, 32);
+    memcpy(expected, data + 32, 8);
+    ASSERT_BYTES_EQ(root, expected, 32);
+
+    /* Internal nodes and padding fields are not values */
+    ASSERT_EQ(ssz_subroot_gindex(data, len, &td, 6, root, err), SSZ_ERR_UNSUPPORTED_TYPE);
+    ASSERT_EQ(ssz_subroot_gindex(data, len, &td, 0x0c, root, err), SSZ_ERR_UNSUPPORTED_TYPE);
+}
+
+TEST(subroot_errors) {
+    uint8_t data[64];
+    uint8_t root[32];
+    char err[128] = {0};
+    TypeDesc u64_td = {SSZ_KIND_BASIC, 8, NULL, NULL, 0, 0};
+    TypeDesc bits_td = {SSZ_KIND_BITLIST, 0, NULL, NULL, 0, 2048};
+    TypeDesc list_td = {SSZ_KIND_LIST, 0, &bits_td, NULL, 0, 16};
+    const void *fields[2] = {&u64_td, &list_td};
+    TypeDesc td = {SSZ_KIND_CONTAINER, 0, NULL, fields, 2, 0};
+    size_t len = build_nested(data);
+
+    const uint32_t into_basic[2] = {0, 0};
+    ASSERT_EQ(ssz_subroot(data, len, &td, into_basic, 2, root, err), SSZ_ERR_UNSUPPORTED_TYPE);
+    const uint32_t no_field[1] = {2};
+    ASSERT_EQ(ssz_subroot(data, len, &td, no_field, 1, root, err), SSZ_ERR_UNSUPPORTED_TYPE);
+    const uint32_t no_elem[2] = {1, 4};
+    ASSERT_EQ(ssz_subroot(data, len, &td, no_elem, 2, root, err), SSZ_ERR_LENGTH_OVERFLOW);
+
+    /* The selected value itself is fully checked */
+    const uint32_t elem1[2] = {1, 1};
+    data[30] = 0x00;
+    ASSERT_EQ(ssz_subroot(data, len, &td, elem1, 2, root, err), SSZ_ERR_NON_CANONICAL);
+    data[30] = 0x03;
+    put_le32(data + 8, 40);
+    ASSERT_EQ(ssz_subroot(data, len, &td, elem1, 2, root, err), SSZ_ERR_BAD_OFFSET);
+}
+
+/* ===== SHARDED ROOT TESTS ===== */
+
+/* Every run depth, with zero runs and a short final chunk, reproduces the
+ * serial root of a list and of a vector over the same bytes */
+TEST(sharded_roots_match_serial) {
+    TypeDesc u8_td = {SSZ_KIND_BASIC, 1, NULL, NULL, 0, 0};
+    TypeDesc list_td = {SSZ_KIND_LIST, 0, &u8_td, NULL, 0, 1 << 20};
+    static uint8_t bytes[1000 * 32 + 7];
+    static uint8_t roots[1024][32];
+    char err[128] = {0};
+    const size_t lens[] = {0, 1, 32, 33, 96, 64 * 32, sizeof(bytes)};
+    for (size_t i = 0; i < sizeof(bytes); i++) bytes[i] = (uint8_t)(i * 29 + 1);
+    memset(bytes + 256 * 32, 0, 128 * 32);
+
+    for (size_t l = 0; l < sizeof(lens) / sizeof(lens[0]); l++) {
+        size_t len = lens[l];
+        uint64_t chunks = (len + 31) / 32;
+        TypeDesc vec_td = {SSZ_KIND_VECTOR, (uint32_t)len, &u8_td, NULL, 0, 0};
+        uint8_t list_root[32], vec_root[32], root[32];
+        ASSERT_EQ(ssz_stream_root_from_buffer(bytes, len, &list_td, list_root, err), 0);
+        ASSERT_EQ(ssz_stream_root_from_buffer(bytes, len, &vec_td, vec_root, err), 0);
+
+        for (uint32_t depth = 0; depth <= 11; depth++) {
+            uint64_t width = (uint64_t)1 << depth;
+            size_t n = 0;
+            for (uint64_t start = 0; start < chunks; start += width, n++) {
+                uint64_t count = chunks - start < width ? chunks - start : width;
+                ASSERT_EQ(ssz_subtree_root(bytes, len, start, count, depth, roots[n], err), 0);
+            }
+            uint32_t length = (uint32_t)len;
+            ASSERT_EQ(ssz_combine_subtrees((const uint8_t (*)[32])roots, n, depth, &length, root, err), 0);
+            ASSERT_BYTES_EQ(root, list_root, 32);
+            ASSERT_EQ(ssz_combine_subtrees((const uint8_t (*)[32])roots, n, depth, NULL, root, err), 0);
+            ASSERT_BYTES_EQ(root, vec_root, 32);
+        }
+    }
+}
+
+TEST(sharded_roots_reject_bad_runs) {
+    static uint8_t bytes[10 * 32];
+    uint8_t root[32];
+    char err[128] = {0};
+    ASSERT_EQ(ssz_subtree_root(bytes, sizeof(bytes), 2, 2, 2, root, err), SSZ_ERR_BAD_OFFSET);
+    ASSERT_EQ(ssz_subtree_root(bytes, sizeof(bytes), 0, 5, 2, root, err), SSZ_ERR_BAD_OFFSET);
+    ASSERT_EQ(ssz_subtree_root(bytes, sizeof(bytes), 8, 4, 2, root, err), SSZ_ERR_LENGTH_OVERFLOW);
+    ASSERT_EQ(ssz_subtree_root(bytes, sizeof(bytes), 12, 0, 2, root, err), SSZ_ERR_LENGTH_OVERFLOW);
+    ASSERT_EQ(ssz_subtree_root(bytes, sizeof(bytes), 0, 1, 200, root, err), SSZ_ERR_UNSUPPORTED_TYPE);
+    ASSERT_EQ(ssz_combine_subtrees(NULL, 0, 200, NULL, root, err), SSZ_ERR_UNSUPPORTED_TYPE);
+    ASSERT_EQ(ssz_subtree_root(bytes, sizeof(bytes), 8, 2, 2, root, err), 0);
+}
+
+/* ===== ELEMENT ROOT TESTS ===== */
+
+/* Validator-shaped records, plus a nested layout with bool vectors and a
+ * short basic field, match the buffer path element by element for counts
+ * around the lane width, under every kernel */
+TEST(container_roots_match_buffer) {
+    static const TypeDesc u64_td = {SSZ_KIND_BASIC, 8, NULL, NULL, 0, 0};
+    static const TypeDesc u16_td = {SSZ_KIND_BASIC, 2, NULL, NULL, 0, 0};
+    static const TypeDesc u8_td = {SSZ_KIND_BASIC, 1, NULL, NULL, 0, 0};
+    static const TypeDesc bool_td = {SSZ_KIND_BOOL, 1, NULL, NULL, 0, 0};
+    static const TypeDesc bytes48_td = {SSZ_KIND_VECTOR, 48, &u8_td, NULL, 0, 0};
+    static const TypeDesc bytes32_td = {SSZ_KIND_VECTOR, 32, &u8_td, NULL, 0, 0};
+    static const TypeDesc bools_td = {SSZ_KIND_VECTOR, 70, &bool_td, NULL, 0, 0};
+    static const void *validator_fields[8] = {&bytes48_td, &bytes32_td, &u64_td, &bool_td,
+                                              &u64_td, &u64_td, &u64_td, &u64_td};
+    static const TypeDesc validator_td = {SSZ_KIND_CONTAINER, 121, NULL, validator_fields, 8, 0};
+    static const void *inner_fields[3] = {&u16_td, &bools_td, &bytes32_td};
+    static const TypeDesc inner_td = {SSZ_KIND_CONTAINER, 104, NULL, inner_fields, 3, 0};
+    static const void *outer_fields[3] = {&inner_td, &bool_td, &validator_td};
+    static const TypeDesc outer_td = {SSZ_KIND_CONTAINER, 226, NULL, outer_fields, 3, 0};
+    const TypeDesc *types[2] = {&validator_td, &outer_td};
+    const ssz_kernel_t kernels[4] = {SSZ_KERNEL_SCALAR, SSZ_KERNEL_SSE41, SSZ_KERNEL_AVX2, SSZ_KERNEL_AVX512};
+    const size_t counts[] = {0, 1, 15, 16, 17, 37};
+    static uint8_t bytes[37 * 226];
+    static uint8_t roots[37][32];
+    uint8_t expected[32];
+    char err[128] = {0};
+
+    for (int t = 0; t < 2; t++) {
+        size_t size = types[t]->fixed_size;
+        for (size_t i = 0; i < sizeof(bytes); i++) bytes[i] = (uint8_t)(i * 131 + t);
+        /* Every bool position of either layout holds 0 or 1 */
+        for (size_t e = 0; e < 37; e++) {
+            uint8_t *rec = bytes + e * size;
+            if (t == 0) {
+                rec[88] &= 1;
+            } else {
+                for (int b = 0; b < 70; b++) rec[2 + b] &= 1;
+                rec[104] &= 1;
+                rec[105 + 88] &= 1;
+            }
+        }
+        for (int k = 0; k < 4; k++) {
+            ssz_kernel_select(kernels[k]);
+            for (size_t c = 0; c < sizeof(counts) / sizeof(counts[0]); c++) {
+                memset(roots, 0, sizeof(roots));
+                ASSERT_EQ(ssz_container_roots(bytes, counts[c], types[t], roots, err), 0);
+                for (size_t e = 0; e < counts[c]; e++) {
+                    ASSERT_EQ(ssz_stream_root_from_buffer(bytes + e * size, size, types[t], expected, err), 0);
+                    ASSERT_BYTES_EQ(roots[e], expected, 32);
+                }
+            }
+        }
+    }
+    ssz_kernel_select(SSZ_KERNEL_AUTO);
+}
+
+TEST(container_roots_reject_and_fall_back) {
+    static const TypeDesc u8_td = {SSZ_KIND_BASIC, 1, NULL, NULL, 0, 0};
+    static const TypeDesc u64_td = {SSZ_KIND_BASIC, 8, NULL, NULL, 0, 0};
+    static const TypeDesc bool_td = {SSZ_KIND_BOOL, 1, NULL, NULL, 0, 0};
+    static const TypeDesc list_td = {SSZ_KIND_LIST, 0, &u8_td, NULL, 0, 16};
+    static const TypeDesc big_td = {SSZ_KIND_VECTOR, 8192, &u8_td, NULL, 0, 0};
+    static const void *flag_fields[2] = {&u64_td, &bool_td};
+    static const TypeDesc flag_td = {SSZ_KIND_CONTAINER, 9, NULL, flag_fields, 2, 0};
+    static const void *big_fields[2] = {&u64_td, &big_td};
+    static const TypeDesc wide_td = {SSZ_KIND_CONTAINER, 8200, NULL, big_fields, 2, 0};
+    static const void *var_fields[2] = {&u64_td, &list_td};
+    static const TypeDesc var_td = {SSZ_KIND_CONTAINER, 0, NULL, var_fields, 2, 0};
+    static uint8_t bytes[5 * 8200];
+    static uint8_t roots[40][32];
+    uint8_t expected[32];
+    char err[128] = {0};
+    memset(bytes, 0, sizeof(bytes));
+
+    /* A bad boolean in element 21 fails the whole batch with its error */
+    bytes[21 * 9 + 8] = 2;
+    ASSERT_EQ(ssz_container_roots(bytes, 40, &flag_td, roots, err), SSZ_ERR_NON_CANONICAL);
+    ASSERT_EQ(ssz_container_roots(bytes, 21, &flag_td, roots, err), 0);
+    ASSERT_EQ(ssz_stream_root_from_buffer(bytes + 21 * 9, 9, &flag_td, expected, err), SSZ_ERR_NON_CANONICAL);
+    bytes[21 * 9 + 8] = 0;
+
+    /* Too many chunks for a lane program: still one root per element */
+    for (size_t i = 0; i < sizeof(bytes); i++) bytes[i] = (uint8_t)(i * 7);
+    ASSERT_EQ(ssz_container_roots(bytes, 5, &wide_td, roots, err), 0);
+    for (size_t e = 0; e < 5; e++) {
+        ASSERT_EQ(ssz_stream_root_from_buffer(bytes + e * 8200, 8200, &wide_td, expected, err), 0);
+        ASSERT_BYTES_EQ(roots[e], expected, 32);
+    }
+
+    ASSERT_EQ(ssz_container_roots(bytes, 1, &var_td, roots, err), SSZ_ERR_UNSUPPORTED_TYPE);
+    ASSERT_EQ(ssz_container_roots(bytes, 1, &big_td, roots, err), SSZ_ERR_UNSUPPORTED_TYPE);
+}
+
+/* ===== VIEW TESTS ===== */
+
+TEST(view_navigates_without_copying) {
+    uint8_t data[64];
+    char err[128] = {0};
+    TypeDesc u64_td = {SSZ_KIND_BASIC, 8, NULL, NULL, 0, 0};
+    TypeDesc bits_td = {SSZ_KIND_BITLIST, 0, NULL, NULL, 0, 2048};
+    TypeDesc list_td = {SSZ_KIND_LIST, 0, &bits_td, NULL, 0, 16};
+    const void *fields[2] = {&u64_td, &list_td};
+    TypeDesc td = {SSZ_KIND_CONTAINER, 0, NULL, fields, 2, 0};
+    size_t len = build_nested(data);
+
+    ssz_view_t root_view, slot, list, elem;
+    ssz_view_init(&root_view, data, len, &td);
+    size_t n = 0;
+    ASSERT_EQ(ssz_view_len(&root_view, &n, err), 0);
+    ASSERT_EQ(n, 2);
+
+    uint64_t value = 0;
+    ASSERT_EQ(ssz_view_field(&root_view, 0, &slot, err), 0);
+    ASSERT_EQ(ssz_view_uint(&slot, &value, err), 0);
+    ASSERT_EQ(value == 0x1716151413121110ull, 1);
+
+    ASSERT_EQ(ssz_view_field(&root_view, 1, &list, err), 0);
+    ASSERT_EQ(ssz_view_len(&list, &n, err), 0);
+    ASSERT_EQ(n, 4);
+    ASSERT_EQ(ssz_view_index(&list, 1, &elem, err), 0);
+    size_t elem_len = 0;
+    ASSERT_EQ(ssz_view_bytes(&elem, &elem_len) == data + 29, 1);
+    ASSERT_EQ(elem_len, 2);
+    ASSERT_EQ(ssz_view_len(&elem, &n, err), 0);
+    ASSERT_EQ(n, 9);
+
+    uint8_t root[32];
+    uint8_t expected[32];
+    ASSERT_EQ(ssz_view_root(&elem, root, err), 0);
+    ASSERT_EQ(ssz_stream_root_from_buffer(data + 29, 2, &bits_td, expected, err), 0);
+    ASSERT_BYTES_EQ(root, expected, 32);
+}
+
+TEST(view_checks_only_visited_path) {
+    uint8_t data[64];
+    char err[128] = {0};
+    TypeDesc u64_td = {SSZ_KIND_BASIC, 8, NULL, NULL, 0, 0};
+    TypeDesc bits_td = {SSZ_KIND_BITLIST, 0, NULL, NULL, 0, 2048};
+    TypeDesc list_td = {SSZ_KIND_LIST, 0, &bits_td, NULL, 0, 16};
+    const void *fields[2] = {&u64_td, &list_td};
+    TypeDesc td = {SSZ_KIND_CONTAINER, 0, NULL, fields, 2, 0};
+    size_t len = build_nested(data);
+    ssz_view_t root_view, list, elem;
+    ssz_view_init(&root_view, data, len, &td);
+    ASSERT_EQ(ssz_view_field(&root_view, 1, &list, err), 0);
+
+    /* A broken sentinel in element 2 does not stop reading element 0 */
+    data[31] = 0x00;
+    ASSERT_EQ(ssz_view_index(&list, 0, &elem, err), 0);
+    ASSERT_EQ(ssz_view_index(&list, 2, &elem, err), 0);
+    size_t n;
+    ASSERT_EQ(ssz_view_len(&elem, &n, err), SSZ_ERR_NON_CANONICAL);
+
+    /* Offsets bounding the visited element are checked */
+    put_le32(data + 20, 40);
+    ASSERT_EQ(ssz_view_index(&list, 1, &elem, err), SSZ_ERR_BAD_OFFSET);
+    ASSERT_EQ(ssz_view_index(&list, 4, &elem, err), SSZ_ERR_LENGTH_OVERFLOW);
+    ASSERT_EQ(ssz_view_field(&list, 0, &elem, err), SSZ_ERR_UNSUPPORTED_TYPE);
+    ASSERT_EQ(ssz_view_index(&root_view, 0, &elem, err), SSZ_ERR_UNSUPPORTED_TYPE);
+}
+
+/* ===== ENCODER TESTS ===== */
+
+/* Pulls from a byte pattern in uneven pieces */
+typedef struct {
+    size_t pos;
+    size_t step;
+} PatternReader;
+
+static size_t pattern_reader(uint8_t *buf, size_t buf_size, void *ctx) {
+    PatternReader *r = (PatternReader *)ctx;
+    size_t n = buf_size < r->step ? buf_size : r->step;
+    for (size_t i = 0; i < n; i++) buf[i] = (uint8_t)((r->pos + i) * 7 / 5);
+    r->pos += n;
+    return n;
+}
+
+typedef struct {
+    uint8_t *out;
+    size_t used;
+    size_t calls;
+    size_t fail_after;
+} CollectWriter;
+
+static int collect_writer(const uint8_t *buf, size_t len, void *ctx) {
+    CollectWriter *w = (CollectWriter *)ctx;
+    if (w->fail_after && w->used + len > w->fail_after) return -1;
+    memcpy(w->out + w->used, buf, len);
+    w->used += len;
+    w->calls++;
+    return 0;
+}
+
+TEST(encode_matches_buffer_path) {
+    uint8_t data[64];
+    uint8_t out[64];
+    uint8_t root[32];
+    uint8_t expected[32];
+    char err[128] = {0};
+    TypeDesc u64_td = {SSZ_KIND_BASIC, 8, NULL, NULL, 0, 0};
+    TypeDesc bits_td = {SSZ_KIND_BITLIST, 0, NULL, NULL, 0, 2048};
+    TypeDesc list_td = {SSZ_KIND_LIST, 0, &bits_td, NULL, 0, 16};
+    const void *fields[2] = {&u64_td, &list_td};
+    TypeDesc td = {SSZ_KIND_CONTAINER, 0, NULL, fields, 2, 0};
+    size_t len = build_nested(data);
+
+    /* Same value as build_nested, described field by field */
+    ssz_value_t bits[4] = {
+        {data + 28, 1, NULL, NULL, NULL, 0}, {data + 29, 2, NULL, NULL, NULL, 0},
+        {data + 31, 1, NULL, NULL, NULL, 0}, {data + 32, 2, NULL, NULL, NULL, 0},
+    };
+    ssz_value_t items[2] = {{data, 8, NULL, NULL, NULL, 0}, {NULL, 0, NULL, NULL, bits, 4}};
+    ssz_value_t v = {NULL, 0, NULL, NULL, items, 2};
+
+    size_t size = 0, written = 0;
+    ASSERT_EQ(ssz_encoded_size(&td, &v, &size, err), 0);
+    ASSERT_EQ(size, len);
+    ASSERT_EQ(ssz_encode_to_buffer(&td, &v, out, sizeof(out), &written, root, err), 0);
+    ASSERT_EQ(written, len);
+    ASSERT_BYTES_EQ(out, data, len);
+    ASSERT_EQ(ssz_stream_root_from_buffer(data, len, &td, expected, err), 0);
+    ASSERT_BYTES_EQ(root, expected, 32);
+
+    /* Fixed containers as packed list elements, and a reader-fed u64 list */
+    TypeDesc bool_td = {SSZ_KIND_BOOL, 1, NULL, NULL, 0, 0};
+    const void *pair_fields[2] = {&u64_td, &bool_td};
+    TypeDesc pair_td = {SSZ_KIND_CONTAINER, 9, NULL, pair_fields, 2, 0};
+    TypeDesc pairs_td = {SSZ_KIND_LIST, 0, &pair_td, NULL, 0, 64};
+    TypeDesc u64s_td = {SSZ_KIND_LIST, 0, &u64_td, NULL, 0, 1024};
+    const void *outer_fields[3] = {&pairs_td, &u64_td, &u64s_td};
+    TypeDesc outer_td = {SSZ_KIND_CONTAINER, 0, NULL, outer_fields, 3, 0};
+
+    uint8_t slots[5][8];
+    uint8_t flags[5];
+    ssz_value_t pair_items[5][2];
+    ssz_value_t pairs[5];
+    for (int i = 0; i < 5; i++) {
+        put_le64(slots[i], 0x0101010101010101ull * (uint64_t)(i + 1));
+        flags[i] = (uint8_t)(i & 1);
+        pair_items[i][0] = (ssz_value_t){slots[i], 8, NULL, NULL, NULL, 0};
+        pair_items[i][1] = (ssz_value_t){&flags[i], 1, NULL, NULL, NULL, 0};
+        pairs[i] = (ssz_value_t){NULL, 0, NULL, NULL, pair_items[i], 2};
+    }
+    PatternReader pr = {0, 13};
+    ssz_value_t outer_items[3] = {
+        {NULL, 0, NULL, NULL, pairs, 5},
+        {slots[4], 8, NULL, NULL, NULL, 0},
+        {NULL, 8 * 600, pattern_reader, &pr, NULL, 0},
+    };
+    ssz_value_t outer = {NULL, 0, NULL, NULL, outer_items, 3};
+
+    uint8_t *buf = malloc(8192);
+    ASSERT_EQ(ssz_encode_to_buffer(&outer_td, &outer, buf, 8192, &written, root, err), 0);
+    ASSERT_EQ(written, 16 + 45 + 4800);
+    ASSERT_EQ(ssz_validate(buf, written, &outer_td, err), 0);
+    ASSERT_EQ(ssz_stream_root_from_buffer(buf, written, &outer_td, expected, err), 0);
+    ASSERT_BYTES_EQ(root, expected, 32);
+    free(buf);
+}
+
+TEST(encode_streams_to_writer) {
+    size_t n = 100000;
+    uint8_t root[32];
+    uint8_t expected[32];
+    char err[128] = {0};
+    TypeDesc u8_td = {SSZ_KIND_BASIC, 1, NULL, NULL, 0, 0};
+    TypeDesc td = {SSZ_KIND_LIST, 0, &u8_td, NULL, 0, 0};
+    PatternReader pr = {0, 1000};
+    ssz_value_t v = {NULL, n, pattern_reader, &pr, NULL, 0};
+
+    /* Only the merkle stack is needed, whatever the list length */
+    size_t ws_size = ssz_workspace_size(&td, n);
+    uint8_t *mem = malloc(ws_size);
+    ssz_workspace_t ws;
+    ssz_workspace_init(&ws, mem, ws_size);
+    CollectWriter w = {malloc(n), 0, 0, 0};
+    ASSERT_EQ(ssz_encode_ws(&ws, &td, &v, collect_writer, &w, root, err), 0);
+    ASSERT_EQ(w.used, n);
+    ASSERT_EQ(w.calls > 1, 1);
+    ASSERT_EQ(ssz_stream_root_from_buffer(w.out, n, &td, expected, err), 0);
+    ASSERT_BYTES_EQ(root, expected, 32);
+
+    /* Writer failures stop the encoder */
+    pr.pos = 0;
+    w.used = 0;
+    w.fail_after = 5000;
+    ASSERT_EQ(ssz_encode(&td, &v, collect_writer, &w, root, err), SSZ_ERR_UNEXPECTED_EOF);
+    ASSERT_EQ(w.used <= 5000, 1);
+    free(w.out);
+    free(mem);
+}
+
+TEST(encode_rejects_bad_values) {
+    uint8_t out[64];
+    uint8_t root[32];
+    size_t written = 0;
+    char err[128] = {0};
+    TypeDesc u64_td = {SSZ_KIND_BASIC, 8, NULL, NULL, 0, 0};
+    TypeDesc bool_td = {SSZ_KIND_BOOL, 1, NULL, NULL, 0, 0};
+    TypeDesc bits_td = {SSZ_KIND_BITLIST, 0, NULL, NULL, 0, 8};
+    TypeDesc bools_td = {SSZ_KIND_LIST, 0, &bool_td, NULL, 0, 4};
+    const void *fields[2] = {&u64_td, &bits_td};
+    TypeDesc td = {SSZ_KIND_CONTAINER, 0, NULL, fields, 2, 0};
+    const uint8_t word[8] = {1, 2, 3, 4, 5, 6, 7, 8};
+    const uint8_t bools[5] = {0, 1, 2, 1, 0};
+    const uint8_t no_sentinel[2] = {0xff, 0x00};
+    const uint8_t too_long[2] = {0xff, 0x02};
+
+    ssz_value_t items[2] = {{word, 8, NULL, NULL, NULL, 0}, {no_sentinel, 2, NULL, NULL, NULL, 0}};
+    ssz_value_t v = {NULL, 0, NULL, NULL, items, 2};
+    ASSERT_EQ(ssz_encode_to_buffer(&td, &v, out, sizeof(out), &written, root, err), SSZ_ERR_NON_CANONICAL);
+    items[1].data = too_long;
+    ASSERT_EQ(ssz_encode_to_buffer(&td, &v, out, sizeof(out), &written, root, err), SSZ_ERR_LENGTH_OVERFLOW);
+    items[1].data = word;
+    items[1].len = 1;
+    ASSERT_EQ(ssz_encode_to_buffer(&td, &v, out, 12, &written, root, err), SSZ_ERR_LENGTH_OVERFLOW);
+    ASSERT_EQ(ssz_encode_to_buffer(&td, &v, out, 13, &written, root, err), 0);
+    ASSERT_EQ(written, 13);
+
+    /* Shape errors are caught by the size pass */
+    v.count = 1;
+    ASSERT_EQ(ssz_encode_to_buffer(&td, &v, out, sizeof(out), &written, root, err), SSZ_ERR_UNSUPPORTED_TYPE);
+    v.count = 2;
+    items[0].len = 7;
+    ASSERT_EQ(ssz_encode_to_buffer(&td, &v, out, sizeof(out), &written, root, err), SSZ_ERR_NON_CANONICAL);
+
+    ssz_value_t list = {bools, 4, NULL, NULL, NULL, 0};
+    ASSERT_EQ(ssz_encode_to_buffer(&bools_td, &list, out, sizeof(out), &written, root, err), SSZ_ERR_NON_CANONICAL);
+    list.len = 5;
+    ASSERT_EQ(ssz_encode_to_buffer(&bools_td, &list, out, sizeof(out), &written, root, err), SSZ_ERR_LENGTH_OVERFLOW);
+
+    /* A reader that ends early */
+    TypeDesc u64s_td = {SSZ_KIND_LIST, 0, &u64_td, NULL, 0, 0};
+    PatternReader pr = {0, 3};
+    ssz_value_t pulled = {NULL, 16, pattern_reader, &pr, NULL, 0};
+    ASSERT_EQ(ssz_encode_to_buffer(&u64s_td, &pulled, out, sizeof(out), &written, root, err), 0);
+    pulled.len = 80;
+    uint8_t big[128];
+    ASSERT_EQ(ssz_encode_to_buffer(&u64s_td, &pulled, big, sizeof(big), &written, root, err), 0);
+    pr.step = 0;
+    ASSERT_EQ(ssz_encode_to_buffer(&u64s_td, &pulled, big, sizeof(big), &written, root, err),
+              SSZ_ERR_UNEXPECTED_EOF);
+}
+
+/* ===== RE-ROOTING TESTS ===== */
+
+typedef struct {
+    uint64_t balances[1200];
+    size_t balance_count;
+    uint8_t blobs[8][64];
+    size_t blob_len[8];
+    size_t blob_count;
+    uint8_t bits[64];
+    size_t bits_len;
+    uint8_t roots[96];
+} RerootState;
+
+static uint64_t reroot_rng(uint64_t *s) {
+    uint64_t z = (*s += 0x9e3779b97f4a7c15ull);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+}
+
+static size_t encode_reroot_state(const TypeDesc *td, const RerootState *s, uint8_t *out, size_t cap) {
+    uint8_t slot[8] = {7, 0, 0, 0, 0, 0, 0, 0};
+    ssz_value_t blobs[8];
+    for (size_t i = 0; i < s->blob_count; i++) {
+        ssz_value_t blob = {s->blobs[i], s->blob_len[i], NULL, NULL, NULL, 0};
+        blobs[i] = blob;
+    }
+    ssz_value_t fields[5] = {
+        {slot, 8, NULL, NULL, NULL, 0},
+        {(const uint8_t *)s->balances, s->balance_count * 8, NULL, NULL, NULL, 0},
+        {NULL, 0, NULL, NULL, blobs, s->blob_count},
+        {s->bits, s->bits_len, NULL, NULL, NULL, 0},
+        {s->roots, 96, NULL, NULL, NULL, 0},
+    };
+    ssz_value_t v = {NULL, 0, NULL, NULL, fields, 5};
+    size_t written = 0;
+    char err[128] = {0};
+    ASSERT_EQ(ssz_encode_to_buffer(td, &v, out, cap, &written, NULL, err), 0);
+    return written;
+}
+
+TEST(reroot_matches_full_hash) {
+    TypeDesc u8_td = {SSZ_KIND_BASIC, 1, NULL, NULL, 0, 0};
+    TypeDesc u64_td = {SSZ_KIND_BASIC, 8, NULL, NULL, 0, 0};
+    TypeDesc balances_td = {SSZ_KIND_LIST, 0, &u64_td, NULL, 0, 4096};
+    TypeDesc blob_td = {SSZ_KIND_LIST, 0, &u8_td, NULL, 0, 64};
+    TypeDesc blobs_td = {SSZ_KIND_LIST, 0, &blob_td, NULL, 0, 8};
+    TypeDesc bits_td = {SSZ_KIND_BITLIST, 0, NULL, NULL, 0, 512};
+    TypeDesc roots_td = {SSZ_KIND_VECTOR, 96, &u8_td, NULL, 0, 96};
+    const void *fields[5] = {&u64_td, &balances_td, &blobs_td, &bits_td, &roots_td};
+    TypeDesc td = {SSZ_KIND_CONTAINER, 0, NULL, fields, 5, 0};
+
+    static RerootState s;
+    static uint8_t old_buf[16384], new_buf[16384];
+    uint64_t seed = 1;
+    memset(&s, 0, sizeof(s));
+    s.balance_count = 300;
+    for (size_t i = 0; i < s.balance_count; i++) s.balances[i] = 32000000000ull + i;
+    s.blob_count = 3;
+    for (size_t i = 0; i < s.blob_count; i++) s.blob_len[i] = 10 + i;
+    s.bits[0] = 0x05;
+    s.bits_len = 1;
+
+    uint8_t root[32], expected[32];
+    char err[128] = {0};
+    ssz_tree_t *tree = NULL;
+    size_t old_len = encode_reroot_state(&td, &s, old_buf, sizeof(old_buf));
+    ASSERT_EQ(ssz_tree_build(old_buf, old_len, &td, &tree, root, err), 0);
+    ASSERT_EQ(ssz_stream_root_from_buffer(old_buf, old_len, &td, expected, err), 0);
+    ASSERT_BYTES_EQ(root, expected, 32);
+
+    /* One balance: a group of chunks and the path above it */
+    ssz_reroot_stats_t stats;
+    s.balances[123] += 1;
+    size_t new_len = encode_reroot_state(&td, &s, new_buf, sizeof(new_buf));
+    ASSERT_EQ(ssz_reroot(old_buf, old_len, tree, new_buf, new_len, &td, root, &stats, err), 0);
+    ASSERT_EQ(ssz_stream_root_from_buffer(new_buf, new_len, &td, expected, err), 0);
+    ASSERT_BYTES_EQ(root, expected, 32);
+    ASSERT_EQ(stats.lists_rebuilt, 0);
+    ASSERT_EQ(stats.leaves_rehashed < 40, 1);
+    memcpy(old_buf, new_buf, new_len);
+    old_len = new_len;
+
+    /* Random edits, including ones that move offsets and resize lists */
+    uint32_t rebuilt = 0;
+    for (int round = 0; round < 200; round++) {
+        switch (reroot_rng(&seed) % 6) {
+            case 0:
+                s.balances[reroot_rng(&seed) % s.balance_count] ^= reroot_rng(&seed);
+                break;
+            case 1:
+                s.balance_count = 1 + reroot_rng(&seed) % 1200;
+                break;
+            case 2: {
+                if (s.blob_count == 0) break;
+                size_t i = reroot_rng(&seed) % s.blob_count;
+                s.blob_len[i] = reroot_rng(&seed) % 65;
+                s.blobs[i][reroot_rng(&seed) % 64] ^= 0x80;
+                break;
+            }
+            case 3:
+                s.blob_count = reroot_rng(&seed) % 9;
+                break;
+            case 4:
+                s.bits_len = 1 + reroot_rng(&seed) % 64;
+                s.bits[reroot_rng(&seed) % s.bits_len] ^= (uint8_t)reroot_rng(&seed);
+                s.bits[s.bits_len - 1] |= 0x80;
+                break;
+            default:
+                s.roots[reroot_rng(&seed) % 96] ^= 1;
+                break;
+        }
+        new_len = encode_reroot_state(&td, &s, new_buf, sizeof(new_buf));
+        ASSERT_EQ(ssz_reroot(old_buf, old_len, tree, new_buf, new_len, &td, root, &stats, err), 0);
+        ASSERT_EQ(ssz_stream_root_from_buffer(new_buf, new_len, &td, expected, err), 0);
+        ASSERT_BYTES_EQ(root, expected, 32);
+        rebuilt += stats.lists_rebuilt;
+        memcpy(old_buf, new_buf, new_len);
+        old_len = new_len;
+    }
+    ASSERT_EQ(rebuilt > 0, 1);
+    ssz_tree_free(tree);
+}
+
+TEST(reroot_rejects_mismatches) {
+    TypeDesc u16_td = {SSZ_KIND_BASIC, 2, NULL, NULL, 0, 0};
+    TypeDesc td = {SSZ_KIND_LIST, 0, &u16_td, NULL, 0, 100};
+    TypeDesc other_td = {SSZ_KIND_LIST, 0, &u16_td, NULL, 0, 100};
+    uint8_t old_bytes[64], new_bytes[65];
+    uint8_t root[32], expected[32];
+    char err[128] = {0};
+    ssz_tree_t *tree = NULL;
+    for (int i = 0; i < 64; i++) old_bytes[i] = (uint8_t)i;
+    memcpy(new_bytes, old_bytes, 64);
+    new_bytes[64] = 1;
+
+    ASSERT_EQ(ssz_tree_build(old_bytes, 63, &td, &tree, root, err), SSZ_ERR_NON_CANONICAL);
+    ASSERT_EQ(tree == NULL, 1);
+    ASSERT_EQ(ssz_tree_build(old_bytes, 64, &td, &tree, root, err), 0);
+
+    ASSERT_EQ(ssz_reroot(old_bytes, 64, tree, new_bytes, 64, &other_td, root, NULL, err), SSZ_ERR_UNSUPPORTED_TYPE);
+    ASSERT_EQ(ssz_reroot(old_bytes, 62, tree, new_bytes, 64, &td, root, NULL, err), SSZ_ERR_MALFORMED_HEADER);
+    /* Invalid new bytes leave the tree as it was */
+    ASSERT_EQ(ssz_reroot(old_bytes, 64, tree, new_bytes, 65, &td, root, NULL, err), SSZ_ERR_NON_CANONICAL);
+    new_bytes[3] = 0xff;
+    ASSERT_EQ(ssz_reroot(old_bytes, 64, tree, new_bytes, 64, &td, root, NULL, err), 0);
+    ASSERT_EQ(ssz_stream_root_from_buffer(new_bytes, 64, &td, expected, err), 0);
+    ASSERT_BYTES_EQ(root, expected, 32);
+    ssz_tree_free(tree);
+}
+
+TEST(tree_file_roundtrip) {
+    TypeDesc u8_td = {SSZ_KIND_BASIC, 1, NULL, NULL, 0, 0};
+    TypeDesc u64_td = {SSZ_KIND_BASIC, 8, NULL, NULL, 0, 0};
+    TypeDesc balances_td = {SSZ_KIND_LIST, 0, &u64_td, NULL, 0, 4096};
+    TypeDesc blob_td = {SSZ_KIND_LIST, 0, &u8_td, NULL, 0, 64};
+    TypeDesc blobs_td = {SSZ_KIND_LIST, 0, &blob_td, NULL, 0, 8};
+    TypeDesc bits_td = {SSZ_KIND_BITLIST, 0, NULL, NULL, 0, 512};
+    TypeDesc roots_td = {SSZ_KIND_VECTOR, 96, &u8_td, NULL, 0, 96};
+    const void *fields[5] = {&u64_td, &balances_td, &blobs_td, &bits_td, &roots_td};
+    TypeDesc td = {SSZ_KIND_CONTAINER, 0, NULL, fields, 5, 0};
+
+    static RerootState s;
+    static uint8_t bytes[16384], next[16384];
+    memset(&s, 0, sizeof(s));
+    s.balance_count = 1000;
+    for (size_t i = 0; i < s.balance_count; i++) s.balances[i] = 32000000000ull + i;
+    s.blob_count = 5;
+    for (size_t i = 0; i < s.blob_count; i++) s.blob_len[i] = 20 + i;
+    s.bits[0] = 0x05;
+    s.bits_len = 1;
+    size_t len = encode_reroot_state(&td, &s, bytes, sizeof(bytes));
+
+    char path[] = "/tmp/ssz_tree_XXXXXX";
+    int fd = mkstemp(path);
+    ASSERT_EQ(fd >= 0, 1);
+    close(fd);
+
+    uint8_t root[32], loaded_root[32], expected[32];
+    char err[128] = {0};
+    ssz_tree_t *tree = NULL, *loaded = NULL;
+    ASSERT_EQ(ssz_tree_build(bytes, len, &td, &tree, root, err), 0);
+    ASSERT_EQ(ssz_tree_save(tree, path, err), 0);
+    ssz_tree_free(tree);
+
+    ASSERT_EQ(ssz_tree_load(path, bytes, len, &td, &loaded, loaded_root, err), 0);
+    ASSERT_BYTES_EQ(loaded_root, root, 32);
+    ssz_tree_root(loaded, loaded_root);
+    ASSERT_BYTES_EQ(loaded_root, root, 32);
+
+    /* A loaded tree serves updates, including a list outgrowing its mapping */
+    ssz_reroot_stats_t stats;
+    s.balances[500] += 7;
+    s.blob_len[2] = 3;
+    size_t next_len = encode_reroot_state(&td, &s, next, sizeof(next));
+    ASSERT_EQ(ssz_reroot(bytes, len, loaded, next, next_len, &td, root, &stats, err), 0);
+    ASSERT_EQ(ssz_stream_root_from_buffer(next, next_len, &td, expected, err), 0);
+    ASSERT_BYTES_EQ(root, expected, 32);
+    s.balance_count = 1200;
+    len = encode_reroot_state(&td, &s, bytes, sizeof(bytes));
+    ASSERT_EQ(ssz_reroot(next, next_len, loaded, bytes, len, &td, root, &stats, err), 0);
+    ASSERT_EQ(stats.lists_rebuilt, 1);
+    ASSERT_EQ(ssz_stream_root_from_buffer(bytes, len, &td, expected, err), 0);
+    ASSERT_BYTES_EQ(root, expected, 32);
+
+    /* Saving over the mapped file replaces it without disturbing the mapping */
+    ASSERT_EQ(ssz_tree_save(loaded, path, err), 0);
+    ssz_tree_free(loaded);
+    ASSERT_EQ(ssz_tree_load(path, bytes, len, &td, &loaded, loaded_root, err), 0);
+    ASSERT_BYTES_EQ(loaded_root, expected, 32);
+    ssz_tree_free(loaded);
+    unlink(path);
+}
+
+TEST(tree_file_rejects_stale) {
+    TypeDesc u64_td = {SSZ_KIND_BASIC, 8, NULL, NULL, 0, 0};
+    TypeDesc u32_td = {SSZ_KIND_BASIC, 4, NULL, NULL, 0, 0};
+    TypeDesc td = {SSZ_KIND_LIST, 0, &u64_td, NULL, 0, 1024};
+    TypeDesc other_td = {SSZ_KIND_LIST, 0, &u32_td, NULL, 0, 2048};
+    static uint8_t bytes[800 * 8];
+    for (size_t i = 0; i < sizeof(bytes); i++) bytes[i] = (uint8_t)(i * 7);
+
+    char path[] = "/tmp/ssz_tree_XXXXXX";
+    int fd = mkstemp(path);
+    ASSERT_EQ(fd >= 0, 1);
+    close(fd);
+
+    uint8_t root[32];
+    char err[128] = {0};
+    ssz_tree_t *tree = NULL;
+    ASSERT_EQ(ssz_tree_load(path, bytes, sizeof(bytes), &td, &tree, root, err), SSZ_ERR_UNEXPECTED_EOF);
+    ASSERT_EQ(ssz_tree_build(bytes, sizeof(bytes), &td, &tree, root, err), 0);
+    ASSERT_EQ(ssz_tree_save(tree, path, err), 0);
+    ssz_tree_free(tree);
+    tree = NULL;
+
+    ASSERT_EQ(ssz_tree_load(path, bytes, sizeof(bytes), &other_td, &tree, root, err), SSZ_ERR_UNSUPPORTED_TYPE);
+    ASSERT_EQ(ssz_tree_load(path, bytes, sizeof(bytes) - 8, &td, &tree, root, err), SSZ_ERR_MALFORMED_HEADER);
+    ASSERT_EQ(tree == NULL, 1);
+
+    /* Bytes edited after saving: the sampled paths no longer hash to the nodes
+     * (200 chunks in 25 groups, so 16 samples cannot all miss every edit) */
+    for (size_t i = 0; i < sizeof(bytes); i += 256) bytes[i] ^= 1;
+    ASSERT_EQ(ssz_tree_load(path, bytes, sizeof(bytes), &td, &tree, root, err), SSZ_ERR_MALFORMED_HEADER);
+    for (size_t i = 0; i < sizeof(bytes); i += 256) bytes[i] ^= 1;
+
+    /* A region capacity whose node area would overflow size_t: region 0's cap
+     * at 96 + 8 set to 2^63 */
+    uint8_t cap[8];
+    FILE *f = fopen(path, "r+b");
+    ASSERT_EQ(f != NULL, 1);
+    fseek(f, 96 + 8, SEEK_SET);
+    ASSERT_EQ(fread(cap, 1, 8, f), 8);
+    const uint8_t huge[8] = {0, 0, 0, 0, 0, 0, 0, 0x80};
+    fseek(f, 96 + 8, SEEK_SET);
+    fwrite(huge, 1, 8, f);
+    fflush(f);
+    ASSERT_EQ(ssz_tree_load(path, bytes, sizeof(bytes), &td, &tree, root, err), SSZ_ERR_MALFORMED_HEADER);
+    ASSERT_EQ(tree == NULL, 1);
+    fseek(f, 96 + 8, SEEK_SET);
+    fwrite(cap, 1, 8, f);
+    fclose(f);
+
+    /* A flipped node fails the root check: heap slot 2, the subtree over the
+     * first 128 chunks, in the node area after the 128-byte header */
+    f = fopen(path, "r+b");
+    ASSERT_EQ(f != NULL, 1);
+    fseek(f, 128 + 2 * 32, SEEK_SET);
+    int c = fgetc(f);
+    fseek(f, 128 + 2 * 32, SEEK_SET);
+    fputc(c ^ 0xff, f);
+    fclose(f);
+    ASSERT_EQ(ssz_tree_load(path, bytes, sizeof(bytes), &td, &tree, root, err), SSZ_ERR_MALFORMED_HEADER);
+    ASSERT_EQ(truncate(path, 100), 0);
+    ASSERT_EQ(ssz_tree_load(path, bytes, sizeof(bytes), &td, &tree, root, err), SSZ_ERR_UNEXPECTED_EOF);
+    unlink(path);
+}
+
+/* ===== RESUMABLE STREAM TESTS ===== */
+
+/* Feed data in pieces of `step` bytes; after `cut` bytes, checkpoint the
+ * context and carry on from a restored copy */
+static int resumed_root(const uint8_t *data, size_t len, const TypeDesc *td, size_t step, size_t cut,
+                        uint8_t root[32]) {
+    char err[128] = {0};
+    ssz_stream_ctx_t *ctx = NULL;
+    int status = ssz_stream_new(td, &ctx, err);
+    if (status != 0) return status;
+    for (size_t pos = 0; pos < len && status == 0;) {
+        size_t n = len - pos < step ? len - pos : step;
+        if (pos < cut && cut < pos + n) n = cut - pos;
+        status = ssz_stream_update(ctx, data + pos, n, err);
+        pos += n;
+        if (pos == cut && status == 0) {
+            static uint8_t ckpt[8192];
+            size_t size = ssz_stream_save(ctx, NULL, 0);
+            ASSERT_EQ(size > 0 && size <= sizeof(ckpt), 1);
+            ASSERT_EQ(ssz_stream_save(ctx, ckpt, sizeof(ckpt)), size);
+            ssz_stream_free(ctx);
+            ASSERT_EQ(ssz_stream_restore(ckpt, size, td, &ctx, err), 0);
+            ASSERT_EQ(ssz_stream_position(ctx), (uint64_t)cut);
+        }
+    }
+    if (status == 0) status = ssz_stream_final(ctx, root, err);
+    ssz_stream_free(ctx);
+    return status;
+}
+
+/* Same root or error code as the reader path for every piece size and
+ * every checkpoint position */
+static void check_resume_matches_reader(const uint8_t *data, size_t len, const TypeDesc *td) {
+    static const size_t steps[] = {1, 7, 33, 4096};
+    uint8_t expected[32] = {0}, root[32];
+    char err[128] = {0};
+    SliceReader r = {data, len, 0, 4096};
+    int want = ssz_stream_root_from_reader(slice_reader, &r, td, expected, err);
+    for (size_t i = 0; i < sizeof(steps) / sizeof(steps[0]); i++) {
+        for (size_t cut = 0; cut <= len; cut += (len > 300 ? 97 : 1)) {
+            ASSERT_EQ(resumed_root(data, len, td, steps[i], cut, root), want);
+            if (want == 0) ASSERT_BYTES_EQ(root, expected, 32);
+        }
+    }
+}
+
+TEST(resume_matches_reader) {
+    TypeDesc u8_td = {SSZ_KIND_BASIC, 1, NULL, NULL, 0, 0};
+    TypeDesc u32_td = {SSZ_KIND_BASIC, 4, NULL, NULL, 0, 0};
+    TypeDesc u64_td = {SSZ_KIND_BASIC, 8, NULL, NULL, 0, 0};
+    TypeDesc bool_td = {SSZ_KIND_BOOL, 1, NULL, NULL, 0, 0};
+    TypeDesc bytes_td = {SSZ_KIND_LIST, 0, &u8_td, NULL, 0, 1000};
+    TypeDesc u64s_td = {SSZ_KIND_LIST, 0, &u64_td, NULL, 0, 100};
+    TypeDesc bools_td = {SSZ_KIND_LIST, 0, &bool_td, NULL, 0, 64};
+    TypeDesc bits_td = {SSZ_KIND_BITLIST, 0, NULL, NULL, 0, 100};
+    TypeDesc vec_td = {SSZ_KIND_VECTOR, 0, &u64_td, NULL, 0, 0};
+    const void *inner_fields[2] = {&u32_td, &bytes_td};
+    TypeDesc inner_td = {SSZ_KIND_CONTAINER, 0, NULL, inner_fields, 2, 0};
+    const void *fields[5] = {&u64_td, &u64s_td, &bits_td, &inner_td, &bools_td};
+    TypeDesc td = {SSZ_KIND_CONTAINER, 0, NULL, fields, 5, 0};
+
+    /* a, offsets of b c d e, b = 3 x u64, c = 12 bits, d = {x, y = 5 bytes}, e = 3 bools */
+    uint8_t data[67] = {0};
+    for (int i = 0; i < 8; i++) data[i] = (uint8_t)(i + 1);
+    put_le32(data + 8, 24);
+    put_le32(data + 12, 48);
+    put_le32(data + 16, 50);
+    put_le32(data + 20, 63);
+    for (int i = 24; i < 48; i++) data[i] = (uint8_t)(i * 3);
+    data[48] = 0xff;
+    data[49] = 0x1d;
+    put_le32(data + 50, 0x01020304);
+    put_le32(data + 54, 8);
+    memcpy(data + 58, "hello", 5);
+    data[63] = 1;
+    data[65] = 1;
+    check_resume_matches_reader(data, 66, &td);
+
+    /* Truncated anywhere, a trailing byte, a bad offset, a bad boolean */
+    for (size_t len = 0; len < 66; len++) check_resume_matches_reader(data, len, &td);
+    check_resume_matches_reader(data, 67, &td);
+    put_le32(data + 16, 47);
+    check_resume_matches_reader(data, 66, &td);
+    put_le32(data + 16, 50);
+    data[64] = 2;
+    check_resume_matches_reader(data, 66, &td);
+
+    static uint8_t big[1308];
+    for (size_t i = 0; i < sizeof(big); i++) big[i] = (uint8_t)(i < 500 ? 0 : i % 251);
+    check_resume_matches_reader(big, 1000, &bytes_td);
+    check_resume_matches_reader(big, 0, &bytes_td);
+    check_resume_matches_reader(big + 500, 160, &vec_td);
+    check_resume_matches_reader(big + 500, 8, &u64_td);
+    check_resume_matches_reader(big + 500, 800, &u64s_td);
+    check_resume_matches_reader(big + 500, 808, &u64s_td);
+    check_resume_matches_reader(data + 48, 2, &bits_td);
+    check_resume_matches_reader(big + 500, 20, &bits_td);
+
+    /* A bitlist field past its limit, whole and truncated: the limit and the
+     * missing bytes must be noticed in the same order on both paths */
+    const void *over_fields[3] = {&u64_td, &bits_td, &bytes_td};
+    TypeDesc over_td = {SSZ_KIND_CONTAINER, 0, NULL, over_fields, 3, 0};
+    uint8_t over[40];
+    memset(over, 0x5a, sizeof(over));
+    put_le32(over + 8, 16);
+    put_le32(over + 12, 36);
+    over[35] = 0x80;
+    for (size_t len = 0; len <= sizeof(over); len++) check_resume_matches_reader(over, len, &over_td);
+}
+
+TEST(resume_rejects_bad_checkpoints) {
+    TypeDesc u8_td = {SSZ_KIND_BASIC, 1, NULL, NULL, 0, 0};
+    TypeDesc td = {SSZ_KIND_LIST, 0, &u8_td, NULL, 0, 1000};
+    TypeDesc other_td = {SSZ_KIND_LIST, 0, &u8_td, NULL, 0, 999};
+    uint8_t data[100];
+    memset(data, 7, sizeof(data));
+    uint8_t ckpt[1024];
+    char err[128] = {0};
+    ssz_stream_ctx_t *ctx = NULL;
+    ASSERT_EQ(ssz_stream_new(&td, &ctx, err), 0);
+    ASSERT_EQ(ssz_stream_update(ctx, data, sizeof(data), err), 0);
+    size_t size = ssz_stream_save(ctx, ckpt, sizeof(ckpt));
+    ASSERT_EQ(size > 0 && size < 256, 1);
+    ssz_stream_free(ctx);
+
+    ASSERT_EQ(ssz_stream_restore(ckpt, size, &other_td, &ctx, err), SSZ_ERR_UNSUPPORTED_TYPE);
+    ASSERT_EQ(ssz_stream_restore(ckpt, size - 1, &td, &ctx, err), SSZ_ERR_MALFORMED_HEADER);
+    ckpt[100] ^= 1;
+    ASSERT_EQ(ssz_stream_restore(ckpt, size, &td, &ctx, err), SSZ_ERR_MALFORMED_HEADER);
+    ckpt[100] ^= 1;
+    ckpt[8] = 2;
+    ASSERT_EQ(ssz_stream_restore(ckpt, size, &td, &ctx, err), SSZ_ERR_MALFORMED_HEADER);
+    ASSERT_EQ(ctx == NULL, 1);
+
+    /* A failed context has no checkpoint */
+    TypeDesc u64_td = {SSZ_KIND_BASIC, 8, NULL, NULL, 0, 0};
+    ASSERT_EQ(ssz_stream_new(&u64_td, &ctx, err), 0);
+    ASSERT_EQ(ssz_stream_update(ctx, data, 9, err), SSZ_ERR_NON_CANONICAL);
+    ASSERT_EQ(ssz_stream_save(ctx, ckpt, sizeof(ckpt)), 0);
+    ssz_stream_free(ctx);
+}
+
+/* Root of data stepped through with slices of at most budget chunks */
+static int stepped_root(const uint8_t *data, size_t len, const TypeDesc *td, uint64_t budget,
+                        uint8_t root[32], size_t *slices) {
+    static uint8_t mem[1 << 16];
+    ssz_workspace_t ws;
+    ssz_ctx_t ctx;
+    char err[128] = {0};
+    ASSERT_EQ(ssz_ctx_workspace_size(td, len) <= sizeof(mem), 1);
+    ssz_workspace_init(&ws, mem, ssz_ctx_workspace_size(td, len));
+    ASSERT_EQ(ssz_ctx_init(&ctx, &ws, data, len, td, err), 0);
+    int status;
+    *slices = 0;
+    do {
+        status = ssz_ctx_step(&ctx, budget, root, err);
+        (*slices)++;
+    } while (status == SSZ_IN_PROGRESS);
+    /* The final result sticks */
+    uint8_t again[32];
+    ASSERT_EQ(ssz_ctx_step(&ctx, budget, again, err), status);
+    if (status == 0) ASSERT_BYTES_EQ(again, root, 32);
+    return status;
+}
+
+static void check_step_matches_buffer(const uint8_t *data, size_t len, const TypeDesc *td) {
+    static const uint64_t budgets[] = {1, 2, 3, 7, 64, 0};
+    uint8_t expected[32] = {0}, root[32];
+    char err[128] = {0};
+    size_t slices;
+    int want = ssz_stream_root_from_buffer(data, len, td, expected, err);
+    for (size_t i = 0; i < sizeof(budgets) / sizeof(budgets[0]); i++) {
+        ASSERT_EQ(stepped_root(data, len, td, budgets[i], root, &slices), want);
+        if (want == 0) ASSERT_BYTES_EQ(root, expected, 32);
+    }
+}
+
+TEST(step_matches_buffer) {
+    TypeDesc u8_td = {SSZ_KIND_BASIC, 1, NULL, NULL, 0, 0};
+    TypeDesc u32_td = {SSZ_KIND_BASIC, 4, NULL, NULL, 0, 0};
+    TypeDesc u64_td = {SSZ_KIND_BASIC, 8, NULL, NULL, 0, 0};
+    TypeDesc bool_td = {SSZ_KIND_BOOL, 1, NULL, NULL, 0, 0};
+    TypeDesc bytes_td = {SSZ_KIND_LIST, 0, &u8_td, NULL, 0, 1000};
+    TypeDesc u64s_td = {SSZ_KIND_LIST, 0, &u64_td, NULL, 0, 100};
+    TypeDesc bools_td = {SSZ_KIND_LIST, 0, &bool_td, NULL, 0, 64};
+    TypeDesc bits_td = {SSZ_KIND_BITLIST, 0, NULL, NULL, 0, 100};
+    TypeDesc vec_td = {SSZ_KIND_VECTOR, 0, &u64_td, NULL, 0, 0};
+    const void *inner_fields[2] = {&u32_td, &bytes_td};
+    TypeDesc inner_td = {SSZ_KIND_CONTAINER, 0, NULL, inner_fields, 2, 0};
+    const void *fields[5] = {&u64_td, &u64s_td, &bits_td, &inner_td, &bools_td};
+    TypeDesc td = {SSZ_KIND_CONTAINER, 0, NULL, fields, 5, 0};
+    TypeDesc blobs_td = {SSZ_KIND_LIST, 0, &bytes_td, NULL, 0, 16};
+    TypeDesc bitlists_td = {SSZ_KIND_LIST, 0, &bits_td, NULL, 0, 16};
+
+    /* Same value as resume_matches_reader, plus its truncations and defects */
+    uint8_t data[67] = {0};
+    for (int i = 0; i < 8; i++) data[i] = (uint8_t)(i + 1);
+    put_le32(data + 8, 24);
+    put_le32(data + 12, 48);
+    put_le32(data + 16, 50);
+    put_le32(data + 20, 63);
+    for (int i = 24; i < 48; i++) data[i] = (uint8_t)(i * 3);
+    data[48] = 0xff;
+    data[49] = 0x1d;
+    put_le32(data + 50, 0x01020304);
+    put_le32(data + 54, 8);
+    memcpy(data + 58, "hello", 5);
+    data[63] = 1;
+    data[65] = 1;
+    check_step_matches_buffer(data, 66, &td);
+    for (size_t len = 0; len <= 67; len++) check_step_matches_buffer(data, len, &td);
+    put_le32(data + 16, 47);
+    check_step_matches_buffer(data, 66, &td);
+    put_le32(data + 16, 50);
+    data[64] = 2;
+    check_step_matches_buffer(data, 66, &td);
+    data[64] = 0;
+
+    static uint8_t big[1308];
+    for (size_t i = 0; i < sizeof(big); i++) big[i] = (uint8_t)(i < 500 ? 0 : i % 251);
+    check_step_matches_buffer(big, 1000, &bytes_td);
+    check_step_matches_buffer(big, 0, &bytes_td);
+    check_step_matches_buffer(big + 500, 160, &vec_td);
+    check_step_matches_buffer(big + 500, 8, &u64_td);
+    check_step_matches_buffer(big + 500, 800, &u64s_td);
+    check_step_matches_buffer(big + 500, 808, &u64s_td);
+    check_step_matches_buffer(data + 48, 2, &bits_td);
+    check_step_matches_buffer(big + 500, 20, &bits_td);
+    check_step_matches_buffer(data + 63, 3, &bools_td);
+
+    /* Variable-size elements: three blobs, then three bitlists */
+    uint8_t list[80];
+    put_le32(list, 12);
+    put_le32(list + 4, 12);
+    put_le32(list + 8, 45);
+    memset(list + 12, 0xab, 68);
+    check_step_matches_buffer(list, 80, &blobs_td);
+    for (size_t len = 0; len < 80; len += 3) check_step_matches_buffer(list, len, &blobs_td);
+    put_le32(list + 4, 13);
+    put_le32(list + 8, 14);
+    list[12] = 1;
+    list[13] = 0x80;
+    check_step_matches_buffer(list, 20, &bitlists_td);
+    check_step_matches_buffer(list, 80, &bitlists_td);
+    list[13] = 0;
+    check_step_matches_buffer(list, 20, &bitlists_td);
+}
+
+TEST(step_bounds_each_slice) {
+    TypeDesc u8_td = {SSZ_KIND_BASIC, 1, NULL, NULL, 0, 0};
+    TypeDesc bytes_td = {SSZ_KIND_LIST, 0, &u8_td, NULL, 0, 1 << 20};
+    TypeDesc blobs_td = {SSZ_KIND_LIST, 0, &bytes_td, NULL, 0, 1024};
+    static uint8_t data[32 * 1000];
+    for (size_t i = 0; i < sizeof(data); i++) data[i] = (uint8_t)(i * 7);
+    uint8_t root[32];
+    size_t slices;
+
+    /* 1000 chunks, 16 per slice */
+    ASSERT_EQ(stepped_root(data, sizeof(data), &bytes_td, 16, root, &slices), 0);
+    ASSERT_EQ(slices, 1000 / 16 + 1);
+    ASSERT_EQ(stepped_root(data, sizeof(data), &bytes_td, 0, root, &slices), 0);
+    ASSERT_EQ(slices, 1);
+
+    /* 100 elements of 316 bytes: every element root counts against the budget */
+    put_le32(data, 400);
+    for (uint32_t i = 1; i < 100; i++) put_le32(data + 4 * i, 400 + i * 316);
+    ASSERT_EQ(stepped_root(data, 400 + 100 * 316, &blobs_td, 10, root, &slices), 0);
+    ASSERT_EQ(slices > 100, 1);
+
+    /* Too little workspace for the frames fails up front */
+    uint8_t mem[16];
+    ssz_workspace_t ws;
+    ssz_ctx_t ctx;
+    char err[128] = {0};
+    ssz_workspace_init(&ws, mem, sizeof(mem));
+    ASSERT_EQ(ssz_ctx_init(&ctx, &ws, data, sizeof(data), &blobs_td, err), SSZ_ERR_WORKSPACE_EXHAUSTED);
+}
+
+/* Spans from the caller and the fd reader's I/O thread export as one trace.
+ * The suite runs a second time built with -DSSZ_TRACE; the default build
+ * checks the disabled functions stay harmless. */
+TEST(trace_export) {
+    TypeDesc u64_td = {SSZ_KIND_BASIC, 8, NULL, NULL, 0, 0};
+    TypeDesc td = {SSZ_KIND_LIST, 0, &u64_td, NULL, 0, 1 << 20};
+    static uint8_t bytes[64 * 1024];
+    for (size_t i = 0; i < sizeof(bytes); i++) bytes[i] = (uint8_t)(i * 13);
+
+    char path[] = "/tmp/ssz_trace_XXXXXX";
+    int fd = mkstemp(path);
+    ASSERT_EQ(fd >= 0, 1);
+    close(fd);
+
+    ssz_trace_reset();
+    uint8_t root[32], expected[32];
+    char err[128] = {0};
+    ASSERT_EQ(ssz_stream_root_from_buffer(bytes, sizeof(bytes), &td, expected, err), 0);
+    FILE *f = tmpfile();
+    ASSERT_EQ(fwrite(bytes, 1, sizeof(bytes), f), sizeof(bytes));
+    fflush(f);
+    ssz_fd_opts_t opts = {4096, 2, 1, 0, NULL};
+    ASSERT_EQ(ssz_stream_root_from_fd(fileno(f), &td, root, &opts, err), 0);
+    fclose(f);
+    ASSERT_BYTES_EQ(root, expected, 32);
+
+    uint64_t dropped = 1;
+    uint64_t count = ssz_trace_count(&dropped);
+    ASSERT_EQ(dropped, 0);
+    ASSERT_EQ(ssz_trace_export(path, err), 0);
+
+    f = fopen(path, "rb");
+    ASSERT_EQ(f != NULL, 1);
+    static char json[1 << 20];
+    size_t n = fread(json, 1, sizeof(json) - 1, f);
+    fclose(f);
+    json[n] = 0;
+    unlink(path);
+    ASSERT_EQ(strncmp(json, "{\"traceEvents\":[", 16), 0);
+
+    size_t begins = 0, ends = 0;
+    for (const char *p = json; (p = strstr(p, "\"ph\":\"")) != NULL; p += 6) {
+        if (p[6] == 'B') begins++;
+        if (p[6] == 'E') ends++;
+    }
+#ifdef SSZ_TRACE
+    ASSERT_EQ(count > 0, 1);
+    ASSERT_EQ(begins + ends, (size_t)count);
+    ASSERT_EQ(begins, ends);
+    ASSERT_EQ(strstr(json, "\"ssz-fd io\"") != NULL, 1);
+    ASSERT_EQ(strstr(json, "\"name\":\"read\"") != NULL, 1);
+    ASSERT_EQ(strstr(json, "\"name\":\"leaves\"") != NULL, 1);
+#else
+    ASSERT_EQ(count, 0);
+    ASSERT_EQ(begins + ends, 0);
+#endif
+    ASSERT_EQ(ssz_trace_export("/nonexistent/dir/trace.json", err), SSZ_ERR_UNEXPECTED_EOF);
+}
+
 /* ===== MAIN TEST RUNNER ===== */
 
 int main(void) {
@@ -593,6 +2705,108 @@ int main(void) {
     RUN_TEST(stress_all_zeros);
     RUN_TEST(stress_all_ones);
 
+    /* Workspace */
+    printf("\n--- Workspace ---\n");
+    RUN_TEST(workspace_matches_default_path);
+    RUN_TEST(workspace_nested_container);
+    RUN_TEST(workspace_reused_across_calls);
+    RUN_TEST(workspace_exhausted);
+    RUN_TEST(default_workspace_deep_nesting);
+    RUN_TEST(default_workspace_wide_container);
+    RUN_TEST(default_workspace_validate_matches_root);
+
+    /* Reader and file descriptor input */
+    printf("\n--- Streaming Input ---\n");
+    RUN_TEST(reader_basic_and_packed);
+    RUN_TEST(reader_bitlist);
+    RUN_TEST(reader_container);
+    RUN_TEST(reader_truncated_container);
+    RUN_TEST(reader_trailing_bytes);
+    RUN_TEST(fd_file_matches_buffer);
+    RUN_TEST(fd_pipe_matches_buffer);
+
+    /* Push-fed roots with checkpoints */
+    printf("\n--- Resumable Streams ---\n");
+    RUN_TEST(resume_matches_reader);
+    RUN_TEST(resume_rejects_bad_checkpoints);
+
+    /* Snappy framed input */
+    printf("\n--- Snappy Frames ---\n");
+    RUN_TEST(crc32c_check_value);
+    RUN_TEST(snappy_uncompressed_matches_buffer);
+    RUN_TEST(snappy_compressed_copies);
+    RUN_TEST(snappy_bad_crc);
+    RUN_TEST(snappy_missing_stream_id);
+
+    /* e2store archives */
+    printf("\n--- Era Archives ---\n");
+    RUN_TEST(era_records_match_buffer_roots);
+    RUN_TEST(era_index_mismatch);
+    RUN_TEST(era_corrupt_record);
+    RUN_TEST(era_truncated_file);
+
+    /* Zero-run collapsing */
+    printf("\n--- Sparse Merkleization ---\n");
+    RUN_TEST(sparse_vector_matches_reference);
+    RUN_TEST(sparse_all_zero_uses_zero_hashes);
+    RUN_TEST(sparse_bitlist_matches_reference);
+
+    /* Offset, boolean and bitlist checks */
+    printf("\n--- Validation Kernels ---\n");
+    RUN_TEST(kernels_agree_across_variants);
+    RUN_TEST(bool_list_rejects_non_canonical);
+    RUN_TEST(list_of_bitlists_matches_composition);
+    RUN_TEST(container_offsets_checked);
+
+    /* Checks without hashing */
+    printf("\n--- Validation Mode ---\n");
+    RUN_TEST(validate_agrees_with_root_path);
+    RUN_TEST(validate_limits_and_lengths);
+    RUN_TEST(container_variable_fields_merkleized);
+
+    /* Roots of selected fields */
+    printf("\n--- Subtree Roots ---\n");
+    RUN_TEST(subroot_by_path);
+    RUN_TEST(subroot_by_gindex);
+    RUN_TEST(subroot_errors);
+
+    /* Bounded slices of one root */
+    printf("\n--- Cooperative Stepping ---\n");
+    RUN_TEST(step_matches_buffer);
+    RUN_TEST(step_bounds_each_slice);
+
+    /* Runs of chunks hashed apart and combined */
+    printf("\n--- Sharded Roots ---\n");
+    RUN_TEST(sharded_roots_match_serial);
+    RUN_TEST(sharded_roots_reject_bad_runs);
+
+    /* Fixed-size container records hashed in lanes */
+    printf("\n--- Element Roots ---\n");
+    RUN_TEST(container_roots_match_buffer);
+    RUN_TEST(container_roots_reject_and_fall_back);
+
+    /* Zero-copy navigation */
+    printf("\n--- Views ---\n");
+    RUN_TEST(view_navigates_without_copying);
+    RUN_TEST(view_checks_only_visited_path);
+
+    /* Serialization with the root computed on the fly */
+    printf("\n--- Encoding ---\n");
+    RUN_TEST(encode_matches_buffer_path);
+    RUN_TEST(encode_streams_to_writer);
+    RUN_TEST(encode_rejects_bad_values);
+
+    /* Diff-based roots of consecutive versions */
+    printf("\n--- Re-rooting ---\n");
+    RUN_TEST(reroot_matches_full_hash);
+    RUN_TEST(reroot_rejects_mismatches);
+    RUN_TEST(tree_file_roundtrip);
+    RUN_TEST(tree_file_rejects_stale);
+
+    /* Timeline export */
+    printf("\n--- Tracing ---\n");
+    RUN_TEST(trace_export);
+
     printf("\n=== Test Summary ===\n");
     printf("Tests run: %d\n", tests_run);
     printf("Tests passed: %d\n", tests_passed);
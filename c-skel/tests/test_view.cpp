@@ -0,0 +1,77 @@
+/* C++ wrapper smoke tests: navigation, iteration and error mapping */
+
+#include "../include/ssz_view.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#define CHECK(cond) do { \
+    if (!(cond)) { \
+        std::printf("\n  FAILED: %s:%d: %s\n", __FILE__, __LINE__, #cond); \
+        std::exit(1); \
+    } \
+} while (0)
+
+static void put_le32(uint8_t *out, uint32_t v) {
+    for (int i = 0; i < 4; i++) out[i] = (uint8_t)(v >> (8 * i));
+}
+
+int main() {
+    /* {uint64, List[List[uint64, 4], 8]} with three inner lists of 1, 0 and 2 */
+    static const TypeDesc u64_td = {SSZ_KIND_BASIC, 8, NULL, NULL, 0, 0};
+    static const TypeDesc inner_td = {SSZ_KIND_LIST, 0, &u64_td, NULL, 0, 4};
+    static const TypeDesc outer_td = {SSZ_KIND_LIST, 0, &inner_td, NULL, 0, 8};
+    static const void *fields[2] = {&u64_td, &outer_td};
+    static const TypeDesc td = {SSZ_KIND_CONTAINER, 0, NULL, fields, 2, 0};
+
+    uint8_t data[12 + 12 + 24] = {0};
+    data[0] = 42;
+    put_le32(data + 8, 12);
+    put_le32(data + 12, 12);
+    put_le32(data + 16, 20);
+    put_le32(data + 20, 20);
+    data[24] = 7;
+    data[32] = 8;
+    data[40] = 9;
+
+    std::printf("Running cpp_view_iteration...");
+    ssz::View v(data, sizeof(data), td);
+    CHECK(v.field(0).as_uint() == 42);
+    ssz::View outer = v.field(1);
+    CHECK(outer.size() == 3);
+    std::vector<size_t> sizes;
+    uint64_t sum = 0;
+    for (ssz::View inner : outer) {
+        sizes.push_back(inner.size());
+        for (ssz::View x : inner) sum += x.as_uint();
+    }
+    CHECK(sizes.size() == 3 && sizes[0] == 1 && sizes[1] == 0 && sizes[2] == 2);
+    CHECK(sum == 24);
+    CHECK(outer[2].data() == data + 32);
+
+    uint8_t root[32];
+    uint8_t expected[32];
+    char err[128] = {0};
+    outer[2].root(root);
+    CHECK(ssz_stream_root_from_buffer(data + 32, 16, &inner_td, expected, err) == 0);
+    CHECK(std::memcmp(root, expected, 32) == 0);
+    std::printf(" PASSED\n");
+
+    std::printf("Running cpp_view_errors...");
+    try {
+        outer[3];
+        CHECK(false);
+    } catch (const ssz::Error &e) {
+        CHECK(e.code() == SSZ_ERR_LENGTH_OVERFLOW);
+        CHECK(std::strstr(e.what(), "out of range") != nullptr);
+    }
+    try {
+        v.field(0).field(0);
+        CHECK(false);
+    } catch (const ssz::Error &e) {
+        CHECK(e.code() == SSZ_ERR_UNSUPPORTED_TYPE);
+    }
+    std::printf(" PASSED\n");
+    return 0;
+}
@@ -0,0 +1,258 @@
+/* ssz-replay: time the C roots on a workload written by ssz-workload
+ *
+ * Usage: ssz-replay [-r passes] <dir>/<scenario>
+ *
+ * Reads <scenario>.type.json, .ssz and .roots, roots every object once to
+ * warm up and then once per pass (default 5), timing each call. Prints one
+ * line per object, in file order:
+ *
+ *   <root hex> <ns pass 1> <ns pass 2> ...
+ *
+ * The root is the one computed, not the expected one, so a driver comparing
+ * implementations sees what this one produced. Exits 1 when any object fails
+ * to verify; a root that differs from .roots is only reported on stderr. */
+
+#define _GNU_SOURCE
+#include "ssz_stream.h"
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static void usage(void) {
+  fprintf(stderr, "Usage: ssz-replay [-r passes] <dir>/<scenario>\n");
+  exit(2);
+}
+
+static uint64_t now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+static uint8_t *read_file(const char *prefix, const char *suffix, size_t *out_len) {
+  char path[1024];
+  snprintf(path, sizeof(path), "%s%s", prefix, suffix);
+  FILE *f = fopen(path, "rb");
+  if (!f) {
+    fprintf(stderr, "ssz-replay: cannot open %s: %s\n", path, strerror(errno));
+    return NULL;
+  }
+  size_t cap = 1 << 16, len = 0;
+  uint8_t *buf = malloc(cap + 1);
+  size_t n;
+  while (buf && (n = fread(buf + len, 1, cap - len, f)) > 0) {
+    len += n;
+    if (len == cap) {
+      cap *= 2;
+      uint8_t *grown = realloc(buf, cap + 1);
+      if (!grown) free(buf);
+      buf = grown;
+    }
+  }
+  fclose(f);
+  if (!buf) {
+    fprintf(stderr, "ssz-replay: out of memory reading %s\n", path);
+    return NULL;
+  }
+  buf[len] = 0;
+  *out_len = len;
+  return buf;
+}
+
+/* ===== Type JSON =====
+ * Only the shape workload_write_type_json emits: objects with kind,
+ * fixedSize, maxLength, elementType and fieldTypes. */
+
+#define MAX_TYPES 256
+
+typedef struct {
+  const char *p;
+  TypeDesc types[MAX_TYPES];
+  const void *fields[MAX_TYPES];
+  size_t type_count;
+  size_t field_count;
+} TypeParser;
+
+static void skip_space(TypeParser *tp) {
+  while (*tp->p == ' ' || *tp->p == '\n' || *tp->p == '\r' || *tp->p == '\t') tp->p++;
+}
+
+static int expect(TypeParser *tp, char c) {
+  skip_space(tp);
+  if (*tp->p != c) return -1;
+  tp->p++;
+  return 0;
+}
+
+static const TypeDesc *parse_type(TypeParser *tp);
+
+static int parse_fields(TypeParser *tp, TypeDesc *td) {
+  const TypeDesc *parsed[MAX_TYPES];
+  uint32_t n = 0;
+  if (expect(tp, '[') != 0) return -1;
+  skip_space(tp);
+  while (*tp->p != ']') {
+    if (n == MAX_TYPES || (parsed[n++] = parse_type(tp)) == NULL) return -1;
+    skip_space(tp);
+    if (*tp->p == ',') tp->p++;
+    skip_space(tp);
+  }
+  tp->p++;
+  /* Children are parsed first, so a field list is contiguous */
+  if (tp->field_count + n > MAX_TYPES) return -1;
+  td->field_types = &tp->fields[tp->field_count];
+  td->field_count = n;
+  for (uint32_t i = 0; i < n; i++) tp->fields[tp->field_count++] = parsed[i];
+  return 0;
+}
+
+static const TypeDesc *parse_type(TypeParser *tp) {
+  if (tp->type_count == MAX_TYPES || expect(tp, '{') != 0) return NULL;
+  TypeDesc *td = &tp->types[tp->type_count++];
+  memset(td, 0, sizeof(*td));
+  skip_space(tp);
+  while (*tp->p != '}') {
+    char key[32];
+    int n = 0;
+    if (sscanf(tp->p, "\"%31[A-Za-z]\"%n", key, &n) != 1 || n == 0) return NULL;
+    tp->p += n;
+    if (expect(tp, ':') != 0) return NULL;
+    skip_space(tp);
+    if (strcmp(key, "elementType") == 0) {
+      if ((td->element_type = parse_type(tp)) == NULL) return NULL;
+    } else if (strcmp(key, "fieldTypes") == 0) {
+      if (parse_fields(tp, td) != 0) return NULL;
+    } else {
+      char *end;
+      unsigned long v = strtoul(tp->p, &end, 10);
+      if (end == tp->p) return NULL;
+      tp->p = end;
+      if (strcmp(key, "kind") == 0) td->kind = (TypeKind)v;
+      else if (strcmp(key, "fixedSize") == 0) td->fixed_size = (uint32_t)v;
+      else if (strcmp(key, "maxLength") == 0) td->max_length = (uint32_t)v;
+      else return NULL;
+    }
+    skip_space(tp);
+    if (*tp->p == ',') tp->p++;
+    skip_space(tp);
+  }
+  tp->p++;
+  return td;
+}
+
+/* ===== Corpus ===== */
+
+typedef struct {
+  size_t offset;
+  size_t len;
+  char root[65];
+} Object;
+
+static Object *read_roots(const char *prefix, size_t data_len, size_t *out_count) {
+  size_t len;
+  char *text = (char *)read_file(prefix, ".roots", &len);
+  if (!text) return NULL;
+  size_t cap = 1024, count = 0;
+  Object *objects = malloc(cap * sizeof(*objects));
+  char *line = text;
+  while (objects && *line) {
+    char *next = strchr(line, '\n');
+    if (next) *next++ = 0;
+    else next = line + strlen(line);
+    if (*line) {
+      if (count == cap) {
+        cap *= 2;
+        Object *grown = realloc(objects, cap * sizeof(*objects));
+        if (!grown) free(objects);
+        objects = grown;
+        if (!objects) break;
+      }
+      Object *o = &objects[count];
+      if (sscanf(line, "%zu %zu %64s", &o->offset, &o->len, o->root) != 3 || o->offset > data_len ||
+          o->len > data_len - o->offset) {
+        fprintf(stderr, "ssz-replay: bad line %zu in %s.roots\n", count + 1, prefix);
+        free(objects);
+        free(text);
+        return NULL;
+      }
+      count++;
+    }
+    line = next;
+  }
+  free(text);
+  if (!objects) fprintf(stderr, "ssz-replay: out of memory\n");
+  *out_count = count;
+  return objects;
+}
+
+int main(int argc, char **argv) {
+  long passes = 5;
+  const char *prefix = NULL;
+
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "-r") == 0 && i + 1 < argc) {
+      passes = strtol(argv[++i], NULL, 10);
+    } else if (argv[i][0] != '-' && !prefix) {
+      prefix = argv[i];
+    } else {
+      usage();
+    }
+  }
+  if (!prefix || passes < 1) usage();
+
+  size_t type_len, data_len, count = 0;
+  char *type_json = (char *)read_file(prefix, ".type.json", &type_len);
+  uint8_t *data = read_file(prefix, ".ssz", &data_len);
+  if (!type_json || !data) return 1;
+  Object *objects = read_roots(prefix, data_len, &count);
+  uint64_t *ns = malloc((count ? count : 1) * (size_t)passes * sizeof(uint64_t));
+  char (*roots)[65] = malloc((count ? count : 1) * sizeof(*roots));
+  if (!objects || !ns || !roots) return 1;
+
+  static TypeParser tp;
+  tp.p = type_json;
+  const TypeDesc *td = parse_type(&tp);
+  if (!td) {
+    fprintf(stderr, "ssz-replay: cannot parse %s.type.json\n", prefix);
+    return 1;
+  }
+
+  int failed = 0;
+  size_t mismatched = 0;
+  for (long pass = -1; pass < passes; pass++) {
+    for (size_t i = 0; i < count; i++) {
+      uint8_t root[32];
+      char err[128] = {0};
+      uint64_t t0 = now_ns();
+      int status = ssz_stream_root_from_buffer(data + objects[i].offset, objects[i].len, td, root, err);
+      uint64_t elapsed = now_ns() - t0;
+      if (status != SSZ_ERR_NONE) {
+        fprintf(stderr, "ssz-replay: object %zu: %s\n", i, err);
+        failed = 1;
+        break;
+      }
+      if (pass < 0) {
+        for (int k = 0; k < 32; k++) snprintf(roots[i] + 2 * k, 3, "%02x", root[k]);
+        if (strcmp(roots[i], objects[i].root) != 0) mismatched++;
+      } else {
+        ns[i * (size_t)passes + (size_t)pass] = elapsed;
+      }
+    }
+    if (failed) return 1;
+  }
+  if (mismatched > 0) fprintf(stderr, "ssz-replay: %zu of %zu root(s) differ from %s.roots\n", mismatched, count, prefix);
+
+  for (size_t i = 0; i < count; i++) {
+    printf("%s", roots[i]);
+    for (long pass = 0; pass < passes; pass++) printf(" %llu", (unsigned long long)ns[i * (size_t)passes + (size_t)pass]);
+    printf("\n");
+  }
+  free(type_json);
+  free(data);
+  free(objects);
+  free(ns);
+  free(roots);
+  return 0;
+}
@@ -0,0 +1,287 @@
+/* ssz-shard-root: root of a packed SSZ payload hashed in parallel runs
+ *
+ * Usage: ssz-shard-root [-j procs] [-d depth] [-e elem_size | --vector] <file>
+ *        ssz-shard-root --shard K -d depth [-e elem_size] <file>
+ *        ssz-shard-root --combine -d depth [--length N | --vector] < roots
+ *
+ * The file holds a List[uintN] (element size -e, default 1 byte) or, with
+ * --vector, a Vector. Its chunks are split into runs of 2^depth chunks.
+ *
+ * The first form forks procs processes (default: online CPUs); each hashes
+ * a contiguous group of runs with ssz_subtree_root and writes the run roots
+ * back over a pipe, and the parent combines them. Without -d the smallest
+ * depth giving at most procs runs is used.
+ *
+ * The other two forms split the same work across hosts: --shard prints the
+ * root of run K as hex, and --combine reads one hex run root per line in run
+ * order and prints the combined root. --length is the list's element count. */
+
+#define _GNU_SOURCE
+#include "ssz_stream.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+static void usage(void) {
+  fprintf(stderr,
+          "Usage: ssz-shard-root [-j procs] [-d depth] [-e elem_size | --vector] <file>\n"
+          "       ssz-shard-root --shard K -d depth [-e elem_size] <file>\n"
+          "       ssz-shard-root --combine -d depth [--length N | --vector] < roots\n");
+  exit(2);
+}
+
+static double now_seconds(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void print_root(const uint8_t root[32]) {
+  for (int k = 0; k < 32; k++) printf("%02x", root[k]);
+  printf("\n");
+}
+
+static int parse_root(const char *hex, uint8_t root[32]) {
+  if (hex[0] == '0' && hex[1] == 'x') hex += 2;
+  if (strspn(hex, "0123456789abcdefABCDEF") != 64) return -1;
+  for (int k = 0; k < 32; k++) {
+    unsigned v;
+    if (sscanf(hex + 2 * k, "%2x", &v) != 1) return -1;
+    root[k] = (uint8_t)v;
+  }
+  return 0;
+}
+
+static int write_all(int fd, const void *buf, size_t n) {
+  const uint8_t *p = buf;
+  while (n > 0) {
+    ssize_t w = write(fd, p, n);
+    if (w < 0 && errno == EINTR) continue;
+    if (w <= 0) return -1;
+    p += w;
+    n -= (size_t)w;
+  }
+  return 0;
+}
+
+static int read_all(int fd, void *buf, size_t n) {
+  uint8_t *p = buf;
+  while (n > 0) {
+    ssize_t r = read(fd, p, n);
+    if (r < 0 && errno == EINTR) continue;
+    if (r <= 0) return -1;
+    p += r;
+    n -= (size_t)r;
+  }
+  return 0;
+}
+
+static int combine_stdin(uint32_t depth, const uint32_t *length) {
+  size_t cap = 1024, n = 0;
+  uint8_t (*roots)[32] = malloc(cap * 32);
+  char line[256];
+  while (roots && fgets(line, sizeof(line), stdin)) {
+    if (line[0] == '\n') continue;
+    if (n == cap) {
+      cap *= 2;
+      void *grown = realloc(roots, cap * 32);
+      if (!grown) break;
+      roots = grown;
+    }
+    if (parse_root(line, roots[n]) != 0) {
+      fprintf(stderr, "ssz-shard-root: bad root on line %zu\n", n + 1);
+      free(roots);
+      return 1;
+    }
+    n++;
+  }
+  if (!roots) {
+    fprintf(stderr, "ssz-shard-root: out of memory\n");
+    return 1;
+  }
+  uint8_t root[32];
+  char err[128] = {0};
+  int status = ssz_combine_subtrees((const uint8_t (*)[32])roots, n, depth, length, root, err);
+  free(roots);
+  if (status != 0) {
+    fprintf(stderr, "ssz-shard-root: %s\n", err);
+    return 1;
+  }
+  print_root(root);
+  return 0;
+}
+
+/* Hash runs [first, first + count) in a child and send their roots to fd */
+static int hash_runs(const uint8_t *bytes, size_t len, uint32_t depth, size_t first, size_t count, int fd) {
+  uint64_t chunks = len / 32 + (len % 32 != 0);
+  uint64_t width = (uint64_t)1 << depth;
+  for (size_t i = first; i < first + count; i++) {
+    uint64_t start = (uint64_t)i * width;
+    uint64_t n = chunks - start < width ? chunks - start : width;
+    uint8_t root[32];
+    char err[128] = {0};
+    if (ssz_subtree_root(bytes, len, start, n, depth, root, err) != 0) {
+      fprintf(stderr, "ssz-shard-root: run %zu: %s\n", i, err);
+      return 1;
+    }
+    if (write_all(fd, root, 32) != 0) return 1;
+  }
+  return 0;
+}
+
+int main(int argc, char **argv) {
+  long procs = sysconf(_SC_NPROCESSORS_ONLN);
+  long depth = -1;
+  long shard = -1;
+  unsigned long elem_size = 1;
+  int vector = 0;
+  int combine = 0;
+  int have_length = 0;
+  uint32_t length = 0;
+  const char *path = NULL;
+
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "-j") == 0 && i + 1 < argc) {
+      procs = strtol(argv[++i], NULL, 10);
+    } else if (strcmp(argv[i], "-d") == 0 && i + 1 < argc) {
+      depth = strtol(argv[++i], NULL, 10);
+    } else if (strcmp(argv[i], "-e") == 0 && i + 1 < argc) {
+      elem_size = strtoul(argv[++i], NULL, 10);
+    } else if (strcmp(argv[i], "--shard") == 0 && i + 1 < argc) {
+      shard = strtol(argv[++i], NULL, 10);
+    } else if (strcmp(argv[i], "--length") == 0 && i + 1 < argc) {
+      length = (uint32_t)strtoul(argv[++i], NULL, 10);
+      have_length = 1;
+    } else if (strcmp(argv[i], "--vector") == 0) {
+      vector = 1;
+    } else if (strcmp(argv[i], "--combine") == 0) {
+      combine = 1;
+    } else if (argv[i][0] != '-' && !path) {
+      path = argv[i];
+    } else {
+      usage();
+    }
+  }
+  if (procs < 1 || elem_size < 1 || depth > 63) usage();
+
+  if (combine) {
+    if (path || depth < 0 || (vector && have_length)) usage();
+    return combine_stdin((uint32_t)depth, vector ? NULL : &length);
+  }
+  if (!path || (shard >= 0 && depth < 0)) usage();
+
+  int fd = open(path, O_RDONLY);
+  struct stat st;
+  if (fd < 0 || fstat(fd, &st) != 0) {
+    fprintf(stderr, "ssz-shard-root: cannot open %s: %s\n", path, strerror(errno));
+    return 1;
+  }
+  size_t len = (size_t)st.st_size;
+  if (len % elem_size != 0) {
+    fprintf(stderr, "ssz-shard-root: length %zu not a multiple of element size %lu\n", len, elem_size);
+    return 1;
+  }
+  const uint8_t *bytes = NULL;
+  if (len > 0) {
+    void *map = mmap(NULL, len, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (map == MAP_FAILED) {
+      fprintf(stderr, "ssz-shard-root: cannot map %s: %s\n", path, strerror(errno));
+      return 1;
+    }
+    bytes = map;
+  }
+  close(fd);
+
+  uint64_t chunks = len / 32 + (len % 32 != 0);
+  uint32_t elems = (uint32_t)(len / elem_size);
+  char err[128] = {0};
+  uint8_t root[32];
+
+  if (shard >= 0) {
+    uint64_t width = (uint64_t)1 << depth;
+    uint64_t start = (uint64_t)shard * width;
+    uint64_t n = start >= chunks ? 0 : (chunks - start < width ? chunks - start : width);
+    if (ssz_subtree_root(bytes, len, start, n, (uint32_t)depth, root, err) != 0) {
+      fprintf(stderr, "ssz-shard-root: %s\n", err);
+      return 1;
+    }
+    print_root(root);
+    return 0;
+  }
+
+  if (depth < 0) {
+    depth = 0;
+    while (((chunks + ((uint64_t)1 << depth) - 1) >> depth) > (uint64_t)procs) depth++;
+  }
+  size_t runs = (size_t)((chunks + ((uint64_t)1 << depth) - 1) >> depth);
+  if ((size_t)procs > runs) procs = runs > 0 ? (long)runs : 1;
+
+  uint8_t (*roots)[32] = malloc((runs > 0 ? runs : 1) * 32);
+  pid_t *pids = calloc((size_t)procs, sizeof(pid_t));
+  int *pipes = calloc((size_t)procs, sizeof(int));
+  if (!roots || !pids || !pipes) {
+    fprintf(stderr, "ssz-shard-root: out of memory\n");
+    return 1;
+  }
+
+  double t0 = now_seconds();
+  size_t per = runs / (size_t)procs, extra = runs % (size_t)procs;
+  size_t first = 0;
+  for (long p = 0; p < procs; p++) {
+    size_t count = per + ((size_t)p < extra);
+    int fds[2];
+    if (pipe(fds) != 0) {
+      fprintf(stderr, "ssz-shard-root: pipe: %s\n", strerror(errno));
+      return 1;
+    }
+    pids[p] = fork();
+    if (pids[p] < 0) {
+      fprintf(stderr, "ssz-shard-root: fork: %s\n", strerror(errno));
+      return 1;
+    }
+    if (pids[p] == 0) {
+      close(fds[0]);
+      _exit(hash_runs(bytes, len, (uint32_t)depth, first, count, fds[1]));
+    }
+    close(fds[1]);
+    pipes[p] = fds[0];
+    first += count;
+  }
+
+  int failed = 0;
+  first = 0;
+  for (long p = 0; p < procs; p++) {
+    size_t count = per + ((size_t)p < extra);
+    if (read_all(pipes[p], roots[first], count * 32) != 0) failed = 1;
+    close(pipes[p]);
+    int status = 0;
+    if (waitpid(pids[p], &status, 0) < 0 || !WIFEXITED(status) || WEXITSTATUS(status) != 0) failed = 1;
+    first += count;
+  }
+  if (failed) {
+    fprintf(stderr, "ssz-shard-root: a shard process failed\n");
+    return 1;
+  }
+
+  int status = ssz_combine_subtrees((const uint8_t (*)[32])roots, runs, (uint32_t)depth,
+                                    vector ? NULL : &elems, root, err);
+  double seconds = now_seconds() - t0;
+  if (status != 0) {
+    fprintf(stderr, "ssz-shard-root: %s\n", err);
+    return 1;
+  }
+  print_root(root);
+  printf("runs=%zu depth=%ld procs=%ld size=%.1fMB time=%.3fs %.2f GB/s\n", runs, depth, procs,
+         len / 1e6, seconds, seconds > 0 ? len / seconds / 1e9 : 0);
+  free(roots);
+  free(pids);
+  free(pipes);
+  return 0;
+}
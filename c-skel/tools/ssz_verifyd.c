@@ -0,0 +1,582 @@
+/* ssz-verifyd: long-running verification daemon on a Unix domain socket
+ *
+ * Usage: ssz-verifyd [-s socket] [-t threads] [-b batch_max] [-w window_us]
+ *                    [-q queue_mib] [-d queue_depth]
+ *
+ * One reader thread per connection parses request frames (see verifyd_proto.h)
+ * into a shared queue. Worker threads take micro-batches off the queue: a worker
+ * waits until the oldest queued request is window_us old or batch_max requests
+ * are queued, takes them all, hashes them and writes each connection's
+ * responses with a single send. Vector[uint8] requests of one length in a batch
+ * share a tree shape and go through ssz_container_roots, which hashes them in
+ * SIMD lanes; everything else is hashed one request at a time. Under load this
+ * amortizes wakeups and syscalls across the batch; when idle the window bounds
+ * the added latency.
+ * Requests stay counted against queue_mib and queue_depth from the moment their
+ * payload is read until they are answered; a reader that would pass either cap
+ * stops reading its connection until workers catch up, so a fast client fills
+ * its socket buffer instead of the daemon's memory.
+ * A VERIFYD_TYPE_STATS request returns queue depth, batch sizes and latency
+ * histograms. SIGINT/SIGTERM drain the queue and exit. */
+
+#define _GNU_SOURCE
+#include "verifyd_proto.h"
+#include <errno.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <time.h>
+#include <unistd.h>
+
+#define HIST_BUCKETS 32
+#define VECTOR_TYPE 2                /* Vector[uint8] in VERIFYD_TYPES */
+#define LANE_BYTES_MAX 4096          /* larger vectors outgrow the lane program */
+
+typedef struct {
+  int fd;
+  int refs;                   /* reader thread + queued requests, atomic */
+  pthread_mutex_t wlock;
+} Conn;
+
+typedef struct Request {
+  struct Request *next;
+  Conn *conn;
+  uint32_t id;
+  uint16_t type;
+  uint32_t len;
+  uint64_t arrived_ns;
+  uint8_t *payload;
+} Request;
+
+typedef struct {
+  pthread_mutex_t lock;
+  pthread_cond_t ready;
+  pthread_cond_t space;
+  Request *head;
+  Request *tail;
+  uint32_t depth;
+  uint32_t max_depth;
+  int stop;
+
+  /* Read but not yet answered; readers wait on space above these caps */
+  uint32_t pending;
+  uint64_t pending_bytes;
+  uint32_t pending_max;
+  uint64_t pending_bytes_max;
+
+  uint32_t batch_max;
+  uint64_t window_ns;
+
+  /* Counters, updated with atomics */
+  uint64_t requests;
+  uint64_t errors;
+  uint64_t batches;
+  uint64_t lane_hashed;                  /* requests hashed by ssz_container_roots */
+  uint64_t stalls;                       /* times a reader waited for space */
+  uint64_t batch_hist[HIST_BUCKETS];     /* log2 of batch size */
+  uint64_t latency_hist[HIST_BUCKETS];   /* log2 of microseconds, arrival to reply sent */
+} Daemon;
+
+static Daemon daemon_state;
+static volatile sig_atomic_t shutting_down = 0;
+static int listen_fd = -1;
+
+static uint64_t now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+static unsigned log2_bucket(uint64_t v) {
+  unsigned b = 0;
+  while (v > 1 && b < HIST_BUCKETS - 1) {
+    v >>= 1;
+    b++;
+  }
+  return b;
+}
+
+static void conn_release(Conn *c) {
+  if (__atomic_sub_fetch(&c->refs, 1, __ATOMIC_ACQ_REL) == 0) {
+    close(c->fd);
+    pthread_mutex_destroy(&c->wlock);
+    free(c);
+  }
+}
+
+static int read_all(int fd, uint8_t *buf, size_t n) {
+  size_t got = 0;
+  while (got < n) {
+    ssize_t k = read(fd, buf + got, n - got);
+    if (k < 0 && errno == EINTR) continue;
+    if (k <= 0) return -1;
+    got += (size_t)k;
+  }
+  return 0;
+}
+
+static int send_all(Conn *c, const uint8_t *buf, size_t n) {
+  int rc = 0;
+  pthread_mutex_lock(&c->wlock);
+  size_t sent = 0;
+  while (sent < n) {
+    ssize_t k = send(c->fd, buf + sent, n - sent, MSG_NOSIGNAL);
+    if (k < 0 && errno == EINTR) continue;
+    if (k <= 0) {
+      rc = -1;
+      break;
+    }
+    sent += (size_t)k;
+  }
+  pthread_mutex_unlock(&c->wlock);
+  return rc;
+}
+
+/* Appends one response frame to out, returns bytes written */
+static size_t put_response(uint8_t *out, uint32_t id, int32_t status, const void *body, size_t body_len) {
+  verifyd_put32(out, (uint32_t)(8 + body_len));
+  verifyd_put32(out + 4, id);
+  verifyd_put32(out + 8, (uint32_t)status);
+  memcpy(out + VERIFYD_RESP_HEADER, body, body_len);
+  return VERIFYD_RESP_HEADER + body_len;
+}
+
+/* ===== Stats ===== */
+
+/* snprintf returns the untruncated length, so *pos may pass cap: every write checks it first */
+static void append_hist(char *out, size_t cap, size_t *pos, const char *name, const uint64_t *hist) {
+  if (*pos < cap) *pos += (size_t)snprintf(out + *pos, cap - *pos, "%s", name);
+  for (unsigned b = 0; b < HIST_BUCKETS && *pos < cap; b++) {
+    uint64_t n = __atomic_load_n(&hist[b], __ATOMIC_RELAXED);
+    if (n) *pos += (size_t)snprintf(out + *pos, cap - *pos, " %llu:%llu", 1ull << b, (unsigned long long)n);
+  }
+  if (*pos < cap) *pos += (size_t)snprintf(out + *pos, cap - *pos, "\n");
+}
+
+static size_t format_stats(char *out, size_t cap) {
+  Daemon *d = &daemon_state;
+  pthread_mutex_lock(&d->lock);
+  uint32_t depth = d->depth;
+  uint32_t max_depth = d->max_depth;
+  uint32_t pending = d->pending;
+  uint64_t pending_bytes = d->pending_bytes;
+  pthread_mutex_unlock(&d->lock);
+
+  uint64_t requests = __atomic_load_n(&d->requests, __ATOMIC_RELAXED);
+  uint64_t batches = __atomic_load_n(&d->batches, __ATOMIC_RELAXED);
+  size_t pos = (size_t)snprintf(out, cap,
+    "requests %llu\nerrors %llu\nbatches %llu\navg_batch %.2f\nqueue_depth %u\nqueue_depth_max %u\n"
+    "pending %u\npending_bytes %llu\nreader_stalls %llu\nlane_hashed %llu\n",
+    (unsigned long long)requests, (unsigned long long)__atomic_load_n(&d->errors, __ATOMIC_RELAXED),
+    (unsigned long long)batches, batches ? (double)requests / (double)batches : 0.0, depth, max_depth,
+    pending, (unsigned long long)pending_bytes,
+    (unsigned long long)__atomic_load_n(&d->stalls, __ATOMIC_RELAXED),
+    (unsigned long long)__atomic_load_n(&d->lane_hashed, __ATOMIC_RELAXED));
+  /* Buckets are lower bounds: "64:10" is 10 samples in [64, 128) */
+  append_hist(out, cap, &pos, "batch_size", d->batch_hist);
+  append_hist(out, cap, &pos, "latency_us", d->latency_hist);
+  return pos < cap ? pos : cap;
+}
+
+/* ===== Queue space ===== */
+
+/* Blocks until a len-byte request fits under both caps, then counts it.
+ * A request larger than the byte cap is let in once nothing else is pending.
+ * Returns -1 if the daemon stops while waiting. */
+static int reserve_space(Daemon *d, uint32_t len) {
+  pthread_mutex_lock(&d->lock);
+  int stalled = 0;
+  while (!d->stop && d->pending > 0 &&
+         (d->pending >= d->pending_max || d->pending_bytes + len > d->pending_bytes_max)) {
+    stalled = 1;
+    pthread_cond_wait(&d->space, &d->lock);
+  }
+  int rc = d->stop ? -1 : 0;
+  if (rc == 0) {
+    d->pending++;
+    d->pending_bytes += len;
+  }
+  pthread_mutex_unlock(&d->lock);
+  if (stalled) __atomic_fetch_add(&d->stalls, 1, __ATOMIC_RELAXED);
+  return rc;
+}
+
+static void release_space(Daemon *d, uint32_t count, uint64_t bytes) {
+  pthread_mutex_lock(&d->lock);
+  d->pending -= count;
+  d->pending_bytes -= bytes;
+  /* Waiting readers need different amounts of space: let each one check */
+  pthread_cond_broadcast(&d->space);
+  pthread_mutex_unlock(&d->lock);
+}
+
+/* ===== Workers ===== */
+
+static size_t take_batch(Daemon *d, Request **batch) {
+  pthread_mutex_lock(&d->lock);
+  for (;;) {
+    while (!d->stop && d->depth == 0) pthread_cond_wait(&d->ready, &d->lock);
+    if (d->depth == 0) {
+      pthread_mutex_unlock(&d->lock);
+      return 0;
+    }
+
+    /* Give concurrent requests until the oldest one's window expires to join the batch */
+    uint64_t deadline = d->head->arrived_ns + d->window_ns;
+    while (!d->stop && d->depth && d->depth < d->batch_max && now_ns() < deadline) {
+      struct timespec ts;
+      clock_gettime(CLOCK_REALTIME, &ts);
+      uint64_t wait = deadline - now_ns();
+      if ((int64_t)wait <= 0) break;
+      ts.tv_nsec += (long)(wait % 1000000000u);
+      ts.tv_sec += (time_t)(wait / 1000000000u) + ts.tv_nsec / 1000000000;
+      ts.tv_nsec %= 1000000000;
+      pthread_cond_timedwait(&d->ready, &d->lock, &ts);
+    }
+    /* Another worker took the queue while we waited; wait for more work */
+    if (d->depth) break;
+  }
+
+  size_t n = 0;
+  while (d->head && n < d->batch_max) {
+    batch[n++] = d->head;
+    d->head = d->head->next;
+    d->depth--;
+  }
+  if (!d->head) d->tail = NULL;
+  /* More work left for another worker */
+  if (d->depth) pthread_cond_signal(&d->ready);
+  pthread_mutex_unlock(&d->lock);
+  return n;
+}
+
+/* Stable insertion sort by connection so each connection's replies are contiguous */
+static void group_by_conn(Request **batch, size_t n) {
+  for (size_t i = 1; i < n; i++) {
+    Request *r = batch[i];
+    size_t j = i;
+    while (j > 0 && (uintptr_t)batch[j - 1]->conn > (uintptr_t)r->conn) {
+      batch[j] = batch[j - 1];
+      j--;
+    }
+    batch[j] = r;
+  }
+}
+
+typedef struct {
+  int status;
+  uint8_t root[32];
+  char err[128];
+} Result;
+
+/* Per-worker buffers, sized for batch_max requests */
+typedef struct {
+  Request **batch;
+  Result *results;
+  uint8_t *done;
+  size_t *group;
+  uint8_t *records;           /* a lane group's payloads, back to back */
+  uint8_t (*roots)[32];
+  uint8_t *out;
+} WorkerBufs;
+
+/* A Vector[uint8] of len bytes has the root of a container whose one field is
+ * that vector with a fixed size, so same-length requests are records of one
+ * fixed layout. Marks the requests it hashed in w->done. */
+static void hash_vector_lanes(Daemon *d, WorkerBufs *w, size_t n) {
+  for (size_t i = 0; i < n; i++) {
+    Request *r = w->batch[i];
+    if (w->done[i] || r->type != VECTOR_TYPE || r->len == 0 || r->len > LANE_BYTES_MAX) continue;
+    size_t count = 0;
+    for (size_t j = i; j < n; j++) {
+      if (!w->done[j] && w->batch[j]->type == VECTOR_TYPE && w->batch[j]->len == r->len) w->group[count++] = j;
+    }
+    if (count < 2) continue;
+
+    for (size_t k = 0; k < count; k++) memcpy(w->records + k * r->len, w->batch[w->group[k]]->payload, r->len);
+    TypeDesc vector = {SSZ_KIND_VECTOR, r->len, &VERIFYD_U8, NULL, 0, 0};
+    const void *fields[1] = {&vector};
+    TypeDesc record = {SSZ_KIND_CONTAINER, r->len, NULL, fields, 1, 0};
+    char err[128];
+    /* Byte vectors cannot fail; if this one does, the requests go one at a time */
+    if (ssz_container_roots(w->records, count, &record, w->roots, err) != SSZ_ERR_NONE) continue;
+    for (size_t k = 0; k < count; k++) {
+      Result *res = &w->results[w->group[k]];
+      res->status = SSZ_ERR_NONE;
+      memcpy(res->root, w->roots[k], 32);
+      w->done[w->group[k]] = 1;
+    }
+    __atomic_fetch_add(&d->lane_hashed, count, __ATOMIC_RELAXED);
+  }
+}
+
+static void hash_batch(Daemon *d, WorkerBufs *w, size_t n) {
+  memset(w->done, 0, n);
+  hash_vector_lanes(d, w, n);
+  for (size_t i = 0; i < n; i++) {
+    if (w->done[i]) continue;
+    Request *r = w->batch[i];
+    Result *res = &w->results[i];
+    res->err[0] = 0;
+    if (r->type >= VERIFYD_TYPE_COUNT) {
+      res->status = SSZ_ERR_UNSUPPORTED_TYPE;
+      snprintf(res->err, sizeof(res->err), "Unknown type id %u", r->type);
+    } else {
+      res->status = ssz_stream_root_from_buffer(r->payload, r->len, &VERIFYD_TYPES[r->type], res->root, res->err);
+    }
+  }
+}
+
+static void *worker(void *arg) {
+  Daemon *d = (Daemon *)arg;
+  size_t max = d->batch_max;
+  WorkerBufs w;
+  w.batch = malloc(max * sizeof(*w.batch));
+  w.results = malloc(max * sizeof(*w.results));
+  w.done = malloc(max);
+  w.group = malloc(max * sizeof(*w.group));
+  w.records = malloc(max * LANE_BYTES_MAX);
+  w.roots = malloc(max * sizeof(*w.roots));
+  w.out = malloc(max * (VERIFYD_RESP_HEADER + 128));
+  if (!w.batch || !w.results || !w.done || !w.group || !w.records || !w.roots || !w.out) {
+    fprintf(stderr, "ssz-verifyd: worker out of memory\n");
+    exit(1);
+  }
+  Request **batch = w.batch;
+  uint8_t *out = w.out;
+
+  for (;;) {
+    size_t n = take_batch(d, batch);
+    if (n == 0) break;
+    group_by_conn(batch, n);
+    hash_batch(d, &w, n);
+
+    size_t pos = 0;
+    size_t run_start = 0;
+    for (size_t i = 0; i < n; i++) {
+      Request *r = batch[i];
+      Result *res = &w.results[i];
+      if (res->status == SSZ_ERR_NONE) {
+        pos += put_response(out + pos, r->id, res->status, res->root, 32);
+      } else {
+        pos += put_response(out + pos, r->id, res->status, res->err, strnlen(res->err, sizeof(res->err)));
+        __atomic_fetch_add(&d->errors, 1, __ATOMIC_RELAXED);
+      }
+
+      /* One send per connection per batch */
+      if (i + 1 == n || batch[i + 1]->conn != r->conn) {
+        send_all(r->conn, out + run_start, pos - run_start);
+        run_start = pos;
+      }
+    }
+
+    uint64_t done = now_ns();
+    uint64_t bytes = 0;
+    for (size_t i = 0; i < n; i++) {
+      Request *r = batch[i];
+      __atomic_fetch_add(&d->latency_hist[log2_bucket((done - r->arrived_ns) / 1000)], 1, __ATOMIC_RELAXED);
+      bytes += r->len;
+      conn_release(r->conn);
+      free(r->payload);
+      free(r);
+    }
+    release_space(d, (uint32_t)n, bytes);
+    __atomic_fetch_add(&d->requests, n, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&d->batches, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&d->batch_hist[log2_bucket(n)], 1, __ATOMIC_RELAXED);
+  }
+
+  free(w.out);
+  free(w.roots);
+  free(w.records);
+  free(w.group);
+  free(w.done);
+  free(w.results);
+  free(w.batch);
+  return NULL;
+}
+
+/* ===== Connections ===== */
+
+static void enqueue(Daemon *d, Request *r) {
+  pthread_mutex_lock(&d->lock);
+  r->next = NULL;
+  if (d->tail) d->tail->next = r;
+  else d->head = r;
+  d->tail = r;
+  d->depth++;
+  if (d->depth > d->max_depth) d->max_depth = d->depth;
+  /* Wake a worker for the first request, and again once a batch is full */
+  if (d->depth == 1 || d->depth >= d->batch_max) pthread_cond_signal(&d->ready);
+  pthread_mutex_unlock(&d->lock);
+}
+
+static void *conn_reader(void *arg) {
+  Conn *c = (Conn *)arg;
+  Daemon *d = &daemon_state;
+  uint8_t hdr[VERIFYD_REQ_HEADER];
+
+  while (read_all(c->fd, hdr, sizeof(hdr)) == 0) {
+    uint32_t frame_len = verifyd_get32(hdr);
+    uint32_t id = verifyd_get32(hdr + 4);
+    uint16_t type = (uint16_t)(hdr[8] | (hdr[9] << 8));
+    if (frame_len < VERIFYD_REQ_HEADER - 4 || frame_len - 8 > VERIFYD_MAX_PAYLOAD) {
+      uint8_t resp[VERIFYD_RESP_HEADER + 32];
+      send_all(c, resp, put_response(resp, id, SSZ_ERR_LENGTH_OVERFLOW, "Frame too large", 15));
+      break;
+    }
+    uint32_t len = frame_len - 8;
+
+    if (type == VERIFYD_TYPE_STATS) {
+      uint8_t resp[VERIFYD_RESP_HEADER + 2048];
+      char text[2048];
+      /* Stats requests carry no payload; skip any that was sent */
+      while (len) {
+        uint32_t step = len < sizeof(text) ? len : (uint32_t)sizeof(text);
+        if (read_all(c->fd, (uint8_t *)text, step) != 0) break;
+        len -= step;
+      }
+      if (len) break;
+      size_t n = format_stats(text, sizeof(text));
+      send_all(c, resp, put_response(resp, id, SSZ_ERR_NONE, text, n));
+      continue;
+    }
+
+    /* Leave the payload in the socket until the queue has room for it */
+    if (reserve_space(d, len) != 0) break;
+    Request *r = malloc(sizeof(*r));
+    uint8_t *payload = malloc(len ? len : 1);
+    if (!r || !payload || read_all(c->fd, payload, len) != 0) {
+      free(r);
+      free(payload);
+      release_space(d, 1, len);
+      break;
+    }
+    r->conn = c;
+    r->id = id;
+    r->type = type;
+    r->len = len;
+    r->payload = payload;
+    r->arrived_ns = now_ns();
+    __atomic_add_fetch(&c->refs, 1, __ATOMIC_ACQ_REL);
+    enqueue(d, r);
+  }
+
+  shutdown(c->fd, SHUT_RD);
+  conn_release(c);
+  return NULL;
+}
+
+static void on_signal(int sig) {
+  (void)sig;
+  shutting_down = 1;
+  if (listen_fd >= 0) shutdown(listen_fd, SHUT_RDWR);
+}
+
+static void usage(void) {
+  fprintf(stderr, "Usage: ssz-verifyd [-s socket] [-t threads] [-b batch_max] [-w window_us]\n"
+                  "                   [-q queue_mib] [-d queue_depth]\n");
+  exit(2);
+}
+
+int main(int argc, char **argv) {
+  const char *path = VERIFYD_DEFAULT_SOCKET;
+  long threads = sysconf(_SC_NPROCESSORS_ONLN);
+  uint32_t batch_max = 64;
+  uint64_t window_us = 50;
+  uint64_t queue_mib = 256;
+  uint32_t queue_depth = 4096;
+
+  for (int i = 1; i < argc; i++) {
+    if (i + 1 >= argc) usage();
+    if (strcmp(argv[i], "-s") == 0) path = argv[++i];
+    else if (strcmp(argv[i], "-t") == 0) threads = strtol(argv[++i], NULL, 10);
+    else if (strcmp(argv[i], "-b") == 0) batch_max = (uint32_t)strtoul(argv[++i], NULL, 10);
+    else if (strcmp(argv[i], "-w") == 0) window_us = strtoull(argv[++i], NULL, 10);
+    else if (strcmp(argv[i], "-q") == 0) queue_mib = strtoull(argv[++i], NULL, 10);
+    else if (strcmp(argv[i], "-d") == 0) queue_depth = (uint32_t)strtoul(argv[++i], NULL, 10);
+    else usage();
+  }
+  if (threads < 1) threads = 1;
+  if (batch_max < 1) batch_max = 1;
+  if (queue_mib < 1) queue_mib = 1;
+  if (queue_depth < 1) queue_depth = 1;
+
+  Daemon *d = &daemon_state;
+  pthread_mutex_init(&d->lock, NULL);
+  pthread_cond_init(&d->ready, NULL);
+  pthread_cond_init(&d->space, NULL);
+  d->batch_max = batch_max;
+  d->window_ns = window_us * 1000;
+  d->pending_max = queue_depth;
+  d->pending_bytes_max = queue_mib << 20;
+
+  struct sockaddr_un addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  if (strlen(path) >= sizeof(addr.sun_path)) {
+    fprintf(stderr, "ssz-verifyd: socket path too long\n");
+    return 1;
+  }
+  strcpy(addr.sun_path, path);
+  unlink(path);
+
+  listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (listen_fd < 0 || bind(listen_fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 || listen(listen_fd, 128) != 0) {
+    fprintf(stderr, "ssz-verifyd: cannot listen on %s: %s\n", path, strerror(errno));
+    return 1;
+  }
+
+  struct sigaction sa;
+  memset(&sa, 0, sizeof(sa));
+  sa.sa_handler = on_signal;
+  sigaction(SIGINT, &sa, NULL);
+  sigaction(SIGTERM, &sa, NULL);
+
+  pthread_t *workers = malloc((size_t)threads * sizeof(*workers));
+  for (long i = 0; i < threads; i++) pthread_create(&workers[i], NULL, worker, d);
+  fprintf(stderr, "ssz-verifyd: listening on %s (%ld workers, batch %u, window %lluus, queue %lluMiB/%u)\n",
+          path, threads, batch_max, (unsigned long long)window_us, (unsigned long long)queue_mib, queue_depth);
+
+  while (!shutting_down) {
+    int fd = accept(listen_fd, NULL, NULL);
+    if (fd < 0) {
+      if (errno == EINTR || errno == ECONNABORTED) continue;
+      break;
+    }
+    Conn *c = malloc(sizeof(*c));
+    if (!c) {
+      close(fd);
+      continue;
+    }
+    c->fd = fd;
+    c->refs = 1;
+    pthread_mutex_init(&c->wlock, NULL);
+    pthread_t tid;
+    if (pthread_create(&tid, NULL, conn_reader, c) != 0) {
+      conn_release(c);
+      continue;
+    }
+    pthread_detach(tid);
+  }
+
+  /* Drain queued requests, then stop workers */
+  pthread_mutex_lock(&d->lock);
+  d->stop = 1;
+  pthread_cond_broadcast(&d->ready);
+  pthread_cond_broadcast(&d->space);
+  pthread_mutex_unlock(&d->lock);
+  for (long i = 0; i < threads; i++) pthread_join(workers[i], NULL);
+  free(workers);
+  close(listen_fd);
+  unlink(path);
+
+  char text[2048];
+  format_stats(text, sizeof(text));
+  fprintf(stderr, "%s", text);
+  return 0;
+}
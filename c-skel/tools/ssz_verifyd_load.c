@@ -0,0 +1,241 @@
+/* ssz-verifyd-load: load generator for ssz-verifyd
+ *
+ * Usage: ssz-verifyd-load [-s socket] [-c connections] [-n requests] [-d depth]
+ *                         [-p payload_bytes] [-t type_id]
+ *
+ * Each connection keeps `depth` requests in flight and checks every returned
+ * root against the local library. Prints throughput, latency percentiles
+ * (send to reply, as seen by the client) and the daemon's own stats. */
+
+#define _GNU_SOURCE
+#include "verifyd_proto.h"
+#include <errno.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <time.h>
+#include <unistd.h>
+
+#define PAYLOAD_VARIANTS 16
+
+typedef struct {
+  const char *path;
+  uint32_t requests;
+  uint32_t depth;
+  uint16_t type;
+  uint32_t payload_len;
+  uint8_t *payloads[PAYLOAD_VARIANTS];
+  uint8_t roots[PAYLOAD_VARIANTS][32];
+} Load;
+
+typedef struct {
+  Load *load;
+  uint64_t *latency_ns;       /* indexed by request id */
+  uint32_t failures;
+  int io_error;
+} ConnJob;
+
+static uint64_t now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+static int connect_to(const char *path) {
+  struct sockaddr_un addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  snprintf(addr.sun_path, sizeof(addr.sun_path), "%s", path);
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0) return -1;
+  if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0) {
+    close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+static int read_all(int fd, uint8_t *buf, size_t n) {
+  size_t got = 0;
+  while (got < n) {
+    ssize_t k = read(fd, buf + got, n - got);
+    if (k < 0 && errno == EINTR) continue;
+    if (k <= 0) return -1;
+    got += (size_t)k;
+  }
+  return 0;
+}
+
+static int write_all(int fd, const uint8_t *buf, size_t n) {
+  size_t sent = 0;
+  while (sent < n) {
+    ssize_t k = send(fd, buf + sent, n - sent, MSG_NOSIGNAL);
+    if (k < 0 && errno == EINTR) continue;
+    if (k <= 0) return -1;
+    sent += (size_t)k;
+  }
+  return 0;
+}
+
+static int send_request(int fd, uint32_t id, uint16_t type, const uint8_t *payload, uint32_t len) {
+  uint8_t hdr[VERIFYD_REQ_HEADER];
+  verifyd_put32(hdr, 8 + len);
+  verifyd_put32(hdr + 4, id);
+  hdr[8] = (uint8_t)type;
+  hdr[9] = (uint8_t)(type >> 8);
+  hdr[10] = 0;
+  hdr[11] = 0;
+  if (write_all(fd, hdr, sizeof(hdr)) != 0) return -1;
+  return len ? write_all(fd, payload, len) : 0;
+}
+
+/* Reads one response; body must hold at least cap bytes, returns body length or -1 */
+static long read_response(int fd, uint32_t *id, int32_t *status, uint8_t *body, size_t cap) {
+  uint8_t hdr[VERIFYD_RESP_HEADER];
+  if (read_all(fd, hdr, sizeof(hdr)) != 0) return -1;
+  uint32_t len = verifyd_get32(hdr) - 8;
+  *id = verifyd_get32(hdr + 4);
+  *status = (int32_t)verifyd_get32(hdr + 8);
+  if (len > cap || read_all(fd, body, len) != 0) return -1;
+  return (long)len;
+}
+
+static void *run_conn(void *arg) {
+  ConnJob *job = (ConnJob *)arg;
+  Load *load = job->load;
+  uint64_t *sent_at = calloc(load->requests, sizeof(uint64_t));
+  int fd = connect_to(load->path);
+  if (fd < 0 || !sent_at) {
+    job->io_error = 1;
+    free(sent_at);
+    return NULL;
+  }
+
+  uint32_t next = 0;
+  uint32_t done = 0;
+  uint8_t body[256];
+  while (done < load->requests) {
+    while (next < load->requests && next - done < load->depth) {
+      sent_at[next] = now_ns();
+      if (send_request(fd, next, load->type, load->payloads[next % PAYLOAD_VARIANTS], load->payload_len) != 0) {
+        job->io_error = 1;
+        goto out;
+      }
+      next++;
+    }
+    uint32_t id;
+    int32_t status;
+    long n = read_response(fd, &id, &status, body, sizeof(body));
+    if (n < 0 || id >= load->requests) {
+      job->io_error = 1;
+      goto out;
+    }
+    job->latency_ns[id] = now_ns() - sent_at[id];
+    if (status != 0 || n != 32 || memcmp(body, load->roots[id % PAYLOAD_VARIANTS], 32) != 0) job->failures++;
+    done++;
+  }
+
+out:
+  close(fd);
+  free(sent_at);
+  return NULL;
+}
+
+static int cmp_u64(const void *a, const void *b) {
+  uint64_t x = *(const uint64_t *)a;
+  uint64_t y = *(const uint64_t *)b;
+  return x < y ? -1 : x > y;
+}
+
+static void usage(void) {
+  fprintf(stderr, "Usage: ssz-verifyd-load [-s socket] [-c connections] [-n requests] [-d depth] "
+                  "[-p payload_bytes] [-t type_id]\n");
+  exit(2);
+}
+
+int main(int argc, char **argv) {
+  Load load = {VERIFYD_DEFAULT_SOCKET, 10000, 16, 0, 256, {0}, {{0}}};
+  uint32_t conns = 4;
+
+  for (int i = 1; i < argc; i++) {
+    if (i + 1 >= argc) usage();
+    if (strcmp(argv[i], "-s") == 0) load.path = argv[++i];
+    else if (strcmp(argv[i], "-c") == 0) conns = (uint32_t)strtoul(argv[++i], NULL, 10);
+    else if (strcmp(argv[i], "-n") == 0) load.requests = (uint32_t)strtoul(argv[++i], NULL, 10);
+    else if (strcmp(argv[i], "-d") == 0) load.depth = (uint32_t)strtoul(argv[++i], NULL, 10);
+    else if (strcmp(argv[i], "-p") == 0) load.payload_len = (uint32_t)strtoul(argv[++i], NULL, 10);
+    else if (strcmp(argv[i], "-t") == 0) load.type = (uint16_t)strtoul(argv[++i], NULL, 10);
+    else usage();
+  }
+  if (conns < 1 || load.requests < 1 || load.depth < 1 || load.type >= VERIFYD_TYPE_COUNT) usage();
+
+  /* Payload variants and their expected roots */
+  for (int v = 0; v < PAYLOAD_VARIANTS; v++) {
+    char err[128] = {0};
+    load.payloads[v] = malloc(load.payload_len ? load.payload_len : 1);
+    for (uint32_t i = 0; i < load.payload_len; i++) load.payloads[v][i] = (uint8_t)(i * 31 + v);
+    if (load.type == 4 && load.payload_len) load.payloads[v][load.payload_len - 1] |= 0x80;
+    if (ssz_stream_root_from_buffer(load.payloads[v], load.payload_len, &VERIFYD_TYPES[load.type],
+                                    load.roots[v], err) != 0) {
+      fprintf(stderr, "ssz-verifyd-load: payload invalid for type %u: %s\n", load.type, err);
+      return 1;
+    }
+  }
+
+  ConnJob *jobs = calloc(conns, sizeof(*jobs));
+  pthread_t *tids = calloc(conns, sizeof(*tids));
+  uint64_t total = (uint64_t)conns * load.requests;
+  uint64_t *latency = calloc(total, sizeof(uint64_t));
+
+  uint64_t t0 = now_ns();
+  for (uint32_t c = 0; c < conns; c++) {
+    jobs[c].load = &load;
+    jobs[c].latency_ns = latency + (uint64_t)c * load.requests;
+    pthread_create(&tids[c], NULL, run_conn, &jobs[c]);
+  }
+  uint32_t failures = 0;
+  int io_errors = 0;
+  for (uint32_t c = 0; c < conns; c++) {
+    pthread_join(tids[c], NULL);
+    failures += jobs[c].failures;
+    io_errors += jobs[c].io_error;
+  }
+  double seconds = (double)(now_ns() - t0) / 1e9;
+
+  if (io_errors) {
+    fprintf(stderr, "ssz-verifyd-load: %d connection(s) failed (is ssz-verifyd running on %s?)\n",
+            io_errors, load.path);
+    return 1;
+  }
+
+  qsort(latency, total, sizeof(uint64_t), cmp_u64);
+  printf("requests=%llu connections=%u depth=%u payload=%uB type=%u\n",
+         (unsigned long long)total, conns, load.depth, load.payload_len, load.type);
+  printf("throughput %.0f req/s, %.1f MB/s, root mismatches %u\n",
+         (double)total / seconds, (double)total * load.payload_len / seconds / 1e6, failures);
+  printf("latency_us p50 %.1f p90 %.1f p99 %.1f p99.9 %.1f max %.1f\n",
+         latency[total * 50 / 100] / 1e3, latency[total * 90 / 100] / 1e3, latency[total * 99 / 100] / 1e3,
+         latency[total * 999 / 1000] / 1e3, latency[total - 1] / 1e3);
+
+  /* Daemon-side view */
+  int fd = connect_to(load.path);
+  uint8_t stats[2048];
+  uint32_t id;
+  int32_t status;
+  long n;
+  if (fd >= 0 && send_request(fd, 0, VERIFYD_TYPE_STATS, NULL, 0) == 0 &&
+      (n = read_response(fd, &id, &status, stats, sizeof(stats) - 1)) >= 0) {
+    stats[n] = 0;
+    printf("--- daemon stats ---\n%s", (char *)stats);
+  }
+  if (fd >= 0) close(fd);
+
+  for (int v = 0; v < PAYLOAD_VARIANTS; v++) free(load.payloads[v]);
+  free(latency);
+  free(tids);
+  free(jobs);
+  return failures ? 1 : 0;
+}
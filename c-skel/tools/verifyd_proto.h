@@ -0,0 +1,49 @@
+#ifndef VERIFYD_PROTO_H
+#define VERIFYD_PROTO_H
+
+/* ssz-verifyd wire protocol, shared by the daemon and its load generator.
+ *
+ * All integers little-endian. Every frame starts with a u32 length counting the
+ * bytes that follow it.
+ *
+ *   request:  u32 len | u32 id | u16 type_id | u16 reserved | payload
+ *   response: u32 len | u32 id | i32 status  | body
+ *
+ * body is the 32-byte root when status is 0, otherwise the error message.
+ * type_id VERIFYD_TYPE_STATS returns a text snapshot of the daemon counters.
+ * Responses on one connection may arrive out of order: match them by id. */
+
+#include "ssz_stream.h"
+
+#define VERIFYD_DEFAULT_SOCKET "/tmp/ssz-verifyd.sock"
+#define VERIFYD_REQ_HEADER 12
+#define VERIFYD_RESP_HEADER 12
+#define VERIFYD_MAX_PAYLOAD (64u << 20)
+#define VERIFYD_TYPE_STATS 0xffff
+
+static const TypeDesc VERIFYD_U8 = {SSZ_KIND_BASIC, 1, NULL, NULL, 0, 0};
+static const TypeDesc VERIFYD_U64 = {SSZ_KIND_BASIC, 8, NULL, NULL, 0, 0};
+
+/* Built-in type table, indexed by type_id */
+static const TypeDesc VERIFYD_TYPES[] = {
+  {SSZ_KIND_LIST, 0, &VERIFYD_U8, NULL, 0, 0xffffffffu},    /* 0: List[uint8] */
+  {SSZ_KIND_BASIC, 8, NULL, NULL, 0, 0},                    /* 1: uint64 */
+  {SSZ_KIND_VECTOR, 0, &VERIFYD_U8, NULL, 0, 0},            /* 2: Vector[uint8] (bytes32 etc.) */
+  {SSZ_KIND_LIST, 0, &VERIFYD_U64, NULL, 0, 0xffffffffu},   /* 3: List[uint64] */
+  {SSZ_KIND_BITLIST, 0, NULL, NULL, 0, 0xffffffffu},        /* 4: Bitlist */
+};
+
+#define VERIFYD_TYPE_COUNT (sizeof(VERIFYD_TYPES) / sizeof(VERIFYD_TYPES[0]))
+
+static inline void verifyd_put32(uint8_t *p, uint32_t v) {
+  p[0] = (uint8_t)v;
+  p[1] = (uint8_t)(v >> 8);
+  p[2] = (uint8_t)(v >> 16);
+  p[3] = (uint8_t)(v >> 24);
+}
+
+static inline uint32_t verifyd_get32(const uint8_t *p) {
+  return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+#endif
@@ -1,10 +1,14 @@
 {
+  "variables": {
+    "ssz_trace%": 0
+  },
   "targets": [
     {
       "target_name": "ssz_native",
       "sources": [
         "src/sha256_native.cc",
         "src/sha256_fallback.cc",
+        "src/merkleizer.cc",
         "src/addon.cc"
       ],
       "include_dirs": [
@@ -18,6 +22,14 @@
       "cflags_cc!": ["-fno-exceptions"],
       "defines": ["NAPI_DISABLE_CPP_EXCEPTIONS"],
       "conditions": [
+        [
+          "ssz_trace==1",
+          {
+            "sources": ["../c-skel/src/ssz_trace.c"],
+            "include_dirs": ["../c-skel/include"],
+            "defines": ["SSZ_TRACE"]
+          }
+        ],
         [
           "OS=='win'",
           {
@@ -4,17 +4,46 @@
 
 #include <napi.h>
 
+#ifdef SSZ_TRACE
+#include "ssz_trace.h"
+
+// Write the spans recorded so far as Chrome Trace Event JSON
+static Napi::Value TraceExport(const Napi::CallbackInfo& info) {
+  Napi::Env env = info.Env();
+  if (info.Length() < 1 || !info[0].IsString()) {
+    Napi::TypeError::New(env, "Expected output path").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  char err[128] = {0};
+  if (ssz_trace_export(info[0].As<Napi::String>().Utf8Value().c_str(), err) != 0) {
+    Napi::Error::New(env, err).ThrowAsJavaScriptException();
+  }
+  return env.Undefined();
+}
+#endif
+
 // Import functions from sha256_native.cc
 extern Napi::Value HashLeaf(const Napi::CallbackInfo& info);
 extern Napi::Value HashParent(const Napi::CallbackInfo& info);
+extern Napi::Value HashPairs(const Napi::CallbackInfo& info);
 extern Napi::Value HasNativeSupport(const Napi::CallbackInfo& info);
 extern Napi::Value GetImplementation(const Napi::CallbackInfo& info);
 
+// Incremental merkleizer and time-sliced root classes from merkleizer.cc
+extern Napi::Function DefineMerkleizer(Napi::Env env);
+extern Napi::Function DefineRootTask(Napi::Env env);
+
 Napi::Object Init(Napi::Env env, Napi::Object exports) {
   exports.Set("hashLeaf", Napi::Function::New(env, HashLeaf));
   exports.Set("hashParent", Napi::Function::New(env, HashParent));
+  exports.Set("hashPairs", Napi::Function::New(env, HashPairs));
   exports.Set("hasNativeSupport", Napi::Function::New(env, HasNativeSupport));
   exports.Set("getImplementation", Napi::Function::New(env, GetImplementation));
+  exports.Set("Merkleizer", DefineMerkleizer(env));
+  exports.Set("RootTask", DefineRootTask(env));
+#ifdef SSZ_TRACE
+  exports.Set("traceExport", Napi::Function::New(env, TraceExport));
+#endif
   return exports;
 }
 
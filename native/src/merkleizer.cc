@@ -0,0 +1,657 @@
+/**
+ * Incremental merkleizer for Node streams
+ *
+ *   const m = new native.Merkleizer(typeDesc);
+ *   m.update(piece); ...            // pieces of any size, split anywhere
+ *   m.digest();                     // { root } | { error, msg }
+ *
+ * Takes the same TypeDesc objects as the TypeScript API and produces the
+ * same roots and errors as sszStreamRootFromSlice, without ever holding the
+ * input: the carry frontier (one 32-byte node per tree level) and at most
+ * one partial chunk live here in C++. The only input kept is the offset
+ * header of a variable-size type, which is bounded by the container's fixed
+ * part or by 4 bytes per list element.
+ */
+
+#include <napi.h>
+#include <chrono>
+#include <cstring>
+#include <cstdint>
+#include <vector>
+#include "sha256_native.h"
+
+#ifdef SSZ_TRACE
+#include "ssz_trace.h"
+#else
+#define SSZ_TRACE_BEGIN(name) ((void)0)
+#define SSZ_TRACE_END(name) ((void)0)
+#endif
+
+namespace {
+
+// Mirrors TypeKind and SszError in src/types.ts
+enum Kind { kBasic = 0, kVector = 1, kList = 2, kContainer = 3, kBitlist = 4 };
+enum Error {
+  kNone = 0,
+  kBadOffset = 1,
+  kNonCanonical = 2,
+  kBitlistPadding = 3,
+  kUnsupportedType = 4,
+  kMalformedHeader = 5,
+  kLengthOverflow = 6,
+  kUnexpectedEOF = 7,
+};
+
+const int kMaxDepth = 65;
+
+// Leaf pairs hashed per batch
+const size_t kPairBatch = 16;
+
+// zero_hash(h) is the root of 2^h zero chunks
+const uint8_t* zero_hash(int height) {
+  static uint8_t table[kMaxDepth][32];
+  static int filled = 1;
+  while (filled <= height) {
+    ssz_native::sha256_hash_pair(table[filled - 1], table[filled - 1], table[filled]);
+    filled++;
+  }
+  return table[height];
+}
+
+bool is_zero(const uint8_t* p, size_t len) {
+  for (size_t i = 0; i < len; i++) {
+    if (p[i]) return false;
+  }
+  return true;
+}
+
+// Binary carry over chunks, as computeRootFromChunks in src/merkle.ts
+class Frontier {
+ public:
+  void push_leaf(const uint8_t chunk[32]) {
+    push(chunk, 0, is_zero(chunk, 32));
+  }
+
+  // Leaf pairs straight from the input, when no leaf is pending. The pairs
+  // are independent, so they are hashed as one batch.
+  void push_leaf_pairs(const uint8_t* pairs, size_t count) {
+    if (is_zero(pairs, count * 64)) {
+      for (size_t i = 0; i < count; i++) push(zero_hash(1), 1, true);
+      return;
+    }
+    uint8_t parents[kPairBatch][32];
+    ssz_native::sha256_hash_pairs(pairs, count, parents[0]);
+    for (size_t i = 0; i < count; i++) {
+      bool zero = is_zero(pairs + i * 64, 64);
+      push(zero ? zero_hash(1) : parents[i], 1, zero);
+    }
+  }
+
+  bool leaf_pending() const { return depth_ > 0 && height_[depth_ - 1] == 0; }
+
+  void finish(uint8_t out[32]) {
+    if (depth_ == 0) {
+      memset(out, 0, 32);
+      return;
+    }
+    while (depth_ > 1) {
+      int left = depth_ - 2;
+      int right = depth_ - 1;
+      int height = (height_[left] > height_[right] ? height_[left] : height_[right]) + 1;
+      uint8_t parent[32];
+      ssz_native::sha256_hash_pair(hash_[left], hash_[right], parent);
+      depth_ -= 2;
+      push(parent, height, false);
+    }
+    memcpy(out, hash_[0], 32);
+  }
+
+ private:
+  void push(const uint8_t node[32], int height, bool zero) {
+    memcpy(hash_[depth_], node, 32);
+    height_[depth_] = height;
+    zero_[depth_] = zero;
+    depth_++;
+    while (depth_ >= 2 && height_[depth_ - 2] == height_[depth_ - 1]) {
+      int below = depth_ - 2;
+      int h = height_[below] + 1;
+      if (zero_[below] && zero_[below + 1]) {
+        memcpy(hash_[below], zero_hash(h), 32);
+      } else {
+        ssz_native::sha256_hash_pair(hash_[below], hash_[below + 1], hash_[below]);
+        zero_[below] = false;
+      }
+      height_[below] = h;
+      depth_--;
+    }
+  }
+
+  uint8_t hash_[kMaxDepth][32];
+  int height_[kMaxDepth];
+  bool zero_[kMaxDepth];
+  int depth_ = 0;
+};
+
+// Chunks the bytes of one range at a time; a range ends zero-padded to a
+// whole chunk, as streamChunksFromSlice does
+class Chunker {
+ public:
+  explicit Chunker(Frontier* frontier) : frontier_(frontier) {}
+
+  void feed(const uint8_t* p, size_t n) {
+    if (fill_ > 0) {
+      size_t take = n < 32 - fill_ ? n : 32 - fill_;
+      memcpy(partial_ + fill_, p, take);
+      fill_ += take;
+      p += take;
+      n -= take;
+      if (fill_ < 32) return;
+      frontier_->push_leaf(partial_);
+      fill_ = 0;
+    }
+    if (n >= 32 && frontier_->leaf_pending()) {
+      frontier_->push_leaf(p);
+      p += 32;
+      n -= 32;
+    }
+    while (n >= 64) {
+      size_t count = n / 64 < kPairBatch ? n / 64 : kPairBatch;
+      frontier_->push_leaf_pairs(p, count);
+      p += count * 64;
+      n -= count * 64;
+    }
+    for (; n >= 32; p += 32, n -= 32) frontier_->push_leaf(p);
+    memcpy(partial_, p, n);
+    fill_ = n;
+  }
+
+  void end_range() {
+    if (fill_ == 0) return;
+    memset(partial_ + fill_, 0, 32 - fill_);
+    frontier_->push_leaf(partial_);
+    fill_ = 0;
+  }
+
+ private:
+  Frontier* frontier_;
+  uint8_t partial_[32];
+  size_t fill_ = 0;
+};
+
+// How a type's bytes split into ranges (see parseToRanges in src/sszParser.ts)
+enum Layout {
+  kWhole,           // one range: basic types, bitlists, field-less containers
+  kFixedElements,   // list or vector of fixed-size elements
+  kVariableList,    // list or vector with an offset table
+  kFixedContainer,  // container of fixed-size fields only
+  kVariableContainer,
+};
+
+uint32_t read_u32(const uint8_t* p) {
+  return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+// Root of one value fed in pieces: the state shared by Merkleizer and RootTask
+class StreamRoot {
+ public:
+  void Compile(Napi::Object td) {
+    Napi::Value kind = td.Get("kind");
+    if (!kind.IsNumber()) return Fail(kUnsupportedType, "Unknown TypeKind");
+    kind_ = kind.As<Napi::Number>().Int32Value();
+    switch (kind_) {
+      case kBasic:
+        if (!FixedSize(td, &fixed_size_)) return Fail(kUnsupportedType, "Basic type missing fixedSize");
+        layout_ = kWhole;
+        return;
+      case kBitlist:
+        layout_ = kWhole;
+        return;
+      case kList:
+      case kVector: {
+        Napi::Value elem = td.Get("elementType");
+        if (!elem.IsObject()) return Fail(kUnsupportedType, "List/Vector missing elementType");
+        uint32_t size = 0;
+        if (FixedSize(elem.As<Napi::Object>(), &size) && size > 0) {
+          layout_ = kFixedElements;
+          fixed_size_ = size;
+        } else {
+          layout_ = kVariableList;
+          header_end_ = 4;
+        }
+        return;
+      }
+      case kContainer: {
+        Napi::Value fields = td.Get("fieldTypes");
+        uint32_t count = fields.IsArray() ? fields.As<Napi::Array>().Length() : 0;
+        if (count == 0) {
+          layout_ = kWhole;
+          return;
+        }
+        Napi::Array arr = fields.As<Napi::Array>();
+        bool variable = false;
+        for (uint32_t i = 0; i < count; i++) {
+          uint32_t size = 0;
+          Napi::Value ft = arr.Get(i);
+          if (!ft.IsObject() || !FixedSize(ft.As<Napi::Object>(), &size)) size = 0;
+          field_sizes_.push_back(size);
+          header_end_ += size > 0 ? size : 4;
+          if (size == 0) variable = true;
+        }
+        layout_ = variable ? kVariableContainer : kFixedContainer;
+        return;
+      }
+      default:
+        Fail(kUnsupportedType, "Unknown TypeKind");
+    }
+  }
+
+  // Feed n bytes at stream position pos_ into whichever range they belong to
+  void Consume(const uint8_t* p, size_t n) {
+    if (n > 0) last_byte_ = p[n - 1];
+    switch (layout_) {
+      case kWhole:
+        chunker_.feed(p, n);
+        pos_ += n;
+        return;
+      case kFixedElements:
+      case kFixedContainer:
+        ConsumeFixedRanges(p, n);
+        return;
+      case kVariableList:
+      case kVariableContainer:
+        ConsumeVariable(p, n);
+        return;
+    }
+  }
+
+  void Finish(uint8_t root[32]) {
+    uint64_t len = pos_;
+    uint64_t mixin = 0;
+    bool has_mixin = false;
+
+    switch (layout_) {
+      case kWhole:
+        if (kind_ == kBasic && fixed_size_ > 0 && len != fixed_size_)
+          return Fail(kNonCanonical, "Basic type length mismatch");
+        if (kind_ == kBitlist) {
+          if (len == 0) return Fail(kNonCanonical, "Bitlist empty");
+          if (last_byte_ == 0) return Fail(kBitlistPadding, "Bitlist sentinel missing");
+          uint64_t bits = (len - 1) * 8;
+          for (uint8_t s = last_byte_; s > 1; s >>= 1) bits++;
+          uint32_t padding = (uint32_t)(len * 8 - bits - 1);
+          if ((last_byte_ & ((1u << padding) - 1)) != 0)
+            return Fail(kBitlistPadding, "Bitlist padding non-zero");
+          mixin = bits;
+          has_mixin = true;
+        }
+        chunker_.end_range();
+        break;
+      case kFixedElements:
+        if (len % fixed_size_ != 0) return Fail(kNonCanonical, "List fixed-size element misalignment");
+        mixin = len / fixed_size_;
+        has_mixin = kind_ == kList;
+        break;
+      case kFixedContainer:
+        if (len != header_end_) return Fail(kMalformedHeader, "Container length mismatch");
+        break;
+      case kVariableList:
+        if (len < 4) return Fail(kMalformedHeader, "Variable list too short for offsets");
+        if (len < header_end_) return Fail(kBadOffset, "Offset table beyond buffer");
+        if (offsets_.back() > len) return Fail(kLengthOverflow, "Offset beyond buffer");
+        if (offsets_.back() != len) return Fail(kNonCanonical, "Trailing bytes in list");
+        chunker_.end_range();
+        mixin = offsets_.size();
+        has_mixin = kind_ == kList;
+        break;
+      case kVariableContainer:
+        if (len < header_end_) return Fail(kMalformedHeader, "Container too short");
+        if (offsets_.back() > len) return Fail(kLengthOverflow, "Offset beyond buffer");
+        chunker_.end_range();
+        EmitFixedFields(true);
+        break;
+    }
+
+    frontier_.finish(root);
+    if (has_mixin) {
+      uint8_t length[32] = {0};
+      for (int i = 0; i < 8; i++) length[i] = (uint8_t)(mixin >> (8 * i));
+      ssz_native::sha256_hash_pair(root, length, root);
+    }
+  }
+
+  Error error() const { return error_; }
+  const char* msg() const { return msg_; }
+
+ private:
+  void Fail(Error error, const char* msg) {
+    if (error_ != kNone) return;
+    error_ = error;
+    msg_ = msg;
+  }
+
+  static bool FixedSize(Napi::Object td, uint32_t* out) {
+    Napi::Value v = td.Get("fixedSize");
+    if (!v.IsNumber()) return false;
+    *out = v.As<Napi::Number>().Uint32Value();
+    return true;
+  }
+
+  // Size of the fixed range at index i; fixed elements repeat forever
+  uint64_t FixedRange(size_t i) const {
+    if (layout_ == kFixedElements) return fixed_size_;
+    return i < field_sizes_.size() ? field_sizes_[i] : 0;
+  }
+
+  void ConsumeFixedRanges(const uint8_t* p, size_t n) {
+    while (n > 0) {
+      uint64_t size = FixedRange(range_);
+      if (size == 0) {
+        // Past the last field: only the length check at the end remains
+        pos_ += n;
+        return;
+      }
+      size_t take = size - in_range_ < n ? (size_t)(size - in_range_) : n;
+      chunker_.feed(p, take);
+      p += take;
+      n -= take;
+      pos_ += take;
+      in_range_ += take;
+      if (in_range_ == size) {
+        chunker_.end_range();
+        range_++;
+        in_range_ = 0;
+      }
+    }
+  }
+
+  void ConsumeVariable(const uint8_t* p, size_t n) {
+    // The offset header is buffered until complete; the first list offset
+    // says how long the list header is
+    while (n > 0 && pos_ < header_end_) {
+      size_t take = header_end_ - pos_ < n ? (size_t)(header_end_ - pos_) : n;
+      header_.insert(header_.end(), p, p + take);
+      p += take;
+      n -= take;
+      pos_ += take;
+      if (pos_ < header_end_) return;
+      if (layout_ == kVariableList && !list_sized_) {
+        uint32_t first = read_u32(header_.data());
+        if (first < 4) return Fail(kMalformedHeader, "No offsets found");
+        if (first % 4 != 0) return Fail(kBadOffset, "Offset table misalignment");
+        header_end_ = first;
+        list_sized_ = true;
+        if (pos_ < header_end_) continue;
+      }
+      if (!ParseHeader()) return;
+    }
+    while (n > 0) {
+      // Bytes between here and the next boundary belong to the current range
+      uint64_t boundary = next_ < offsets_.size() ? offsets_[next_] : UINT64_MAX;
+      size_t take = boundary - pos_ < n ? (size_t)(boundary - pos_) : n;
+      if (next_ > 0) chunker_.feed(p, take);
+      p += take;
+      n -= take;
+      pos_ += take;
+      if (pos_ == boundary) EnterRange();
+    }
+  }
+
+  // Offsets are checked as soon as the header is complete; whether they fit
+  // the input is only known at the end
+  bool ParseHeader() {
+    const uint8_t* h = header_.data();
+    if (layout_ == kVariableList) {
+      for (uint64_t i = 0; i < header_end_; i += 4) offsets_.push_back(read_u32(h + i));
+    } else {
+      uint64_t at = 0;
+      for (uint32_t size : field_sizes_) {
+        if (size > 0) {
+          at += size;
+          continue;
+        }
+        uint32_t off = read_u32(h + at);
+        if (off < header_end_) {
+          Fail(kBadOffset, "Offset points into header");
+          return false;
+        }
+        offsets_.push_back(off);
+        at += 4;
+      }
+    }
+    for (size_t i = 1; i < offsets_.size(); i++) {
+      if (offsets_[i] <= offsets_[i - 1]) {
+        Fail(kBadOffset, "Offsets not strictly increasing");
+        return false;
+      }
+    }
+    // Fixed fields ahead of the first variable one go out now
+    EmitFixedFields(false);
+    if (pos_ == offsets_[0]) EnterRange();
+    return true;
+  }
+
+  // Close the variable range before offsets_[next_], open the one after it
+  void EnterRange() {
+    if (next_ > 0) {
+      chunker_.end_range();
+      EmitFixedFields(true);
+    }
+    next_++;
+  }
+
+  // Container fields up to the next variable one, stepping past the variable
+  // field whose range just closed
+  void EmitFixedFields(bool after_variable) {
+    if (layout_ != kVariableContainer) return;
+    if (after_variable) {
+      field_++;
+      field_at_ += 4;
+    }
+    while (field_ < field_sizes_.size() && field_sizes_[field_] > 0) {
+      uint32_t size = field_sizes_[field_];
+      chunker_.feed(header_.data() + field_at_, size);
+      chunker_.end_range();
+      field_at_ += size;
+      field_++;
+    }
+  }
+
+  Frontier frontier_;
+  Chunker chunker_{&frontier_};
+  int kind_ = kBasic;
+  Layout layout_ = kWhole;
+  uint32_t fixed_size_ = 0;
+  std::vector<uint32_t> field_sizes_;
+
+  uint64_t pos_ = 0;        // bytes consumed
+  uint8_t last_byte_ = 0;
+  size_t range_ = 0;        // current fixed range
+  uint64_t in_range_ = 0;   // bytes of it consumed
+
+  uint64_t header_end_ = 0;
+  std::vector<uint8_t> header_;
+  std::vector<uint64_t> offsets_;
+  bool list_sized_ = false;   // first list offset seen
+  size_t next_ = 0;           // offsets_[next_] is the next boundary
+  size_t field_ = 0;          // next container field to emit
+  uint64_t field_at_ = 0;     // its position in the header
+
+  Error error_ = kNone;
+  const char* msg_ = "";
+};
+
+// { root } or { error, msg }
+Napi::Object ResultObject(Napi::Env env, const StreamRoot& value, const uint8_t root[32]) {
+  Napi::Object result = Napi::Object::New(env);
+  if (value.error() != kNone) {
+    result.Set("error", Napi::Number::New(env, value.error()));
+    result.Set("msg", Napi::String::New(env, value.msg()));
+  } else {
+    result.Set("root", Napi::Buffer<uint8_t>::Copy(env, root, 32));
+  }
+  return result;
+}
+
+class Merkleizer : public Napi::ObjectWrap<Merkleizer> {
+ public:
+  static Napi::Function Define(Napi::Env env) {
+    return DefineClass(env, "Merkleizer", {
+      InstanceMethod("update", &Merkleizer::Update),
+      InstanceMethod("digest", &Merkleizer::Digest),
+    });
+  }
+
+  explicit Merkleizer(const Napi::CallbackInfo& info) : Napi::ObjectWrap<Merkleizer>(info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 1 || !info[0].IsObject()) {
+      Napi::TypeError::New(env, "Expected TypeDesc argument").ThrowAsJavaScriptException();
+      return;
+    }
+    value_.Compile(info[0].As<Napi::Object>());
+  }
+
+ private:
+  Napi::Value Update(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (done_) {
+      Napi::Error::New(env, "Merkleizer already digested").ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+    if (info.Length() < 1 || !info[0].IsTypedArray() ||
+        info[0].As<Napi::TypedArray>().TypedArrayType() != napi_uint8_array) {
+      Napi::TypeError::New(env, "Expected Uint8Array or Buffer").ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+    Napi::Uint8Array buf = info[0].As<Napi::Uint8Array>();
+    SSZ_TRACE_BEGIN("update");
+    if (value_.error() == kNone) value_.Consume(buf.Data(), buf.ByteLength());
+    SSZ_TRACE_END("update");
+    return info.This();
+  }
+
+  Napi::Value Digest(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (done_) {
+      Napi::Error::New(env, "Merkleizer already digested").ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+    done_ = true;
+    uint8_t root[32];
+    SSZ_TRACE_BEGIN("digest");
+    if (value_.error() == kNone) value_.Finish(root);
+    SSZ_TRACE_END("digest");
+    return ResultObject(env, value_, root);
+  }
+
+  StreamRoot value_;
+  bool done_ = false;
+};
+
+// Bytes hashed between clock checks in a time-bounded slice
+const size_t kSlicePiece = 64 * 32;
+
+/**
+ * Root of a whole buffer in bounded slices, for hosts that must keep serving
+ * their event loop while a large value hashes:
+ *
+ *   const task = new native.RootTask(typeDesc, bytes, { sliceNs: 1e6 });
+ *   let step;
+ *   while (!(step = task.next()).done) await new Promise(setImmediate);
+ *   step.value;                     // { root } | { error, msg }
+ *
+ * Each next() hashes until sliceNs nanoseconds have passed or sliceChunks
+ * chunks are in (0 for no limit; the default is a 1 ms slice), checking the
+ * clock every kSlicePiece bytes, so a slice overruns its budget by at most
+ * one piece. Unfinished steps carry the bytes consumed so far as their value.
+ * The task is its own iterator. It keeps bytes alive but does not copy them,
+ * so they must not change until it is done.
+ */
+class RootTask : public Napi::ObjectWrap<RootTask> {
+ public:
+  static Napi::Function Define(Napi::Env env) {
+    return DefineClass(env, "RootTask", {
+      InstanceMethod("next", &RootTask::Next),
+      InstanceMethod(Napi::Symbol::WellKnown(env, "iterator"), &RootTask::Iterator),
+    });
+  }
+
+  explicit RootTask(const Napi::CallbackInfo& info) : Napi::ObjectWrap<RootTask>(info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 2 || !info[0].IsObject() || !info[1].IsTypedArray() ||
+        info[1].As<Napi::TypedArray>().TypedArrayType() != napi_uint8_array) {
+      Napi::TypeError::New(env, "Expected TypeDesc and Uint8Array arguments").ThrowAsJavaScriptException();
+      return;
+    }
+    if (info.Length() > 2 && info[2].IsObject()) {
+      Napi::Object opts = info[2].As<Napi::Object>();
+      Napi::Value ns = opts.Get("sliceNs");
+      Napi::Value chunks = opts.Get("sliceChunks");
+      if (ns.IsNumber()) slice_ns_ = (int64_t)ns.As<Napi::Number>().DoubleValue();
+      if (chunks.IsNumber()) slice_chunks_ = (uint64_t)chunks.As<Napi::Number>().DoubleValue();
+    }
+    bytes_ = Napi::Persistent(info[1].As<Napi::Object>());
+    value_.Compile(info[0].As<Napi::Object>());
+  }
+
+ private:
+  Napi::Value Iterator(const Napi::CallbackInfo& info) {
+    return info.This();
+  }
+
+  Napi::Value Next(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (result_.IsEmpty()) {
+      SSZ_TRACE_BEGIN("slice");
+      RunSlice(env);
+      SSZ_TRACE_END("slice");
+    }
+    Napi::Object step = Napi::Object::New(env);
+    step.Set("done", Napi::Boolean::New(env, !result_.IsEmpty()));
+    if (result_.IsEmpty()) {
+      step.Set("value", Napi::Number::New(env, (double)at_));
+    } else {
+      step.Set("value", result_.Value());
+    }
+    return step;
+  }
+
+  void RunSlice(Napi::Env env) {
+    Napi::Uint8Array bytes = bytes_.Value().As<Napi::Uint8Array>();
+    const uint8_t* data = bytes.Data();
+    size_t len = bytes.ByteLength();
+    auto start = std::chrono::steady_clock::now();
+    uint64_t chunks = 0;
+
+    while (at_ < len && value_.error() == kNone) {
+      size_t n = len - at_ < kSlicePiece ? len - at_ : kSlicePiece;
+      if (slice_chunks_ > 0 && n > (slice_chunks_ - chunks) * 32) n = (size_t)(slice_chunks_ - chunks) * 32;
+      value_.Consume(data + at_, n);
+      at_ += n;
+      chunks += (n + 31) / 32;
+      if (slice_chunks_ > 0 && chunks >= slice_chunks_) return;
+      if (slice_ns_ > 0 && std::chrono::steady_clock::now() - start >= std::chrono::nanoseconds(slice_ns_)) return;
+    }
+
+    uint8_t root[32];
+    if (value_.error() == kNone) value_.Finish(root);
+    result_ = Napi::Persistent(ResultObject(env, value_, root));
+    bytes_.Reset();
+  }
+
+  StreamRoot value_;
+  Napi::ObjectReference bytes_;
+  Napi::ObjectReference result_;
+  size_t at_ = 0;
+  int64_t slice_ns_ = 1000000;
+  uint64_t slice_chunks_ = 0;
+};
+
+}  // namespace
+
+Napi::Function DefineMerkleizer(Napi::Env env) {
+  return Merkleizer::Define(env);
+}
+
+Napi::Function DefineRootTask(Napi::Env env) {
+  return RootTask::Define(env);
+}
@@ -32,29 +32,33 @@ extern "C" void sha256_fallback(const uint8_t* data, size_t len, uint8_t* hash)
     0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
   };
 
-  // Padding
-  size_t padded_len = ((len + 9 + 63) / 64) * 64;
-  uint8_t* padded = new uint8_t[padded_len];
-  memcpy(padded, data, len);
-  padded[len] = 0x80;
-  memset(padded + len + 1, 0, padded_len - len - 9);
-  
+  // Padding: whole blocks are read in place, only the tail is copied
+  size_t full_len = len & ~(size_t)63;
+  size_t rem = len - full_len;
+  size_t tail_len = ((rem + 9 + 63) / 64) * 64;
+  uint8_t tail[128];
+  memcpy(tail, data + full_len, rem);
+  tail[rem] = 0x80;
+  memset(tail + rem + 1, 0, tail_len - rem - 9);
+
   // Append length in bits (big-endian)
-  uint64_t bit_len = len * 8;
+  uint64_t bit_len = (uint64_t)len * 8;
   for (int i = 0; i < 8; i++) {
-    padded[padded_len - 1 - i] = (bit_len >> (i * 8)) & 0xff;
+    tail[tail_len - 1 - i] = (bit_len >> (i * 8)) & 0xff;
   }
+  size_t padded_len = full_len + tail_len;
 
   // Process blocks
   for (size_t offset = 0; offset < padded_len; offset += 64) {
+    const uint8_t* block = offset < full_len ? data + offset : tail + (offset - full_len);
     uint32_t w[64];
     
     // Prepare message schedule
     for (int i = 0; i < 16; i++) {
-      w[i] = ((uint32_t)padded[offset + i * 4] << 24) |
-             ((uint32_t)padded[offset + i * 4 + 1] << 16) |
-             ((uint32_t)padded[offset + i * 4 + 2] << 8) |
-             ((uint32_t)padded[offset + i * 4 + 3]);
+      w[i] = ((uint32_t)block[i * 4] << 24) |
+             ((uint32_t)block[i * 4 + 1] << 16) |
+             ((uint32_t)block[i * 4 + 2] << 8) |
+             ((uint32_t)block[i * 4 + 3]);
     }
     
     for (int i = 16; i < 64; i++) {
@@ -84,8 +88,6 @@ extern "C" void sha256_fallback(const uint8_t* data, size_t len, uint8_t* hash)
     h[4] += e; h[5] += f; h[6] += g; h[7] += hh;
   }
 
-  delete[] padded;
-
   // Output hash (big-endian)
   for (int i = 0; i < 8; i++) {
     hash[i * 4] = (h[i] >> 24) & 0xff;
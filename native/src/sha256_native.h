@@ -15,6 +15,13 @@ void sha256_hash(const uint8_t* data, size_t len, uint8_t* out);
 // Dual hash: (left || right) -> 32-byte digest (optimized for merkle trees)
 void sha256_hash_pair(const uint8_t left[32], const uint8_t right[32], uint8_t* out);
 
+// Batch pair hash: n 64-byte messages at in -> n digests at out, which may
+// be in itself (a merkle level reduced in place). With SHA-NI, up to `ways`
+// messages (4, 2 or 1) go through the rounds together. Two is the default:
+// on the cores measured so far a second stream covers the gap between
+// sha256rnds2 latency and throughput, and four streams spill registers.
+void sha256_hash_pairs(const uint8_t* in, size_t n, uint8_t* out, int ways = 2);
+
 // Check if hardware SHA extensions are available
 bool has_sha_extensions();
 
@@ -0,0 +1,101 @@
+//! Time the Rust roots on a workload written by c-skel's ssz-workload.
+//!
+//! Usage: replay <basic|vector|list|container|bitlist> <fixed_size> <dir>/<scenario> [passes]
+//!
+//! This crate's TypeDesc has no nested types, so the kind and fixed size come
+//! from the caller instead of <scenario>.type.json; for lists and vectors the
+//! fixed size is the element size. Reads <scenario>.ssz and .roots, roots
+//! every object once to warm up and then once per pass (default 5). Prints
+//! one line per object, "<root hex> <ns pass 1> <ns pass 2> ...", the same
+//! format as c-skel's ssz-replay.
+
+use ssz_stream::{ssz_stream_root_from_slice, TypeDesc, TypeKind};
+use std::fs;
+use std::io::{self, Write};
+use std::process::exit;
+use std::time::Instant;
+
+fn usage() -> ! {
+    eprintln!("Usage: replay <basic|vector|list|container|bitlist> <fixed_size> <dir>/<scenario> [passes]");
+    exit(2);
+}
+
+fn main() {
+    let args: Vec<String> = std::env::args().collect();
+    if args.len() < 4 || args.len() > 5 {
+        usage();
+    }
+    let kind = match args[1].as_str() {
+        "basic" => TypeKind::Basic,
+        "vector" => TypeKind::Vector,
+        "list" => TypeKind::List,
+        "container" => TypeKind::Container,
+        "bitlist" => TypeKind::Bitlist,
+        _ => usage(),
+    };
+    let fixed_size: usize = args[2].parse().unwrap_or_else(|_| usage());
+    let td = TypeDesc {
+        kind,
+        fixed_size: if fixed_size > 0 { Some(fixed_size) } else { None },
+    };
+    let prefix = &args[3];
+    let passes: usize = match args.get(4) {
+        Some(p) => p.parse().unwrap_or_else(|_| usage()),
+        None => 5,
+    };
+    if passes == 0 {
+        usage();
+    }
+
+    let data = fs::read(format!("{}.ssz", prefix)).unwrap_or_else(|e| {
+        eprintln!("replay: cannot open {}.ssz: {}", prefix, e);
+        exit(1);
+    });
+    let index = fs::read_to_string(format!("{}.roots", prefix)).unwrap_or_else(|e| {
+        eprintln!("replay: cannot open {}.roots: {}", prefix, e);
+        exit(1);
+    });
+    let mut objects = Vec::new();
+    for (n, line) in index.lines().filter(|l| !l.is_empty()).enumerate() {
+        let mut parts = line.split_whitespace();
+        let offset = parts.next().and_then(|s| s.parse::<usize>().ok());
+        let len = parts.next().and_then(|s| s.parse::<usize>().ok());
+        match (offset, len) {
+            (Some(o), Some(l)) if o <= data.len() && l <= data.len() - o => objects.push((o, l)),
+            _ => {
+                eprintln!("replay: bad line {} in {}.roots", n + 1, prefix);
+                exit(1);
+            }
+        }
+    }
+
+    let mut roots = vec![[0u8; 32]; objects.len()];
+    let mut ns = vec![0u64; objects.len() * passes];
+    for pass in 0..=passes {
+        for (i, &(offset, len)) in objects.iter().enumerate() {
+            let start = Instant::now();
+            let result = ssz_stream_root_from_slice(&td, &data[offset..offset + len]);
+            let elapsed = start.elapsed().as_nanos() as u64;
+            match result {
+                Ok(root) if pass == 0 => roots[i] = root,
+                Ok(_) => ns[i * passes + pass - 1] = elapsed,
+                Err(e) => {
+                    eprintln!("replay: object {}: {:?}", i, e);
+                    exit(1);
+                }
+            }
+        }
+    }
+
+    let stdout = io::stdout();
+    let mut out = io::BufWriter::new(stdout.lock());
+    for (i, root) in roots.iter().enumerate() {
+        for b in root {
+            write!(out, "{:02x}", b).unwrap();
+        }
+        for t in &ns[i * passes..(i + 1) * passes] {
+            write!(out, " {}", t).unwrap();
+        }
+        writeln!(out).unwrap();
+    }
+}
@@ -6,13 +6,14 @@ export function* streamChunksFromSlice(bytes: Uint8Array, ranges: Range[]): Gene
   for (const range of ranges) {
     const len = range.end - range.start;
     let offset = range.start;
-    while (offset < range.end) {
+    /* Whole chunks are views into bytes; only a range's padded tail is copied */
+    for (; offset + 32 <= range.end; offset += 32) {
+      yield bytes.subarray(offset, offset + 32);
+    }
+    if (offset < range.end) {
       const chunk = new Uint8Array(32);
-      const remain = range.end - offset;
-      const toCopy = Math.min(32, remain);
-      chunk.set(bytes.subarray(offset, offset + toCopy), 0);
+      chunk.set(bytes.subarray(offset, range.end), 0);
       yield chunk;
-      offset += 32;
     }
   }
 }
@@ -30,8 +30,9 @@ function sha256(data: Uint8Array): Uint8Array {
   const padded = new Uint8Array(totalLen);
   padded.set(data, 0);
   padded[len] = 0x80;
+  // Big-endian 64-bit length: >>> shifts wrap at 32, so divide for the high word
   for (let i = 0; i < 8; i++) {
-    padded[totalLen - 1 - i] = (bitLen >>> (i * 8)) & 0xff;
+    padded[totalLen - 1 - i] = Math.floor(bitLen / 2 ** (i * 8)) & 0xff;
   }
 
   let h0 = 0x6a09e667,
@@ -36,17 +36,21 @@ export function sszStreamRootFromReader(
   td: TypeDesc,
   reader: (buf: Uint8Array) => number
 ): { root: Uint8Array } | { error: SszError; msg: string } {
-  const tempBuf = new Uint8Array(8192);
-  let allBytes = new Uint8Array(0);
+  /* Read straight into a buffer that doubles when full: linear copying overall */
+  const readSize = 8192;
+  let allBytes = new Uint8Array(64 * 1024);
+  let length = 0;
 
   while (true) {
-    const n = reader(tempBuf);
+    if (allBytes.length - length < readSize) {
+      const grown = new Uint8Array(allBytes.length * 2);
+      grown.set(allBytes.subarray(0, length), 0);
+      allBytes = grown;
+    }
+    const n = reader(allBytes.subarray(length, length + readSize));
     if (n === 0) break;
-    const newAll = new Uint8Array(allBytes.length + n);
-    newAll.set(allBytes, 0);
-    newAll.set(tempBuf.subarray(0, n), allBytes.length);
-    allBytes = newAll;
+    length += n;
   }
 
-  return sszStreamRootFromSlice(td, allBytes);
+  return sszStreamRootFromSlice(td, allBytes.subarray(0, length));
 }
@@ -1,25 +1,236 @@
 /**
  * Multi-threaded merkleizer using Worker Threads
- * Path to 3M+ ops/sec on older hardware
+ *
+ * A MerklePool keeps its workers alive between calls. Chunks are copied once
+ * into a SharedArrayBuffer, each worker folds one power-of-two run of them in
+ * place in that buffer, and the main thread folds the run roots. Tasks are
+ * posted and collected through Atomics on a shared control block, so a call
+ * costs no worker startup and no structured clone of the chunks.
  */
 
-import { Worker } from 'worker_threads';
+import { Worker, MessageChannel } from 'worker_threads';
+import type { MessagePort } from 'worker_threads';
 import * as path from 'path';
 import { hashParent } from './hash.js';
+import {
+  CTL_COUNT,
+  CTL_DONE,
+  CTL_FIRST,
+  CTL_GEN,
+  CTL_ROOT,
+  CTL_SCRATCH,
+  CTL_SEQ,
+  CTL_STATUS,
+  CTL_STRIDE,
+  PoolWorkerData,
+  foldRun,
+} from './merkle-worker.js';
+
+/* Below 1024 chunks (32 KB) the round trip to the workers costs more than it saves */
+export const PARALLEL_MIN_CHUNKS = 1024;
+
+export interface MerklePoolOptions {
+  /* Inputs with fewer chunks are hashed on the calling thread */
+  minChunks?: number;
+}
+
+interface PoolSlot {
+  worker: Worker;
+  port: MessagePort;
+  seq: number;
+}
+
+/* Smallest power of two that splits n chunks into at most `runs` runs */
+function runSize(n: number, runs: number): number {
+  let size = 1;
+  while (Math.ceil(n / size) > runs) size *= 2;
+  return size;
+}
+
+/**
+ * Persistent pool of merkleization workers sharing one data buffer
+ *
+ * Runs start at multiples of a power of two, so every run is a subtree of the
+ * single-threaded fold and the root is the same as
+ * computeRootFromChunksOptimized for any thread count. Calls are serialized;
+ * workers are unref'd while idle and do not keep the process alive.
+ */
+export class MerklePool {
+  private readonly slots: PoolSlot[] = [];
+  private readonly ctl: Int32Array;
+  private readonly minChunks: number;
+  private data: SharedArrayBuffer;
+  private buf: Uint8Array;
+  private gen = 0;
+  private queue: Promise<unknown> = Promise.resolve();
+  private failed: Error | null = null;
+
+  constructor(
+    readonly threads: number = 4,
+    options: MerklePoolOptions = {}
+  ) {
+    if (!Number.isInteger(threads) || threads < 1) {
+      throw new RangeError(`MerklePool: invalid thread count ${threads}`);
+    }
+    this.minChunks = Math.max(2, options.minChunks ?? PARALLEL_MIN_CHUNKS);
+    this.ctl = new Int32Array(new SharedArrayBuffer(threads * CTL_STRIDE * 4));
+    this.data = new SharedArrayBuffer(0);
+    this.buf = new Uint8Array(this.data);
+
+    for (let slot = 0; slot < threads; slot++) {
+      const { port1, port2 } = new MessageChannel();
+      const init: PoolWorkerData = {
+        merklePool: true,
+        slot,
+        control: this.ctl.buffer as SharedArrayBuffer,
+        data: this.data,
+        port: port2,
+      };
+      const worker = new Worker(path.join(__dirname, 'merkle-worker.js'), {
+        workerData: init,
+        transferList: [port2],
+      });
+      worker.on('error', (err) => this.fail(err));
+      worker.on('exit', (code) => this.fail(new Error(`Worker stopped with exit code ${code}`)));
+      worker.unref();
+      port1.unref();
+      this.slots.push({ worker, port: port1, seq: 0 });
+    }
+  }
+
+  /**
+   * Merkle root of `chunks`, given as 32-byte chunks or as one packed buffer
+   * whose length is a multiple of 32. The input is not modified.
+   */
+  root(chunks: Uint8Array[] | Uint8Array): Promise<Uint8Array> {
+    const call = this.queue.then(() => this.compute(chunks));
+    this.queue = call.catch(() => undefined);
+    return call;
+  }
+
+  /* Stop the workers; pending and later calls reject */
+  async close(): Promise<void> {
+    this.fail(new Error('MerklePool closed'));
+    await Promise.all(this.slots.map((s) => s.worker.terminate()));
+  }
+
+  private fail(err: Error): void {
+    if (this.failed) return;
+    this.failed = err;
+    for (const [threads, pool] of pools) {
+      if (pool === this) pools.delete(threads);
+    }
+    // Wake the caller if it is waiting on a worker that will never answer
+    for (let slot = 0; slot < this.threads; slot++) {
+      Atomics.store(this.ctl, slot * CTL_STRIDE + CTL_DONE, -1);
+      Atomics.notify(this.ctl, slot * CTL_STRIDE + CTL_DONE);
+    }
+  }
+
+  private async compute(chunks: Uint8Array[] | Uint8Array): Promise<Uint8Array> {
+    if (this.failed) throw this.failed;
+
+    const packed = chunks instanceof Uint8Array;
+    if (packed && chunks.length % 32 !== 0) {
+      throw new RangeError(`MerklePool: ${chunks.length} bytes is not a whole number of chunks`);
+    }
+    const n = packed ? chunks.length / 32 : chunks.length;
+    if (n === 0) return new Uint8Array(32);
+    if (n < this.minChunks) {
+      const work = new Uint8Array(n * 32 + Math.ceil(n / 2) * 32 + 32);
+      copyChunks(work, chunks);
+      foldRun(work, 0, n, n * 32, work.length - 32);
+      return work.slice(work.length - 32);
+    }
+
+    const size = runSize(n, this.threads);
+    const runs = Math.ceil(n / size);
+    const scratchBase = n * 32;
+    const rootBase = scratchBase + Math.ceil(n / 2) * 32;
+    this.reserve(rootBase + runs * 32);
+
+    const buf = this.buf;
+    copyChunks(buf, chunks);
+
+    for (let r = 0; r < runs; r++) {
+      const s = this.slots[r];
+      const base = r * CTL_STRIDE;
+      const first = r * size;
+      this.ctl[base + CTL_FIRST] = first;
+      this.ctl[base + CTL_COUNT] = Math.min(size, n - first);
+      this.ctl[base + CTL_SCRATCH] = scratchBase + (first / 2) * 32;
+      this.ctl[base + CTL_ROOT] = rootBase + r * 32;
+      this.ctl[base + CTL_GEN] = this.gen;
+      s.seq = (s.seq + 1) & 0x7fffffff;
+      s.worker.ref();
+      Atomics.store(this.ctl, base + CTL_SEQ, s.seq);
+      Atomics.notify(this.ctl, base + CTL_SEQ);
+    }
+
+    try {
+      for (let r = 0; r < runs; r++) {
+        await this.waitDone(r);
+      }
+    } finally {
+      for (let r = 0; r < runs; r++) this.slots[r].worker.unref();
+    }
+
+    return computeRootSingleThreaded(chunkViews(buf, rootBase / 32, runs)).slice();
+  }
 
-interface WorkerTask {
-  chunks: Uint8Array[];
-  taskId: number;
+  /* Grow the shared data buffer to at least `bytes` and hand it to every worker */
+  private reserve(bytes: number): void {
+    if (this.data.byteLength >= bytes) return;
+    this.data = new SharedArrayBuffer(Math.max(bytes, this.data.byteLength * 2));
+    this.buf = new Uint8Array(this.data);
+    this.gen++;
+    for (const s of this.slots) s.port.postMessage(this.data);
+  }
+
+  private async waitDone(slot: number): Promise<void> {
+    const index = slot * CTL_STRIDE + CTL_DONE;
+    const seq = this.slots[slot].seq;
+    // Atomics.waitAsync is missing from the ES2020 lib typings
+    const waitAsync = (Atomics as any).waitAsync;
+    for (let cur = Atomics.load(this.ctl, index); cur !== seq; ) {
+      if (this.failed) throw this.failed;
+      if (waitAsync) {
+        const res = waitAsync(this.ctl, index, cur);
+        if (res.async) await res.value;
+      } else {
+        Atomics.wait(this.ctl, index, cur);
+      }
+      cur = Atomics.load(this.ctl, index);
+    }
+    if (this.ctl[slot * CTL_STRIDE + CTL_STATUS] !== 0) {
+      throw new Error(`MerklePool: worker ${slot} failed to hash its run`);
+    }
+  }
+}
+
+function copyChunks(buf: Uint8Array, chunks: Uint8Array[] | Uint8Array): void {
+  if (chunks instanceof Uint8Array) {
+    buf.set(chunks, 0);
+  } else {
+    for (let i = 0; i < chunks.length; i++) buf.set(chunks[i], i * 32);
+  }
 }
 
-interface WorkerResult {
-  root: Uint8Array;
-  taskId: number;
+/* 32-byte views of `count` chunks of `buf` starting at chunk `first` */
+function chunkViews(buf: Uint8Array, first: number, count: number): Uint8Array[] {
+  const views: Uint8Array[] = new Array(count);
+  for (let i = 0; i < count; i++) {
+    const off = (first + i) * 32;
+    views[i] = buf.subarray(off, off + 32);
+  }
+  return views;
 }
 
+const pools = new Map<number, MerklePool>();
+
 /**
  * Parallel merkleization using worker threads
- * Splits tree into subtrees, processes in parallel, combines results
+ * Hashes on a shared MerklePool per thread count, created on first use
  */
 export async function computeRootFromChunksParallel(
   chunks: Uint8Array[],
@@ -33,55 +244,16 @@ export async function computeRootFromChunksParallel(
   }
 
   // For small trees, single-threaded is faster (avoid thread overhead)
-  if (chunks.length < 64) {
+  if (chunks.length < PARALLEL_MIN_CHUNKS) {
     return computeRootSingleThreaded(chunks);
   }
 
-  // Split chunks into subtrees for parallel processing
-  const chunkSize = Math.ceil(chunks.length / numThreads);
-  const subtrees: Uint8Array[][] = [];
-
-  for (let i = 0; i < chunks.length; i += chunkSize) {
-    subtrees.push(chunks.slice(i, Math.min(i + chunkSize, chunks.length)));
-  }
-
-  // Process subtrees in parallel
-  const workers: Worker[] = [];
-  const results: Promise<Uint8Array>[] = [];
-
-  try {
-    for (let i = 0; i < subtrees.length; i++) {
-      const promise = new Promise<Uint8Array>((resolve, reject) => {
-        const worker = new Worker(path.join(__dirname, 'merkle-worker.js'), {
-          workerData: { chunks: subtrees[i], taskId: i },
-        });
-
-        workers.push(worker);
-
-        worker.on('message', (result: WorkerResult) => {
-          resolve(result.root);
-        });
-
-        worker.on('error', reject);
-        worker.on('exit', (code) => {
-          if (code !== 0) {
-            reject(new Error(`Worker stopped with exit code ${code}`));
-          }
-        });
-      });
-
-      results.push(promise);
-    }
-
-    // Wait for all subtrees to complete
-    const subtreeRoots = await Promise.all(results);
-
-    // Combine subtree roots into final root
-    return computeRootSingleThreaded(subtreeRoots);
-  } finally {
-    // Clean up workers
-    workers.forEach((w) => w.terminate());
+  let pool = pools.get(numThreads);
+  if (!pool) {
+    pool = new MerklePool(numThreads);
+    pools.set(numThreads, pool);
   }
+  return pool.root(chunks);
 }
 
 /**
@@ -137,58 +309,51 @@ function computeRootSingleThreaded(chunks: Uint8Array[]): Uint8Array {
 export async function benchmarkParallelMerkleization() {
   console.log('╔══════════════════════════════════════════════════════════╗');
   console.log('║  Multi-threaded Merkleization Benchmark                 ║');
-  console.log('║  Intel i7-2600 (2011) - 4 cores, 8 threads              ║');
+  console.log('║  Persistent SharedArrayBuffer pool vs one thread        ║');
   console.log('╚══════════════════════════════════════════════════════════╝\n');
 
-  function generateChunk(): Uint8Array {
-    const chunk = new Uint8Array(32);
-    for (let i = 0; i < 32; i++) {
-      chunk[i] = Math.floor(Math.random() * 256);
-    }
-    return chunk;
-  }
-
-  const testCases = [
-    { size: 256, iterations: 100, threads: [1, 2, 4] },
-    { size: 1024, iterations: 50, threads: [1, 2, 4] },
-    { size: 4096, iterations: 20, threads: [1, 2, 4, 8] },
-  ];
+  const threads = [2, 4];
+  // minChunks: 2 sends every size to the workers so the crossover shows
+  const pools = threads.map((t) => new MerklePool(t, { minChunks: 2 }));
+  const sizesKB = [4, 16, 64, 256, 1024, 4096];
 
-  for (const { size, iterations, threads } of testCases) {
-    console.log(`\nTree size: ${size} leaves`);
-    console.log(`Iterations: ${iterations}`);
-
-    const chunks = Array.from({ length: size }, () => generateChunk());
-    const hashOpsPerMerkleization = size - 1;
+  for (const kb of sizesKB) {
+    const packed = new Uint8Array(kb * 1024);
+    for (let i = 0; i < packed.length; i++) {
+      packed[i] = (i * 2654435761) >>> 24;
+    }
+    const n = packed.length / 32;
+    const work = new Uint8Array(n * 32 + Math.ceil(n / 2) * 32 + 32);
+    const iterations = Math.max(3, Math.round(2048 / kb));
 
-    for (const numThreads of threads) {
+    const time = async (fn: () => unknown): Promise<number> => {
+      await fn();
       const start = performance.now();
-
-      for (let i = 0; i < iterations; i++) {
-        if (numThreads === 1) {
-          computeRootSingleThreaded(chunks);
-        } else {
-          await computeRootFromChunksParallel(chunks, numThreads);
-        }
-      }
-
+      for (let i = 0; i < iterations; i++) await fn();
       const elapsed = (performance.now() - start) / 1000;
-      const merkleizationsPerSec = iterations / elapsed;
-      const totalHashOpsPerSec = merkleizationsPerSec * hashOpsPerMerkleization;
-
+      return (packed.length * iterations) / elapsed / 1e6;
+    };
+
+    console.log(`\nTree size: ${kb} KB (${n} leaves), ${iterations} iterations`);
+    // Same hashing as the workers, on this thread
+    const single = await time(() => {
+      work.set(packed);
+      foldRun(work, 0, n, n * 32, work.length - 32);
+    });
+    console.log(`  1 thread : ${single.toFixed(1)} MB/s`);
+    for (let p = 0; p < pools.length; p++) {
+      const mbs = await time(() => pools[p].root(packed));
       console.log(
-        `  ${numThreads} thread${numThreads > 1 ? 's' : ' '}: ${(totalHashOpsPerSec / 1000000).toFixed(2)}M hash ops/sec`
+        `  ${threads[p]} threads: ${mbs.toFixed(1)} MB/s (${(mbs / single).toFixed(2)}x)`
       );
-
-      if (totalHashOpsPerSec >= 3000000) {
-        console.log(`    ✅ TARGET MET! (3M+)`);
-      }
     }
   }
 
+  await Promise.all(pools.map((p) => p.close()));
+
   console.log('\n═══════════════════════════════════════════════════════════');
-  console.log('Multi-threading scales SHA-256 performance across cores.');
-  console.log('Expected: 4 threads ≈ 3-4x single-thread performance');
+  console.log('Each pool worker folds one power-of-two run in shared memory;');
+  console.log('speedup needs as many free cores as threads.');
   console.log('═══════════════════════════════════════════════════════════');
 }
 
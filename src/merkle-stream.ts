@@ -0,0 +1,152 @@
+import * as path from 'path';
+import { Readable, Transform, TransformCallback } from 'stream';
+import { pipeline } from 'stream/promises';
+import { TypeDesc, SszError } from './types.js';
+
+/* Streaming roots on the native incremental merkleizer (Node only) */
+
+export interface NativeMerkleizer {
+  update(piece: Uint8Array): NativeMerkleizer;
+  digest(): { root: Uint8Array } | { error: SszError; msg: string };
+}
+
+type MerkleizerClass = new (td: TypeDesc) => NativeMerkleizer;
+
+export type RootResult = { root: Uint8Array } | { error: SszError; msg: string };
+
+/* Unfinished steps carry the bytes hashed so far */
+export interface NativeRootTask {
+  next(): IteratorResult<number, RootResult>;
+  [Symbol.iterator](): NativeRootTask;
+}
+
+type RootTaskClass = new (
+  td: TypeDesc,
+  bytes: Uint8Array,
+  opts?: { sliceNs?: number; sliceChunks?: number }
+) => NativeRootTask;
+
+/* n 64-byte messages in, n 32-byte digests out; ways caps the kernel width */
+type HashPairsFn = (pairs: Uint8Array, ways?: 1 | 2 | 4) => Uint8Array;
+
+let addon:
+  | { Merkleizer?: MerkleizerClass; RootTask?: RootTaskClass; hashPairs?: HashPairsFn }
+  | null
+  | undefined;
+
+function loadAddon(): typeof addon {
+  if (addon !== undefined) return addon;
+  addon = null;
+  // From src/ under ts-node and from dist/src/ once compiled
+  for (const root of [path.join(__dirname, '..'), path.join(__dirname, '..', '..')]) {
+    try {
+      addon = require(path.join(root, 'native', 'build', 'Release', 'ssz_native.node'));
+      break;
+    } catch {
+      /* try the next location */
+    }
+  }
+  return addon;
+}
+
+/* The addon's Merkleizer class, or null when the addon is not built */
+export function nativeMerkleizer(): MerkleizerClass | null {
+  return loadAddon()?.Merkleizer ?? null;
+}
+
+/* The addon's RootTask class, or null when the addon is not built */
+export function nativeRootTask(): RootTaskClass | null {
+  return loadAddon()?.RootTask ?? null;
+}
+
+/* The addon's batch pair hash, or null when the addon is not built */
+export function nativeHashPairs(): HashPairsFn | null {
+  return loadAddon()?.hashPairs ?? null;
+}
+
+export class SszStreamError extends Error {
+  constructor(
+    public readonly error: SszError,
+    msg: string
+  ) {
+    super(msg);
+    this.name = 'SszStreamError';
+  }
+}
+
+/*
+ * Transform that hashes whatever is written to it and emits the 32-byte root
+ * once the input ends. Memory stays constant whatever the input size: the
+ * tree frontier lives in the native merkleizer and pieces are not retained.
+ * An invalid input fails the stream with an SszStreamError.
+ */
+export class MerkleizeStream extends Transform {
+  root: Uint8Array | null = null;
+  private readonly hasher: NativeMerkleizer;
+
+  constructor(td: TypeDesc) {
+    super();
+    const Merkleizer = nativeMerkleizer();
+    if (!Merkleizer) throw new Error('Native addon not available');
+    this.hasher = new Merkleizer(td);
+  }
+
+  override _transform(
+    piece: Buffer,
+    _encoding: BufferEncoding,
+    callback: TransformCallback
+  ): void {
+    this.hasher.update(piece);
+    callback();
+  }
+
+  override _flush(callback: TransformCallback): void {
+    const res = this.hasher.digest();
+    if ('error' in res) {
+      callback(new SszStreamError(res.error, res.msg));
+      return;
+    }
+    this.root = res.root;
+    callback(null, res.root);
+  }
+}
+
+/* Root of everything source yields, e.g. fs.createReadStream(path) */
+export async function sszStreamRootFromStream(
+  td: TypeDesc,
+  source: Readable | AsyncIterable<Uint8Array>
+): Promise<RootResult> {
+  const merkleize = new MerkleizeStream(td);
+  try {
+    await pipeline(source, merkleize, async (roots: AsyncIterable<Uint8Array>) => {
+      for await (const _ of roots) {
+        /* the root is kept on merkleize */
+      }
+    });
+  } catch (err) {
+    if (err instanceof SszStreamError) return { error: err.error, msg: err.message };
+    throw err;
+  }
+  return { root: merkleize.root! };
+}
+
+/*
+ * Root of bytes hashed in slices of about sliceMs milliseconds, yielding to
+ * the event loop between slices so timers and I/O keep being served while a
+ * large value hashes. The total cost is that of one call plus a macrotask
+ * per slice.
+ */
+export async function sszRootInSlices(
+  td: TypeDesc,
+  bytes: Uint8Array,
+  opts: { sliceMs?: number } = {}
+): Promise<RootResult> {
+  const RootTask = nativeRootTask();
+  if (!RootTask) throw new Error('Native addon not available');
+  const task = new RootTask(td, bytes, { sliceNs: (opts.sliceMs ?? 1) * 1e6 });
+  for (;;) {
+    const step = task.next();
+    if (step.done) return step.value;
+    await new Promise<void>((resolve) => setImmediate(resolve));
+  }
+}
@@ -1,62 +1,126 @@
 /**
  * Worker thread for parallel merkleization
- * Processes a subtree and returns the root
+ *
+ * A pool worker owns one slot of the pool's control block and sleeps in
+ * Atomics.wait until the main thread bumps its sequence number. It then folds
+ * its run of chunks straight out of the shared data buffer and writes the run
+ * root back into it, so no chunk is ever structured-cloned.
  */
 
-const { parentPort, workerData } = require('worker_threads');
+import { isMainThread, parentPort, receiveMessageOnPort, workerData } from 'worker_threads';
+import type { MessagePort } from 'worker_threads';
 import { hashParent } from './hash.js';
+import { nativeHashPairs } from './merkle-stream.js';
 
-interface WorkerData {
-  chunks: Uint8Array[];
-  taskId: number;
+/* Control block layout: CTL_STRIDE int32 fields per worker slot */
+export const CTL_STRIDE = 8;
+export const CTL_SEQ = 0; // bumped by the main thread to post a task
+export const CTL_DONE = 1; // set to SEQ by the worker once the task is finished
+export const CTL_FIRST = 2; // first chunk of the run
+export const CTL_COUNT = 3; // chunks in the run
+export const CTL_SCRATCH = 4; // byte offset of the run's scratch area
+export const CTL_ROOT = 5; // byte offset the run root is written to
+export const CTL_GEN = 6; // data buffer generation, bumped when it grows
+export const CTL_STATUS = 7; // 0 on success
+
+export interface PoolWorkerData {
+  merklePool: true;
+  slot: number;
+  control: SharedArrayBuffer;
+  data: SharedArrayBuffer;
+  port: MessagePort;
 }
 
-function computeRoot(chunks: Uint8Array[]): Uint8Array {
-  if (chunks.length === 0) return new Uint8Array(32);
-  if (chunks.length === 1) return chunks[0];
+const hashPairs = nativeHashPairs();
 
-  let currentLevel = [...chunks];
+/* Hash `pairs` adjacent pairs at `src` into `dst`; dst <= src may overlap */
+function hashLevel(buf: Uint8Array, src: number, dst: number, pairs: number): void {
+  if (hashPairs) {
+    buf.set(hashPairs(buf.subarray(src, src + pairs * 64)), dst);
+    return;
+  }
+  for (let i = 0; i < pairs; i++) {
+    const l = src + i * 64;
+    buf.set(hashParent(buf.subarray(l, l + 32), buf.subarray(l + 32, l + 64)), dst + i * 32);
+  }
+}
 
-  while (currentLevel.length > 1) {
-    const nextLevel: Uint8Array[] = [];
+/*
+ * Fold chunks [first, first + count) of `buf` and write the 32-byte root at
+ * `root`. The first level hashes from the input into `scratch`, which must
+ * hold ceil(count / 2) chunks, and later levels fold in place there, so the
+ * input is left untouched. An odd node is carried up unhashed, the same fold
+ * as computeRootFromChunksOptimized.
+ */
+export function foldRun(
+  buf: Uint8Array,
+  first: number,
+  count: number,
+  scratch: number,
+  root: number
+): void {
+  const src = first * 32;
+  if (count === 1) {
+    buf.copyWithin(root, src, src + 32);
+    return;
+  }
 
-    let i = 0;
-    while (i + 7 < currentLevel.length) {
-      const batch: Uint8Array[] = [];
-      for (let j = 0; j < 4; j++) {
-        const combined = new Uint8Array(64);
-        combined.set(currentLevel[i + j * 2], 0);
-        combined.set(currentLevel[i + j * 2 + 1], 32);
-        batch.push(combined);
-      }
+  let len = count;
+  let pairs = len >>> 1;
+  hashLevel(buf, src, scratch, pairs);
+  if (len & 1) {
+    buf.copyWithin(scratch + pairs * 32, src + (len - 1) * 32, src + len * 32);
+  }
+  len = (len + 1) >>> 1;
 
-      for (const combined of batch) {
-        const left = combined.subarray(0, 32);
-        const right = combined.subarray(32, 64);
-        nextLevel.push(hashParent(left, right));
-      }
-      i += 8;
+  while (len > 1) {
+    pairs = len >>> 1;
+    hashLevel(buf, scratch, scratch, pairs);
+    if (len & 1) {
+      buf.copyWithin(scratch + pairs * 32, scratch + (len - 1) * 32, scratch + len * 32);
     }
+    len = (len + 1) >>> 1;
+  }
+  buf.copyWithin(root, scratch, scratch + 32);
+}
 
-    while (i + 1 < currentLevel.length) {
-      const parent = hashParent(currentLevel[i], currentLevel[i + 1]);
-      nextLevel.push(parent);
-      i += 2;
-    }
+function serve(init: PoolWorkerData): void {
+  const ctl = new Int32Array(init.control);
+  const base = init.slot * CTL_STRIDE;
+  let buf = new Uint8Array(init.data);
+  let gen = 0;
+  let seq = 0;
 
-    if (i < currentLevel.length) {
-      nextLevel.push(currentLevel[i]);
+  for (;;) {
+    Atomics.wait(ctl, base + CTL_SEQ, seq);
+    seq = Atomics.load(ctl, base + CTL_SEQ);
+
+    // The buffer may have grown several times since the last task
+    if (ctl[base + CTL_GEN] !== gen) {
+      for (let m = receiveMessageOnPort(init.port); m; m = receiveMessageOnPort(init.port)) {
+        buf = new Uint8Array(m.message as SharedArrayBuffer);
+      }
+      gen = ctl[base + CTL_GEN];
     }
 
-    currentLevel = nextLevel;
+    let status = 0;
+    try {
+      foldRun(
+        buf,
+        ctl[base + CTL_FIRST],
+        ctl[base + CTL_COUNT],
+        ctl[base + CTL_SCRATCH],
+        ctl[base + CTL_ROOT]
+      );
+    } catch {
+      status = 1;
+    }
+    ctl[base + CTL_STATUS] = status;
+    Atomics.store(ctl, base + CTL_DONE, seq);
+    Atomics.notify(ctl, base + CTL_DONE);
   }
-
-  return currentLevel[0];
 }
 
-// Process the subtree
-const { chunks, taskId } = workerData as WorkerData;
-const root = computeRoot(chunks);
-
-// Send result back to main thread
-parentPort?.postMessage({ root, taskId });
+if (!isMainThread && parentPort && (workerData as PoolWorkerData | null)?.merklePool) {
+  serve(workerData as PoolWorkerData);
+}
@@ -7,6 +7,30 @@ import { SszError } from './types.js';
 interface StackEntry {
   hash: Uint8Array;
   height: number;
+  zero: boolean; /* root of an all-zero subtree: hash === zeroHash(height) */
+}
+
+/* zeroHashes[h] is the root of 2^h zero chunks, extended on demand */
+const zeroHashes: Uint8Array[] = [new Uint8Array(32)];
+
+export function zeroHash(height: number): Uint8Array {
+  while (zeroHashes.length <= height) {
+    const below = zeroHashes[zeroHashes.length - 1];
+    zeroHashes.push(hashParent(below, below));
+  }
+  return zeroHashes[height];
+}
+
+function isZeroChunk(chunk: Uint8Array): boolean {
+  /* Word-wise scan when the chunk is 4-byte aligned in its buffer */
+  if ((chunk.byteOffset & 3) === 0 && chunk.length === 32) {
+    const words = new Uint32Array(chunk.buffer, chunk.byteOffset, 8);
+    return (words[0] | words[1] | words[2] | words[3] | words[4] | words[5] | words[6] | words[7]) === 0;
+  }
+  for (let i = 0; i < chunk.length; i++) {
+    if (chunk[i] !== 0) return false;
+  }
+  return true;
 }
 
 export function computeRootFromChunks(
@@ -18,7 +42,7 @@ export function computeRootFromChunks(
 
   for (const item of chunkGen) {
     if ('error' in item) return item;
-    pushAndMerge(stack, { hash: item, height: 0 });
+    pushAndMerge(stack, { hash: item, height: 0, zero: isZeroChunk(item) });
     count++;
   }
 
@@ -32,15 +56,13 @@ export function computeRootFromChunks(
     const right = stack.pop()!;
     const left = stack.pop()!;
     const parent = hashParent(left.hash, right.hash);
-    pushAndMerge(stack, { hash: parent, height: Math.max(left.height, right.height) + 1 });
-  }
-
-  let root = stack[0].hash;
-  if (mixinLength !== undefined) {
-    root = mixinLengthRoot(root, mixinLength);
+    pushAndMerge(stack, { hash: parent, height: Math.max(left.height, right.height) + 1, zero: false });
   }
 
-  return { root };
+  /* An all-zero tree's top entry is the shared zeroHashes cache: hand out a copy */
+  const top = stack[0].hash;
+  if (mixinLength !== undefined) return { root: mixinLengthRoot(top, mixinLength) };
+  return { root: top.slice() };
 }
 
 function pushAndMerge(stack: StackEntry[], entry: StackEntry): void {
@@ -51,8 +73,13 @@ function pushAndMerge(stack: StackEntry[], entry: StackEntry): void {
     if (below.height !== top.height) break;
     stack.pop();
     stack.pop();
+    /* Two zero subtrees make the next zero subtree: look it up, don't hash */
+    if (below.zero && top.zero) {
+      stack.push({ hash: zeroHash(below.height + 1), height: below.height + 1, zero: true });
+      continue;
+    }
     const parent = hashParent(below.hash, top.hash);
-    stack.push({ hash: parent, height: below.height + 1 });
+    stack.push({ hash: parent, height: below.height + 1, zero: false });
   }
 }
 
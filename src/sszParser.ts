@@ -104,23 +104,24 @@ function parseVariableList(bytes: Uint8Array): { ranges: Range[]; error: SszErro
       error: SszError.MalformedHeader,
       msg: 'Variable list too short for offsets',
     };
-  const offsets: number[] = [];
-  let i = 0;
-  while (i + 4 <= bytes.length) {
-    const off = readU32LE(bytes, i);
-    if (off < i + 4) break;
-    offsets.push(off);
-    i += 4;
-  }
-  if (offsets.length === 0)
+  // The first offset is where the payload starts, so it fixes the header
+  // length; payload bytes are never read as offsets
+  const view = u32View(bytes);
+  const headerEnd = view.getUint32(0, true);
+  if (headerEnd < 4)
     return { ranges: [], error: SszError.MalformedHeader, msg: 'No offsets found' };
-  const headerEnd = offsets[0];
-  if (headerEnd !== offsets.length * 4)
+  if (headerEnd % 4 !== 0)
     return { ranges: [], error: SszError.BadOffset, msg: 'Offset table misalignment' };
-  for (let j = 1; j < offsets.length; j++) {
-    if (offsets[j] <= offsets[j - 1])
-      return { ranges: [], error: SszError.BadOffset, msg: 'Offsets not strictly increasing' };
-  }
+  if (headerEnd > bytes.length)
+    return { ranges: [], error: SszError.BadOffset, msg: 'Offset table beyond buffer' };
+  const offsets: number[] = [];
+  for (let i = 0; i < headerEnd; i += 4) offsets.push(view.getUint32(i, true));
+  // Fold the ordering check into one flag (&& stops comparing after the first
+  // violation) and report it after the loop rather than returning from inside it
+  let ordered = true;
+  for (let j = 1; j < offsets.length; j++) ordered = ordered && offsets[j] > offsets[j - 1];
+  if (!ordered)
+    return { ranges: [], error: SszError.BadOffset, msg: 'Offsets not strictly increasing' };
   if (offsets[offsets.length - 1] > bytes.length)
     return { ranges: [], error: SszError.LengthOverflow, msg: 'Offset beyond buffer' };
   if (offsets[offsets.length - 1] !== bytes.length)
@@ -152,28 +153,29 @@ function parseVariableContainer(
   }
   if (bytes.length < fixedSize)
     return { ranges: [], error: SszError.MalformedHeader, msg: 'Container too short' };
+  const view = u32View(bytes);
   const offsets: number[] = [];
+  const headerEnd = fixedSize;
   let byteOffset = 0;
+  let ordered = true;
+  // Bounds checks return at the first bad offset in field order; ordering is
+  // folded into a flag the same way and reported once all offsets are read
   for (let i = 0; i < fieldCount; i++) {
     if (fixedFields[i]) {
       byteOffset += td.fieldTypes![i].fixedSize!;
     } else {
-      const off = readU32LE(bytes, byteOffset);
+      const off = view.getUint32(byteOffset, true);
+      if (off < headerEnd)
+        return { ranges: [], error: SszError.BadOffset, msg: 'Offset points into header' };
+      if (off > bytes.length)
+        return { ranges: [], error: SszError.LengthOverflow, msg: 'Offset beyond buffer' };
+      if (offsets.length > 0) ordered = ordered && off > offsets[offsets.length - 1];
       offsets.push(off);
       byteOffset += 4;
     }
   }
-  const headerEnd = fixedSize;
-  for (const off of offsets) {
-    if (off < headerEnd)
-      return { ranges: [], error: SszError.BadOffset, msg: 'Offset points into header' };
-    if (off > bytes.length)
-      return { ranges: [], error: SszError.LengthOverflow, msg: 'Offset beyond buffer' };
-  }
-  for (let i = 1; i < offsets.length; i++) {
-    if (offsets[i] <= offsets[i - 1])
-      return { ranges: [], error: SszError.BadOffset, msg: 'Offsets not strictly increasing' };
-  }
+  if (!ordered)
+    return { ranges: [], error: SszError.BadOffset, msg: 'Offsets not strictly increasing' };
 
   const ranges: Range[] = [];
   let fixedOff = 0;
@@ -194,13 +196,7 @@ function parseVariableContainer(
   return { ranges, error: SszError.None, msg: '' };
 }
 
-function readU32LE(bytes: Uint8Array, offset: number): number {
-  // Fix: use unsigned right-shift to prevent sign extension and ensure result is non-negative
-  return (
-    (bytes[offset] |
-      (bytes[offset + 1] << 8) |
-      (bytes[offset + 2] << 16) |
-      (bytes[offset + 3] << 24)) >>>
-    0
-  );
+function u32View(bytes: Uint8Array): DataView {
+  // getUint32(off, true) is unsigned little-endian, no sign-extension fixups needed
+  return new DataView(bytes.buffer, bytes.byteOffset, bytes.byteLength);
 }
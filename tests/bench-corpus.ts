@@ -0,0 +1,433 @@
+import * as fs from 'fs';
+import * as path from 'path';
+import { execFileSync } from 'child_process';
+import { sszStreamRootFromSlice, TypeDesc, TypeKind } from '../src/index.js';
+import { nativeMerkleizer } from '../src/merkle-stream.js';
+import { CorpusObject, Scenario, listScenarios, loadScenario } from './corpus.js';
+
+/* Cross-implementation benchmark on a shared corpus.
+ *
+ * The corpus is what c-skel's ssz-workload writes: for each scenario a
+ * <name>.ssz file of objects back to back, <name>.type.json with their type
+ * and <name>.roots with one "offset length root" line per object. Every
+ * implementation that is built roots the same objects (one warmup pass, then
+ * --passes timed passes), each root is checked against the corpus, and
+ * throughput and latency percentiles are reported per implementation,
+ * scenario and object size.
+ *
+ *   node dist/tests/bench-corpus.js --corpus <dir> [--passes N]
+ *        [--only ts,native,wasm,c,rust] [--out report.json] [--strict] [scenario...]
+ *
+ * Backends that are not built, or cannot express a scenario's type, are
+ * listed as skipped. Root mismatches are reported; with --strict they also
+ * fail the run. */
+
+/* Roots in object order, and samples[i * passes + p] for pass p of object i */
+interface RunOutput {
+  roots: string[];
+  ns: number[];
+}
+
+interface Backend {
+  name: string;
+  /* Why the backend cannot run here, or null when it can */
+  unavailable(): string | null;
+  /* Why this type cannot be expressed, or null when it can */
+  unsupported(td: TypeDesc): string | null;
+  run(scenario: Scenario, passes: number): RunOutput;
+}
+
+interface Summary {
+  objects: number;
+  bytes: number;
+  samples: number;
+  mbPerSec: number;
+  objectsPerSec: number;
+  p50Us: number;
+  p99Us: number;
+  p999Us: number;
+}
+
+interface BackendReport {
+  status: 'ok' | 'skipped' | 'failed';
+  reason?: string;
+  mismatches?: number;
+  firstMismatch?: number;
+  total?: Summary;
+  bySize?: Record<string, Summary>;
+}
+
+const repoRoot = process.cwd();
+
+function toHex(bytes: Uint8Array): string {
+  return Buffer.from(bytes.buffer, bytes.byteOffset, bytes.byteLength).toString('hex');
+}
+
+function describeType(td: TypeDesc): string {
+  const elem = td.elementType;
+  switch (td.kind) {
+    case TypeKind.Basic:
+      return `uint${(td.fixedSize ?? 0) * 8}`;
+    case TypeKind.Vector:
+      if (elem?.kind === TypeKind.Basic && elem.fixedSize === 1) return `Bytes${td.fixedSize}`;
+      return `Vector[${elem ? describeType(elem) : '?'}]`;
+    case TypeKind.List:
+      return `List[${elem ? describeType(elem) : '?'}, ${td.maxLength}]`;
+    case TypeKind.Bitlist:
+      return `Bitlist[${td.maxLength}]`;
+    case TypeKind.Container:
+      return `Container(${td.fieldTypes?.length ?? 0} fields)`;
+  }
+  return 'unknown';
+}
+
+/* ===== Backends ===== */
+
+/* Time an in-process root function the way the external runners do */
+function runInProcess(
+  scenario: Scenario,
+  passes: number,
+  root: (bytes: Uint8Array) => Uint8Array
+): RunOutput {
+  const { bytes, objects } = scenario;
+  const slices = objects.map((o) => bytes.subarray(o.offset, o.offset + o.len));
+  const roots = slices.map((s) => toHex(root(s)));
+  const ns = new Array<number>(objects.length * passes);
+  for (let p = 0; p < passes; p++) {
+    for (let i = 0; i < slices.length; i++) {
+      const t0 = process.hrtime.bigint();
+      root(slices[i]);
+      ns[i * passes + p] = Number(process.hrtime.bigint() - t0);
+    }
+  }
+  return { roots, ns };
+}
+
+/* Parse "<root> <ns> <ns> ..." lines from ssz-replay or the Rust example */
+function runExternal(file: string, args: string[], passes: number): RunOutput {
+  const out = execFileSync(file, args, { maxBuffer: 1 << 30, encoding: 'utf8' });
+  const roots: string[] = [];
+  const ns: number[] = [];
+  for (const line of out.split('\n')) {
+    if (line === '') continue;
+    const fields = line.split(' ');
+    if (fields.length !== passes + 1) throw new Error(`Unexpected runner output: ${line}`);
+    roots.push(fields[0]);
+    for (let p = 1; p <= passes; p++) ns.push(Number(fields[p]));
+  }
+  return { roots, ns };
+}
+
+function rootOrThrow(result: { root: Uint8Array } | { error: number; msg: string }): Uint8Array {
+  if ('root' in result) return result.root;
+  throw new Error(result.msg);
+}
+
+const tsBackend: Backend = {
+  name: 'ts',
+  unavailable: () => null,
+  unsupported: () => null,
+  run: (s, passes) => runInProcess(s, passes, (b) => rootOrThrow(sszStreamRootFromSlice(s.td, b))),
+};
+
+const nativeBackend: Backend = {
+  name: 'native',
+  unavailable: () => (nativeMerkleizer() ? null : 'addon not built (npm run build:native)'),
+  unsupported: () => null,
+  run: (s, passes) => {
+    const Merkleizer = nativeMerkleizer()!;
+    return runInProcess(s, passes, (b) => rootOrThrow(new Merkleizer(s.td).update(b).digest()));
+  },
+};
+
+/* The wasm crate's descriptor names basic types and takes no nesting below
+ * list or vector elements and container fields */
+function wasmBasic(td: TypeDesc | undefined): string | null {
+  if (td?.kind === TypeKind.Basic && [1, 2, 4, 8].includes(td.fixedSize ?? 0)) {
+    return `uint${td.fixedSize! * 8}`;
+  }
+  if (td?.kind === TypeKind.Vector && td.fixedSize === 32 && td.elementType?.fixedSize === 1) {
+    return 'bytes32';
+  }
+  return null;
+}
+
+function wasmType(td: TypeDesc): object | null {
+  const basic = wasmBasic(td);
+  if (basic) return { type: basic };
+  const elem = wasmBasic(td.elementType);
+  switch (td.kind) {
+    case TypeKind.Bitlist:
+      return { type: 'bitlist' };
+    case TypeKind.List:
+      return elem ? { type: 'list', elementType: { type: elem }, length: td.maxLength } : null;
+    case TypeKind.Vector: {
+      const size = td.elementType?.fixedSize ?? 0;
+      return elem && size > 0
+        ? { type: 'vector', elementType: { type: elem }, length: (td.fixedSize ?? 0) / size }
+        : null;
+    }
+    case TypeKind.Container: {
+      const fields = (td.fieldTypes ?? []).map(wasmBasic);
+      if (fields.some((f) => f === null)) return null;
+      return { type: 'container', fields: fields.map((f) => ({ type: f })) };
+    }
+  }
+  return null;
+}
+
+const wasmPath = path.join(repoRoot, 'wasm', 'pkg-nodejs', 'ssz_verifier_wasm.js');
+
+const wasmBackend: Backend = {
+  name: 'wasm',
+  unavailable: () => (fs.existsSync(wasmPath) ? null : 'not built (npm run build:wasm:node)'),
+  unsupported: (td) => (wasmType(td) ? null : 'nested type'),
+  run: (s, passes) => {
+    const wasm = require(wasmPath);
+    const json = JSON.stringify(wasmType(s.td));
+    return runInProcess(s, passes, (b) => wasm.sszStreamRoot(b, json));
+  },
+};
+
+const replayPath = path.join(repoRoot, 'c-skel', 'build', 'ssz-replay');
+
+const cBackend: Backend = {
+  name: 'c',
+  unavailable: () => (fs.existsSync(replayPath) ? null : 'not built (make -C c-skel tools)'),
+  unsupported: () => null,
+  run: (s, passes) => runExternal(replayPath, ['-r', String(passes), s.prefix], passes),
+};
+
+/* rust-skel's TypeDesc is a kind and one size: the element size for lists
+ * and vectors, the total size for containers */
+function rustType(td: TypeDesc): [string, number] | null {
+  const elem = td.elementType;
+  switch (td.kind) {
+    case TypeKind.Basic:
+      return ['basic', td.fixedSize ?? 0];
+    case TypeKind.Bitlist:
+      return ['bitlist', 0];
+    case TypeKind.List:
+    case TypeKind.Vector:
+      if (elem?.kind !== TypeKind.Basic || !elem.fixedSize) return null;
+      return [td.kind === TypeKind.List ? 'list' : 'vector', elem.fixedSize];
+    case TypeKind.Container:
+      return td.fixedSize ? ['container', td.fixedSize] : null;
+  }
+  return null;
+}
+
+const rustPath = path.join(repoRoot, 'rust-skel', 'target', 'release', 'examples', 'replay');
+
+const rustBackend: Backend = {
+  name: 'rust',
+  unavailable: () =>
+    fs.existsSync(rustPath) ? null : 'not built (cargo build --release --example replay)',
+  unsupported: (td) => (rustType(td) ? null : 'variable-size or nested type'),
+  run: (s, passes) => {
+    const [kind, size] = rustType(s.td)!;
+    return runExternal(rustPath, [kind, String(size), s.prefix, String(passes)], passes);
+  },
+};
+
+const BACKENDS = [tsBackend, nativeBackend, wasmBackend, cBackend, rustBackend];
+
+/* ===== Statistics ===== */
+
+const SIZE_BUCKETS: [string, number][] = [
+  ['<256B', 256],
+  ['256B-4KB', 4096],
+  ['4KB-64KB', 65536],
+  ['64KB-1MB', 1 << 20],
+  ['>=1MB', Infinity],
+];
+
+function sizeBucket(len: number): string {
+  return SIZE_BUCKETS.find(([, limit]) => len < limit)![0];
+}
+
+/* Nearest-rank percentile of sorted samples */
+function percentile(sorted: number[], q: number): number {
+  if (sorted.length === 0) return 0;
+  return sorted[Math.min(sorted.length - 1, Math.ceil(q * sorted.length) - 1)];
+}
+
+function summarize(
+  objects: CorpusObject[],
+  indices: number[],
+  ns: number[],
+  passes: number
+): Summary {
+  const samples: number[] = [];
+  let bytes = 0;
+  for (const i of indices) {
+    bytes += objects[i].len;
+    for (let p = 0; p < passes; p++) samples.push(ns[i * passes + p]);
+  }
+  samples.sort((a, b) => a - b);
+  const totalNs = samples.reduce((a, b) => a + b, 0);
+  return {
+    objects: indices.length,
+    bytes,
+    samples: samples.length,
+    mbPerSec: totalNs > 0 ? (bytes * passes) / (totalNs / 1e9) / 1e6 : 0,
+    objectsPerSec: totalNs > 0 ? samples.length / (totalNs / 1e9) : 0,
+    p50Us: percentile(samples, 0.5) / 1000,
+    p99Us: percentile(samples, 0.99) / 1000,
+    p999Us: percentile(samples, 0.999) / 1000,
+  };
+}
+
+function report(scenario: Scenario, backend: Backend, passes: number): BackendReport {
+  const reason = backend.unavailable() ?? backend.unsupported(scenario.td);
+  if (reason) return { status: 'skipped', reason };
+
+  let out: RunOutput;
+  try {
+    out = backend.run(scenario, passes);
+  } catch (e: any) {
+    return { status: 'failed', reason: String(e.message ?? e).split('\n')[0] };
+  }
+  const { objects } = scenario;
+  if (out.roots.length !== objects.length) {
+    return { status: 'failed', reason: `${out.roots.length} roots for ${objects.length} objects` };
+  }
+
+  let mismatches = 0;
+  let firstMismatch: number | undefined;
+  out.roots.forEach((root, i) => {
+    if (root === objects[i].root) return;
+    mismatches++;
+    firstMismatch ??= i;
+  });
+
+  const buckets = new Map<string, number[]>();
+  objects.forEach((o, i) => {
+    const name = sizeBucket(o.len);
+    if (!buckets.has(name)) buckets.set(name, []);
+    buckets.get(name)!.push(i);
+  });
+  const bySize: Record<string, Summary> = {};
+  for (const [name] of SIZE_BUCKETS) {
+    const indices = buckets.get(name);
+    if (indices) bySize[name] = summarize(objects, indices, out.ns, passes);
+  }
+  const all = objects.map((_, i) => i);
+  return {
+    status: 'ok',
+    mismatches,
+    firstMismatch,
+    total: summarize(objects, all, out.ns, passes),
+    bySize,
+  };
+}
+
+/* ===== Driver ===== */
+
+function usage(): never {
+  console.error(
+    'Usage: bench-corpus --corpus <dir> [--passes N] [--only ts,native,wasm,c,rust]\n' +
+      '                    [--out report.json] [--strict] [scenario...]'
+  );
+  process.exit(2);
+}
+
+function main(): void {
+  let corpus: string | undefined;
+  let passes = 5;
+  let only: string[] | undefined;
+  let outPath: string | undefined;
+  let strict = false;
+  const names: string[] = [];
+
+  const args = process.argv.slice(2);
+  for (let i = 0; i < args.length; i++) {
+    const arg = args[i];
+    if (arg === '--corpus' && i + 1 < args.length) corpus = args[++i];
+    else if (arg === '--passes' && i + 1 < args.length) passes = Number(args[++i]);
+    else if (arg === '--only' && i + 1 < args.length) only = args[++i].split(',');
+    else if (arg === '--out' && i + 1 < args.length) outPath = args[++i];
+    else if (arg === '--strict') strict = true;
+    else if (!arg.startsWith('-')) names.push(arg);
+    else usage();
+  }
+  if (!corpus || !Number.isInteger(passes) || passes < 1) usage();
+
+  const backends = BACKENDS.filter((b) => !only || only.includes(b.name));
+  const scenarios = names.length > 0 ? names : listScenarios(corpus);
+  if (scenarios.length === 0) {
+    console.error(`No scenarios in ${corpus}; write some with c-skel's ssz-workload`);
+    process.exit(1);
+  }
+
+  console.log('SSZ Cross-Implementation Benchmark\n');
+  console.log(`Corpus: ${corpus}, ${passes} timed pass(es) after one warmup\n`);
+
+  const results: object[] = [];
+  let mismatched = 0;
+  for (const name of scenarios) {
+    const scenario = loadScenario(corpus, name);
+    const type = describeType(scenario.td);
+    console.log(
+      `${name}: ${scenario.objects.length} object(s), ${scenario.bytes.length} bytes, ${type}`
+    );
+    console.log(
+      `  ${'impl'.padEnd(8)}${'size'.padEnd(10)}${'objects'.padStart(8)}${'MB/s'.padStart(10)}` +
+        `${'obj/s'.padStart(12)}${'p50 µs'.padStart(12)}${'p99 µs'.padStart(12)}` +
+        `${'p99.9 µs'.padStart(12)}  roots`
+    );
+
+    const byBackend: Record<string, BackendReport> = {};
+    for (const backend of backends) {
+      const r = report(scenario, backend, passes);
+      byBackend[backend.name] = r;
+      if (r.status !== 'ok') {
+        console.log(`  ${backend.name.padEnd(8)}${r.status}: ${r.reason}`);
+        continue;
+      }
+      if (r.mismatches! > 0) mismatched++;
+      const roots =
+        r.mismatches === 0
+          ? 'ok'
+          : `${r.mismatches} differ (first: object ${r.firstMismatch})`;
+      const rows: [string, Summary][] = [['all', r.total!], ...Object.entries(r.bySize!)];
+      for (const [size, s] of rows.length === 2 ? rows.slice(0, 1) : rows) {
+        console.log(
+          `  ${backend.name.padEnd(8)}${size.padEnd(10)}${String(s.objects).padStart(8)}` +
+            `${s.mbPerSec.toFixed(1).padStart(10)}` +
+            `${Math.round(s.objectsPerSec).toLocaleString().padStart(12)}` +
+            `${s.p50Us.toFixed(2).padStart(12)}${s.p99Us.toFixed(2).padStart(12)}` +
+            `${s.p999Us.toFixed(2).padStart(12)}  ${size === 'all' ? roots : ''}`
+        );
+      }
+    }
+    console.log('');
+    results.push({
+      scenario: name,
+      type,
+      typeDesc: scenario.td,
+      objects: scenario.objects.length,
+      bytes: scenario.bytes.length,
+      backends: byBackend,
+    });
+  }
+
+  if (outPath) {
+    const doc = {
+      date: new Date().toISOString(),
+      platform: `${process.platform} ${process.arch}`,
+      node: process.version,
+      corpus: path.resolve(corpus),
+      passes,
+      scenarios: results,
+    };
+    fs.writeFileSync(outPath, JSON.stringify(doc, null, 2) + '\n');
+    console.log(`Report written to ${outPath}`);
+  }
+  if (mismatched > 0) {
+    console.log(`${mismatched} implementation/scenario pair(s) disagree with the corpus roots`);
+    if (strict) process.exit(1);
+  }
+}
+
+main();
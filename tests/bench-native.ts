@@ -94,6 +94,30 @@ elapsed = (performance.now() - start) / 1000;
 let opsChainsafeParent = ITERATIONS / elapsed;
 console.log(`  ${(opsChainsafeParent / 1000000).toFixed(2)}M ops/sec\n`);
 
+// Batch pair hashing: independent messages through interleaved rounds
+console.log('═══════════════════════════════════════════════════════');
+console.log('Batch Pair Hash (hashPairs, 1M pairs per call)\n');
+
+const PAIRS = 1 << 20;
+const pairBuffer = Buffer.alloc(PAIRS * 64);
+for (let i = 0; i < pairBuffer.length; i++) pairBuffer[i] = (i * 31) & 0xff;
+const opsByWays: Record<number, number> = {};
+for (const ways of [1, 2, 4]) {
+  nativeSHA.hashPairs(pairBuffer, ways);
+  let best = Infinity;
+  for (let rep = 0; rep < 5; rep++) {
+    start = performance.now();
+    nativeSHA.hashPairs(pairBuffer, ways);
+    best = Math.min(best, (performance.now() - start) / 1000);
+  }
+  opsByWays[ways] = PAIRS / best;
+  console.log(
+    `  ${ways}-way: ${(opsByWays[ways] / 1000000).toFixed(2)}M pairs/sec ` +
+      `(${(opsByWays[ways] / opsByWays[1]).toFixed(2)}x single-stream)`
+  );
+}
+console.log('');
+
 // Final comparison
 console.log('╔════════════════════════════════════════════════════════╗');
 console.log('║  PERFORMANCE COMPARISON                                ║');
@@ -0,0 +1,43 @@
+import * as fs from 'fs';
+import * as path from 'path';
+import { TypeDesc } from '../src/index.js';
+
+/* Workload files written by c-skel's ssz-workload: <name>.ssz holds the
+ * objects back to back, <name>.type.json their type and <name>.roots one
+ * "offset length root" line per object. Shared by the benchmarks that
+ * replay the same data through several implementations. */
+
+export interface CorpusObject {
+  offset: number;
+  len: number;
+  root: string;
+}
+
+export interface Scenario {
+  name: string;
+  prefix: string;
+  td: TypeDesc;
+  bytes: Uint8Array;
+  objects: CorpusObject[];
+}
+
+export function loadScenario(dir: string, name: string): Scenario {
+  const prefix = path.join(dir, name);
+  const td = JSON.parse(fs.readFileSync(`${prefix}.type.json`, 'utf8')) as TypeDesc;
+  const bytes = new Uint8Array(fs.readFileSync(`${prefix}.ssz`));
+  const objects: CorpusObject[] = [];
+  for (const line of fs.readFileSync(`${prefix}.roots`, 'utf8').split('\n')) {
+    if (line === '') continue;
+    const [offset, len, root] = line.split(' ');
+    objects.push({ offset: Number(offset), len: Number(len), root });
+  }
+  return { name, prefix, td, bytes, objects };
+}
+
+export function listScenarios(dir: string): string[] {
+  return fs
+    .readdirSync(dir)
+    .filter((f) => f.endsWith('.type.json'))
+    .map((f) => f.slice(0, -'.type.json'.length))
+    .sort();
+}
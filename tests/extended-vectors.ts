@@ -1,4 +1,16 @@
+import { Readable } from 'stream';
 import { sszStreamRootFromSlice, TypeDesc, TypeKind, SszError } from '../src/index.js';
+import { hashParent } from '../src/hash.js';
+import { computeRootFromChunks, zeroHash } from '../src/merkle.js';
+import { computeRootFromChunksOptimized } from '../src/merkle-optimized.js';
+import { MerklePool, computeRootFromChunksParallel } from '../src/merkle-parallel.js';
+import {
+  nativeHashPairs,
+  nativeMerkleizer,
+  nativeRootTask,
+  sszRootInSlices,
+  sszStreamRootFromStream,
+} from '../src/merkle-stream.js';
 
 /* Extended test vectors for comprehensive coverage */
 
@@ -424,5 +436,376 @@ console.log('\n=== Extended Test Suite: Negative Cases ===\n');
   );
 }
 
-console.log(`\n✅ Extended Tests: ${passed} passed, ${failed} failed\n`);
-process.exit(failed > 0 ? 1 : 0);
+console.log('\n=== Extended Test Suite: Sparse Merkleization ===\n');
+
+// Reference carry merkleizer without zero-subtree shortcuts
+function referenceRoot(data: Uint8Array): Uint8Array {
+  const stack: { hash: Uint8Array; height: number }[] = [];
+  for (let off = 0; off < data.length; off += 32) {
+    const chunk = new Uint8Array(32);
+    chunk.set(data.subarray(off, Math.min(off + 32, data.length)));
+    stack.push({ hash: chunk, height: 0 });
+    while (stack.length >= 2 && stack[stack.length - 2].height === stack[stack.length - 1].height) {
+      const top = stack.pop()!;
+      const below = stack.pop()!;
+      stack.push({ hash: hashParent(below.hash, top.hash), height: below.height + 1 });
+    }
+  }
+  while (stack.length > 1) {
+    const top = stack.pop()!;
+    const below = stack.pop()!;
+    stack.push({ hash: hashParent(below.hash, top.hash), height: below.height + 1 });
+  }
+  return stack.length ? stack[0].hash : new Uint8Array(32);
+}
+
+function* chunksOf(data: Uint8Array): Generator<Uint8Array> {
+  for (let off = 0; off < data.length; off += 32) {
+    const chunk = new Uint8Array(32);
+    chunk.set(data.subarray(off, Math.min(off + 32, data.length)));
+    yield chunk;
+  }
+}
+
+{
+  const data = new Uint8Array(1000 * 32 + 5);
+  for (const chunkIndex of [-1, 0, 3, 511, 512, 999]) {
+    if (chunkIndex >= 0) data[chunkIndex * 32 + 7] = 0x5a;
+    for (const len of [data.length, 1000 * 32, 64 * 32, 37 * 32]) {
+      const view = data.subarray(0, len);
+      const res = computeRootFromChunks(chunksOf(view), len);
+      const lengthChunk = new Uint8Array(32);
+      new DataView(lengthChunk.buffer).setUint32(0, len, true);
+      const expected = hashParent(referenceRoot(view), lengthChunk);
+      assert(
+        'root' in res && hex(res.root) === hex(expected),
+        `sparse chunks (${len} bytes, non-zero chunk ${chunkIndex}) should match reference`
+      );
+    }
+  }
+}
+
+{
+  let expected = new Uint8Array(32);
+  for (let h = 0; h < 6; h++) expected = hashParent(expected, expected);
+  const res = computeRootFromChunks(chunksOf(new Uint8Array(64 * 32)));
+  assert(hex(zeroHash(6)) === hex(expected), 'zeroHash(6) should be six zero-over-zero hashes');
+  assert('root' in res && hex(res.root) === hex(expected), 'all-zero 64-chunk root should equal zeroHash(6)');
+  if ('root' in res) res.root.fill(0xff);
+  assert(hex(zeroHash(6)) === hex(expected), 'writing to a returned root should not touch the zero cache');
+  const again = computeRootFromChunks(chunksOf(new Uint8Array(64 * 32)));
+  assert('root' in again && hex(again.root) === hex(expected), 'later all-zero roots should be unaffected');
+}
+
+{
+  // A one-chunk value's root is its own chunk, which streamChunksFromSlice
+  // hands out as a view of the input
+  const data = new Uint8Array(32).fill(0x3c);
+  const res = sszStreamRootFromSlice(bytes32Type, data);
+  data.fill(0);
+  assert(
+    'root' in res && hex(res.root) === '3c'.repeat(32),
+    'bytes32 root should not change when the input buffer is reused'
+  );
+}
+
+console.log('\n=== Extended Test Suite: Native Merkleizer ===\n');
+
+function sameResult(
+  a: { root: Uint8Array } | { error: SszError; msg: string },
+  b: { root: Uint8Array } | { error: SszError; msg: string }
+): boolean {
+  if ('root' in a) return 'root' in b && hex(a.root) === hex(b.root);
+  return 'error' in b && a.error === b.error;
+}
+
+function* piecesOf(data: Uint8Array, sizes: (i: number) => number): Generator<Uint8Array> {
+  for (let off = 0, i = 0; off < data.length; i++) {
+    const end = Math.min(data.length, off + sizes(i));
+    yield data.subarray(off, end);
+    off = end;
+  }
+}
+
+async function nativeMerkleizerTests(): Promise<void> {
+  const Merkleizer = nativeMerkleizer();
+  if (!Merkleizer) {
+    console.log('skipped: native addon not built (npm run build:native)');
+    return;
+  }
+
+  let seed = 0x2545f491;
+  const random = (n: number): Uint8Array => {
+    const out = new Uint8Array(n);
+    for (let i = 0; i < n; i++) {
+      seed = (Math.imul(seed, 1103515245) + 12345) >>> 0;
+      out[i] = seed >>> 24;
+    }
+    return out;
+  };
+  const u32 = (v: number): Uint8Array => new Uint8Array(new Uint32Array([v]).buffer);
+  const concat = (...parts: Uint8Array[]): Uint8Array => {
+    const out = new Uint8Array(parts.reduce((n, p) => n + p.length, 0));
+    let off = 0;
+    for (const p of parts) {
+      out.set(p, off);
+      off += p.length;
+    }
+    return out;
+  };
+
+  const varBytes: TypeDesc = { kind: TypeKind.Basic, fixedSize: 0 };
+  const uint40: TypeDesc = { kind: TypeKind.Basic, fixedSize: 5 };
+  const varList: TypeDesc = { kind: TypeKind.List, elementType: varBytes };
+  const fixedContainer: TypeDesc = {
+    kind: TypeKind.Container,
+    fieldTypes: [uint64Type, uint64Type, { kind: TypeKind.Basic, fixedSize: 3 }, bytes32Type],
+  };
+  const varContainer: TypeDesc = {
+    kind: TypeKind.Container,
+    fieldTypes: [uint64Type, varBytes, uint32Type, varBytes, uint16Type],
+  };
+
+  const elem0 = concat(u32(1), random(70));
+  const elem1 = concat(u32(2), random(3));
+  const varListBytes = concat(
+    u32(12),
+    u32(12 + elem0.length),
+    u32(12 + elem0.length + elem1.length),
+    elem0,
+    elem1
+  );
+  const header = (o0: number, o1: number) =>
+    concat(random(8), u32(o0), random(4), u32(o1), random(2));
+  const body0 = random(45);
+  const body1 = random(100);
+  const bitlist = concat(random(99), new Uint8Array([0xc0]));
+
+  const cases: [string, TypeDesc, Uint8Array][] = [
+    ['uint64', uint64Type, random(8)],
+    ['uint64 wrong length', uint64Type, random(9)],
+    ['variable bytes', varBytes, random(1000)],
+    ['bitlist', bitlistType, bitlist],
+    ['bitlist without sentinel', bitlistType, concat(random(10), new Uint8Array(1))],
+    ['empty List[uint8]', listUint8, new Uint8Array(0)],
+    ['List[uint8]', listUint8, random(1000)],
+    ['List[uint32]', listUint32, random(10000)],
+    ['List[uint40]', { kind: TypeKind.List, elementType: uint40 }, random(2000 * 5)],
+    ['misaligned List[uint32]', listUint32, random(10001)],
+    ['Vector[uint64]', vectorUint64, random(4096)],
+    [
+      'zero List[uint64]',
+      { kind: TypeKind.List, elementType: uint64Type },
+      new Uint8Array(1 << 20),
+    ],
+    ['fixed container', fixedContainer, random(51)],
+    ['fixed container wrong length', fixedContainer, random(52)],
+    ['variable list', varList, varListBytes],
+    ['variable container', varContainer, concat(header(22, 67), body0, body1)],
+    ['variable container with gap', varContainer, concat(header(25, 70), random(3), body0, body1)],
+    ['variable container, empty tail', varContainer, concat(header(22, 67), body0)],
+    ['offset into header', varContainer, concat(header(21, 67), random(46), body1)],
+    ['offsets not increasing', varContainer, concat(header(67, 22), body0, body1)],
+    ['offset beyond buffer', varContainer, concat(header(22, 500), body0, body1)],
+    ['container too short', varContainer, random(20)],
+  ];
+
+  const splits: [string, (i: number) => number][] = [
+    ['whole', () => Infinity],
+    ['1-byte pieces', () => 1],
+    ['31/33-byte pieces', (i) => (i % 2 ? 33 : 31)],
+    ['random pieces', () => 1 + (random(1)[0] % 97)],
+  ];
+
+  for (const [name, td, data] of cases) {
+    const expected = sszStreamRootFromSlice(td, data);
+    for (const [split, sizes] of splits) {
+      if (split === '1-byte pieces' && data.length > 65536) continue;
+      const m = new Merkleizer(td);
+      for (const piece of piecesOf(data, sizes)) m.update(piece);
+      assert(
+        sameResult(expected, m.digest()),
+        `native ${name} (${split}) should match sszStreamRootFromSlice`
+      );
+    }
+  }
+
+  {
+    // Both sides size the list header from the first offset; payload words
+    // that look like offsets must not change the result
+    const listList: TypeDesc = { kind: TypeKind.List, elementType: listUint8 };
+    const table = (offsets: number[], len: number): Uint8Array => {
+      const data = random(len);
+      offsets.forEach((o, i) => {
+        if (i * 4 + 4 <= len) data.set(u32(o), i * 4);
+      });
+      return data;
+    };
+    const crafted: [number[], number][] = [
+      [[8, 0x43], 0x43],
+      [[8, 0x43], 0x50],
+      [[8, 0x43], 0x40],
+      [[12, 20, 0x43], 0x43],
+      [[12, 20, 16], 0x43],
+      [[12, 12, 0x43], 0x43],
+      [[4], 4],
+      [[4], 40],
+      [[0], 16],
+      [[3], 16],
+      [[10, 20], 20],
+      [[16, 20], 12],
+      [[8], 6],
+    ];
+    const tables = crafted.map(([offsets, len]) => table(offsets, len));
+    for (let i = 0; i < 400; i++) {
+      const count = 1 + (random(1)[0] % 6);
+      const len = count * 4 + (random(1)[0] % 80);
+      const offsets = [count * 4];
+      for (let j = 1; j < count; j++) {
+        // Mostly ordered tables, with the odd bad offset thrown in
+        const r = random(1)[0];
+        offsets.push(r < 16 ? r : Math.min(len, offsets[j - 1] + (r % 24)));
+      }
+      if (random(1)[0] < 128) offsets[count - 1] = len;
+      tables.push(table(offsets, len));
+    }
+    for (const data of tables) {
+      const expected = sszStreamRootFromSlice(listList, data);
+      for (const [split, sizes] of splits) {
+        const m = new Merkleizer(listList);
+        for (const piece of piecesOf(data, sizes)) m.update(piece);
+        assert(
+          sameResult(expected, m.digest()),
+          `native List[List[uint8]] (${hex(data.subarray(0, 12))}..., ${data.length} bytes, ${split}) should match sszStreamRootFromSlice`
+        );
+      }
+    }
+  }
+
+  {
+    const data = random(1 << 16);
+    const pieces = Readable.from(piecesOf(data, () => 4000));
+    const res = await sszStreamRootFromStream(listUint32, pieces);
+    const expected = sszStreamRootFromSlice(listUint32, data);
+    assert(sameResult(expected, res), 'stream root should match slice root');
+    const bad = await sszStreamRootFromStream(listUint32, Readable.from([data.subarray(0, 7)]));
+    assert(
+      'error' in bad && bad.error === SszError.NonCanonical,
+      'stream of misaligned list should fail'
+    );
+  }
+
+  {
+    // Every kernel width, with batches that do not divide evenly
+    const hashPairs = nativeHashPairs()!;
+    for (let n = 0; n <= 9; n++) {
+      const pairs = random(n * 64);
+      const expected = new Uint8Array(n * 32);
+      for (let i = 0; i < n; i++) {
+        const pair = pairs.subarray(i * 64, i * 64 + 64);
+        expected.set(hashParent(pair.subarray(0, 32), pair.subarray(32)), i * 32);
+      }
+      for (const ways of [1, 2, 4] as const) {
+        const out = hashPairs(Buffer.from(pairs), ways);
+        assert(
+          hex(out) === hex(expected),
+          `hashPairs of ${n} pairs (${ways}-way) should match hashParent`
+        );
+      }
+    }
+  }
+
+  const RootTask = nativeRootTask()!;
+  for (const [name, td, data] of cases) {
+    const expected = sszStreamRootFromSlice(td, data);
+    for (const sliceChunks of [1, 3, 64]) {
+      const task = new RootTask(td, data, { sliceNs: 0, sliceChunks });
+      let step = task.next();
+      let slices = 1;
+      for (; !step.done; slices++) {
+        assert(step.value <= data.length, `RootTask ${name} position should stay in the input`);
+        step = task.next();
+      }
+      assert(
+        sameResult(expected, step.value),
+        `RootTask ${name} (${sliceChunks}-chunk slices) should match sszStreamRootFromSlice`
+      );
+      const again = task.next();
+      assert(
+        again.done === true && sameResult(expected, again.value),
+        `RootTask ${name} result should stick`
+      );
+      if ('root' in expected && data.length > 64 * 32) {
+        assert(
+          slices > data.length / 32 / sliceChunks,
+          `RootTask ${name} should take one slice per budget`
+        );
+      }
+    }
+  }
+
+  {
+    // Timers still fire while a large value hashes in 1 ms slices
+    const data = random(8 << 20);
+    let ticks = 0;
+    const timer = setInterval(() => ticks++, 1);
+    const res = await sszRootInSlices(listUint32, data, { sliceMs: 1 });
+    clearInterval(timer);
+    assert(
+      sameResult(sszStreamRootFromSlice(listUint32, data), res),
+      'sliced root should match slice root'
+    );
+    assert(ticks > 0, 'timers should run between slices');
+    const task = new RootTask(listUint32, data.subarray(0, 4096), { sliceNs: 0, sliceChunks: 16 });
+    const steps = [...task];
+    assert(steps.length === 8 && steps[7] === 4096, 'RootTask should iterate positions until done');
+  }
+}
+
+async function parallelMerkleTests(): Promise<void> {
+  let seed = 0x9e3779b9;
+  const chunkAt = (): Uint8Array => {
+    const c = new Uint8Array(32);
+    for (let i = 0; i < 32; i++) {
+      seed ^= seed << 13;
+      seed ^= seed >>> 17;
+      seed ^= seed << 5;
+      c[i] = seed & 0xff;
+    }
+    return c;
+  };
+
+  // Power-of-two runs keep the pooled root equal to the single-threaded fold
+  for (const threads of [2, 3, 4]) {
+    const pool = new MerklePool(threads, { minChunks: 2 });
+    try {
+      for (const n of [2, 3, 1000, 1024, 1025, 3000, 4097]) {
+        const chunks = Array.from({ length: n }, chunkAt);
+        const expected = hex(computeRootFromChunksOptimized(chunks));
+        const packed = new Uint8Array(n * 32);
+        chunks.forEach((c, i) => packed.set(c, i * 32));
+        const copy = packed.slice();
+        const [fromChunks, fromPacked] = await Promise.all([pool.root(chunks), pool.root(packed)]);
+        assert(hex(fromChunks) === expected, `pool(${threads}) root of ${n} chunks`);
+        assert(hex(fromPacked) === expected, `pool(${threads}) root of ${n} packed chunks`);
+        assert(hex(packed) === hex(copy), `pool(${threads}) should not modify its input`);
+      }
+    } finally {
+      await pool.close();
+    }
+  }
+
+  const chunks = Array.from({ length: 5000 }, chunkAt);
+  assert(
+    hex(await computeRootFromChunksParallel(chunks, 4)) ===
+      hex(computeRootFromChunksOptimized(chunks)),
+    'computeRootFromChunksParallel should match the optimized merkleizer'
+  );
+}
+
+nativeMerkleizerTests()
+  .then(parallelMerkleTests)
+  .then(() => {
+    console.log(`\n✅ Extended Tests: ${passed} passed, ${failed} failed\n`);
+    process.exit(failed > 0 ? 1 : 0);
+  });
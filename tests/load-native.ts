@@ -0,0 +1,344 @@
+import * as fs from 'fs';
+import { Worker, isMainThread, parentPort, workerData } from 'worker_threads';
+import { sszStreamRootFromSlice } from '../src/index.js';
+import { nativeMerkleizer } from '../src/merkle-stream.js';
+import { Scenario, loadScenario } from './corpus.js';
+
+/* Tail latency of the native addon under concurrent offered load.
+ *
+ *   node dist/tests/load-native.js --corpus <dir> [--clients N] [--rate R]
+ *        [--duration S] [--mix scenario:weight,...] [--impl native|ts] [--out file.hgrm]
+ *
+ * Each client is a worker thread that roots corpus objects (written by
+ * c-skel's ssz-workload) one at a time and checks that each object keeps
+ * the same root from call to call. Objects are drawn from the scenarios in
+ * proportion to their weights. With --rate the
+ * clients share R requests per second; latency is counted from each
+ * request's intended start, so a client stuck behind a slow request is
+ * charged for the wait (coordinated-omission correction). Service time from
+ * the actual start is kept alongside. Without --rate the clients run flat
+ * out. The C library's counterpart is c-skel's ssz-load. */
+
+/* ===== HDR histogram =====
+ * Same layout as ssz-load: values below 2048 ns have their own bucket, and
+ * each power of two above is split into 1024, so values are within 0.1%. */
+
+const HDR_SUB_BITS = 10;
+const HDR_SUB = 1 << HDR_SUB_BITS;
+const HDR_MAX_SHIFT = 32;
+const HDR_BUCKETS = (HDR_MAX_SHIFT + 2) * HDR_SUB;
+
+class Hdr {
+  counts = new Float64Array(HDR_BUCKETS);
+  total = 0;
+  max = 0;
+
+  static index(v: number): number {
+    if (v < 2 * HDR_SUB) return Math.max(0, Math.floor(v));
+    const shift = Math.floor(Math.log2(v)) - HDR_SUB_BITS;
+    if (shift > HDR_MAX_SHIFT) return HDR_BUCKETS - 1;
+    return (shift + 1) * HDR_SUB + Math.floor(v / 2 ** shift) - HDR_SUB;
+  }
+
+  /* Largest value that lands in bucket i */
+  static value(i: number): number {
+    if (i < 2 * HDR_SUB) return i;
+    const shift = Math.floor(i / HDR_SUB) - 1;
+    return ((i % HDR_SUB) + HDR_SUB + 1) * 2 ** shift - 1;
+  }
+
+  record(v: number): void {
+    this.counts[Hdr.index(v)]++;
+    this.total++;
+    if (v > this.max) this.max = v;
+  }
+
+  add(other: { counts: Float64Array; total: number; max: number }): void {
+    for (let i = 0; i < HDR_BUCKETS; i++) this.counts[i] += other.counts[i];
+    this.total += other.total;
+    if (other.max > this.max) this.max = other.max;
+  }
+
+  percentile(q: number): number {
+    if (this.total === 0) return 0;
+    const rank = Math.max(1, Math.round((q / 100) * this.total));
+    let seen = 0;
+    for (let i = 0; i < HDR_BUCKETS; i++) {
+      seen += this.counts[i];
+      if (seen >= rank) return Math.min(Hdr.value(i), this.max);
+    }
+    return this.max;
+  }
+
+  /* HdrHistogram's percentile-distribution text format, in microseconds */
+  format(): string {
+    const lines = [
+      `${'Value'.padStart(12)} ${'Percentile'.padStart(14)} ${'TotalCount'.padStart(10)} ` +
+        `${'1/(1-Percentile)'.padStart(14)}`,
+      '',
+    ];
+    let seen = 0;
+    for (let i = 0; i < HDR_BUCKETS; i++) {
+      if (this.counts[i] === 0) continue;
+      seen += this.counts[i];
+      const p = seen / this.total;
+      const v = (Math.min(Hdr.value(i), this.max) / 1e3).toFixed(3).padStart(12);
+      const tail = p < 1 ? ` ${(1 / (1 - p)).toFixed(2).padStart(14)}` : '';
+      lines.push(`${v} ${p.toFixed(12).padStart(14)} ${String(seen).padStart(10)}${tail}`);
+    }
+    lines.push(`#[Max = ${(this.max / 1e3).toFixed(3).padStart(12)}, Total count = ${this.total}]`);
+    return lines.join('\n') + '\n';
+  }
+}
+
+/* ===== Client ===== */
+
+interface ClientConfig {
+  corpus: string;
+  mix: [string, number][];
+  impl: 'native' | 'ts';
+  index: number;
+  clients: number;
+  rate: number;
+}
+
+interface ClientResult {
+  corrected: Hdr[];
+  service: Hdr[];
+  mismatches: number;
+  corpusDiffers: number;
+  failures: number;
+  late: number;
+}
+
+/* Sleeps the thread; Atomics.wait blocks without spinning */
+const sleeper = new Int32Array(new SharedArrayBuffer(4));
+
+function sleepUntil(ns: bigint): void {
+  const ms = Number(ns - process.hrtime.bigint()) / 1e6;
+  if (ms > 0) Atomics.wait(sleeper, 0, 0, ms);
+}
+
+function toHex(bytes: Uint8Array): string {
+  return Buffer.from(bytes.buffer, bytes.byteOffset, bytes.byteLength).toString('hex');
+}
+
+/* Loads the corpus up front; the run's start and end come later, once
+ * every client is ready */
+function prepareClient(cfg: ClientConfig): (startNs: bigint, endNs: bigint) => ClientResult {
+  const scenarios: Scenario[] = cfg.mix.map(([name]) => loadScenario(cfg.corpus, name));
+  return (startNs, endNs) => runClient(cfg, scenarios, startNs, endNs);
+}
+
+function runClient(
+  cfg: ClientConfig,
+  scenarios: Scenario[],
+  startNs: bigint,
+  endNs: bigint
+): ClientResult {
+  const weights = cfg.mix.map(([, w]) => w);
+  const weightTotal = weights.reduce((a, b) => a + b, 0);
+  const Merkleizer = nativeMerkleizer();
+  if (cfg.impl === 'native' && !Merkleizer) throw new Error('native addon not built');
+  const root = (s: Scenario, b: Uint8Array): Uint8Array | null => {
+    const r =
+      cfg.impl === 'native'
+        ? new Merkleizer!(s.td).update(b).digest()
+        : sszStreamRootFromSlice(s.td, b);
+    return 'root' in r ? r.root : null;
+  };
+
+  const result: ClientResult = {
+    corrected: scenarios.map(() => new Hdr()),
+    service: scenarios.map(() => new Hdr()),
+    mismatches: 0,
+    corpusDiffers: 0,
+    failures: 0,
+    late: 0,
+  };
+  /* Client k takes requests k, k + clients, ... of the shared schedule */
+  const interval = cfg.rate > 0 ? BigInt(Math.round((1e9 * cfg.clients) / cfg.rate)) : 0n;
+  let intended = startNs + (cfg.rate > 0 ? BigInt(Math.round((1e9 * cfg.index) / cfg.rate)) : 0n);
+  const seen = scenarios.map(() => new Map<number, string>());
+  let state = Math.imul(cfg.index + 1, 0x9e3779b1) | 1;
+  const random = (): number => {
+    state ^= state << 13;
+    state ^= state >>> 17;
+    state ^= state << 5;
+    return (state >>> 0) / 4294967296;
+  };
+
+  for (;;) {
+    let now = process.hrtime.bigint();
+    if (interval > 0n) {
+      if (intended >= endNs) break;
+      if (now < intended) {
+        sleepUntil(intended);
+        now = process.hrtime.bigint();
+      } else if (now - intended > 1000n) {
+        result.late++;
+      }
+    } else {
+      if (now >= endNs) break;
+      intended = now;
+    }
+
+    let pick = random() * weightTotal;
+    let s = 0;
+    while (pick >= weights[s] && s < weights.length - 1) pick -= weights[s++];
+    const scenario = scenarios[s];
+    const i = Math.floor(random() * scenario.objects.length);
+    const obj = scenario.objects[i];
+    const r = root(scenario, scenario.bytes.subarray(obj.offset, obj.offset + obj.len));
+    const done = process.hrtime.bigint();
+    if (!r) {
+      result.failures++;
+    } else {
+      /* The backends do not all match the generator's roots yet, so the
+       * check is that an object keeps the root it first got */
+      const hex = toHex(r);
+      const first = seen[s].get(i);
+      if (first === undefined) {
+        seen[s].set(i, hex);
+        if (hex !== obj.root) result.corpusDiffers++;
+      } else if (hex !== first) {
+        result.mismatches++;
+      }
+    }
+
+    result.corrected[s].record(Number(done - intended));
+    result.service[s].record(Number(done - now));
+    intended += interval;
+  }
+  return result;
+}
+
+/* ===== Driver ===== */
+
+function usage(): never {
+  console.error(
+    'Usage: load-native --corpus <dir> [--clients N] [--rate R] [--duration S]\n' +
+      '                   [--mix scenario:weight,...] [--impl native|ts] [--out file.hgrm]'
+  );
+  process.exit(2);
+}
+
+function row(name: string, kind: string, h: Hdr, seconds: number): string {
+  const us = (q: number) => (h.percentile(q) / 1e3).toFixed(1).padStart(10);
+  const rate = String(Math.round(h.total / seconds));
+  return (
+    `  ${name.padEnd(26)}${kind.padEnd(11)}${String(h.total).padStart(9)}${rate.padStart(9)}` +
+    `${us(50)}${us(90)}${us(99)}${us(99.9)}${us(99.99)}${(h.max / 1e3).toFixed(1).padStart(11)}`
+  );
+}
+
+async function main(): Promise<void> {
+  let corpus: string | undefined;
+  let clients = 4;
+  let rate = 0;
+  let duration = 10;
+  let mixSpec = 'gossip-attestation-flood:90,sync-aggregate-stream:9,mainnet-block:1';
+  let impl: 'native' | 'ts' = 'native';
+  let outPath: string | undefined;
+
+  const args = process.argv.slice(2);
+  for (let i = 0; i < args.length; i++) {
+    const arg = args[i];
+    if (i + 1 >= args.length) usage();
+    if (arg === '--corpus') corpus = args[++i];
+    else if (arg === '--clients') clients = Number(args[++i]);
+    else if (arg === '--rate') rate = Number(args[++i]);
+    else if (arg === '--duration') duration = Number(args[++i]);
+    else if (arg === '--mix') mixSpec = args[++i];
+    else if (arg === '--impl' && ['native', 'ts'].includes(args[i + 1])) impl = args[++i] as 'ts';
+    else if (arg === '--out') outPath = args[++i];
+    else usage();
+  }
+  if (!corpus || !(clients >= 1) || !(rate >= 0) || !(duration > 0)) usage();
+  const mix = mixSpec.split(',').map((item): [string, number] => {
+    const [name, weight] = item.split(':');
+    return [name, weight === undefined ? 1 : Number(weight)];
+  });
+  if (mix.some(([name, w]) => !(w > 0) || !fs.existsSync(`${corpus}/${name}.ssz`))) {
+    console.error(`Every --mix scenario needs a weight above 0 and its files in ${corpus}`);
+    process.exit(2);
+  }
+  if (impl === 'native' && !nativeMerkleizer()) {
+    console.error('Native addon not built (npm run build:native)');
+    process.exit(1);
+  }
+
+  /* The clock starts once every client has loaded the corpus */
+  const workers = Array.from({ length: clients }, (_, index) => {
+    const cfg: ClientConfig = { corpus: corpus!, mix, impl, index, clients, rate };
+    return new Worker(__filename, { workerData: cfg });
+  });
+  const next = (w: Worker) =>
+    new Promise<any>((resolve, reject) => {
+      w.once('message', resolve);
+      w.once('error', reject);
+    });
+  await Promise.all(workers.map(next));
+  const startNs = process.hrtime.bigint() + 10_000_000n;
+  const endNs = startNs + BigInt(Math.round(duration * 1e9));
+  const done = workers.map(next);
+  workers.forEach((w) => w.postMessage({ startNs, endNs }));
+  const results: ClientResult[] = await Promise.all(done);
+  const seconds = Number(process.hrtime.bigint() - startNs) / 1e9;
+
+  const corrected = mix.map(() => new Hdr());
+  const service = mix.map(() => new Hdr());
+  let mismatches = 0;
+  let corpusDiffers = 0;
+  let failures = 0;
+  let late = 0;
+  for (const r of results) {
+    corpusDiffers += r.corpusDiffers;
+    r.corrected.forEach((h, s) => corrected[s].add(h));
+    r.service.forEach((h, s) => service[s].add(h));
+    mismatches += r.mismatches;
+    failures += r.failures;
+    late += r.late;
+  }
+  const allCorrected = new Hdr();
+  const allService = new Hdr();
+  corrected.forEach((h) => allCorrected.add(h));
+  service.forEach((h) => allService.add(h));
+
+  console.log(
+    `${impl}, ${clients} client(s), ${rate > 0 ? `offered ${rate} req/s` : 'flat out'}, ` +
+      `${seconds.toFixed(1)} s`
+  );
+  console.log(
+    `achieved ${Math.round(allCorrected.total / seconds)} req/s, ${late} started late, ` +
+      `${failures} failed, ${mismatches} root mismatch(es)`
+  );
+  if (corpusDiffers > 0) {
+    console.log(`${corpusDiffers} object(s) rooted differently from the corpus`);
+  }
+  console.log('');
+  const head = ['p50 µs', 'p90 µs', 'p99 µs', 'p99.9 µs', 'p99.99 µs'];
+  console.log(
+    `  ${'scenario'.padEnd(26)}${'latency'.padEnd(11)}${'requests'.padStart(9)}` +
+      `${'req/s'.padStart(9)}${head.map((h) => h.padStart(10)).join('')}${'max µs'.padStart(11)}`
+  );
+  const rows: [string, Hdr, Hdr][] = [
+    ...mix.map(([name], s): [string, Hdr, Hdr] => [name, corrected[s], service[s]]),
+    ['all', allCorrected, allService],
+  ];
+  for (const [name, c, s] of rows) {
+    console.log(row(name, 'corrected', c, seconds));
+    if (rate > 0) console.log(row('', 'service', s, seconds));
+  }
+
+  if (outPath) fs.writeFileSync(outPath, allCorrected.format());
+  if (failures > 0 || mismatches > 0) process.exit(1);
+}
+
+if (isMainThread) {
+  main();
+} else {
+  const run = prepareClient(workerData as ClientConfig);
+  parentPort!.once('message', ({ startNs, endNs }) => parentPort!.postMessage(run(startNs, endNs)));
+  parentPort!.postMessage('ready');
+}